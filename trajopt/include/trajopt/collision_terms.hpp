@@ -1,6 +1,10 @@
 #pragma once
+#include <array>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <Eigen/Core>
 
 #include <tesseract_collision/core/fwd.h>
@@ -10,17 +14,109 @@
 #include <tesseract_visualization/fwd.h>
 
 #include <trajopt_common/fwd.h>
+#include <trajopt_common/macros.h>
 #include <trajopt_sco/sco_common.hpp>
 
 #include <trajopt/cache.hxx>
+#include <trajopt/collision_world_snapshot.hpp>
+#include <trajopt/fwd.hpp>
 #include <trajopt/typedefs.hpp>
 
 namespace trajopt
 {
+/**
+ * @brief A compact contact record holding only the data needed to build the distance expressions
+ * @details It is converted once from a tesseract ContactResult. The link names are interned by the collision
+ * evaluator, see CollisionEvaluator::getLinkName.
+ */
+struct ContactRecord
+{
+  /** @brief The interned ids of the two links, ordered like the contact result link names */
+  std::array<int, 2> link_ids{ -1, -1 };
+
+  /** @brief The index of the link pair in ContactRecords::pairs */
+  std::size_t pair_index{ 0 };
+
+  /** @brief The distance between the two links */
+  double distance{ 0 };
+
+  /** @brief The normal pointing from link 0 to link 1 */
+  Eigen::Vector3d normal{ Eigen::Vector3d::Zero() };
+
+  /** @brief The nearest points in the link frames */
+  std::array<Eigen::Vector3d, 2> nearest_points_local{ Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero() };
+
+  /** @brief The nearest points relative to the link origins, expressed in world at the contact transforms */
+  std::array<Eigen::Vector3d, 2> nearest_points_offset{ Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero() };
+
+  /** @brief The nearest points relative to the link origins, expressed in world at the cc transforms */
+  std::array<Eigen::Vector3d, 2> cc_nearest_points_offset{ Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero() };
+
+  /** @brief The continuous collision time for each link */
+  std::array<double, 2> cc_time{ -1, -1 };
+
+  /** @brief The continuous collision type for each link */
+  std::array<tesseract_collision::ContinuousCollisionType, 2> cc_type{
+    tesseract_collision::ContinuousCollisionType::CCType_None,
+    tesseract_collision::ContinuousCollisionType::CCType_None
+  };
+};
+
+/** @brief A link pair referencing a contiguous range of contact records */
+struct ContactPairRecord
+{
+  /** @brief The interned ids of the two links, ordered like the contact results map key */
+  std::array<int, 2> link_ids{ -1, -1 };
+
+  /** @brief The link pair safety margin data */
+  std::array<double, 2> data{ 0, 0 };
+
+  /** @brief The index of the first contact record of this pair */
+  std::size_t begin{ 0 };
+
+  /** @brief One past the index of the last contact record of this pair */
+  std::size_t end{ 0 };
+};
+
+/** @brief The contact records of a collision check, stored contiguously in contact results map order */
+struct ContactRecords
+{
+  std::vector<ContactRecord> records;
+  std::vector<ContactPairRecord> pairs;
+};
+
+using ContactRecordsConstPtr = std::shared_ptr<const ContactRecords>;
+
 using ContactResultMapConstPtr = std::shared_ptr<const tesseract_collision::ContactResultMap>;
 using ContactResultVectorWrapper = std::vector<std::reference_wrapper<const tesseract_collision::ContactResult>>;
 using ContactResultVectorConstPtr = std::shared_ptr<const ContactResultVectorWrapper>;
 
+/**
+ * @brief A contact query shared by the collision evaluators of different terms checking the same states
+ * @details A cost with a large buffer and a constraint with a tight margin are often added on the same steps. The
+ * evaluators sharing a query check each state once at the largest contact distance they need and each applies its own
+ * margin and coefficient filtering to a copy of the unfiltered results of each sub-segment.
+ */
+struct SharedContactQuery
+{
+  using Ptr = std::shared_ptr<SharedContactQuery>;
+
+  /** @brief The unfiltered contact results of each interpolated sub-segment with contacts, with its index */
+  using SubSegmentResults = std::vector<std::pair<long, tesseract_collision::ContactResultMap>>;
+
+  /** @brief The largest contact distance required by the evaluators sharing the query */
+  double margin{ 0 };
+
+  /** @brief The number of evaluators sharing the query, the cache is only used if there is more than one */
+  int num_evaluators{ 0 };
+
+  /** @brief The unfiltered contact results, keyed by the hash of the checked states */
+  Cache<std::size_t, std::shared_ptr<const SubSegmentResults>> cache{ 4 };
+
+  /** @brief Serializes access to the cache when the evaluators are called from different threads */
+  std::mutex mutex;
+};
+
 /**
  * @brief This contains the different types of expression evaluators used when performing continuous collision checking.
  */
@@ -108,7 +204,8 @@ struct CollisionEvaluator
                      tesseract_collision::ContactTestType contact_test_type,
                      double longest_valid_segment_length,
                      double safety_margin_buffer,
-                     bool dynamic_environment = false);
+                     bool dynamic_environment = false,
+                     std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   virtual ~CollisionEvaluator() = default;
   CollisionEvaluator(const CollisionEvaluator&) = default;
   CollisionEvaluator& operator=(const CollisionEvaluator&) = default;
@@ -154,66 +251,60 @@ struct CollisionEvaluator
 
   /**
    * @brief This function checks to see if results are cached for input variable x. If not it calls CalcCollisions and
-   * caches the results vector with x as the key.
+   * caches the converted contact records with x as the key.
    * @param x Optimizer variables
    */
-  ContactResultVectorConstPtr GetContactResultVectorCached(const DblVec& x);
+  ContactRecordsConstPtr GetContactRecordsCached(const DblVec& x);
 
   /**
-   * @brief This function checks to see if results are cached for input variable x. If not it calls CalcCollisions and
-   * caches the results with x as the key.
+   * @brief Get the contact results vector for input variable x
+   * @details Only the contact records are cached, so this calls CalcCollisions on every call
    * @param x Optimizer variables
    */
-  ContactResultMapConstPtr GetContactResultMapCached(const DblVec& x);
+  DEPRECATED("Use GetContactRecordsCached, the contact results are no longer cached")
+  ContactResultVectorConstPtr GetContactResultVectorCached(const DblVec& x);
 
   /**
-   * @brief Extracts the gradient information based on the contact results
-   * @param dofvals The joint values
-   * @param contact_result The contact results to compute the gradient
-   * @param data Data associated with the link pair the contact results associated with.
-   * @param isTimestep1 Indicates if this is the second timestep when computing gradient for continuous collision
-   * @return The gradient results
+   * @brief Get the contact results for input variable x
+   * @details Only the contact records are cached, so this calls CalcCollisions on every call
+   * @param x Optimizer variables
    */
-  GradientResults GetGradient(const Eigen::VectorXd& dofvals,
-                              const tesseract_collision::ContactResult& contact_result,
-                              const std::array<double, 2>& data,
-                              bool isTimestep1);
+  DEPRECATED("Use GetContactRecordsCached, the contact results are no longer cached")
+  ContactResultMapConstPtr GetContactResultMapCached(const DblVec& x);
 
   /**
-   * @brief Extracts the gradient information based on the contact results
-   * @param dofvals The joint values
-   * @param contact_result The contact results to compute the gradient
-   * @param isTimestep1 Indicates if this is the second timestep when computing gradient for continuous collision
-   * @return The gradient results
+   * @brief Get the link name associated with an interned link id of a contact record
+   * @param link_id The interned link id
+   * @return The link name
    */
-  GradientResults GetGradient(const Eigen::VectorXd& dofvals,
-                              const tesseract_collision::ContactResult& contact_result,
-                              bool isTimestep1);
+  const std::string& getLinkName(int link_id) const;
 
   /**
-   * @brief Extracts the gradient information based on the contact results
+   * @brief Extracts the gradient information based on the contact record
    * @param dofvals The joint values
-   * @param contact_result The contact results to compute the gradient
-   * @param data Data associated with the link pair the contact results associated with.
+   * @param contact_record The contact record to compute the gradient
+   * @param data Data associated with the link pair the contact record is associated with.
    * @param isTimestep1 Indicates if this is the second timestep when computing gradient for continuous collision
    * @return The gradient results
    */
-  GradientResults GetGradient(const Eigen::VectorXd& dofvals0,
-                              const Eigen::VectorXd& dofvals1,
-                              const tesseract_collision::ContactResult& contact_result,
+  GradientResults GetGradient(const Eigen::VectorXd& dofvals,
+                              const ContactRecord& contact_record,
                               const std::array<double, 2>& data,
                               bool isTimestep1);
 
   /**
-   * @brief Extracts the gradient information based on the contact results
-   * @param dofvals The joint values
-   * @param contact_result The contact results to compute the gradient
+   * @brief Extracts the gradient information based on the contact record
+   * @param dofvals0 The joint values at the start state
+   * @param dofvals1 The joint values at the end state
+   * @param contact_record The contact record to compute the gradient
+   * @param data Data associated with the link pair the contact record is associated with.
    * @param isTimestep1 Indicates if this is the second timestep when computing gradient for continuous collision
    * @return The gradient results
    */
   GradientResults GetGradient(const Eigen::VectorXd& dofvals0,
                               const Eigen::VectorXd& dofvals1,
-                              const tesseract_collision::ContactResult& contact_result,
+                              const ContactRecord& contact_record,
+                              const std::array<double, 2>& data,
                               bool isTimestep1);
 
   /**
@@ -222,9 +313,20 @@ struct CollisionEvaluator
    */
   std::shared_ptr<const trajopt_common::SafetyMarginData> getSafetyMarginData() const;
 
+  /**
+   * @brief Share the contact queries of this evaluator with other evaluators checking the same states
+   * @details The evaluators must have the same manipulator, variables, contact test type and longest valid segment
+   * length. The contact distance of the query is raised to cover this evaluator's safety margin data.
+   * @param shared_query The shared contact query
+   */
+  void setSharedContactQuery(std::shared_ptr<SharedContactQuery> shared_query);
+
+  /** @brief Get the contact query shared with other evaluators, nullptr if not shared */
+  std::shared_ptr<SharedContactQuery> getSharedContactQuery() const;
+
   /** @brief The collision results cached results */
 
-  Cache<std::size_t, std::pair<ContactResultMapConstPtr, ContactResultVectorConstPtr>> m_cache{ 2 };
+  Cache<std::size_t, ContactRecordsConstPtr> m_cache{ 2 };
 
 protected:
   std::shared_ptr<const tesseract_kinematics::JointGroup> manip_;
@@ -232,8 +334,17 @@ protected:
   std::vector<std::string> env_active_link_names_;
   std::vector<std::string> manip_active_link_names_;
   std::vector<std::string> diff_active_link_names_;
+  /** @brief Preallocated transforms of the manipulator active links, ordered like manip_active_link_names_ */
+  tesseract_common::VectorIsometry3d manip_active_link_transforms0_;
+  tesseract_common::VectorIsometry3d manip_active_link_transforms1_;
   std::shared_ptr<const trajopt_common::SafetyMarginData> safety_margin_data_;
   double safety_margin_buffer_{ 0 };
+  /** @brief The contact distance the contact manager is configured with */
+  double contact_margin_{ 0 };
+  /** @brief The contact query shared with evaluators of other terms, nullptr if not shared */
+  std::shared_ptr<SharedContactQuery> shared_query_;
+  /** @brief The collision world the contact managers are cloned from, nullptr if the evaluator owns its own */
+  std::shared_ptr<const CollisionWorldSnapshot> snapshot_;
   tesseract_collision::ContactTestType contact_test_type_{ tesseract_collision::ContactTestType::ALL };
   double longest_valid_segment_length_{ 0.05 };
   sco::VarVector vars0_;
@@ -242,25 +353,81 @@ protected:
   std::function<tesseract_common::TransformMap(const Eigen::Ref<const Eigen::VectorXd>& joint_values)> get_state_fn_;
   bool dynamic_environment_{ false };
 
-  std::pair<ContactResultMapConstPtr, ContactResultVectorConstPtr> GetContactResultCached(const DblVec& x);
+  /** @brief The interned link names referenced by the contact records */
+  std::vector<std::string> link_names_;
+  /** @brief Indicates if the interned link is an active link of the manipulator */
+  std::vector<bool> link_is_active_;
+  std::unordered_map<std::string, int> link_ids_;
+
+  /**
+   * @brief Get the interned id of a link, adding it if it has not been seen before
+   * @param link_name The link name
+   * @return The interned link id
+   */
+  int getLinkId(const std::string& link_name);
+
+  /**
+   * @brief Convert the contact results into compact contact records
+   * @param dist_results The contact results map
+   * @return The contact records
+   */
+  ContactRecordsConstPtr createContactRecords(const tesseract_collision::ContactResultMap& dist_results);
+
+  /**
+   * @brief Check if the contact distance of the shared query is larger than the one of the contact manager
+   * @details If it is, contact_margin_ is updated and the caller must apply it to its contact manager.
+   * @return True if the contact manager contact distance must be updated
+   */
+  bool updateContactMargin();
+
+  /**
+   * @brief Get the contact manager for a query
+   * @details If a collision world snapshot is used this is a contact manager checked out of the snapshot until the
+   * handle is destroyed, otherwise it is the evaluator's own contact manager. Its contact distance is updated to
+   * contact_margin_. Call it from the contact query passed to runContactQuery, so a query answered by the shared cache
+   * does not check out a contact manager.
+   * @param contact_manager The evaluator's own contact manager, nullptr if a snapshot is used
+   * @return The handle of the contact manager
+   */
+  DiscreteContactManagerHandle
+  getContactManager(const std::shared_ptr<tesseract_collision::DiscreteContactManager>& contact_manager);
+  ContinuousContactManagerHandle
+  getContactManager(const std::shared_ptr<tesseract_collision::ContinuousContactManager>& contact_manager);
+
+  /** @brief Called with the index and the unfiltered contact results of a sub-segment */
+  using SubSegmentFn = std::function<void(long, tesseract_collision::ContactResultMap&)>;
+
+  /**
+   * @brief Get the unfiltered contact results of each sub-segment, using the shared contact query if more than one
+   * evaluator shares it
+   * @details The evaluator filters the results of each sub-segment in accumulate, so the results kept for a pair do not
+   * depend on the other evaluators sharing the query.
+   * @param key The hash of the checked states
+   * @param contact_query Performs the contact query with the evaluator's contact manager, calling its argument for each
+   * sub-segment with contacts
+   * @param accumulate Filters and accumulates the results of a sub-segment
+   */
+  void runContactQuery(std::size_t key,
+                       const std::function<void(const SubSegmentFn&)>& contact_query,
+                       const SubSegmentFn& accumulate);
 
   void CollisionsToDistanceExpressions(sco::AffExprVector& exprs,
                                        std::vector<std::array<double, 2>>& exprs_data,
-                                       const ContactResultVectorWrapper& dist_results,
+                                       const ContactRecords& dist_results,
                                        const sco::VarVector& vars,
                                        const DblVec& x,
                                        bool isTimestep1);
 
   void CollisionsToDistanceExpressionsW(sco::AffExprVector& exprs,
                                         std::vector<std::array<double, 2>>& exprs_data,
-                                        const tesseract_collision::ContactResultMap& dist_results,
+                                        const ContactRecords& dist_results,
                                         const sco::VarVector& vars,
                                         const DblVec& x,
                                         bool isTimestep1);
 
   void CollisionsToDistanceExpressionsContinuousW(sco::AffExprVector& exprs,
                                                   std::vector<std::array<double, 2>>& exprs_data,
-                                                  const tesseract_collision::ContactResultMap& dist_results,
+                                                  const ContactRecords& dist_results,
                                                   const sco::VarVector& vars0,
                                                   const sco::VarVector& vars1,
                                                   const DblVec& x,
@@ -383,7 +550,8 @@ public:
                                    sco::VarVector vars,
                                    CollisionExpressionEvaluatorType type,
                                    double safety_margin_buffer,
-                                   bool dynamic_environment = false);
+                                   bool dynamic_environment = false,
+                                   std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   /**
   @brief linearize all contact distances in terms of robot dofs
   ;
@@ -428,7 +596,8 @@ public:
                          sco::VarVector vars0,
                          sco::VarVector vars1,
                          CollisionExpressionEvaluatorType type,
-                         double safety_margin_buffer);
+                         double safety_margin_buffer,
+                         std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   void CalcDistExpressions(const DblVec& x,
                            sco::AffExprVector& exprs,
                            std::vector<std::array<double, 2>>& exprs_data) override;
@@ -468,7 +637,8 @@ public:
                              sco::VarVector vars0,
                              sco::VarVector vars1,
                              CollisionExpressionEvaluatorType type,
-                             double safety_margin_buffer);
+                             double safety_margin_buffer,
+                             std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   void CalcDistExpressions(const DblVec& x,
                            sco::AffExprVector& exprs,
                            std::vector<std::array<double, 2>>& exprs_data) override;
@@ -500,7 +670,8 @@ public:
                 tesseract_collision::ContactTestType contact_test_type,
                 sco::VarVector vars,
                 CollisionExpressionEvaluatorType type,
-                double safety_margin_buffer);
+                double safety_margin_buffer,
+                std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   /* constructor for discrete continuous and cast continuous cost */
   CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGroup> manip,
                 std::shared_ptr<const tesseract_environment::Environment> env,
@@ -511,11 +682,14 @@ public:
                 sco::VarVector vars1,
                 CollisionExpressionEvaluatorType type,
                 bool discrete,
-                double safety_margin_buffer);
+                double safety_margin_buffer,
+                std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   sco::ConvexObjective::Ptr convex(const DblVec& x, sco::Model* model) override;
   double value(const DblVec&) override;
   void Plot(const std::shared_ptr<tesseract_visualization::Visualization>& plotter, const DblVec& x) override;
   sco::VarVector getVars() override { return m_calc->GetVars(); }
+  /** @brief Get the collision evaluator of the cost */
+  CollisionEvaluator::Ptr getEvaluator() const { return m_calc; }
 
 private:
   CollisionEvaluator::Ptr m_calc;
@@ -531,7 +705,8 @@ public:
                       tesseract_collision::ContactTestType contact_test_type,
                       sco::VarVector vars,
                       CollisionExpressionEvaluatorType type,
-                      double safety_margin_buffer);
+                      double safety_margin_buffer,
+                      std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   /* constructor for discrete continuous and cast continuous cost */
   CollisionConstraint(std::shared_ptr<const tesseract_kinematics::JointGroup> manip,
                       std::shared_ptr<const tesseract_environment::Environment> env,
@@ -542,11 +717,14 @@ public:
                       sco::VarVector vars1,
                       CollisionExpressionEvaluatorType type,
                       bool discrete,
-                      double safety_margin_buffer);
+                      double safety_margin_buffer,
+                      std::shared_ptr<const CollisionWorldSnapshot> snapshot = nullptr);
   sco::ConvexConstraints::Ptr convex(const DblVec& x, sco::Model* model) override;
   DblVec value(const DblVec&) override;
   void Plot(const DblVec& x);
   sco::VarVector getVars() override { return m_calc->GetVars(); }
+  /** @brief Get the collision evaluator of the constraint */
+  CollisionEvaluator::Ptr getEvaluator() const { return m_calc; }
 
 private:
   CollisionEvaluator::Ptr m_calc;
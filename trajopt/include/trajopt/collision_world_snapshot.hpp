@@ -0,0 +1,185 @@
+#pragma once
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/functional/hash.hpp>
+#include <tesseract_collision/core/fwd.h>
+#include <tesseract_environment/fwd.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt
+{
+/**
+ * @brief A contact manager used for one query
+ * @details A contact manager checked out of a CollisionWorldSnapshot is returned to the snapshot when the handle is
+ * destroyed, so it can be reused by the next query of any thread. A handle may also refer to a contact manager owned
+ * by the caller, which is left alone.
+ */
+template <typename ContactManagerType>
+class ContactManagerHandle
+{
+public:
+  ContactManagerHandle() = default;
+
+  /** @brief Refer to a contact manager owned by the caller */
+  explicit ContactManagerHandle(ContactManagerType& manager) : manager_(&manager) {}
+
+  /**
+   * @param manager The contact manager
+   * @param release Called when the handle is done with the contact manager
+   */
+  ContactManagerHandle(ContactManagerType& manager, std::function<void()> release)
+    : manager_(&manager), release_(std::move(release))
+  {
+  }
+
+  ~ContactManagerHandle() { reset(); }
+  ContactManagerHandle(const ContactManagerHandle&) = delete;
+  ContactManagerHandle& operator=(const ContactManagerHandle&) = delete;
+  ContactManagerHandle(ContactManagerHandle&& other) noexcept
+    : manager_(std::exchange(other.manager_, nullptr)), release_(std::exchange(other.release_, nullptr))
+  {
+  }
+  ContactManagerHandle& operator=(ContactManagerHandle&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      manager_ = std::exchange(other.manager_, nullptr);
+      release_ = std::exchange(other.release_, nullptr);
+    }
+    return *this;
+  }
+
+  ContactManagerType& operator*() const { return *manager_; }
+  ContactManagerType* operator->() const { return manager_; }
+
+  /** @brief Give the contact manager back, the handle is empty afterwards */
+  void reset()
+  {
+    if (release_)
+      release_();
+
+    manager_ = nullptr;
+    release_ = nullptr;
+  }
+
+private:
+  ContactManagerType* manager_{ nullptr };
+  std::function<void()> release_;
+};
+
+using DiscreteContactManagerHandle = ContactManagerHandle<tesseract_collision::DiscreteContactManager>;
+using ContinuousContactManagerHandle = ContactManagerHandle<tesseract_collision::ContinuousContactManager>;
+
+/**
+ * @brief A read-only snapshot of the collision world shared by the collision evaluators of many problems
+ * @details The contact managers of the environment are cloned once when the snapshot is created. Evaluators built on
+ * a snapshot do not clone their own contact managers. Instead each query checks a clone for its set of active links
+ * out of a pool and returns it when it is done, so the number of clones is bounded by the number of concurrent
+ * queries. Before each query an evaluator sets the transforms of its active links and the contact distance, so the
+ * active link poses are the only state an evaluator changes.
+ *
+ * The snapshot must be created from an environment in the same state as the one the problems are built from. It is
+ * not used by evaluators of dynamic environments, since they also move links which are not part of the manipulator.
+ */
+class CollisionWorldSnapshot
+{
+public:
+  using Ptr = std::shared_ptr<CollisionWorldSnapshot>;
+  using ConstPtr = std::shared_ptr<const CollisionWorldSnapshot>;
+
+  /** @param env The environment to take the snapshot of */
+  explicit CollisionWorldSnapshot(const tesseract_environment::Environment& env);
+  ~CollisionWorldSnapshot() = default;
+  CollisionWorldSnapshot(const CollisionWorldSnapshot&) = delete;
+  CollisionWorldSnapshot& operator=(const CollisionWorldSnapshot&) = delete;
+  CollisionWorldSnapshot(CollisionWorldSnapshot&&) = delete;
+  CollisionWorldSnapshot& operator=(CollisionWorldSnapshot&&) = delete;
+
+  /** @brief The revision of the environment the snapshot was taken from */
+  int getRevision() const;
+
+  /**
+   * @brief Check out a discrete contact manager for the active links
+   * @details The contact manager must only be used through the handle, by one thread at a time
+   * @param active_links The active links of the contact manager
+   * @param contact_distance The default contact distance of the contact manager
+   * @return The handle of the discrete contact manager
+   */
+  DiscreteContactManagerHandle getDiscreteContactManager(const std::vector<std::string>& active_links,
+                                                         double contact_distance) const;
+
+  /**
+   * @brief Check out a continuous contact manager for the active links
+   * @details The contact manager must only be used through the handle, by one thread at a time
+   * @param active_links The active links of the contact manager
+   * @param contact_distance The default contact distance of the contact manager
+   * @return The handle of the continuous contact manager
+   */
+  ContinuousContactManagerHandle getContinuousContactManager(const std::vector<std::string>& active_links,
+                                                             double contact_distance) const;
+
+  /** @brief The number of contact managers cloned from the snapshot */
+  std::size_t getNumContactManagers() const;
+
+private:
+  template <typename ContactManagerType>
+  struct ContactManagerPool;
+
+  /** @brief A contact manager cloned for a set of active links */
+  template <typename ContactManagerType>
+  struct PooledContactManager
+  {
+    std::shared_ptr<ContactManagerType> manager;
+    /** @brief The default contact distance the contact manager is configured with */
+    double contact_distance{ -1 };
+    /** @brief The pool the contact manager is returned to, it is destroyed instead if the pool no longer exists */
+    std::weak_ptr<ContactManagerPool<ContactManagerType>> pool;
+    /** @brief The idle contact managers of the pool with the same active links */
+    std::vector<std::unique_ptr<PooledContactManager>>* idle{ nullptr };
+  };
+
+  /** @brief The contact managers cloned from one contact manager of the snapshot */
+  template <typename ContactManagerType>
+  struct ContactManagerPool
+  {
+    using Ptr = std::shared_ptr<ContactManagerPool>;
+
+    std::mutex mutex;
+    /** @brief The contact managers which are not checked out, indexed by their active links */
+    std::unordered_map<std::vector<std::string>,
+                       std::vector<std::unique_ptr<PooledContactManager<ContactManagerType>>>,
+                       boost::hash<std::vector<std::string>>>
+        idle;
+    /** @brief The number of contact managers cloned */
+    std::size_t num_managers{ 0 };
+  };
+
+  /**
+   * @brief Check out an idle contact manager for the active links, cloning one if none is idle
+   * @details Only the lookup is serialized, the contact manager is cloned and configured by the calling thread. The
+   * handle only holds the pooled contact manager, so checking a contact manager out and in again does not allocate. If
+   * the snapshot is destroyed first, the contact manager is destroyed when the handle releases it.
+   */
+  template <typename ContactManagerType>
+  static ContactManagerHandle<ContactManagerType>
+  checkOut(const typename ContactManagerPool<ContactManagerType>::Ptr& pool,
+           const std::shared_ptr<const ContactManagerType>& manager,
+           const std::vector<std::string>& active_links,
+           double contact_distance);
+
+  int revision_{ 0 };
+  std::shared_ptr<const tesseract_collision::DiscreteContactManager> discrete_manager_;
+  std::shared_ptr<const tesseract_collision::ContinuousContactManager> continuous_manager_;
+
+  ContactManagerPool<tesseract_collision::DiscreteContactManager>::Ptr discrete_pool_;
+  ContactManagerPool<tesseract_collision::ContinuousContactManager>::Ptr continuous_pool_;
+};
+}  // namespace trajopt
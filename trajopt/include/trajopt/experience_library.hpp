@@ -0,0 +1,205 @@
+#pragma once
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Core>
+#include <tesseract_environment/fwd.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/typedefs.hpp>
+
+namespace trajopt
+{
+struct ProblemConstructionInfo;
+
+/** @brief A solved trajectory stored in an ExperienceLibrary */
+struct Experience
+{
+  /** @brief The solved trajectory, one row per timestep */
+  TrajArray traj;
+  /** @brief The signature of the environment the trajectory was solved in, see getEnvironmentSignature() */
+  std::string environment_signature;
+  /** @brief The cost of the solved trajectory, the lower cost is kept when the same motion is added twice */
+  double cost{ 0 };
+  /** @brief The value of the library usage counter when the experience was last added or retrieved */
+  std::size_t last_used{ 0 };
+};
+
+/**
+ * @brief A library of solved trajectories used to warm start new problems
+ * @details Experiences are grouped by environment signature and number of joints, and indexed by their start and goal
+ * joint states with a kd-tree. A query returns the nearest experience, time warped to the requested number of steps
+ * and with its endpoints moved onto the requested start and goal. When the capacity is exceeded the least recently
+ * used experience is evicted. The kd-tree of a group is rebuilt on the first retrieve after it changed.
+ */
+class ExperienceLibrary
+{
+public:
+  using Ptr = std::shared_ptr<ExperienceLibrary>;
+  using ConstPtr = std::shared_ptr<const ExperienceLibrary>;
+
+  /** @param capacity The maximum number of experiences stored */
+  explicit ExperienceLibrary(std::size_t capacity = 1000);
+  ~ExperienceLibrary() = default;
+  ExperienceLibrary(const ExperienceLibrary&) = delete;
+  ExperienceLibrary& operator=(const ExperienceLibrary&) = delete;
+  ExperienceLibrary(ExperienceLibrary&&) = delete;
+  ExperienceLibrary& operator=(ExperienceLibrary&&) = delete;
+
+  /**
+   * @brief Add a solved trajectory to the library
+   * @details If an experience with the same start and goal (within merge_tolerance) exists, it is replaced when the new
+   * cost is not higher
+   * @param traj The solved trajectory with at least two rows, one column per joint
+   * @param environment_signature The signature of the environment the trajectory was solved in
+   * @param cost The cost of the solved trajectory
+   */
+  void add(const TrajArray& traj, const std::string& environment_signature, double cost = 0);
+
+  /**
+   * @brief Get the nearest experience adapted to the start and goal
+   * @param traj The adapted trajectory with n_steps rows
+   * @param start The start joint state
+   * @param goal The goal joint state
+   * @param environment_signature The signature of the environment, only experiences with the same signature are used
+   * @param n_steps The number of steps of the adapted trajectory, must be at least two
+   * @param max_distance Experiences whose start and goal are further than this (euclidean norm of both) are ignored
+   * @return True if an experience was found
+   */
+  bool retrieve(TrajArray& traj,
+                const Eigen::Ref<const Eigen::VectorXd>& start,
+                const Eigen::Ref<const Eigen::VectorXd>& goal,
+                const std::string& environment_signature,
+                int n_steps,
+                double max_distance = std::numeric_limits<double>::max());
+
+  /**
+   * @brief Initialize the problem from the nearest experience
+   * @details The start is the current state of the manipulator in the environment. If an experience is found the
+   * init info is set to GIVEN_TRAJ with the adapted trajectory, otherwise it is not changed.
+   * @param pci The problem construction info, the env, kin and basic info must be set
+   * @param goal The goal joint state
+   * @param environment_signature The signature of the environment
+   * @param max_distance Experiences whose start and goal are further than this are ignored
+   * @return True if the init info was set from an experience
+   */
+  bool warmStart(ProblemConstructionInfo& pci,
+                 const Eigen::Ref<const Eigen::VectorXd>& goal,
+                 const std::string& environment_signature,
+                 double max_distance = std::numeric_limits<double>::max());
+
+  /** @brief The number of experiences stored */
+  std::size_t size() const;
+
+  /** @brief Remove all experiences */
+  void clear();
+
+  /** @brief The maximum number of experiences stored */
+  std::size_t getCapacity() const;
+
+  /** @brief Set the maximum number of experiences stored, evicting the least recently used if required */
+  void setCapacity(std::size_t capacity);
+
+  /**
+   * @brief Write the experiences to a json file
+   * @return True if successful
+   */
+  bool save(const std::string& file_path) const;
+
+  /**
+   * @brief Add the experiences from a json file written by save()
+   * @details The capacity is set to the saved capacity. The whole file is validated first, so the library is not
+   * changed if it fails.
+   * @return True if successful
+   */
+  bool load(const std::string& file_path);
+
+  /** @brief Experiences whose start and goal are within this distance of a new one are merged with it */
+  double merge_tolerance{ 1e-4 };
+
+private:
+  struct Bucket;
+
+  /** @brief The location of an experience, the buckets are never moved because they are stored in an unordered_map */
+  struct LRUEntry
+  {
+    Bucket* bucket{ nullptr };
+    std::size_t index{ 0 };
+  };
+  using LRUList = std::list<LRUEntry>;
+
+  /** @brief The experiences with the same environment signature and number of joints */
+  struct Bucket
+  {
+    std::vector<Experience> experiences;
+    /** @brief The start and goal of each experience */
+    std::vector<Eigen::VectorXd> keys;
+    /** @brief The entry of each experience in the least recently used list */
+    std::vector<LRUList::iterator> lru_entries;
+    /** @brief The experience indices ordered as an implicit kd-tree, the median of each range is its node */
+    std::vector<std::size_t> kdtree;
+    /** @brief True if the kd-tree needs to be rebuilt */
+    bool dirty{ true };
+
+    void buildKDTree();
+    void searchKDTree(const Eigen::VectorXd& key,
+                      std::size_t begin,
+                      std::size_t end,
+                      std::size_t depth,
+                      std::size_t& nearest,
+                      double& nearest_dist_sq) const;
+  };
+
+  mutable std::mutex mutex_;
+  std::size_t capacity_;
+  std::size_t usage_counter_{ 0 };
+  std::size_t size_{ 0 };
+  std::unordered_map<std::string, Bucket> buckets_;
+  /** @brief Every experience ordered from least to most recently used */
+  LRUList lru_;
+
+  /**
+   * @brief Find the nearest experience to the key, returns false if the bucket is empty
+   * @details If the kd-tree is out of date it is rebuilt when rebuild is true, otherwise the experiences are scanned
+   */
+  static bool findNearest(Bucket& bucket,
+                          const Eigen::VectorXd& key,
+                          bool rebuild,
+                          std::size_t& nearest,
+                          double& nearest_dist_sq);
+
+  void addUnlocked(const TrajArray& traj, const std::string& environment_signature, double cost);
+  void evictUnlocked();
+
+  /** @brief Mark the experience as the most recently used */
+  void touchUnlocked(Bucket& bucket, std::size_t index);
+};
+
+/**
+ * @brief Adapt a trajectory to a new start, goal and number of steps
+ * @details The trajectory is linearly resampled to n_steps and the start and goal offsets are blended along it
+ * @param traj The trajectory to adapt with at least two rows
+ * @param start The new start joint state
+ * @param goal The new goal joint state
+ * @param n_steps The number of steps of the adapted trajectory, must be at least two
+ * @return The adapted trajectory
+ */
+TrajArray adaptTrajectory(const TrajArray& traj,
+                          const Eigen::Ref<const Eigen::VectorXd>& start,
+                          const Eigen::Ref<const Eigen::VectorXd>& goal,
+                          int n_steps);
+
+/**
+ * @brief Calculate a signature of the fixtures in the environment
+ * @details The signature is a hash of the names, collision geometry types and dimensions, collision origins and current
+ * transforms of the links that are not moved by any active joint, so it is the same for environments with the same
+ * fixtures in the same place. Lengths are rounded to 1e-4 before hashing.
+ */
+std::string getEnvironmentSignature(const tesseract_environment::Environment& env);
+}  // namespace trajopt
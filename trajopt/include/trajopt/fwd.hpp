@@ -8,6 +8,10 @@ enum class CollisionExpressionEvaluatorType;
 struct LinkGradientResults;
 struct GradientResults;
 struct CollisionEvaluator;
+struct SharedContactQuery;
+
+// collision_world_snapshot.hpp
+class CollisionWorldSnapshot;
 
 // problem_description.hpp
 enum class TermType : char;
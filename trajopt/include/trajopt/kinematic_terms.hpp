@@ -68,8 +68,12 @@ struct DynamicCartPoseErrCalculator : public TrajOptVectorOfVector
   Eigen::VectorXd operator()(const Eigen::VectorXd& dof_vals) const override;
 };
 
-/** @brief Used to calculate the jacobian for CartPoseTermInfo */
-struct DynamicCartPoseJacCalculator : sco::MatrixOfVector
+/**
+ * @brief Used to calculate the jacobian for CartPoseTermInfo
+ * @details This also implements sco::VectorAndMatrixOfVector so the error and jacobian can be calculated from a single
+ * forward kinematics evaluation during convexification
+ */
+struct DynamicCartPoseJacCalculator : sco::MatrixOfVector, sco::VectorAndMatrixOfVector
 {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -88,6 +92,9 @@ struct DynamicCartPoseJacCalculator : sco::MatrixOfVector
   /** @brief A offset transform to be applied to target_frame_ location */
   Eigen::Isometry3d target_frame_offset_;
 
+  /** @brief Error function matching DynamicCartPoseErrCalculator, used when the error is requested with the jacobian */
+  ErrorFunctionType error_function_{ nullptr };
+
   /**
    * @brief This is a vector of indices to be returned Default: {0, 1, 2, 3, 4, 5}
    *
@@ -105,9 +112,18 @@ struct DynamicCartPoseJacCalculator : sco::MatrixOfVector
       std::string target_frame,
       const Eigen::Isometry3d& source_frame_offset = Eigen::Isometry3d::Identity(),
       const Eigen::Isometry3d& target_frame_offset = Eigen::Isometry3d::Identity(),
-      const Eigen::VectorXi& indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()));
+      const Eigen::VectorXi& indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()),
+      const Eigen::VectorXd& lower_tolerance = {},
+      const Eigen::VectorXd& upper_tolerance = {});
 
   Eigen::MatrixXd operator()(const Eigen::VectorXd& dof_vals) const override;
+
+  void operator()(const Eigen::VectorXd& dof_vals, Eigen::VectorXd& err, Eigen::MatrixXd& jac) const override;
+
+  /** @brief Calculate the jacobian given the already computed source and target transforms at dof_vals */
+  Eigen::MatrixXd calcJacobian(const Eigen::VectorXd& dof_vals,
+                               const Eigen::Isometry3d& source_tf,
+                               const Eigen::Isometry3d& target_tf) const;
 };
 
 /**
@@ -162,8 +178,12 @@ struct CartPoseErrCalculator : public TrajOptVectorOfVector
   Eigen::VectorXd operator()(const Eigen::VectorXd& dof_vals) const override;
 };
 
-/** @brief Used to calculate the jacobian for StaticCartPoseTermInfo */
-struct CartPoseJacCalculator : sco::MatrixOfVector
+/**
+ * @brief Used to calculate the jacobian for StaticCartPoseTermInfo
+ * @details This also implements sco::VectorAndMatrixOfVector so the error and jacobian can be calculated from a single
+ * forward kinematics evaluation during convexification
+ */
+struct CartPoseJacCalculator : sco::MatrixOfVector, sco::VectorAndMatrixOfVector
 {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -187,6 +207,9 @@ struct CartPoseJacCalculator : sco::MatrixOfVector
   /** @brief The error function to calculate the error difference used for jacobian calculations */
   ErrorDiffFunctionType error_diff_function_;
 
+  /** @brief Error function matching CartPoseErrCalculator, used when the error is requested with the jacobian */
+  ErrorFunctionType error_function_{ nullptr };
+
   /**
    * @brief This is a vector of indices to be returned Default: {0, 1, 2, 3, 4, 5}
    *
@@ -204,9 +227,18 @@ struct CartPoseJacCalculator : sco::MatrixOfVector
       std::string target_frame,
       const Eigen::Isometry3d& source_frame_offset = Eigen::Isometry3d::Identity(),
       const Eigen::Isometry3d& target_frame_offset = Eigen::Isometry3d::Identity(),
-      const Eigen::VectorXi& indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()));
+      const Eigen::VectorXi& indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()),
+      const Eigen::VectorXd& lower_tolerance = {},
+      const Eigen::VectorXd& upper_tolerance = {});
 
   Eigen::MatrixXd operator()(const Eigen::VectorXd& dof_vals) const override;
+
+  void operator()(const Eigen::VectorXd& dof_vals, Eigen::VectorXd& err, Eigen::MatrixXd& jac) const override;
+
+  /** @brief Calculate the jacobian given the already computed source and target transforms at dof_vals */
+  Eigen::MatrixXd calcJacobian(const Eigen::VectorXd& dof_vals,
+                               const Eigen::Isometry3d& source_tf,
+                               const Eigen::Isometry3d& target_tf) const;
 };
 
 /**
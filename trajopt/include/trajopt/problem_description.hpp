@@ -25,6 +25,8 @@ using TrajOptRequest = Json::Value;
 using TrajOptResponse = Json::Value;
 
 struct ProblemConstructionInfo;
+struct SharedContactQuery;
+class CollisionWorldSnapshot;
 
 enum class TermType : char
 {
@@ -89,6 +91,8 @@ public:
   int GetNumDOF() { return m_traj_vars.cols(); }
   std::shared_ptr<const tesseract_kinematics::JointGroup> GetKin() { return m_kin; }
   std::shared_ptr<const tesseract_environment::Environment> GetEnv() { return m_env; }
+  /** @brief The collision world snapshot the collision terms are built on, nullptr if they clone their own */
+  std::shared_ptr<const CollisionWorldSnapshot> getCollisionWorldSnapshot() const { return m_collision_snapshot; }
   void SetInitTraj(const TrajArray& x) { m_init_traj = x; }
   TrajArray GetInitTraj() { return m_init_traj; }
   friend TrajOptProb::Ptr ConstructProblem(const ProblemConstructionInfo&);
@@ -97,13 +101,23 @@ public:
   /** @brief Sets TrajOptProb.has_time  */
   void SetHasTime(bool tmp) { has_time = tmp; }
 
+  /**
+   * @brief Get the contact query shared by the collision terms checking the same states, creating it if needed
+   * @param key Identifies the checked states, the evaluator type, the contact test type and the longest valid segment
+   * @return The shared contact query
+   */
+  std::shared_ptr<SharedContactQuery> getSharedContactQuery(const std::string& key);
+
 private:
   /** @brief If true, the last column in the optimization matrix will be 1/dt */
   bool has_time;
   VarArray m_traj_vars;
   std::shared_ptr<const tesseract_kinematics::JointGroup> m_kin;
   std::shared_ptr<const tesseract_environment::Environment> m_env;
+  std::shared_ptr<const CollisionWorldSnapshot> m_collision_snapshot;
   TrajArray m_init_traj;
+  /** @brief The contact queries shared by collision terms, see getSharedContactQuery */
+  std::unordered_map<std::string, std::shared_ptr<SharedContactQuery>> m_shared_contact_queries;
 };
 
 // void  SetupPlotting(TrajOptProb& prob, Optimizer& opt); TODO: Levi
@@ -244,6 +258,12 @@ public:
   std::shared_ptr<const tesseract_environment::Environment> env;
   std::shared_ptr<const tesseract_kinematics::JointGroup> kin;
 
+  /**
+   * @brief An optional collision world snapshot of env shared with other problems
+   * @details If set, the collision terms use the snapshot's contact managers instead of cloning their own
+   */
+  std::shared_ptr<const CollisionWorldSnapshot> collision_snapshot;
+
   std::vector<sco::Optimizer::Callback> callbacks;
 
   ProblemConstructionInfo(std::shared_ptr<const tesseract_environment::Environment> env) : env(std::move(env)) {}
@@ -698,4 +718,64 @@ TrajOptProb::Ptr ConstructProblem(const Json::Value&,
 TrajOptResult::Ptr OptimizeProblem(const TrajOptProb::Ptr&,
                                    const std::shared_ptr<tesseract_visualization::Visualization>& plotter = nullptr);
 
+/**
+ * @brief Settings for the coarse-to-fine solve performed by OptimizeProblemMultiResolution
+ * @details Each stride defines one coarse level which keeps every stride-th step, the first and last step and every
+ * step referenced by a term or fixed timestep. Levels are solved in the order given, so strides should be listed from
+ * coarsest to finest. The full resolution problem is always solved last.
+ */
+struct MultiResolutionInfo
+{
+  /** @brief The step stride of each coarse level, ordered from coarsest to finest */
+  std::vector<int> strides{ 4 };
+
+  /** @brief Coarse levels with fewer steps than this are skipped */
+  int min_steps{ 3 };
+};
+
+/**
+ * @brief Get the steps of the full problem kept by a coarse level with the provided stride
+ * @details The returned steps are sorted and always contain the first and last step, the fixed timesteps and every
+ * step at which a term starts, ends or is fixed. The term infos must already be hatched so their steps are resolved.
+ * @param pci The problem construction info of the full problem
+ * @param stride The step stride of the coarse level
+ * @return The sorted steps of the full problem kept by the coarse level
+ */
+std::vector<int> getMultiResolutionSteps(const ProblemConstructionInfo& pci, int stride);
+
+/**
+ * @brief Create the problem construction info of a coarse level
+ * @details Term infos are copied and their steps are remapped to the coarse steps. The kept steps are not always evenly
+ * spaced, so joint velocity, acceleration and jerk terms and cartesian velocity terms are split into one term per run
+ * of evenly spaced coarse steps, with their targets, tolerances and limits scaled by the gap of the run. Differences
+ * spanning two runs are dropped. Single timestep collision terms are switched to discrete continuous evaluation, with
+ * the longest valid segment length limited to the largest segment of the provided trajectory, so the motion between
+ * the kept steps is still checked.
+ * @param pci The problem construction info of the full problem, with hatched term infos
+ * @param steps The steps of the full problem kept by the coarse level
+ * @param traj The full resolution trajectory used to initialize the coarse level
+ * @return The coarse problem construction info, or nullptr if the problem contains terms that cannot be coarsened
+ */
+std::shared_ptr<ProblemConstructionInfo> createMultiResolutionInfo(const ProblemConstructionInfo& pci,
+                                                                   const std::vector<int>& steps,
+                                                                   const TrajArray& traj);
+
+/**
+ * @brief Solve the problem coarse-to-fine
+ * @details Each level of the multi resolution info is solved starting from the previous solution, which is then
+ * linearly interpolated to warm start the next level. If the problem uses time or contains terms that cannot be
+ * coarsened only the full resolution problem is solved. The term infos of pci are copied before being hatched, so pci
+ * is left unchanged.
+ * @note Only problems built from a ProblemConstructionInfo and solved with the sco optimizer are supported. Problems
+ * built with trajopt_ifopt and solved with trajopt_sqp have no multi resolution solve.
+ * @param pci The problem construction info of the full problem
+ * @param info The multi resolution settings
+ * @param plotter Optional plotter used for the full resolution solve
+ * @return The result of the full resolution solve
+ */
+TrajOptResult::Ptr
+OptimizeProblemMultiResolution(const ProblemConstructionInfo& pci,
+                               const MultiResolutionInfo& info = MultiResolutionInfo(),
+                               const std::shared_ptr<tesseract_visualization::Visualization>& plotter = nullptr);
+
 }  // namespace trajopt
@@ -80,6 +80,18 @@ public:
   {
   }
 
+  /// supply error function, gradient and a calculator returning both, which must agree with f and dfdx
+  TrajOptCostFromErrFunc(sco::VectorOfVector::Ptr f,
+                         sco::MatrixOfVector::Ptr dfdx,
+                         std::shared_ptr<const sco::VectorAndMatrixOfVector> f_and_dfdx,
+                         sco::VarVector vars,
+                         const Eigen::Ref<const Eigen::VectorXd>& coeffs,
+                         sco::PenaltyType pen_type,
+                         const std::string& name)
+    : CostFromErrFunc(std::move(f), std::move(dfdx), std::move(f_and_dfdx), std::move(vars), coeffs, pen_type, name)
+  {
+  }
+
   void Plot(const std::shared_ptr<tesseract_visualization::Visualization>& plotter, const DblVec& x) override
   {
     // If error function has a inherited from TrajOptVectorOfVector, call its Plot function
@@ -116,6 +128,18 @@ public:
   {
   }
 
+  /// supply error function, gradient and a calculator returning both, which must agree with f and dfdx
+  TrajOptConstraintFromErrFunc(sco::VectorOfVector::Ptr f,
+                               sco::MatrixOfVector::Ptr dfdx,
+                               std::shared_ptr<const sco::VectorAndMatrixOfVector> f_and_dfdx,
+                               sco::VarVector vars,
+                               const Eigen::Ref<const Eigen::VectorXd>& coeffs,
+                               sco::ConstraintType type,
+                               const std::string& name)
+    : ConstraintFromErrFunc(std::move(f), std::move(dfdx), std::move(f_and_dfdx), std::move(vars), coeffs, type, name)
+  {
+  }
+
   void Plot(const std::shared_ptr<tesseract_visualization::Visualization>& plotter, const DblVec& x) override
   {
     // If error function has a inherited from TrajOptVectorOfVector, call its Plot function
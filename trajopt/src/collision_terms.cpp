@@ -13,11 +13,13 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/collision_terms.hpp>
+#include <trajopt/collision_world_snapshot.hpp>
 #include <trajopt/utils.hpp>
 #include <trajopt_sco/expr_ops.hpp>
 #include <trajopt_sco/expr_vec_ops.hpp>
 #include <trajopt_sco/modeling_utils.hpp>
 #include <trajopt_sco/sco_common.hpp>
+#include <trajopt_common/collision_utils.h>
 #include <trajopt_common/eigen_conversions.hpp>
 #include <trajopt_common/logging.hpp>
 #include <trajopt_common/stl_to_string.hpp>
@@ -25,12 +27,12 @@ TRAJOPT_IGNORE_WARNINGS_POP
 
 namespace trajopt
 {
-void CollisionsToDistances(const ContactResultVectorWrapper& dist_results, DblVec& dists)
+void CollisionsToDistances(const ContactRecords& dist_results, DblVec& dists)
 {
   dists.clear();
-  dists.reserve(dist_results.size());
-  for (const auto& dist_result : dist_results)
-    dists.push_back(dist_result.get().distance);
+  dists.reserve(dist_results.records.size());
+  for (const auto& dist_result : dist_results.records)
+    dists.push_back(dist_result.distance);
 }
 
 void DebugPrintInfoHeader(Eigen::Index dof)
@@ -195,66 +197,57 @@ void DebugPrintInfo(const tesseract_collision::ContactResult& res,
 }
 
 GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals,
-                                                const tesseract_collision::ContactResult& contact_result,
+                                                const ContactRecord& contact_record,
                                                 const std::array<double, 2>& data,
                                                 bool isTimestep1)
 {
   GradientResults results(data);
   for (std::size_t i = 0; i < 2; ++i)
   {
-    if (manip_->isActiveLinkName(contact_result.link_names[i]))
+    const auto link_id = static_cast<std::size_t>(contact_record.link_ids[i]);
+    if (link_is_active_[link_id])
     {
       results.gradients[i].has_gradient = true;
 
       // Calculate Jacobian
-      Eigen::MatrixXd jac = manip_->calcJacobian(dofvals, contact_result.link_names[i]);
+      Eigen::MatrixXd jac = manip_->calcJacobian(dofvals, link_names_[link_id]);
 
       // Need to change the base and ref point of the jacobian.
       // When changing ref point you must provide a vector from the current ref
       // point to the new ref point.
       results.gradients[i].scale = 1;
-      Eigen::Isometry3d link_transform = contact_result.transform[i];
-      if (contact_result.cc_type[i] != tesseract_collision::ContinuousCollisionType::CCType_None)
+      Eigen::Vector3d nearest_point_offset = contact_record.nearest_points_offset[i];
+      if (contact_record.cc_type[i] != tesseract_collision::ContinuousCollisionType::CCType_None)
       {
-        assert(contact_result.cc_time[i] >= 0.0 && contact_result.cc_time[i] <= 1.0);
-        results.gradients[i].scale = (isTimestep1) ? contact_result.cc_time[i] : (1 - contact_result.cc_time[i]);
-        link_transform = (isTimestep1) ? contact_result.cc_transform[i] : contact_result.transform[i];
+        assert(contact_record.cc_time[i] >= 0.0 && contact_record.cc_time[i] <= 1.0);
+        results.gradients[i].scale = (isTimestep1) ? contact_record.cc_time[i] : (1 - contact_record.cc_time[i]);
+        nearest_point_offset =
+            (isTimestep1) ? contact_record.cc_nearest_points_offset[i] : contact_record.nearest_points_offset[i];
       }
       // Since the link transform is known do not call calcJacobian with link point
-      tesseract_common::jacobianChangeRefPoint(jac, link_transform.linear() * contact_result.nearest_points_local[i]);
+      tesseract_common::jacobianChangeRefPoint(jac, nearest_point_offset);
 
 #ifndef NDEBUG
-//      Eigen::Isometry3d test_link_transform = manip_->calcFwdKin(dofvals).at(contact_result.link_names[i]);
-//      assert(test_link_transform.isApprox(link_transform, 0.0001));
+//      Eigen::Isometry3d test_link_transform = manip_->calcFwdKin(dofvals).at(link_names_[link_id]);
+//      assert(((test_link_transform.linear() * contact_record.nearest_points_local[i]) - nearest_point_offset).norm() <
+//             0.0001);
 
 //      Eigen::MatrixXd jac_test;
 //      jac_test.resize(6, manip_->numJoints());
-//      tesseract_kinematics::numericalJacobian(jac_test, *manip_, dofvals, contact_result.link_names[i],
-//      contact_result.nearest_points_local[i]); bool check = jac.isApprox(jac_test, 1e-3); assert(check == true);
+//      tesseract_kinematics::numericalJacobian(jac_test, *manip_, dofvals, link_names_[link_id],
+//      contact_record.nearest_points_local[i]); bool check = jac.isApprox(jac_test, 1e-3); assert(check == true);
 #endif
 
-      results.gradients[i].gradient = ((i == 0) ? -1.0 : 1.0) * contact_result.normal.transpose() * jac.topRows(3);
+      results.gradients[i].gradient = ((i == 0) ? -1.0 : 1.0) * contact_record.normal.transpose() * jac.topRows(3);
     }
   }
 
-  // DebugPrintInfo(contact_result, results.gradients[0].gradient, results.gradients[1].gradient, dofvals);
-
   return results;
 }
 
-GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals,
-                                                const tesseract_collision::ContactResult& contact_result,
-                                                bool isTimestep1)
-{
-  // Contains the contact distance threshold and coefficient for the given link pair
-  const std::array<double, 2>& data =
-      safety_margin_data_->getPairSafetyMarginData(contact_result.link_names[0], contact_result.link_names[1]);
-  return GetGradient(dofvals, contact_result, data, isTimestep1);
-}
-
 GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals0,
                                                 const Eigen::VectorXd& dofvals1,
-                                                const tesseract_collision::ContactResult& contact_result,
+                                                const ContactRecord& contact_record,
                                                 const std::array<double, 2>& data,
                                                 bool isTimestep1)
 {
@@ -262,36 +255,36 @@ GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals0,
   Eigen::VectorXd dofvalst = Eigen::VectorXd::Zero(dofvals0.size());
   for (std::size_t i = 0; i < 2; ++i)
   {
-    if (manip_->isActiveLinkName(contact_result.link_names[i]))
+    const auto link_id = static_cast<std::size_t>(contact_record.link_ids[i]);
+    if (link_is_active_[link_id])
     {
       results.gradients[i].has_gradient = true;
 
-      if (contact_result.cc_type[i] == tesseract_collision::ContinuousCollisionType::CCType_Time0)
+      if (contact_record.cc_type[i] == tesseract_collision::ContinuousCollisionType::CCType_Time0)
         dofvalst = dofvals0;
-      else if (contact_result.cc_type[i] == tesseract_collision::ContinuousCollisionType::CCType_Time1)
+      else if (contact_record.cc_type[i] == tesseract_collision::ContinuousCollisionType::CCType_Time1)
         dofvalst = dofvals1;
       else
-        dofvalst = dofvals0 + (dofvals1 - dofvals0) * contact_result.cc_time[i];
+        dofvalst = dofvals0 + (dofvals1 - dofvals0) * contact_record.cc_time[i];
 
       // Calculate Jacobian
-      Eigen::MatrixXd jac = manip_->calcJacobian(dofvalst, contact_result.link_names[i]);
+      Eigen::MatrixXd jac = manip_->calcJacobian(dofvalst, link_names_[link_id]);
 
       // Need to change the base and ref point of the jacobian.
       // When changing ref point you must provide a vector from the current ref
       // point to the new ref point.
-      results.gradients[i].scale = 1;
-      Eigen::Isometry3d link_transform = contact_result.transform[i];
-
-      assert(contact_result.cc_time[i] >= 0.0 && contact_result.cc_time[i] <= 1.0);
-      results.gradients[i].scale = (isTimestep1) ? contact_result.cc_time[i] : (1 - contact_result.cc_time[i]);
-      link_transform = (isTimestep1) ? contact_result.cc_transform[i] : contact_result.transform[i];
+      assert(contact_record.cc_time[i] >= 0.0 && contact_record.cc_time[i] <= 1.0);
+      results.gradients[i].scale = (isTimestep1) ? contact_record.cc_time[i] : (1 - contact_record.cc_time[i]);
+      const Eigen::Vector3d& nearest_point_offset =
+          (isTimestep1) ? contact_record.cc_nearest_points_offset[i] : contact_record.nearest_points_offset[i];
 
       // Since the link transform is known do not call calcJacobian with link point
-      tesseract_common::jacobianChangeRefPoint(jac, link_transform.linear() * contact_result.nearest_points_local[i]);
+      tesseract_common::jacobianChangeRefPoint(jac, nearest_point_offset);
 
 #ifndef NDEBUG
-      Eigen::Isometry3d test_link_transform = manip_->calcFwdKin(dofvalst)[contact_result.link_names[i]];
-      assert(test_link_transform.isApprox(link_transform, 0.0001));
+      Eigen::Isometry3d test_link_transform = manip_->calcFwdKin(dofvalst)[link_names_[link_id]];
+      assert(((test_link_transform.linear() * contact_record.nearest_points_local[i]) - nearest_point_offset).norm() <
+             0.0001);
 
       Eigen::MatrixXd jac_test;
       jac_test.resize(6, manip_->numJoints());
@@ -299,40 +292,171 @@ GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals0,
                                               Eigen::Isometry3d::Identity(),
                                               *manip_,
                                               dofvalst,
-                                              contact_result.link_names[i],
-                                              contact_result.nearest_points_local[i]);
+                                              link_names_[link_id],
+                                              contact_record.nearest_points_local[i]);
       bool check = jac.isApprox(jac_test, 1e-3);
       assert(check == true);
 #endif
 
-      results.gradients[i].gradient = ((i == 0) ? -1.0 : 1.0) * contact_result.normal.transpose() * jac.topRows(3);
+      results.gradients[i].gradient = ((i == 0) ? -1.0 : 1.0) * contact_record.normal.transpose() * jac.topRows(3);
     }
   }
 
-  // DebugPrintInfo(contact_result, results.gradients[0].gradient, results.gradients[1].gradient, dofvalst);
-
   return results;
 }
 
-GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals0,
-                                                const Eigen::VectorXd& dofvals1,
-                                                const tesseract_collision::ContactResult& contact_result,
-                                                bool isTimestep1)
+std::shared_ptr<const trajopt_common::SafetyMarginData> CollisionEvaluator::getSafetyMarginData() const
 {
-  // Contains the contact distance threshold and coefficient for the given link pair
-  const std::array<double, 2>& data =
-      safety_margin_data_->getPairSafetyMarginData(contact_result.link_names[0], contact_result.link_names[1]);
-  return GetGradient(dofvals0, dofvals1, contact_result, data, isTimestep1);
+  return safety_margin_data_;
 }
 
-std::shared_ptr<const trajopt_common::SafetyMarginData> CollisionEvaluator::getSafetyMarginData() const
+void CollisionEvaluator::setSharedContactQuery(std::shared_ptr<SharedContactQuery> shared_query)
 {
-  return safety_margin_data_;
+  if (shared_query_ != nullptr)
+    --shared_query_->num_evaluators;
+
+  shared_query_ = std::move(shared_query);
+  if (shared_query_ == nullptr)
+    return;
+
+  ++shared_query_->num_evaluators;
+  shared_query_->margin =
+      std::max(shared_query_->margin, safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
+}
+
+std::shared_ptr<SharedContactQuery> CollisionEvaluator::getSharedContactQuery() const { return shared_query_; }
+
+bool CollisionEvaluator::updateContactMargin()
+{
+  if (shared_query_ == nullptr || shared_query_->num_evaluators < 2 || !(shared_query_->margin > contact_margin_))
+    return false;
+
+  contact_margin_ = shared_query_->margin;
+  return true;
+}
+
+DiscreteContactManagerHandle CollisionEvaluator::getContactManager(
+    const std::shared_ptr<tesseract_collision::DiscreteContactManager>& contact_manager)
+{
+  const bool margin_changed = updateContactMargin();
+  if (snapshot_ != nullptr)
+    return snapshot_->getDiscreteContactManager(manip_active_link_names_, contact_margin_);
+
+  if (margin_changed)
+    contact_manager->setDefaultCollisionMarginData(contact_margin_);
+
+  return DiscreteContactManagerHandle(*contact_manager);
+}
+
+ContinuousContactManagerHandle CollisionEvaluator::getContactManager(
+    const std::shared_ptr<tesseract_collision::ContinuousContactManager>& contact_manager)
+{
+  const bool margin_changed = updateContactMargin();
+  if (snapshot_ != nullptr)
+    return snapshot_->getContinuousContactManager(manip_active_link_names_, contact_margin_);
+
+  if (margin_changed)
+    contact_manager->setDefaultCollisionMarginData(contact_margin_);
+
+  return ContinuousContactManagerHandle(*contact_manager);
+}
+
+void CollisionEvaluator::runContactQuery(std::size_t key,
+                                         const std::function<void(const SubSegmentFn&)>& contact_query,
+                                         const SubSegmentFn& accumulate)
+{
+  if (shared_query_ == nullptr || shared_query_->num_evaluators < 2)
+  {
+    contact_query(accumulate);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(shared_query_->mutex);
+  auto* it = shared_query_->cache.get(key);
+  if (it != nullptr)
+  {
+    LOG_DEBUG("using shared collision check\n")
+    for (const auto& sub_segment : **it)
+    {
+      tesseract_collision::ContactResultMap contacts{ sub_segment.second };
+      accumulate(sub_segment.first, contacts);
+    }
+    return;
+  }
+
+  auto sub_segments = std::make_shared<SharedContactQuery::SubSegmentResults>();
+  contact_query([&sub_segments, &accumulate](long index, tesseract_collision::ContactResultMap& contacts) {
+    sub_segments->emplace_back(index, contacts);
+    accumulate(index, contacts);
+  });
+  shared_query_->cache.put(key, sub_segments);
+}
+
+const std::string& CollisionEvaluator::getLinkName(int link_id) const
+{
+  return link_names_.at(static_cast<std::size_t>(link_id));
+}
+
+int CollisionEvaluator::getLinkId(const std::string& link_name)
+{
+  auto it = link_ids_.find(link_name);
+  if (it != link_ids_.end())
+    return it->second;
+
+  const auto link_id = static_cast<int>(link_names_.size());
+  link_names_.push_back(link_name);
+  link_is_active_.push_back(manip_->isActiveLinkName(link_name));
+  link_ids_[link_name] = link_id;
+  return link_id;
+}
+
+ContactRecordsConstPtr
+CollisionEvaluator::createContactRecords(const tesseract_collision::ContactResultMap& dist_results)
+{
+  auto contact_records = std::make_shared<ContactRecords>();
+  contact_records->records.reserve(dist_results.count());
+  for (const auto& pair : dist_results)
+  {
+    if (pair.second.empty())
+      continue;
+
+    ContactPairRecord pair_record;
+    pair_record.link_ids = { getLinkId(pair.first.first), getLinkId(pair.first.second) };
+    pair_record.data = safety_margin_data_->getPairSafetyMarginData(pair.first.first, pair.first.second);
+    pair_record.begin = contact_records->records.size();
+    for (const tesseract_collision::ContactResult& res : pair.second)
+    {
+      ContactRecord record;
+
+      // The contact result link order is not required to match the map key order
+      if (res.link_names[0] == pair.first.first)
+        record.link_ids = pair_record.link_ids;
+      else
+        record.link_ids = { pair_record.link_ids[1], pair_record.link_ids[0] };
+
+      record.pair_index = contact_records->pairs.size();
+      record.distance = res.distance;
+      record.normal = res.normal;
+      for (std::size_t i = 0; i < 2; ++i)
+      {
+        record.nearest_points_local[i] = res.nearest_points_local[i];
+        record.nearest_points_offset[i] = res.transform[i].linear() * res.nearest_points_local[i];
+        record.cc_nearest_points_offset[i] = res.cc_transform[i].linear() * res.nearest_points_local[i];
+        record.cc_time[i] = res.cc_time[i];
+        record.cc_type[i] = res.cc_type[i];
+      }
+      contact_records->records.push_back(record);
+    }
+    pair_record.end = contact_records->records.size();
+    contact_records->pairs.push_back(pair_record);
+  }
+
+  return contact_records;
 }
 
 void CollisionEvaluator::CollisionsToDistanceExpressions(sco::AffExprVector& exprs,
                                                          std::vector<std::array<double, 2>>& exprs_data,
-                                                         const ContactResultVectorWrapper& dist_results,
+                                                         const ContactRecords& dist_results,
                                                          const sco::VarVector& vars,
                                                          const DblVec& x,
                                                          bool isTimestep1)
@@ -345,12 +469,12 @@ void CollisionEvaluator::CollisionsToDistanceExpressions(sco::AffExprVector& exp
 
   exprs.clear();
   exprs_data.clear();
-  exprs.reserve(dist_results.size());
-  exprs_data.reserve(dist_results.size());
-  for (const auto& res : dist_results)
+  exprs.reserve(dist_results.records.size());
+  exprs_data.reserve(dist_results.records.size());
+  for (const auto& res : dist_results.records)
   {
     sco::AffExpr dist(0);
-    GradientResults grad = GetGradient(dofvals, res.get(), isTimestep1);
+    GradientResults grad = GetGradient(dofvals, res, dist_results.pairs[res.pair_index].data, isTimestep1);
     for (const auto& g : grad.gradients)
     {
       if (g.has_gradient)
@@ -370,7 +494,7 @@ void CollisionEvaluator::CollisionsToDistanceExpressions(sco::AffExprVector& exp
 
 void CollisionEvaluator::CollisionsToDistanceExpressionsW(sco::AffExprVector& exprs,
                                                           std::vector<std::array<double, 2>>& exprs_data,
-                                                          const tesseract_collision::ContactResultMap& dist_results,
+                                                          const ContactRecords& dist_results,
                                                           const sco::VarVector& vars,
                                                           const DblVec& x,
                                                           bool isTimestep1)
@@ -383,13 +507,10 @@ void CollisionEvaluator::CollisionsToDistanceExpressionsW(sco::AffExprVector& ex
 
   exprs.clear();
   exprs_data.clear();
-  exprs.reserve(dist_results.count());
-  exprs_data.reserve(dist_results.count());
-  for (const auto& pair : dist_results)
+  exprs.reserve(dist_results.pairs.size());
+  exprs_data.reserve(dist_results.pairs.size());
+  for (const auto& pair : dist_results.pairs)
   {
-    if (pair.second.empty())
-      continue;
-
     double worst_dist{ std::numeric_limits<double>::max() };
     double total_weight[2];
     bool found[2];
@@ -405,11 +526,11 @@ void CollisionEvaluator::CollisionsToDistanceExpressionsW(sco::AffExprVector& ex
     dist_grad[1] = Eigen::VectorXd::Zero(manip_->numJoints());
 
     // Contains the contact distance threshold and coefficient for the given link pair
-    const std::array<double, 2>& data =
-        safety_margin_data_->getPairSafetyMarginData(pair.first.first, pair.first.second);
+    const std::array<double, 2>& data = pair.data;
 
-    for (const auto& res : pair.second)
+    for (std::size_t r = pair.begin; r < pair.end; ++r)
     {
+      const ContactRecord& res = dist_results.records[r];
       GradientResults grad = GetGradient(dofvals, res, data, isTimestep1);
 
       for (std::size_t i = 0; i < 2; ++i)
@@ -458,7 +579,7 @@ void CollisionEvaluator::CollisionsToDistanceExpressionsW(sco::AffExprVector& ex
 void CollisionEvaluator::CollisionsToDistanceExpressionsContinuousW(
     sco::AffExprVector& exprs,
     std::vector<std::array<double, 2>>& exprs_data,
-    const tesseract_collision::ContactResultMap& dist_results,
+    const ContactRecords& dist_results,
     const sco::VarVector& vars0,
     const sco::VarVector& vars1,
     const DblVec& x,
@@ -474,13 +595,10 @@ void CollisionEvaluator::CollisionsToDistanceExpressionsContinuousW(
 
   exprs.clear();
   exprs_data.clear();
-  exprs.reserve(dist_results.count());
-  exprs_data.reserve(dist_results.count());
-  for (const auto& pair : dist_results)
+  exprs.reserve(dist_results.pairs.size());
+  exprs_data.reserve(dist_results.pairs.size());
+  for (const auto& pair : dist_results.pairs)
   {
-    if (pair.second.empty())
-      continue;
-
     double worst_dist{ std::numeric_limits<double>::max() };
     double total_weight[2];
     bool found[2];
@@ -496,11 +614,11 @@ void CollisionEvaluator::CollisionsToDistanceExpressionsContinuousW(
     dist_grad[1] = Eigen::VectorXd::Zero(manip_->numJoints());
 
     // Contains the contact distance threshold and coefficient for the given link pair
-    const std::array<double, 2>& data =
-        safety_margin_data_->getPairSafetyMarginData(pair.first.first, pair.first.second);
+    const std::array<double, 2>& data = pair.data;
 
-    for (const auto& res : pair.second)
+    for (std::size_t r = pair.begin; r < pair.end; ++r)
     {
+      const ContactRecord& res = dist_results.records[r];
       GradientResults grad = GetGradient(dofvals0, dofvals1, res, data, isTimestep1);
 
       for (std::size_t i = 0; i < 2; ++i)
@@ -564,7 +682,8 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::JointGroup::ConstPt
                                        tesseract_collision::ContactTestType contact_test_type,
                                        double longest_valid_segment_length,
                                        double safety_margin_buffer,
-                                       bool dynamic_environment)
+                                       bool dynamic_environment,
+                                       std::shared_ptr<const CollisionWorldSnapshot> snapshot)
   : manip_(std::move(manip))
   , env_(std::move(env))
   , safety_margin_data_(std::move(safety_margin_data))
@@ -575,6 +694,15 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::JointGroup::ConstPt
 {
   manip_active_link_names_ = manip_->getActiveLinkNames();
 
+  // A dynamic environment also moves links which are not part of the manipulator so it needs its own contact manager
+  if (snapshot != nullptr && !dynamic_environment_)
+  {
+    if (snapshot->getRevision() != env_->getRevision())
+      PRINT_AND_THROW("The collision world snapshot revision does not match the environment revision");
+
+    snapshot_ = std::move(snapshot);
+  }
+
   // If the environment is not expected to change, then the cloned state solver may be used each time.
   if (dynamic_environment_)
   {
@@ -602,25 +730,25 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::JointGroup::ConstPt
 
 void CollisionEvaluator::CalcDists(const DblVec& x, DblVec& dists)
 {
-  ContactResultVectorConstPtr dist_results = GetContactResultVectorCached(x);
+  ContactRecordsConstPtr dist_results = GetContactRecordsCached(x);
   CollisionsToDistances(*dist_results, dists);
 }
 
 inline size_t hash(const DblVec& x) { return boost::hash_range(x.begin(), x.end()); }
-ContactResultVectorConstPtr CollisionEvaluator::GetContactResultVectorCached(const DblVec& x)
+
+inline size_t hash(const Eigen::Ref<const Eigen::VectorXd>& x)
 {
-  std::pair<ContactResultMapConstPtr, ContactResultVectorConstPtr> pair = GetContactResultCached(x);
-  return pair.second;
+  return boost::hash_range(x.data(), x.data() + x.size());
 }
 
-ContactResultMapConstPtr CollisionEvaluator::GetContactResultMapCached(const DblVec& x)
+inline size_t hash(const Eigen::Ref<const Eigen::VectorXd>& x0, const Eigen::Ref<const Eigen::VectorXd>& x1)
 {
-  std::pair<ContactResultMapConstPtr, ContactResultVectorConstPtr> pair = GetContactResultCached(x);
-  return pair.first;
+  size_t key = hash(x0);
+  boost::hash_combine(key, hash(x1));
+  return key;
 }
 
-std::pair<ContactResultMapConstPtr, ContactResultVectorConstPtr>
-CollisionEvaluator::GetContactResultCached(const DblVec& x)
+ContactRecordsConstPtr CollisionEvaluator::GetContactRecordsCached(const DblVec& x)
 {
   size_t key = hash(sco::getDblVec(x, GetVars()));
   auto* it = m_cache.get(key);
@@ -642,30 +770,43 @@ CollisionEvaluator::GetContactResultCached(const DblVec& x)
 
   CalcCollisions(x, dist_map);
 
-  auto dist_map_ptr = std::make_shared<tesseract_collision::ContactResultMap>(dist_map);
-  auto dist_vec_ptr = std::make_shared<ContactResultVectorWrapper>();
-  dist_map_ptr->flattenWrapperResults(*dist_vec_ptr);
+  // Only the compact records are cached, the contact results are reused by the next collision check
+  ContactRecordsConstPtr contact_records = createContactRecords(dist_map);
+  m_cache.put(key, contact_records);
+  return contact_records;
+}
+
+ContactResultVectorConstPtr CollisionEvaluator::GetContactResultVectorCached(const DblVec& x)
+{
+  // The vector references the contact results, so it shares the ownership of the map holding them
+  auto data = std::make_shared<std::pair<tesseract_collision::ContactResultMap, ContactResultVectorWrapper>>();
+  CalcCollisions(x, data->first);
+  data->first.flattenWrapperResults(data->second);
+  return { data, &data->second };
+}
 
-  auto pair = std::make_pair(dist_map_ptr, dist_vec_ptr);
-  m_cache.put(key, pair);
-  return pair;
+ContactResultMapConstPtr CollisionEvaluator::GetContactResultMapCached(const DblVec& x)
+{
+  auto dist_map = std::make_shared<tesseract_collision::ContactResultMap>();
+  CalcCollisions(x, *dist_map);
+  return dist_map;
 }
 
 void CollisionEvaluator::CalcDistExpressionsStartFree(const DblVec& x,
                                                       sco::AffExprVector& exprs,
                                                       std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  ContactRecordsConstPtr dist_vec = GetContactRecordsCached(x);
+  const ContactRecords& dist_results = *dist_vec;
 
   sco::AffExprVector exprs0;
   CollisionsToDistanceExpressions(exprs0, exprs_data, dist_results, vars0_, x, false);
 
   exprs.resize(exprs0.size());
-  assert(exprs0.size() == dist_results.size());
+  assert(exprs0.size() == dist_results.records.size());
   for (std::size_t i = 0; i < exprs0.size(); ++i)
   {
-    exprs[i] = sco::AffExpr(dist_results[i].get().distance);
+    exprs[i] = sco::AffExpr(dist_results.records[i].distance);
     sco::exprInc(exprs[i], exprs0[i]);
     exprs[i] = sco::cleanupAff(exprs[i]);
   }
@@ -675,17 +816,17 @@ void CollisionEvaluator::CalcDistExpressionsEndFree(const DblVec& x,
                                                     sco::AffExprVector& exprs,
                                                     std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  ContactRecordsConstPtr dist_vec = GetContactRecordsCached(x);
+  const ContactRecords& dist_results = *dist_vec;
 
   sco::AffExprVector exprs1;
   CollisionsToDistanceExpressions(exprs1, exprs_data, dist_results, vars1_, x, true);
 
   exprs.resize(exprs1.size());
-  assert(exprs1.size() == dist_results.size());
+  assert(exprs1.size() == dist_results.records.size());
   for (std::size_t i = 0; i < exprs1.size(); ++i)
   {
-    exprs[i] = sco::AffExpr(dist_results[i].get().distance);
+    exprs[i] = sco::AffExpr(dist_results.records[i].distance);
     sco::exprInc(exprs[i], exprs1[i]);
     exprs[i] = sco::cleanupAff(exprs[i]);
   }
@@ -695,8 +836,8 @@ void CollisionEvaluator::CalcDistExpressionsBothFree(const DblVec& x,
                                                      sco::AffExprVector& exprs,
                                                      std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  ContactRecordsConstPtr dist_vec = GetContactRecordsCached(x);
+  const ContactRecords& dist_results = *dist_vec;
 
   sco::AffExprVector exprs0, exprs1;
   std::vector<std::array<double, 2>> exprs_data0, exprs_data1;
@@ -705,12 +846,12 @@ void CollisionEvaluator::CalcDistExpressionsBothFree(const DblVec& x,
 
   exprs_data = exprs_data0;
   exprs.resize(exprs0.size());
-  assert(exprs0.size() == dist_results.size());
+  assert(exprs0.size() == dist_results.records.size());
   assert(exprs0.size() == exprs1.size());
   assert(exprs0.size() == exprs_data0.size());
   for (std::size_t i = 0; i < exprs0.size(); ++i)
   {
-    exprs[i] = sco::AffExpr(dist_results[i].get().distance);
+    exprs[i] = sco::AffExpr(dist_results.records[i].distance);
     sco::exprInc(exprs[i], exprs0[i]);
     sco::exprInc(exprs[i], exprs1[i]);
     exprs[i] = sco::cleanupAff(exprs[i]);
@@ -721,7 +862,7 @@ void CollisionEvaluator::CalcDistExpressionsStartFreeW(const DblVec& x,
                                                        sco::AffExprVector& exprs,
                                                        std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultMapConstPtr dist_results = GetContactResultMapCached(x);
+  ContactRecordsConstPtr dist_results = GetContactRecordsCached(x);
 
   sco::AffExprVector exprs0;
   CollisionsToDistanceExpressionsContinuousW(exprs0, exprs_data, *dist_results, vars0_, vars1_, x, false);
@@ -739,7 +880,7 @@ void CollisionEvaluator::CalcDistExpressionsEndFreeW(const DblVec& x,
                                                      sco::AffExprVector& exprs,
                                                      std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultMapConstPtr dist_results = GetContactResultMapCached(x);
+  ContactRecordsConstPtr dist_results = GetContactRecordsCached(x);
 
   sco::AffExprVector exprs1;
   CollisionsToDistanceExpressionsContinuousW(exprs1, exprs_data, *dist_results, vars0_, vars1_, x, true);
@@ -757,7 +898,7 @@ void CollisionEvaluator::CalcDistExpressionsBothFreeW(const DblVec& x,
                                                       sco::AffExprVector& exprs,
                                                       std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultMapConstPtr dist_results = GetContactResultMapCached(x);
+  ContactRecordsConstPtr dist_results = GetContactRecordsCached(x);
 
   sco::AffExprVector exprs0, exprs1;
   std::vector<std::array<double, 2>> exprs_data0, exprs_data1;
@@ -780,15 +921,15 @@ void CollisionEvaluator::CalcDistExpressionsSingleTimeStep(const DblVec& x,
                                                            sco::AffExprVector& exprs,
                                                            std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  ContactRecordsConstPtr dist_vec = GetContactRecordsCached(x);
+  const ContactRecords& dist_results = *dist_vec;
 
   CollisionsToDistanceExpressions(exprs, exprs_data, dist_results, vars0_, x, false);
-  assert(dist_results.size() == exprs.size());
+  assert(dist_results.records.size() == exprs.size());
 
   for (std::size_t i = 0; i < exprs.size(); ++i)
   {
-    sco::exprInc(exprs[i], dist_results[i].get().distance);
+    sco::exprInc(exprs[i], dist_results.records[i].distance);
     sco::cleanupAff(exprs[i]);
   }
 }
@@ -797,9 +938,9 @@ void CollisionEvaluator::CalcDistExpressionsSingleTimeStepW(const DblVec& x,
                                                             sco::AffExprVector& exprs,
                                                             std::vector<std::array<double, 2>>& exprs_data)
 {
-  ContactResultMapConstPtr dist_results = GetContactResultMapCached(x);
+  ContactRecordsConstPtr dist_results = GetContactRecordsCached(x);
   CollisionsToDistanceExpressionsW(exprs, exprs_data, *dist_results, vars0_, x, false);
-  assert(dist_results->count() == exprs.size());
+  assert(dist_results->pairs.size() == exprs.size());
 
   for (auto& expr : exprs)
     expr = sco::cleanupAff(expr);
@@ -881,22 +1022,28 @@ SingleTimestepCollisionEvaluator::SingleTimestepCollisionEvaluator(
     sco::VarVector vars,
     CollisionExpressionEvaluatorType type,
     double safety_margin_buffer,
-    bool dynamic_environment)
+    bool dynamic_environment,
+    std::shared_ptr<const CollisionWorldSnapshot> snapshot)
   : CollisionEvaluator(std::move(manip),
                        std::move(env),
                        std::move(safety_margin_data),
                        contact_test_type,
                        0,
                        safety_margin_buffer,
-                       dynamic_environment)
+                       dynamic_environment,
+                       std::move(snapshot))
 {
   vars0_ = std::move(vars);
   evaluator_type_ = type;
 
-  contact_manager_ = env_->getDiscreteContactManager();
-  contact_manager_->setActiveCollisionObjects(manip_->getActiveLinkNames());
   /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
-  contact_manager_->setDefaultCollisionMarginData(safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
+  contact_margin_ = safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_;
+  if (snapshot_ == nullptr)
+  {
+    contact_manager_ = env_->getDiscreteContactManager();
+    contact_manager_->setActiveCollisionObjects(manip_->getActiveLinkNames());
+    contact_manager_->setDefaultCollisionMarginData(contact_margin_);
+  }
 
   switch (evaluator_type_)
   {
@@ -935,16 +1082,28 @@ void SingleTimestepCollisionEvaluator::CalcCollisions(const DblVec& x,
 void SingleTimestepCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
                                                       tesseract_collision::ContactResultMap& dist_results)
 {
-  tesseract_common::TransformMap state = get_state_fn_(dof_vals);
+  // The contact manager is only checked out if the query is not already in the shared cache
+  auto contact_query = [this, &dof_vals](const SubSegmentFn& sub_segment_fn) {
+    DiscreteContactManagerHandle contact_manager_handle = getContactManager(contact_manager_);
+    tesseract_collision::DiscreteContactManager& contact_manager = *contact_manager_handle;
+    tesseract_common::TransformMap state = get_state_fn_(dof_vals);
 
-  // If not empty then there are links that are not part of the kinematics object that can move (dynamic environment)
-  for (const auto& link_name : diff_active_link_names_)
-    contact_manager_->setCollisionObjectsTransform(link_name, state[link_name]);
+    // If not empty then there are links that are not part of the kinematics object that can move (dynamic environment)
+    for (const auto& link_name : diff_active_link_names_)
+      contact_manager.setCollisionObjectsTransform(link_name, state[link_name]);
 
-  for (const auto& link_name : manip_active_link_names_)
-    contact_manager_->setCollisionObjectsTransform(link_name, state[link_name]);
+    trajopt_common::getLinkTransforms(manip_active_link_transforms0_, manip_active_link_names_, state);
+    contact_manager.setCollisionObjectsTransform(manip_active_link_names_, manip_active_link_transforms0_);
 
-  contact_manager_->contactTest(dist_results, contact_test_type_);
+    tesseract_collision::ContactResultMap contacts;
+    contact_manager.contactTest(contacts, contact_test_type_);
+    if (!contacts.empty())
+      sub_segment_fn(0, contacts);
+  };
+  auto accumulate = [&dist_results](long /*index*/, tesseract_collision::ContactResultMap& contacts) {
+    dist_results = std::move(contacts);
+  };
+  runContactQuery(hash(dof_vals), contact_query, accumulate);
 
   const auto& zero_coeff_pairs = getSafetyMarginData()->getPairsWithZeroCoeff();
   auto filter = [this, &zero_coeff_pairs](tesseract_collision::ContactResultMap::PairType& pair) {
@@ -978,17 +1137,18 @@ void SingleTimestepCollisionEvaluator::CalcDistExpressions(const DblVec& x,
 void SingleTimestepCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visualization::Visualization>& plotter,
                                             const DblVec& x)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  // Only compact contact records are cached so the full contact results are recomputed for plotting
+  tesseract_collision::ContactResultMap dist_map;
+  CalcCollisions(x, dist_map);
+  tesseract_collision::ContactResultVector dist_results;
+  dist_map.flattenCopyResults(dist_results);
 
   Eigen::VectorXd dofvals = sco::getVec(x, vars0_);
 
-  tesseract_collision::ContactResultVector dist_results_copy(dist_results.size());
   Eigen::VectorXd safety_distance(dist_results.size());
   for (auto i = 0u; i < dist_results.size(); ++i)
   {
-    const tesseract_collision::ContactResult& res = dist_results[i].get();
-    dist_results_copy[i] = res;
+    const tesseract_collision::ContactResult& res = dist_results[i];
 
     // Contains the contact distance threshold and coefficient for the given link pair
     const std::array<double, 2>& data =
@@ -1014,7 +1174,7 @@ void SingleTimestepCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visu
     return getSafetyMarginData()->getPairSafetyMarginData(link1, link2)[0];
   };
 
-  tesseract_visualization::ContactResultsMarker cm(manip_->getActiveLinkNames(), dist_results_copy, margin_fn);
+  tesseract_visualization::ContactResultsMarker cm(manip_->getActiveLinkNames(), dist_results, margin_fn);
   plotter->plotMarker(cm);
 }
 
@@ -1029,22 +1189,29 @@ DiscreteCollisionEvaluator::DiscreteCollisionEvaluator(
     sco::VarVector vars0,
     sco::VarVector vars1,
     CollisionExpressionEvaluatorType type,
-    double safety_margin_buffer)
+    double safety_margin_buffer,
+    std::shared_ptr<const CollisionWorldSnapshot> snapshot)
   : CollisionEvaluator(std::move(manip),
                        std::move(env),
                        std::move(safety_margin_data),
                        contact_test_type,
                        longest_valid_segment_length,
-                       safety_margin_buffer)
+                       safety_margin_buffer,
+                       false,
+                       std::move(snapshot))
 {
   vars0_ = std::move(vars0);
   vars1_ = std::move(vars1);
   evaluator_type_ = type;
 
-  contact_manager_ = env_->getDiscreteContactManager();
-  contact_manager_->setActiveCollisionObjects(manip_->getActiveLinkNames());
   /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
-  contact_manager_->setDefaultCollisionMarginData(safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
+  contact_margin_ = safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_;
+  if (snapshot_ == nullptr)
+  {
+    contact_manager_ = env_->getDiscreteContactManager();
+    contact_manager_->setActiveCollisionObjects(manip_->getActiveLinkNames());
+    contact_manager_->setDefaultCollisionMarginData(contact_margin_);
+  }
 
   switch (evaluator_type_)
   {
@@ -1126,14 +1293,6 @@ void DiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Ve
   // the longest valid segment length.
   double dist = (dof_vals1 - dof_vals0).norm();
 
-  // If not empty then there are links that are not part of the kinematics object that can move (dynamic environment)
-  if (!diff_active_link_names_.empty())
-  {
-    tesseract_common::TransformMap state = get_state_fn_(dof_vals0);
-    for (const auto& link_name : diff_active_link_names_)
-      contact_manager_->setCollisionObjectsTransform(link_name, state[link_name]);
-  }
-
   long cnt = 2;
   if (dist > longest_valid_segment_length_)
   {
@@ -1141,10 +1300,40 @@ void DiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Ve
     cnt = static_cast<long>(std::ceil(dist / longest_valid_segment_length_)) + 1;
   }
 
-  // Create interpolated trajectory between two states that satisfies the longest valid segment length.
-  tesseract_common::TrajArray subtraj(cnt, dof_vals0.size());
-  for (long i = 0; i < dof_vals0.size(); ++i)
-    subtraj.col(i) = Eigen::VectorXd::LinSpaced(cnt, dof_vals0(i), dof_vals1(i));
+  // The contact manager is only checked out if the query is not already in the shared cache
+  auto contact_query = [this, &dof_vals0, &dof_vals1, cnt](const SubSegmentFn& sub_segment_fn) {
+    DiscreteContactManagerHandle contact_manager_handle = getContactManager(contact_manager_);
+    tesseract_collision::DiscreteContactManager& contact_manager = *contact_manager_handle;
+    // If not empty then there are links that are not part of the kinematics object that can move (dynamic environment)
+    if (!diff_active_link_names_.empty())
+    {
+      tesseract_common::TransformMap state = get_state_fn_(dof_vals0);
+      for (const auto& link_name : diff_active_link_names_)
+        contact_manager.setCollisionObjectsTransform(link_name, state[link_name]);
+    }
+
+    // Create interpolated trajectory between two states that satisfies the longest valid segment length.
+    tesseract_common::TrajArray subtraj(cnt, dof_vals0.size());
+    for (long i = 0; i < dof_vals0.size(); ++i)
+      subtraj.col(i) = Eigen::VectorXd::LinSpaced(cnt, dof_vals0(i), dof_vals1(i));
+
+    // Perform casted collision checking for sub trajectory and store results in contacts_vector
+    /** @todo require this to be passed in to reduce memory allocations */
+    tesseract_collision::ContactResultMap contacts;
+    for (int i = 0; i < subtraj.rows(); ++i)
+    {
+      trajopt_common::getLinkTransforms(
+          manip_active_link_transforms0_, manip_active_link_names_, get_state_fn_(subtraj.row(i)));
+      contact_manager.setCollisionObjectsTransform(manip_active_link_names_, manip_active_link_transforms0_);
+
+      contact_manager.contactTest(contacts, contact_test_type_);
+
+      if (!contacts.empty())
+        sub_segment_fn(i, contacts);
+
+      contacts.clear();
+    }
+  };
 
   // Define Filter
   const auto& zero_coeff_pairs = getSafetyMarginData()->getPairsWithZeroCoeff();
@@ -1162,27 +1351,16 @@ void DiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Ve
     removeInvalidContactResults(pair.second, data);
   };
 
-  // Perform casted collision checking for sub trajectory and store results in contacts_vector
-  tesseract_common::TrajArray::Index last_state_idx{ subtraj.rows() - 1 };
-  double dt = 1.0 / double(last_state_idx);
-  /** @todo require this to be passed in to reduce memory allocations */
-  tesseract_collision::ContactResultMap contacts{ dist_results };
-  for (int i = 0; i < subtraj.rows(); ++i)
-  {
-    tesseract_common::TransformMap state0 = get_state_fn_(subtraj.row(i));
-
-    for (const auto& link_name : manip_active_link_names_)
-      contact_manager_->setCollisionObjectsTransform(link_name, state0[link_name]);
-
-    contact_manager_->contactTest(contacts, contact_test_type_);
-
-    if (!contacts.empty())
-    {
-      dist_results.addInterpolatedCollisionResults(
-          contacts, i, last_state_idx, manip_active_link_names_, dt, true, filter);
-    }
-    contacts.clear();
-  }
+  // The filter is applied to each sub-segment before keeping the closest contacts of a pair, so contacts at a fixed
+  // state do not hide the contacts along the segment
+  const long last_state_idx = cnt - 1;
+  const double dt = 1.0 / double(last_state_idx);
+  auto accumulate = [this, &dist_results, &filter, last_state_idx, dt](
+                        long index, tesseract_collision::ContactResultMap& contacts) {
+    dist_results.addInterpolatedCollisionResults(
+        contacts, index, last_state_idx, manip_active_link_names_, dt, true, filter);
+  };
+  runContactQuery(hash(dof_vals0, dof_vals1), contact_query, accumulate);
 }
 
 void DiscreteCollisionEvaluator::CalcDistExpressions(const DblVec& x,
@@ -1195,8 +1373,11 @@ void DiscreteCollisionEvaluator::CalcDistExpressions(const DblVec& x,
 void DiscreteCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visualization::Visualization>& plotter,
                                       const DblVec& x)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  // Only compact contact records are cached so the full contact results are recomputed for plotting
+  tesseract_collision::ContactResultMap dist_map;
+  CalcCollisions(x, dist_map);
+  tesseract_collision::ContactResultVector dist_results;
+  dist_map.flattenCopyResults(dist_results);
 
   Eigen::VectorXd dofvals0 = sco::getVec(x, vars0_);
   Eigen::VectorXd dofvals1 = sco::getVec(x, vars1_);
@@ -1204,12 +1385,10 @@ void DiscreteCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visualizat
   tesseract_common::TransformMap state0 = manip_->calcFwdKin(dofvals0);
   tesseract_common::TransformMap state1 = manip_->calcFwdKin(dofvals1);
 
-  tesseract_collision::ContactResultVector dist_results_copy(dist_results.size());
   Eigen::VectorXd safety_distance(dist_results.size());
   for (auto i = 0u; i < dist_results.size(); ++i)
   {
-    const tesseract_collision::ContactResult& res = dist_results[i].get();
-    dist_results_copy[i] = res;
+    const tesseract_collision::ContactResult& res = dist_results[i];
 
     // Contains the contact distance threshold and coefficient for the given link pair
     const std::array<double, 2>& data =
@@ -1260,7 +1439,7 @@ void DiscreteCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visualizat
     return getSafetyMarginData()->getPairSafetyMarginData(link1, link2)[0];
   };
 
-  tesseract_visualization::ContactResultsMarker cm(manip_->getActiveLinkNames(), dist_results_copy, margin_fn);
+  tesseract_visualization::ContactResultsMarker cm(manip_->getActiveLinkNames(), dist_results, margin_fn);
   plotter->plotMarker(cm);
 }
 
@@ -1277,22 +1456,29 @@ CastCollisionEvaluator::CastCollisionEvaluator(
     sco::VarVector vars0,
     sco::VarVector vars1,
     CollisionExpressionEvaluatorType type,
-    double safety_margin_buffer)
+    double safety_margin_buffer,
+    std::shared_ptr<const CollisionWorldSnapshot> snapshot)
   : CollisionEvaluator(std::move(manip),
                        std::move(env),
                        std::move(safety_margin_data),
                        contact_test_type,
                        longest_valid_segment_length,
-                       safety_margin_buffer)
+                       safety_margin_buffer,
+                       false,
+                       std::move(snapshot))
 {
   vars0_ = std::move(vars0);
   vars1_ = std::move(vars1);
   evaluator_type_ = type;
 
-  contact_manager_ = env_->getContinuousContactManager();
-  contact_manager_->setActiveCollisionObjects(manip_->getActiveLinkNames());
   /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
-  contact_manager_->setDefaultCollisionMarginData(safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
+  contact_margin_ = safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_;
+  if (snapshot_ == nullptr)
+  {
+    contact_manager_ = env_->getContinuousContactManager();
+    contact_manager_->setActiveCollisionObjects(manip_->getActiveLinkNames());
+    contact_manager_->setDefaultCollisionMarginData(contact_margin_);
+  }
 
   switch (evaluator_type_)
   {
@@ -1373,14 +1559,70 @@ void CastCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Vector
   // the collision checking is broken up into multiple casted collision checks such that each check is less then
   // the longest valid segment length.
   double dist = (dof_vals1 - dof_vals0).norm();
+  const bool interpolate = (dist > longest_valid_segment_length_);
 
-  // If not empty then there are links that are not part of the kinematics object that can move (dynamic environment)
-  if (!diff_active_link_names_.empty())
-  {
-    tesseract_common::TransformMap state = get_state_fn_(dof_vals0);
-    for (const auto& link_name : diff_active_link_names_)
-      contact_manager_->setCollisionObjectsTransform(link_name, state[link_name]);
-  }
+  // Calculate the number state to interpolate
+  long cnt = 2;
+  if (interpolate)
+    cnt = static_cast<long>(std::ceil(dist / longest_valid_segment_length_)) + 1;
+
+  // The contact manager is only checked out if the query is not already in the shared cache
+  auto contact_query = [this, &dof_vals0, &dof_vals1, interpolate, cnt](const SubSegmentFn& sub_segment_fn) {
+    ContinuousContactManagerHandle contact_manager_handle = getContactManager(contact_manager_);
+    tesseract_collision::ContinuousContactManager& contact_manager = *contact_manager_handle;
+    // If not empty then there are links that are not part of the kinematics object that can move (dynamic environment)
+    if (!diff_active_link_names_.empty())
+    {
+      tesseract_common::TransformMap state = get_state_fn_(dof_vals0);
+      for (const auto& link_name : diff_active_link_names_)
+        contact_manager.setCollisionObjectsTransform(link_name, state[link_name]);
+    }
+
+    /** @todo require this to be passed in to reduce memory allocations */
+    tesseract_collision::ContactResultMap contacts;
+    if (interpolate)
+    {
+      // Create interpolated trajectory between two states that satisfies the longest valid segment length.
+      tesseract_common::TrajArray subtraj(cnt, dof_vals0.size());
+      for (long i = 0; i < dof_vals0.size(); ++i)
+        subtraj.col(i) = Eigen::VectorXd::LinSpaced(cnt, dof_vals0(i), dof_vals1(i));
+
+      // Perform casted collision checking for sub trajectory and store results in contacts_vector
+      // The end state of a segment is the start state of the next one so its link transforms are reused
+      trajopt_common::getLinkTransforms(
+          manip_active_link_transforms1_, manip_active_link_names_, manip_->calcFwdKin(subtraj.row(0)));
+      for (int i = 0; i < subtraj.rows() - 1; ++i)
+      {
+        std::swap(manip_active_link_transforms0_, manip_active_link_transforms1_);
+        trajopt_common::getLinkTransforms(
+            manip_active_link_transforms1_, manip_active_link_names_, manip_->calcFwdKin(subtraj.row(i + 1)));
+
+        contact_manager.setCollisionObjectsTransform(
+            manip_active_link_names_, manip_active_link_transforms0_, manip_active_link_transforms1_);
+
+        contact_manager.contactTest(contacts, contact_test_type_);
+
+        if (!contacts.empty())
+          sub_segment_fn(i, contacts);
+
+        contacts.clear();
+      }
+    }
+    else
+    {
+      trajopt_common::getLinkTransforms(
+          manip_active_link_transforms0_, manip_active_link_names_, manip_->calcFwdKin(dof_vals0));
+      trajopt_common::getLinkTransforms(
+          manip_active_link_transforms1_, manip_active_link_names_, manip_->calcFwdKin(dof_vals1));
+      contact_manager.setCollisionObjectsTransform(
+          manip_active_link_names_, manip_active_link_transforms0_, manip_active_link_transforms1_);
+
+      contact_manager.contactTest(contacts, contact_test_type_);
+
+      if (!contacts.empty())
+        sub_segment_fn(0, contacts);
+    }
+  };
 
   // Define Filter
   const auto& zero_coeff_pairs = getSafetyMarginData()->getPairsWithZeroCoeff();
@@ -1398,50 +1640,24 @@ void CastCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Vector
     removeInvalidContactResults(pair.second, data);
   };
 
-  if (dist > longest_valid_segment_length_)
-  {
-    // Calculate the number state to interpolate
-    size_t cnt = static_cast<size_t>(std::ceil(dist / longest_valid_segment_length_)) + 1;
-
-    // Create interpolated trajectory between two states that satisfies the longest valid segment length.
-    tesseract_common::TrajArray subtraj(cnt, dof_vals0.size());
-    for (size_t i = 0; i < dof_vals0.size(); ++i)
-      subtraj.col(i) = Eigen::VectorXd::LinSpaced(cnt, dof_vals0(i), dof_vals1(i));
-
-    // Perform casted collision checking for sub trajectory and store results in contacts_vector
-    /** @todo require this to be passed in to reduce memory allocations */
-    tesseract_collision::ContactResultMap contacts{ dist_results };
-    tesseract_common::TrajArray::Index last_state_idx{ subtraj.rows() - 1 };
-    double dt = 1.0 / double(last_state_idx);
-    for (int i = 0; i < subtraj.rows() - 1; ++i)
+  // The filter is applied to each sub-segment before keeping the closest contacts of a pair, so contacts at a fixed
+  // state do not hide the contacts along the segment
+  const long last_state_idx = cnt - 1;
+  const double dt = 1.0 / double(last_state_idx);
+  auto accumulate = [this, &dist_results, &filter, interpolate, last_state_idx, dt](
+                        long index, tesseract_collision::ContactResultMap& contacts) {
+    if (interpolate)
     {
-      tesseract_common::TransformMap state0 = manip_->calcFwdKin(subtraj.row(i));
-      tesseract_common::TransformMap state1 = manip_->calcFwdKin(subtraj.row(i + 1));
-
-      for (const auto& link_name : manip_active_link_names_)
-        contact_manager_->setCollisionObjectsTransform(link_name, state0[link_name], state1[link_name]);
-
-      contact_manager_->contactTest(contacts, contact_test_type_);
-
-      if (!contacts.empty())
-      {
-        dist_results.addInterpolatedCollisionResults(
-            contacts, i, last_state_idx, manip_active_link_names_, dt, false, filter);
-      }
-      contacts.clear();
+      dist_results.addInterpolatedCollisionResults(
+          contacts, index, last_state_idx, manip_active_link_names_, dt, false, filter);
     }
-  }
-  else
-  {
-    tesseract_common::TransformMap state0 = manip_->calcFwdKin(dof_vals0);
-    tesseract_common::TransformMap state1 = manip_->calcFwdKin(dof_vals1);
-    for (const auto& link_name : manip_active_link_names_)
-      contact_manager_->setCollisionObjectsTransform(link_name, state0[link_name], state1[link_name]);
-
-    contact_manager_->contactTest(dist_results, contact_test_type_);
-
-    dist_results.filter(filter);
-  }
+    else
+    {
+      dist_results = std::move(contacts);
+      dist_results.filter(filter);
+    }
+  };
+  runContactQuery(hash(dof_vals0, dof_vals1), contact_query, accumulate);
 }
 
 void CastCollisionEvaluator::CalcDistExpressions(const DblVec& x,
@@ -1454,17 +1670,18 @@ void CastCollisionEvaluator::CalcDistExpressions(const DblVec& x,
 void CastCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visualization::Visualization>& plotter,
                                   const DblVec& x)
 {
-  ContactResultVectorConstPtr dist_vec = GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  // Only compact contact records are cached so the full contact results are recomputed for plotting
+  tesseract_collision::ContactResultMap dist_map;
+  CalcCollisions(x, dist_map);
+  tesseract_collision::ContactResultVector dist_results;
+  dist_map.flattenCopyResults(dist_results);
 
   Eigen::VectorXd dofvals = sco::getVec(x, vars0_);
 
-  tesseract_collision::ContactResultVector dist_results_copy(dist_results.size());
   Eigen::VectorXd safety_distance(dist_results.size());
   for (auto i = 0u; i < dist_results.size(); ++i)
   {
-    const tesseract_collision::ContactResult& res = dist_results[i].get();
-    dist_results_copy[i] = res;
+    const tesseract_collision::ContactResult& res = dist_results[i];
 
     // Contains the contact distance threshold and coefficient for the given link pair
     const std::array<double, 2>& data =
@@ -1512,7 +1729,7 @@ void CastCollisionEvaluator::Plot(const std::shared_ptr<tesseract_visualization:
     return getSafetyMarginData()->getPairSafetyMarginData(link1, link2)[0];
   };
 
-  tesseract_visualization::ContactResultsMarker cm(manip_->getActiveLinkNames(), dist_results_copy, margin_fn);
+  tesseract_visualization::ContactResultsMarker cm(manip_->getActiveLinkNames(), dist_results, margin_fn);
   plotter->plotMarker(cm);
 }
 
@@ -1526,7 +1743,8 @@ CollisionCost::CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGr
                              tesseract_collision::ContactTestType contact_test_type,
                              sco::VarVector vars,
                              CollisionExpressionEvaluatorType type,
-                             double safety_margin_buffer)
+                             double safety_margin_buffer,
+                             std::shared_ptr<const CollisionWorldSnapshot> snapshot)
   : Cost("collision")
 {
   m_calc = std::make_shared<SingleTimestepCollisionEvaluator>(std::move(manip),
@@ -1535,7 +1753,9 @@ CollisionCost::CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGr
                                                               contact_test_type,
                                                               std::move(vars),
                                                               type,
-                                                              safety_margin_buffer);
+                                                              safety_margin_buffer,
+                                                              false,
+                                                              std::move(snapshot));
 }
 
 CollisionCost::CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGroup> manip,
@@ -1547,7 +1767,8 @@ CollisionCost::CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGr
                              sco::VarVector vars1,
                              CollisionExpressionEvaluatorType type,
                              bool discrete,
-                             double safety_margin_buffer)
+                             double safety_margin_buffer,
+                             std::shared_ptr<const CollisionWorldSnapshot> snapshot)
 {
   if (discrete)
   {
@@ -1560,7 +1781,8 @@ CollisionCost::CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGr
                                                           std::move(vars0),
                                                           std::move(vars1),
                                                           type,
-                                                          safety_margin_buffer);
+                                                          safety_margin_buffer,
+                                                          std::move(snapshot));
   }
   else
   {
@@ -1573,7 +1795,8 @@ CollisionCost::CollisionCost(std::shared_ptr<const tesseract_kinematics::JointGr
                                                       std::move(vars0),
                                                       std::move(vars1),
                                                       type,
-                                                      safety_margin_buffer);
+                                                      safety_margin_buffer,
+                                                      std::move(snapshot));
   }
 }
 
@@ -1587,9 +1810,6 @@ sco::ConvexObjective::Ptr CollisionCost::convex(const sco::DblVec& x, sco::Model
   m_calc->CalcDistExpressions(x, exprs, exprs_data);
   assert(exprs.size() == exprs_data.size());
 
-  auto dist_results = m_calc->GetContactResultVectorCached(x);
-  UNUSED(dist_results);
-
   for (std::size_t i = 0; i < exprs.size(); ++i)
   {
     // Contains the contact distance threshold and coefficient for the given link pair
@@ -1606,16 +1826,14 @@ double CollisionCost::value(const sco::DblVec& x)
   DblVec dists;
   m_calc->CalcDists(x, dists);
 
-  auto dist_vec = m_calc->GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  ContactRecordsConstPtr dist_vec = m_calc->GetContactRecordsCached(x);
+  const ContactRecords& dist_results = *dist_vec;
 
   double out = 0;
   for (std::size_t i = 0; i < dists.size(); ++i)
   {
-    const tesseract_collision::ContactResult& res = dist_results[i].get();
     // Contains the contact distance threshold and coefficient for the given link pair
-    const std::array<double, 2>& data =
-        m_calc->getSafetyMarginData()->getPairSafetyMarginData(res.link_names[0], res.link_names[1]);
+    const std::array<double, 2>& data = dist_results.pairs[dist_results.records[i].pair_index].data;
     out += sco::pospart(data[0] - dists[i]) * data[1];
   }
   return out;
@@ -1633,7 +1851,8 @@ CollisionConstraint::CollisionConstraint(std::shared_ptr<const tesseract_kinemat
                                          tesseract_collision::ContactTestType contact_test_type,
                                          sco::VarVector vars,
                                          CollisionExpressionEvaluatorType type,
-                                         double safety_margin_buffer)
+                                         double safety_margin_buffer,
+                                         std::shared_ptr<const CollisionWorldSnapshot> snapshot)
 {
   name_ = "collision";
   m_calc = std::make_shared<SingleTimestepCollisionEvaluator>(std::move(manip),
@@ -1642,7 +1861,9 @@ CollisionConstraint::CollisionConstraint(std::shared_ptr<const tesseract_kinemat
                                                               contact_test_type,
                                                               std::move(vars),
                                                               type,
-                                                              safety_margin_buffer);
+                                                              safety_margin_buffer,
+                                                              false,
+                                                              std::move(snapshot));
 }
 
 CollisionConstraint::CollisionConstraint(std::shared_ptr<const tesseract_kinematics::JointGroup> manip,
@@ -1654,7 +1875,8 @@ CollisionConstraint::CollisionConstraint(std::shared_ptr<const tesseract_kinemat
                                          sco::VarVector vars1,
                                          CollisionExpressionEvaluatorType type,
                                          bool discrete,
-                                         double safety_margin_buffer)
+                                         double safety_margin_buffer,
+                                         std::shared_ptr<const CollisionWorldSnapshot> snapshot)
 {
   if (discrete)
   {
@@ -1667,7 +1889,8 @@ CollisionConstraint::CollisionConstraint(std::shared_ptr<const tesseract_kinemat
                                                           std::move(vars0),
                                                           std::move(vars1),
                                                           type,
-                                                          safety_margin_buffer);
+                                                          safety_margin_buffer,
+                                                          std::move(snapshot));
   }
   else
   {
@@ -1680,7 +1903,8 @@ CollisionConstraint::CollisionConstraint(std::shared_ptr<const tesseract_kinemat
                                                       std::move(vars0),
                                                       std::move(vars1),
                                                       type,
-                                                      safety_margin_buffer);
+                                                      safety_margin_buffer,
+                                                      std::move(snapshot));
   }
 }
 
@@ -1694,9 +1918,6 @@ sco::ConvexConstraints::Ptr CollisionConstraint::convex(const sco::DblVec& x, sc
   m_calc->CalcDistExpressions(x, exprs, exprs_data);
   assert(exprs.size() == exprs_data.size());
 
-  auto dist_results = m_calc->GetContactResultVectorCached(x);
-  UNUSED(dist_results);
-
   for (std::size_t i = 0; i < exprs.size(); ++i)
   {
     // Contains the contact distance threshold and coefficient for the given link pair
@@ -1713,16 +1934,14 @@ DblVec CollisionConstraint::value(const sco::DblVec& x)
   DblVec dists;
   m_calc->CalcDists(x, dists);
 
-  auto dist_vec = m_calc->GetContactResultVectorCached(x);
-  const ContactResultVectorWrapper& dist_results = *dist_vec;
+  ContactRecordsConstPtr dist_vec = m_calc->GetContactRecordsCached(x);
+  const ContactRecords& dist_results = *dist_vec;
 
   DblVec out(dists.size());
   for (std::size_t i = 0; i < dists.size(); ++i)
   {
-    const tesseract_collision::ContactResult& res = dist_results[i].get();
     // Contains the contact distance threshold and coefficient for the given link pair
-    const std::array<double, 2>& data =
-        m_calc->getSafetyMarginData()->getPairSafetyMarginData(res.link_names[0], res.link_names[1]);
+    const std::array<double, 2>& data = dist_results.pairs[dist_results.records[i].pair_index].data;
 
     out[i] = sco::pospart(data[0] - dists[i]) * data[1];
   }
@@ -0,0 +1,103 @@
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <sstream>
+#include <tesseract_environment/environment.h>
+#include <tesseract_collision/core/discrete_contact_manager.h>
+#include <tesseract_collision/core/continuous_contact_manager.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/collision_world_snapshot.hpp>
+
+namespace trajopt
+{
+template <typename ContactManagerType>
+ContactManagerHandle<ContactManagerType>
+CollisionWorldSnapshot::checkOut(const typename ContactManagerPool<ContactManagerType>::Ptr& pool,
+                                 const std::shared_ptr<const ContactManagerType>& manager,
+                                 const std::vector<std::string>& active_links,
+                                 double contact_distance)
+{
+  if (manager == nullptr)
+    PRINT_AND_THROW("The environment of the collision world snapshot does not have the requested contact manager");
+
+  std::unique_ptr<PooledContactManager<ContactManagerType>> pooled_manager;
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    auto it = pool->idle.find(active_links);
+    if (it != pool->idle.end() && !it->second.empty())
+    {
+      pooled_manager = std::move(it->second.back());
+      it->second.pop_back();
+    }
+  }
+
+  if (pooled_manager == nullptr)
+  {
+    pooled_manager = std::make_unique<PooledContactManager<ContactManagerType>>();
+    pooled_manager->manager = manager->clone();
+    pooled_manager->manager->setActiveCollisionObjects(active_links);
+    pooled_manager->pool = pool;
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pooled_manager->idle = &pool->idle[active_links];
+    ++pool->num_managers;
+  }
+
+  if (pooled_manager->contact_distance != contact_distance)
+  {
+    pooled_manager->manager->setDefaultCollisionMarginData(contact_distance);
+    pooled_manager->contact_distance = contact_distance;
+  }
+
+  // The handle owns the checked out contact manager until it puts it back into the pool. Only a pointer is captured,
+  // so the release function fits in the small buffer of std::function.
+  ContactManagerType& checked_out_manager = *pooled_manager->manager;
+  return { checked_out_manager, [checked_out = pooled_manager.release()]() {
+            std::unique_ptr<PooledContactManager<ContactManagerType>> returned(checked_out);
+            if (auto returned_pool = returned->pool.lock())
+            {
+              std::lock_guard<std::mutex> lock(returned_pool->mutex);
+              returned->idle->push_back(std::move(returned));
+            }
+          } };
+}
+
+CollisionWorldSnapshot::CollisionWorldSnapshot(const tesseract_environment::Environment& env)
+  : revision_(env.getRevision())
+  , discrete_manager_(env.getDiscreteContactManager())
+  , continuous_manager_(env.getContinuousContactManager())
+  , discrete_pool_(std::make_shared<ContactManagerPool<tesseract_collision::DiscreteContactManager>>())
+  , continuous_pool_(std::make_shared<ContactManagerPool<tesseract_collision::ContinuousContactManager>>())
+{
+}
+
+int CollisionWorldSnapshot::getRevision() const { return revision_; }
+
+DiscreteContactManagerHandle
+CollisionWorldSnapshot::getDiscreteContactManager(const std::vector<std::string>& active_links,
+                                                  double contact_distance) const
+{
+  return checkOut(discrete_pool_, discrete_manager_, active_links, contact_distance);
+}
+
+ContinuousContactManagerHandle
+CollisionWorldSnapshot::getContinuousContactManager(const std::vector<std::string>& active_links,
+                                                    double contact_distance) const
+{
+  return checkOut(continuous_pool_, continuous_manager_, active_links, contact_distance);
+}
+
+std::size_t CollisionWorldSnapshot::getNumContactManagers() const
+{
+  std::size_t num_managers{ 0 };
+  {
+    std::lock_guard<std::mutex> lock(discrete_pool_->mutex);
+    num_managers += discrete_pool_->num_managers;
+  }
+  {
+    std::lock_guard<std::mutex> lock(continuous_pool_->mutex);
+    num_managers += continuous_pool_->num_managers;
+  }
+  return num_managers;
+}
+}  // namespace trajopt
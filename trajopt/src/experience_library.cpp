@@ -0,0 +1,541 @@
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <boost/functional/hash.hpp>
+#include <json/json.h>
+#include <console_bridge/console.h>
+#include <tesseract_environment/environment.h>
+#include <tesseract_geometry/geometries.h>
+#include <tesseract_scene_graph/link.h>
+#include <tesseract_kinematics/core/joint_group.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/experience_library.hpp>
+#include <trajopt/problem_description.hpp>
+#include <trajopt_common/interpolation.hpp>
+
+namespace trajopt
+{
+namespace
+{
+/** @brief The key of an experience is its start and goal joint state */
+Eigen::VectorXd getKey(const TrajArray& traj)
+{
+  Eigen::VectorXd key(2 * traj.cols());
+  key << traj.row(0).transpose(), traj.row(traj.rows() - 1).transpose();
+  return key;
+}
+
+std::string getBucketName(const std::string& environment_signature, Eigen::Index dof)
+{
+  return environment_signature + "#" + std::to_string(dof);
+}
+
+/** @brief Combine a value rounded to 1e-4 into the seed so numerical noise does not change the hash */
+void hashCombineRounded(std::size_t& seed, double value)
+{
+  boost::hash_combine(seed, static_cast<long long>(std::llround(value * 1e4)));
+}
+
+void hashCombineRounded(std::size_t& seed, const Eigen::Isometry3d& tf)
+{
+  for (Eigen::Index i = 0; i < 3; ++i)
+  {
+    hashCombineRounded(seed, tf.translation()(i));
+    for (Eigen::Index j = 0; j < 3; ++j)
+      hashCombineRounded(seed, tf.linear()(i, j));
+  }
+}
+
+/** @brief Combine the type and dimensions of the geometry into the seed */
+void hashCombineGeometry(std::size_t& seed, const tesseract_geometry::Geometry& geometry)
+{
+  using tesseract_geometry::GeometryType;
+  boost::hash_combine(seed, static_cast<int>(geometry.getType()));
+  switch (geometry.getType())
+  {
+    case GeometryType::BOX:
+    {
+      const auto& box = static_cast<const tesseract_geometry::Box&>(geometry);
+      hashCombineRounded(seed, box.getX());
+      hashCombineRounded(seed, box.getY());
+      hashCombineRounded(seed, box.getZ());
+      break;
+    }
+    case GeometryType::SPHERE:
+      hashCombineRounded(seed, static_cast<const tesseract_geometry::Sphere&>(geometry).getRadius());
+      break;
+    case GeometryType::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const tesseract_geometry::Cylinder&>(geometry);
+      hashCombineRounded(seed, cylinder.getRadius());
+      hashCombineRounded(seed, cylinder.getLength());
+      break;
+    }
+    case GeometryType::CAPSULE:
+    {
+      const auto& capsule = static_cast<const tesseract_geometry::Capsule&>(geometry);
+      hashCombineRounded(seed, capsule.getRadius());
+      hashCombineRounded(seed, capsule.getLength());
+      break;
+    }
+    case GeometryType::CONE:
+    {
+      const auto& cone = static_cast<const tesseract_geometry::Cone&>(geometry);
+      hashCombineRounded(seed, cone.getRadius());
+      hashCombineRounded(seed, cone.getLength());
+      break;
+    }
+    case GeometryType::PLANE:
+    {
+      const auto& plane = static_cast<const tesseract_geometry::Plane&>(geometry);
+      hashCombineRounded(seed, plane.getA());
+      hashCombineRounded(seed, plane.getB());
+      hashCombineRounded(seed, plane.getC());
+      hashCombineRounded(seed, plane.getD());
+      break;
+    }
+    case GeometryType::MESH:
+    case GeometryType::CONVEX_MESH:
+    case GeometryType::SDF_MESH:
+    {
+      const auto& mesh = static_cast<const tesseract_geometry::PolygonMesh&>(geometry);
+      for (Eigen::Index i = 0; i < 3; ++i)
+        hashCombineRounded(seed, mesh.getScale()(i));
+      for (const auto& vertex : *mesh.getVertices())
+      {
+        for (Eigen::Index i = 0; i < 3; ++i)
+          hashCombineRounded(seed, vertex(i));
+      }
+      for (Eigen::Index i = 0; i < mesh.getFaces()->size(); ++i)
+        boost::hash_combine(seed, (*mesh.getFaces())(i));
+      break;
+    }
+    case GeometryType::OCTREE:
+    {
+      const auto& octree = static_cast<const tesseract_geometry::Octree&>(geometry);
+      hashCombineRounded(seed, octree.getOctree()->getResolution());
+      boost::hash_combine(seed, octree.getOctree()->size());
+      break;
+    }
+    default:
+      break;
+  }
+}
+}  // namespace
+
+void ExperienceLibrary::Bucket::buildKDTree()
+{
+  kdtree.resize(experiences.size());
+  for (std::size_t i = 0; i < kdtree.size(); ++i)
+    kdtree[i] = i;
+
+  // Split each range at its median, cycling through the dimensions of the key
+  std::function<void(std::size_t, std::size_t, std::size_t)> build = [&](std::size_t begin,
+                                                                         std::size_t end,
+                                                                         std::size_t depth) {
+    if (end - begin < 2)
+      return;
+
+    const auto dim = static_cast<Eigen::Index>(depth % static_cast<std::size_t>(keys[kdtree[begin]].size()));
+    const std::size_t mid = begin + ((end - begin) / 2);
+    std::nth_element(kdtree.begin() + static_cast<long>(begin),
+                     kdtree.begin() + static_cast<long>(mid),
+                     kdtree.begin() + static_cast<long>(end),
+                     [&](std::size_t a, std::size_t b) { return keys[a](dim) < keys[b](dim); });
+    build(begin, mid, depth + 1);
+    build(mid + 1, end, depth + 1);
+  };
+  build(0, kdtree.size(), 0);
+  dirty = false;
+}
+
+void ExperienceLibrary::Bucket::searchKDTree(const Eigen::VectorXd& key,
+                                             std::size_t begin,
+                                             std::size_t end,
+                                             std::size_t depth,
+                                             std::size_t& nearest,
+                                             double& nearest_dist_sq) const
+{
+  if (begin >= end)
+    return;
+
+  const std::size_t mid = begin + ((end - begin) / 2);
+  const std::size_t index = kdtree[mid];
+  const double dist_sq = (keys[index] - key).squaredNorm();
+  if (dist_sq < nearest_dist_sq)
+  {
+    nearest = index;
+    nearest_dist_sq = dist_sq;
+  }
+
+  const auto dim = static_cast<Eigen::Index>(depth % static_cast<std::size_t>(key.size()));
+  const double diff = key(dim) - keys[index](dim);
+  if (diff < 0)
+  {
+    searchKDTree(key, begin, mid, depth + 1, nearest, nearest_dist_sq);
+    if (diff * diff < nearest_dist_sq)
+      searchKDTree(key, mid + 1, end, depth + 1, nearest, nearest_dist_sq);
+  }
+  else
+  {
+    searchKDTree(key, mid + 1, end, depth + 1, nearest, nearest_dist_sq);
+    if (diff * diff < nearest_dist_sq)
+      searchKDTree(key, begin, mid, depth + 1, nearest, nearest_dist_sq);
+  }
+}
+
+ExperienceLibrary::ExperienceLibrary(std::size_t capacity) : capacity_(capacity) {}
+
+bool ExperienceLibrary::findNearest(Bucket& bucket,
+                                    const Eigen::VectorXd& key,
+                                    bool rebuild,
+                                    std::size_t& nearest,
+                                    double& nearest_dist_sq)
+{
+  if (bucket.experiences.empty())
+    return false;
+
+  nearest_dist_sq = std::numeric_limits<double>::max();
+  if (bucket.dirty && !rebuild)
+  {
+    for (std::size_t i = 0; i < bucket.keys.size(); ++i)
+    {
+      const double dist_sq = (bucket.keys[i] - key).squaredNorm();
+      if (dist_sq < nearest_dist_sq)
+      {
+        nearest = i;
+        nearest_dist_sq = dist_sq;
+      }
+    }
+    return true;
+  }
+
+  if (bucket.dirty)
+    bucket.buildKDTree();
+
+  bucket.searchKDTree(key, 0, bucket.kdtree.size(), 0, nearest, nearest_dist_sq);
+  return true;
+}
+
+void ExperienceLibrary::touchUnlocked(Bucket& bucket, std::size_t index)
+{
+  bucket.experiences[index].last_used = ++usage_counter_;
+  lru_.splice(lru_.end(), lru_, bucket.lru_entries[index]);
+}
+
+void ExperienceLibrary::add(const TrajArray& traj, const std::string& environment_signature, double cost)
+{
+  if (traj.rows() < 2 || traj.cols() < 1)
+  {
+    CONSOLE_BRIDGE_logWarn("ExperienceLibrary, trajectories must have at least two steps and one joint");
+    return;
+  }
+
+  std::scoped_lock lock(mutex_);
+  addUnlocked(traj, environment_signature, cost);
+}
+
+void ExperienceLibrary::addUnlocked(const TrajArray& traj, const std::string& environment_signature, double cost)
+{
+  Bucket& bucket = buckets_[getBucketName(environment_signature, traj.cols())];
+  Eigen::VectorXd key = getKey(traj);
+
+  // Replace the experience of the same motion if this one is not worse. A kd-tree which is out of date is not rebuilt
+  // because adds usually come in batches, so it is only rebuilt once on the next retrieve.
+  std::size_t nearest{ 0 };
+  double nearest_dist_sq{ 0 };
+  if (findNearest(bucket, key, false, nearest, nearest_dist_sq) &&
+      nearest_dist_sq <= merge_tolerance * merge_tolerance)
+  {
+    Experience& experience = bucket.experiences[nearest];
+    if (cost <= experience.cost)
+    {
+      experience.traj = traj;
+      experience.cost = cost;
+      bucket.keys[nearest] = key;
+      bucket.dirty = true;
+    }
+    touchUnlocked(bucket, nearest);
+    return;
+  }
+
+  Experience experience;
+  experience.traj = traj;
+  experience.environment_signature = environment_signature;
+  experience.cost = cost;
+  experience.last_used = ++usage_counter_;
+  bucket.experiences.push_back(std::move(experience));
+  bucket.keys.push_back(std::move(key));
+  bucket.lru_entries.push_back(lru_.insert(lru_.end(), LRUEntry{ &bucket, bucket.experiences.size() - 1 }));
+  bucket.dirty = true;
+  ++size_;
+
+  evictUnlocked();
+}
+
+void ExperienceLibrary::evictUnlocked()
+{
+  while (size_ > capacity_ && !lru_.empty())
+  {
+    const LRUEntry entry = lru_.front();
+    lru_.pop_front();
+
+    // Move the last experience of the bucket into the evicted one, the kd-tree is rebuilt anyway
+    Bucket& bucket = *entry.bucket;
+    const std::size_t last = bucket.experiences.size() - 1;
+    if (entry.index != last)
+    {
+      bucket.experiences[entry.index] = std::move(bucket.experiences[last]);
+      bucket.keys[entry.index] = std::move(bucket.keys[last]);
+      bucket.lru_entries[entry.index] = bucket.lru_entries[last];
+      bucket.lru_entries[entry.index]->index = entry.index;
+    }
+    bucket.experiences.pop_back();
+    bucket.keys.pop_back();
+    bucket.lru_entries.pop_back();
+    bucket.dirty = true;
+    --size_;
+  }
+}
+
+bool ExperienceLibrary::retrieve(TrajArray& traj,
+                                 const Eigen::Ref<const Eigen::VectorXd>& start,
+                                 const Eigen::Ref<const Eigen::VectorXd>& goal,
+                                 const std::string& environment_signature,
+                                 int n_steps,
+                                 double max_distance)
+{
+  if (n_steps < 2 || start.size() != goal.size())
+    return false;
+
+  std::scoped_lock lock(mutex_);
+  auto it = buckets_.find(getBucketName(environment_signature, start.size()));
+  if (it == buckets_.end())
+    return false;
+
+  Eigen::VectorXd key(2 * start.size());
+  key << start, goal;
+
+  std::size_t nearest{ 0 };
+  double nearest_dist_sq{ 0 };
+  if (!findNearest(it->second, key, true, nearest, nearest_dist_sq) || std::sqrt(nearest_dist_sq) > max_distance)
+    return false;
+
+  touchUnlocked(it->second, nearest);
+  traj = adaptTrajectory(it->second.experiences[nearest].traj, start, goal, n_steps);
+  return true;
+}
+
+bool ExperienceLibrary::warmStart(ProblemConstructionInfo& pci,
+                                  const Eigen::Ref<const Eigen::VectorXd>& goal,
+                                  const std::string& environment_signature,
+                                  double max_distance)
+{
+  if (pci.env == nullptr || pci.kin == nullptr)
+    return false;
+
+  Eigen::VectorXd start = pci.env->getCurrentJointValues(pci.kin->getJointNames());
+  TrajArray traj;
+  if (!retrieve(traj, start, goal, environment_signature, pci.basic_info.n_steps, max_distance))
+    return false;
+
+  pci.init_info.type = InitInfo::GIVEN_TRAJ;
+  pci.init_info.data = traj;
+  return true;
+}
+
+std::size_t ExperienceLibrary::size() const
+{
+  std::scoped_lock lock(mutex_);
+  return size_;
+}
+
+void ExperienceLibrary::clear()
+{
+  std::scoped_lock lock(mutex_);
+  buckets_.clear();
+  lru_.clear();
+  size_ = 0;
+}
+
+std::size_t ExperienceLibrary::getCapacity() const
+{
+  std::scoped_lock lock(mutex_);
+  return capacity_;
+}
+
+void ExperienceLibrary::setCapacity(std::size_t capacity)
+{
+  std::scoped_lock lock(mutex_);
+  capacity_ = capacity;
+  evictUnlocked();
+}
+
+bool ExperienceLibrary::save(const std::string& file_path) const
+{
+  Json::Value root;
+  {
+    std::scoped_lock lock(mutex_);
+    root["capacity"] = static_cast<Json::UInt64>(capacity_);
+    Json::Value& experiences = root["experiences"];
+    experiences = Json::Value(Json::arrayValue);
+
+    // Write the experiences from least to most recently used so loading preserves the eviction order
+    for (const LRUEntry& entry : lru_)
+    {
+      const Experience* experience = &entry.bucket->experiences[entry.index];
+      Json::Value value;
+      value["environment_signature"] = experience->environment_signature;
+      value["cost"] = experience->cost;
+      value["rows"] = static_cast<Json::Int64>(experience->traj.rows());
+      value["cols"] = static_cast<Json::Int64>(experience->traj.cols());
+      Json::Value& traj = value["traj"];
+      traj = Json::Value(Json::arrayValue);
+      for (Eigen::Index i = 0; i < experience->traj.size(); ++i)
+        traj.append(experience->traj.data()[i]);
+      experiences.append(value);
+    }
+  }
+
+  std::ofstream file(file_path);
+  if (!file)
+  {
+    CONSOLE_BRIDGE_logError("ExperienceLibrary, failed to open '%s' for writing", file_path.c_str());
+    return false;
+  }
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  file << Json::writeString(builder, root);
+  return file.good();
+}
+
+bool ExperienceLibrary::load(const std::string& file_path)
+{
+  std::ifstream file(file_path);
+  if (!file)
+  {
+    CONSOLE_BRIDGE_logError("ExperienceLibrary, failed to open '%s' for reading", file_path.c_str());
+    return false;
+  }
+
+  Json::Value root;
+  Json::CharReaderBuilder builder;
+  std::string errors;
+  if (!Json::parseFromStream(builder, file, &root, &errors))
+  {
+    CONSOLE_BRIDGE_logError("ExperienceLibrary, failed to parse '%s': %s", file_path.c_str(), errors.c_str());
+    return false;
+  }
+
+  // Validate everything before changing the library so a bad file does not load partially
+  if (!root.isObject() || !(root["capacity"].isNull() || root["capacity"].isUInt64()) ||
+      !(root["experiences"].isNull() || root["experiences"].isArray()))
+  {
+    CONSOLE_BRIDGE_logError("ExperienceLibrary, invalid library in '%s'", file_path.c_str());
+    return false;
+  }
+
+  const Json::Value& values = root["experiences"];
+  std::vector<Experience> experiences;
+  experiences.reserve(values.size());
+  for (const auto& value : values)
+  {
+    if (!value.isObject() || !value["rows"].isInt64() || !value["cols"].isInt64() || !value["traj"].isArray() ||
+        !value["environment_signature"].isString() || !value["cost"].isNumeric())
+    {
+      CONSOLE_BRIDGE_logError("ExperienceLibrary, invalid experience in '%s'", file_path.c_str());
+      return false;
+    }
+
+    const auto rows = static_cast<Eigen::Index>(value["rows"].asInt64());
+    const auto cols = static_cast<Eigen::Index>(value["cols"].asInt64());
+    const Json::Value& data = value["traj"];
+    if (rows < 2 || cols < 1 || static_cast<Eigen::Index>(data.size()) != rows * cols ||
+        !std::all_of(data.begin(), data.end(), [](const Json::Value& v) { return v.isNumeric(); }))
+    {
+      CONSOLE_BRIDGE_logError("ExperienceLibrary, invalid experience in '%s'", file_path.c_str());
+      return false;
+    }
+
+    Experience experience;
+    experience.traj.resize(rows, cols);
+    for (Json::ArrayIndex i = 0; i < data.size(); ++i)
+      experience.traj.data()[i] = data[i].asDouble();
+    experience.environment_signature = value["environment_signature"].asString();
+    experience.cost = value["cost"].asDouble();
+    experiences.push_back(std::move(experience));
+  }
+
+  std::scoped_lock lock(mutex_);
+  if (!root["capacity"].isNull())
+  {
+    capacity_ = static_cast<std::size_t>(root["capacity"].asUInt64());
+    evictUnlocked();
+  }
+
+  for (const auto& experience : experiences)
+    addUnlocked(experience.traj, experience.environment_signature, experience.cost);
+  return true;
+}
+
+TrajArray adaptTrajectory(const TrajArray& traj,
+                          const Eigen::Ref<const Eigen::VectorXd>& start,
+                          const Eigen::Ref<const Eigen::VectorXd>& goal,
+                          int n_steps)
+{
+  assert(traj.rows() >= 2 && n_steps >= 2);
+  assert(traj.cols() == start.size() && traj.cols() == goal.size());
+
+  // Time warp the trajectory onto the new number of steps
+  Eigen::VectorXd new_x = Eigen::VectorXd::LinSpaced(n_steps, 0, 1);
+  TrajArray result = traj;
+  if (traj.rows() != n_steps)
+  {
+    Eigen::VectorXd old_x = Eigen::VectorXd::LinSpaced(traj.rows(), 0, 1);
+    result = trajopt_common::interp2d(new_x, old_x, traj);
+  }
+
+  // Move the endpoints onto the new start and goal, blending the offsets along the trajectory
+  Eigen::RowVectorXd start_offset = start.transpose() - result.row(0);
+  Eigen::RowVectorXd goal_offset = goal.transpose() - result.row(n_steps - 1);
+  for (Eigen::Index i = 0; i < n_steps; ++i)
+    result.row(i) += ((1.0 - new_x(i)) * start_offset) + (new_x(i) * goal_offset);
+
+  return result;
+}
+
+std::string getEnvironmentSignature(const tesseract_environment::Environment& env)
+{
+  std::vector<std::string> link_names = env.getStaticLinkNames();
+  std::sort(link_names.begin(), link_names.end());
+
+  std::size_t seed{ 0 };
+  tesseract_scene_graph::SceneState state = env.getState();
+  for (const auto& link_name : link_names)
+  {
+    auto link = env.getLink(link_name);
+    if (link == nullptr || link->collision.empty())
+      continue;
+
+    boost::hash_combine(seed, link_name);
+    for (const auto& collision : link->collision)
+    {
+      hashCombineGeometry(seed, *collision->geometry);
+      hashCombineRounded(seed, collision->origin);
+    }
+
+    hashCombineRounded(seed, state.link_transforms.at(link_name));
+  }
+
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << seed;
+  return ss.str();
+}
+}  // namespace trajopt
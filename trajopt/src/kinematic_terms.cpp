@@ -71,24 +71,10 @@ Eigen::VectorXd applyTolerances(const Eigen::VectorXd& error,
   return resultant;
 }
 
-DynamicCartPoseErrCalculator::DynamicCartPoseErrCalculator(
-    std::shared_ptr<const tesseract_kinematics::JointGroup> manip,
-    std::string source_frame,
-    std::string target_frame,
-    const Eigen::Isometry3d& source_frame_offset,  // NOLINT(modernize-pass-by-value)
-    const Eigen::Isometry3d& target_frame_offset,  // NOLINT(modernize-pass-by-value)
-    const Eigen::VectorXi& indices,                // NOLINT(modernize-pass-by-value)
-    const Eigen::VectorXd& lower_tolerance,        // NOLINT(modernize-pass-by-value)
-    const Eigen::VectorXd& upper_tolerance)        // NOLINT(modernize-pass-by-value)
-  : manip_(std::move(manip))
-  , source_frame_(std::move(source_frame))
-  , target_frame_(std::move(target_frame))
-  , source_frame_offset_(source_frame_offset)
-  , target_frame_offset_(target_frame_offset)
-  , indices_(indices)
+ErrorFunctionType createCartPoseErrorFunction(bool is_target_active,
+                                              const Eigen::VectorXd& lower_tolerance,
+                                              const Eigen::VectorXd& upper_tolerance)
 {
-  assert(indices_.size() <= 6);
-
   if (lower_tolerance.size() != upper_tolerance.size())
   {
     std::stringstream error_ss;
@@ -101,21 +87,58 @@ DynamicCartPoseErrCalculator::DynamicCartPoseErrCalculator(
   if ((lower_tolerance.size() == 0 && upper_tolerance.size() == 0) ||
       tesseract_common::almostEqualRelativeAndAbs(lower_tolerance, upper_tolerance))
   {
-    error_function = [this](const Eigen::Isometry3d& target_tf, const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
+    if (is_target_active)
+    {
+      return [](const Eigen::Isometry3d& target_tf, const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
+        return tesseract_common::calcTransformError(source_tf, target_tf);
+      };
+    }
+
+    return [](const Eigen::Isometry3d& target_tf, const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
       return tesseract_common::calcTransformError(target_tf, source_tf);
     };
   }
-  else
+
+  if (is_target_active)
   {
-    error_function = [lower_tolerance, upper_tolerance](const Eigen::Isometry3d& target_tf,
-                                                        const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
+    return [lower_tolerance, upper_tolerance](const Eigen::Isometry3d& target_tf,
+                                              const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
       // Calculate the error using tesseract_common::calcTransformError or equivalent
-      VectorXd err = tesseract_common::calcTransformError(target_tf, source_tf);
+      VectorXd err = tesseract_common::calcTransformError(source_tf, target_tf);
 
       // Apply tolerances
       return applyTolerances(err, lower_tolerance, upper_tolerance);
     };
   }
+
+  return [lower_tolerance, upper_tolerance](const Eigen::Isometry3d& target_tf,
+                                            const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
+    // Calculate the error using tesseract_common::calcTransformError or equivalent
+    VectorXd err = tesseract_common::calcTransformError(target_tf, source_tf);
+
+    // Apply tolerances
+    return applyTolerances(err, lower_tolerance, upper_tolerance);
+  };
+}
+
+DynamicCartPoseErrCalculator::DynamicCartPoseErrCalculator(
+    std::shared_ptr<const tesseract_kinematics::JointGroup> manip,
+    std::string source_frame,
+    std::string target_frame,
+    const Eigen::Isometry3d& source_frame_offset,  // NOLINT(modernize-pass-by-value)
+    const Eigen::Isometry3d& target_frame_offset,  // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXi& indices,                // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXd& lower_tolerance,        // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXd& upper_tolerance)        // NOLINT(modernize-pass-by-value)
+  : manip_(std::move(manip))
+  , source_frame_(std::move(source_frame))
+  , target_frame_(std::move(target_frame))
+  , source_frame_offset_(source_frame_offset)
+  , target_frame_offset_(target_frame_offset)
+  , indices_(indices)
+{
+  assert(indices_.size() <= 6);
+  error_function = createCartPoseErrorFunction(false, lower_tolerance, upper_tolerance);
 }
 
 VectorXd DynamicCartPoseErrCalculator::operator()(const VectorXd& dof_vals) const
@@ -160,7 +183,9 @@ DynamicCartPoseJacCalculator::DynamicCartPoseJacCalculator(
     std::string target_frame,
     const Eigen::Isometry3d& source_frame_offset,  // NOLINT(modernize-pass-by-value)
     const Eigen::Isometry3d& target_frame_offset,  // NOLINT(modernize-pass-by-value)
-    const Eigen::VectorXi& indices)                // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXi& indices,                // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXd& lower_tolerance,        // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXd& upper_tolerance)        // NOLINT(modernize-pass-by-value)
   : manip_(std::move(manip))
   , source_frame_(std::move(source_frame))
   , source_frame_offset_(source_frame_offset)
@@ -170,15 +195,36 @@ DynamicCartPoseJacCalculator::DynamicCartPoseJacCalculator(
   , epsilon_(DEFAULT_EPSILON)
 {
   assert(indices_.size() <= 6);
+  error_function_ = createCartPoseErrorFunction(false, lower_tolerance, upper_tolerance);
 }
 
 MatrixXd DynamicCartPoseJacCalculator::operator()(const VectorXd& dof_vals) const
 {
-  // Duplicated from calcForwardNumJac in trajopt_sco/src/num_diff.cpp, but with ignoring tolerances
   tesseract_common::TransformMap state = manip_->calcFwdKin(dof_vals);
   Isometry3d source_tf = state[source_frame_] * source_frame_offset_;
   Isometry3d target_tf = state[target_frame_] * target_frame_offset_;
+  return calcJacobian(dof_vals, source_tf, target_tf);
+}
 
+void DynamicCartPoseJacCalculator::operator()(const VectorXd& dof_vals, VectorXd& err, MatrixXd& jac) const
+{
+  tesseract_common::TransformMap state = manip_->calcFwdKin(dof_vals);
+  Isometry3d source_tf = state[source_frame_] * source_frame_offset_;
+  Isometry3d target_tf = state[target_frame_] * target_frame_offset_;
+
+  VectorXd full_err = error_function_(target_tf, source_tf);
+  err.resize(indices_.size());
+  for (int i = 0; i < indices_.size(); ++i)
+    err[i] = full_err[indices_[i]];
+
+  jac = calcJacobian(dof_vals, source_tf, target_tf);
+}
+
+MatrixXd DynamicCartPoseJacCalculator::calcJacobian(const VectorXd& dof_vals,
+                                                    const Isometry3d& source_tf,
+                                                    const Isometry3d& target_tf) const
+{
+  // Duplicated from calcForwardNumJac in trajopt_sco/src/num_diff.cpp, but with ignoring tolerances
   Eigen::MatrixXd jac0(indices_.size(), dof_vals.size());
   Eigen::VectorXd dof_vals_pert = dof_vals;
   for (int i = 0; i < dof_vals.size(); ++i)
@@ -219,59 +265,7 @@ CartPoseErrCalculator::CartPoseErrCalculator(
 {
   assert(indices_.size() <= 6);
   is_target_active_ = manip_->isActiveLinkName(target_frame_);
-
-  if (lower_tolerance.size() != upper_tolerance.size())
-  {
-    std::stringstream error_ss;
-    error_ss << "CartPoseErrCalculator: Mismatched tolerance sizes. lower: " << lower_tolerance.size()
-             << ", upper: " << upper_tolerance.size();
-    throw std::runtime_error(error_ss.str());
-  }
-
-  // Check to see if the waypoint is toleranced and set the error function accordingly
-  if ((lower_tolerance.size() == 0 && upper_tolerance.size() == 0) ||
-      tesseract_common::almostEqualRelativeAndAbs(lower_tolerance, upper_tolerance))
-  {
-    if (is_target_active_)
-    {
-      error_function_ = [this](const Eigen::Isometry3d& target_tf,
-                               const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
-        return tesseract_common::calcTransformError(source_tf, target_tf);
-      };
-    }
-    else
-    {
-      error_function_ = [this](const Eigen::Isometry3d& target_tf,
-                               const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
-        return tesseract_common::calcTransformError(target_tf, source_tf);
-      };
-    }
-  }
-  else
-  {
-    if (is_target_active_)
-    {
-      error_function_ = [lower_tolerance, upper_tolerance](const Eigen::Isometry3d& target_tf,
-                                                           const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
-        // Calculate the error using tesseract_common::calcTransformError or equivalent
-        VectorXd err = tesseract_common::calcTransformError(source_tf, target_tf);
-
-        // Apply tolerances
-        return applyTolerances(err, lower_tolerance, upper_tolerance);
-      };
-    }
-    else
-    {
-      error_function_ = [lower_tolerance, upper_tolerance](const Eigen::Isometry3d& target_tf,
-                                                           const Eigen::Isometry3d& source_tf) -> Eigen::VectorXd {
-        // Calculate the error using tesseract_common::calcTransformError or equivalent
-        VectorXd err = tesseract_common::calcTransformError(target_tf, source_tf);
-
-        // Apply tolerances
-        return applyTolerances(err, lower_tolerance, upper_tolerance);
-      };
-    }
-  }
+  error_function_ = createCartPoseErrorFunction(is_target_active_, lower_tolerance, upper_tolerance);
 }
 
 VectorXd CartPoseErrCalculator::operator()(const VectorXd& dof_vals) const
@@ -316,7 +310,9 @@ CartPoseJacCalculator::CartPoseJacCalculator(
     std::string target_frame,
     const Eigen::Isometry3d& source_frame_offset,  // NOLINT(modernize-pass-by-value)
     const Eigen::Isometry3d& target_frame_offset,  // NOLINT(modernize-pass-by-value)
-    const Eigen::VectorXi& indices)                // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXi& indices,                // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXd& lower_tolerance,        // NOLINT(modernize-pass-by-value)
+    const Eigen::VectorXd& upper_tolerance)        // NOLINT(modernize-pass-by-value)
   : manip_(std::move(manip))
   , source_frame_(std::move(source_frame))
   , source_frame_offset_(source_frame_offset)
@@ -327,6 +323,7 @@ CartPoseJacCalculator::CartPoseJacCalculator(
 {
   is_target_active_ = manip_->isActiveLinkName(target_frame_);
   assert(indices_.size() <= 6);
+  error_function_ = createCartPoseErrorFunction(is_target_active_, lower_tolerance, upper_tolerance);
 
   if (is_target_active_)
   {
@@ -367,7 +364,27 @@ MatrixXd CartPoseJacCalculator::operator()(const VectorXd& dof_vals) const
   tesseract_common::TransformMap state = manip_->calcFwdKin(dof_vals);
   Isometry3d source_tf = state[source_frame_] * source_frame_offset_;
   Isometry3d target_tf = state[target_frame_] * target_frame_offset_;
+  return calcJacobian(dof_vals, source_tf, target_tf);
+}
 
+void CartPoseJacCalculator::operator()(const VectorXd& dof_vals, VectorXd& err, MatrixXd& jac) const
+{
+  tesseract_common::TransformMap state = manip_->calcFwdKin(dof_vals);
+  Isometry3d source_tf = state[source_frame_] * source_frame_offset_;
+  Isometry3d target_tf = state[target_frame_] * target_frame_offset_;
+
+  VectorXd full_err = error_function_(target_tf, source_tf);
+  err.resize(indices_.size());
+  for (int i = 0; i < indices_.size(); ++i)
+    err[i] = full_err[indices_[i]];
+
+  jac = calcJacobian(dof_vals, source_tf, target_tf);
+}
+
+MatrixXd CartPoseJacCalculator::calcJacobian(const VectorXd& dof_vals,
+                                             const Isometry3d& source_tf,
+                                             const Isometry3d& target_tf) const
+{
   Eigen::MatrixXd jac0(indices_.size(), dof_vals.size());
   Eigen::VectorXd dof_vals_pert = dof_vals;
   for (int i = 0; i < dof_vals.size(); ++i)
@@ -622,7 +639,9 @@ MatrixXd AvoidSingularityJacCalculator::jacobianPartialDerivative(const VectorXd
                                                                   Eigen::Index jntIdx) const
 {
   // Calculate the jacobian for the given joint perturbed by some epsilon
-  Eigen::VectorXd joints(state);
+  // Making this thread_local avoids heap contention when terms are evaluated in parallel
+  thread_local Eigen::VectorXd joints;
+  joints = state;
   double eps = eps_;
   joints(jntIdx) += eps;
 
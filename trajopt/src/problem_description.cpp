@@ -1,7 +1,9 @@
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <boost/algorithm/string.hpp>
+#include <cmath>
 #include <json/json.h>
+#include <typeinfo>
 #include <console_bridge/console.h>
 TRAJOPT_IGNORE_WARNINGS_POP
 
@@ -17,6 +19,7 @@ TRAJOPT_IGNORE_WARNINGS_POP
 #include <trajopt_sco/expr_ops.hpp>
 #include <trajopt_common/eigen_conversions.hpp>
 #include <trajopt_common/eigen_slicing.hpp>
+#include <trajopt_common/interpolation.hpp>
 #include <trajopt_common/logging.hpp>
 #include <trajopt_common/vector_ops.hpp>
 
@@ -406,6 +409,432 @@ TrajOptResult::Ptr OptimizeProblem(const TrajOptProb::Ptr& prob,
   return std::make_shared<TrajOptResult>(opt.results(), *prob);
 }
 
+namespace
+{
+/** @brief Map a step of the full problem to its index in the sorted coarse steps, unset steps (< 0) are kept */
+int toCoarseStep(const std::vector<int>& steps, int step)
+{
+  if (step < 0)
+    return step;
+
+  return static_cast<int>(std::distance(steps.begin(), std::lower_bound(steps.begin(), steps.end(), step)));
+}
+
+IntVec toCoarseSteps(const std::vector<int>& steps, const IntVec& fine_steps)
+{
+  IntVec coarse_steps;
+  coarse_steps.reserve(fine_steps.size());
+  for (int step : fine_steps)
+    coarse_steps.push_back(toCoarseStep(steps, step));
+
+  std::sort(coarse_steps.begin(), coarse_steps.end());
+  return coarse_steps;
+}
+
+void scaleValues(DblVec& values, double scale)
+{
+  for (double& value : values)
+    value *= scale;
+}
+
+/** @brief Copy a term info only if it is exactly of type T, so user derived term infos are never sliced */
+template <typename T>
+std::shared_ptr<T> copyTermInfo(const TermInfo::Ptr& term)
+{
+  const TermInfo& info = *term;
+  if (typeid(info) != typeid(T))
+    return nullptr;
+
+  return std::make_shared<T>(static_cast<const T&>(info));
+}
+
+/** @brief Copy a term info which is exactly one of the types Ts, nullptr otherwise */
+template <typename... Ts>
+TermInfo::Ptr copyTermInfoOf(const TermInfo::Ptr& term)
+{
+  TermInfo::Ptr copy;
+  ((copy = (copy != nullptr) ? copy : TermInfo::Ptr(copyTermInfo<Ts>(term))), ...);
+  return copy;
+}
+
+/**
+ * @brief Replace each term info with a copy, since hatch resolves the steps and parameters of a term info in place
+ * @return False if a term info is of a type that cannot be copied, it is then left unchanged
+ */
+bool copyTermInfos(std::vector<TermInfo::Ptr>& terms)
+{
+  bool copied = true;
+  for (TermInfo::Ptr& term : terms)
+  {
+    TermInfo::Ptr copy = copyTermInfoOf<UserDefinedTermInfo,
+                                        DynamicCartPoseTermInfo,
+                                        CartPoseTermInfo,
+                                        CartVelTermInfo,
+                                        JointPosTermInfo,
+                                        JointVelTermInfo,
+                                        JointAccTermInfo,
+                                        JointJerkTermInfo,
+                                        CollisionTermInfo,
+                                        TotalTimeTermInfo,
+                                        AvoidSingularityTermInfo>(term);
+    if (copy == nullptr)
+      copied = false;
+    else
+      term = copy;
+  }
+  return copied;
+}
+
+/** @brief Consecutive coarse steps which are all the same number of full resolution steps apart */
+struct CoarseRun
+{
+  int first_step;
+  int last_step;
+  int gap;
+};
+
+/**
+ * @brief Split the coarse steps covering the full resolution steps [first_step, last_step] into runs with a uniform gap
+ * @details Finite differences are only valid between evenly spaced steps, so each run becomes its own term scaled by
+ * its gap. Differences across two runs are dropped on the coarse level.
+ * @param min_intervals Runs with fewer intervals are dropped
+ */
+std::vector<CoarseRun> getCoarseRuns(const std::vector<int>& steps, int first_step, int last_step, int min_intervals)
+{
+  std::vector<CoarseRun> runs;
+  const int coarse_first = toCoarseStep(steps, first_step);
+  const int coarse_last = std::min(toCoarseStep(steps, last_step), static_cast<int>(steps.size()) - 1);
+  auto gap = [&steps](int i) { return steps[static_cast<std::size_t>(i)] - steps[static_cast<std::size_t>(i - 1)]; };
+
+  int run_first = coarse_first;
+  for (int i = coarse_first + 1; i <= coarse_last; ++i)
+  {
+    if (i < coarse_last && gap(i + 1) == gap(i))
+      continue;
+
+    if (i - run_first >= min_intervals)
+      runs.push_back({ run_first, i, gap(i) });
+
+    run_first = i;
+  }
+
+  return runs;
+}
+
+/**
+ * @brief Coarsen a joint term whose targets and tolerances are finite differences of the given order
+ * @details Order zero terms keep a single term. Higher orders get one term per run of evenly spaced coarse steps, with
+ * the targets and tolerances scaled by the gap of the run to the power of the order.
+ */
+template <typename T>
+void coarsenJointTermInfo(const TermInfo::Ptr& term,
+                          const std::vector<int>& steps,
+                          int order,
+                          std::vector<TermInfo::Ptr>& coarse_terms)
+{
+  auto fine = std::static_pointer_cast<T>(term);
+  if (order == 0)
+  {
+    auto coarse = std::make_shared<T>(*fine);
+    coarse->first_step = toCoarseStep(steps, fine->first_step);
+    coarse->last_step = toCoarseStep(steps, fine->last_step);
+    coarse_terms.push_back(coarse);
+    return;
+  }
+
+  // Acceleration needs two intervals and jerk four, see the hatch functions
+  const int min_intervals = (order == 3) ? 4 : order;
+  for (const CoarseRun& run : getCoarseRuns(steps, fine->first_step, fine->last_step, min_intervals))
+  {
+    auto coarse = std::make_shared<T>(*fine);
+    coarse->first_step = run.first_step;
+    coarse->last_step = run.last_step;
+    const double scale = std::pow(static_cast<double>(run.gap), order);
+    scaleValues(coarse->targets, scale);
+    scaleValues(coarse->upper_tols, scale);
+    scaleValues(coarse->lower_tols, scale);
+    coarse_terms.push_back(coarse);
+  }
+}
+
+TermInfo::Ptr coarsenCollisionTermInfo(const TermInfo::Ptr& term, const std::vector<int>& steps, double max_segment)
+{
+  auto coarse = copyTermInfo<CollisionTermInfo>(term);
+  if (coarse->first_step < 0)
+    return coarse;
+
+  auto fine = std::static_pointer_cast<CollisionTermInfo>(term);
+  coarse->first_step = toCoarseStep(steps, fine->first_step);
+  coarse->last_step = toCoarseStep(steps, fine->last_step);
+  coarse->fixed_steps = toCoarseSteps(steps, fine->fixed_steps);
+  coarse->info.clear();
+  for (int step : steps)
+  {
+    if (step < fine->first_step || step > fine->last_step || fine->info.empty())
+      continue;
+
+    // Safety margin data is only given per step when the term is created from json
+    const auto index = static_cast<std::size_t>(step - fine->first_step);
+    coarse->info.push_back((index < fine->info.size()) ? fine->info[index] : fine->info.front());
+  }
+
+  // Continuous evaluation does not support two adjacent fixed steps, which coarsening may create
+  bool adjacent_fixed = false;
+  for (std::size_t i = 1; i < coarse->fixed_steps.size(); ++i)
+    adjacent_fixed = adjacent_fixed || (coarse->fixed_steps[i] - coarse->fixed_steps[i - 1] == 1);
+
+  if (adjacent_fixed)
+  {
+    coarse->evaluator_type = CollisionEvaluatorType::SINGLE_TIMESTEP;
+  }
+  else if (coarse->evaluator_type == CollisionEvaluatorType::SINGLE_TIMESTEP)
+  {
+    // Check the motion between the kept steps at least as densely as the removed steps were checked
+    coarse->evaluator_type = CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+    if (max_segment > 0)
+      coarse->longest_valid_segment_length = std::min(coarse->longest_valid_segment_length, max_segment);
+  }
+
+  return coarse;
+}
+
+/**
+ * @brief Add the coarse terms of a full resolution term to coarse_terms
+ * @return False if the term cannot be coarsened
+ */
+bool coarsenTermInfo(const TermInfo::Ptr& term,
+                     const std::vector<int>& steps,
+                     double max_segment,
+                     std::vector<TermInfo::Ptr>& coarse_terms)
+{
+  const TermInfo& info = *term;
+  if (typeid(info) == typeid(JointPosTermInfo))
+    coarsenJointTermInfo<JointPosTermInfo>(term, steps, 0, coarse_terms);
+  else if (typeid(info) == typeid(JointVelTermInfo))
+    coarsenJointTermInfo<JointVelTermInfo>(term, steps, 1, coarse_terms);
+  else if (typeid(info) == typeid(JointAccTermInfo))
+    coarsenJointTermInfo<JointAccTermInfo>(term, steps, 2, coarse_terms);
+  else if (typeid(info) == typeid(JointJerkTermInfo))
+    coarsenJointTermInfo<JointJerkTermInfo>(term, steps, 3, coarse_terms);
+  else if (typeid(info) == typeid(CollisionTermInfo))
+    coarse_terms.push_back(coarsenCollisionTermInfo(term, steps, max_segment));
+  else if (auto coarse = copyTermInfo<CartPoseTermInfo>(term))
+  {
+    coarse->timestep = toCoarseStep(steps, coarse->timestep);
+    coarse_terms.push_back(coarse);
+  }
+  else if (auto coarse = copyTermInfo<DynamicCartPoseTermInfo>(term))
+  {
+    coarse->timestep = toCoarseStep(steps, coarse->timestep);
+    coarse_terms.push_back(coarse);
+  }
+  else if (auto fine = copyTermInfo<CartVelTermInfo>(term))
+  {
+    if (fine->last_step < 0)
+    {
+      fine->first_step = toCoarseStep(steps, fine->first_step);
+      coarse_terms.push_back(fine);
+      return true;
+    }
+
+    // Each velocity term spans a step and the one after it
+    for (const CoarseRun& run : getCoarseRuns(steps, fine->first_step, fine->last_step + 1, 1))
+    {
+      auto coarse = std::make_shared<CartVelTermInfo>(*fine);
+      coarse->first_step = run.first_step;
+      coarse->last_step = run.last_step - 1;
+      coarse->max_displacement *= run.gap;
+      coarse_terms.push_back(coarse);
+    }
+  }
+  else if (auto coarse = copyTermInfo<UserDefinedTermInfo>(term))
+  {
+    coarse->first_step = toCoarseStep(steps, coarse->first_step);
+    coarse->last_step = toCoarseStep(steps, coarse->last_step);
+    coarse->fixed_steps = toCoarseSteps(steps, coarse->fixed_steps);
+    coarse_terms.push_back(coarse);
+  }
+  else if (auto coarse = copyTermInfo<AvoidSingularityTermInfo>(term))
+  {
+    coarse->first_step = toCoarseStep(steps, coarse->first_step);
+    coarse->last_step = toCoarseStep(steps, coarse->last_step);
+    coarse_terms.push_back(coarse);
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+std::vector<int> getMultiResolutionSteps(const ProblemConstructionInfo& pci, int stride)
+{
+  const int n_steps = pci.basic_info.n_steps;
+  std::vector<int> steps;
+  steps.reserve(static_cast<std::size_t>(n_steps));
+  auto add_step = [&steps, n_steps](int step) {
+    if (step >= 0 && step < n_steps)
+      steps.push_back(step);
+  };
+
+  for (int i = 0; i < n_steps; i += std::max(stride, 1))
+    steps.push_back(i);
+
+  add_step(n_steps - 1);
+  for (int step : pci.basic_info.fixed_timesteps)
+    add_step(step);
+
+  auto add_term_steps = [&add_step](const TermInfo::Ptr& term) {
+    if (auto t = std::dynamic_pointer_cast<CartPoseTermInfo>(term))
+    {
+      add_step(t->timestep);
+    }
+    else if (auto t = std::dynamic_pointer_cast<DynamicCartPoseTermInfo>(term))
+    {
+      add_step(t->timestep);
+    }
+    else if (auto t = std::dynamic_pointer_cast<CartVelTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step + 1);
+    }
+    else if (auto t = std::dynamic_pointer_cast<JointPosTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+    }
+    else if (auto t = std::dynamic_pointer_cast<JointVelTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+    }
+    else if (auto t = std::dynamic_pointer_cast<JointAccTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+    }
+    else if (auto t = std::dynamic_pointer_cast<JointJerkTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+    }
+    else if (auto t = std::dynamic_pointer_cast<AvoidSingularityTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+    }
+    else if (auto t = std::dynamic_pointer_cast<UserDefinedTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+      for (int step : t->fixed_steps)
+        add_step(step);
+    }
+    else if (auto t = std::dynamic_pointer_cast<CollisionTermInfo>(term))
+    {
+      add_step(t->first_step);
+      add_step(t->last_step);
+      for (int step : t->fixed_steps)
+        add_step(step);
+    }
+  };
+
+  for (const TermInfo::Ptr& term : pci.cost_infos)
+    add_term_steps(term);
+
+  for (const TermInfo::Ptr& term : pci.cnt_infos)
+    add_term_steps(term);
+
+  std::sort(steps.begin(), steps.end());
+  steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+  return steps;
+}
+
+std::shared_ptr<ProblemConstructionInfo> createMultiResolutionInfo(const ProblemConstructionInfo& pci,
+                                                                   const std::vector<int>& steps,
+                                                                   const TrajArray& traj)
+{
+  if (pci.basic_info.use_time)
+    return nullptr;
+
+  double max_segment = 0;
+  for (Eigen::Index i = 1; i < traj.rows(); ++i)
+    max_segment = std::max(max_segment, (traj.row(i) - traj.row(i - 1)).norm());
+
+  auto coarse = std::make_shared<ProblemConstructionInfo>(pci);
+  coarse->basic_info.n_steps = static_cast<int>(steps.size());
+  coarse->basic_info.fixed_timesteps = toCoarseSteps(steps, pci.basic_info.fixed_timesteps);
+  coarse->callbacks.clear();
+
+  coarse->init_info.type = InitInfo::GIVEN_TRAJ;
+  coarse->init_info.data.resize(static_cast<Eigen::Index>(steps.size()), traj.cols());
+  for (std::size_t i = 0; i < steps.size(); ++i)
+    coarse->init_info.data.row(static_cast<Eigen::Index>(i)) = traj.row(steps[i]);
+
+  coarse->cost_infos.clear();
+  for (const TermInfo::Ptr& term : pci.cost_infos)
+  {
+    if (!coarsenTermInfo(term, steps, max_segment, coarse->cost_infos))
+      return nullptr;
+  }
+
+  coarse->cnt_infos.clear();
+  for (const TermInfo::Ptr& term : pci.cnt_infos)
+  {
+    if (!coarsenTermInfo(term, steps, max_segment, coarse->cnt_infos))
+      return nullptr;
+  }
+
+  return coarse;
+}
+
+TrajOptResult::Ptr OptimizeProblemMultiResolution(const ProblemConstructionInfo& pci,
+                                                  const MultiResolutionInfo& info,
+                                                  const tesseract_visualization::Visualization::Ptr& plotter)
+{
+  // Hatching resolves the term infos in place, so the full problem is built from copies which are then used to create
+  // the coarse levels. Each coarse level gets its own copies as well.
+  ProblemConstructionInfo fine_pci(pci);
+  const bool copied = copyTermInfos(fine_pci.cost_infos) && copyTermInfos(fine_pci.cnt_infos);
+
+  // Constructing the full problem first resolves the term steps and generates the initial trajectory
+  TrajOptProb::Ptr prob = ConstructProblem(fine_pci);
+  TrajArray traj = prob->GetInitTraj();
+
+  const int n_steps = prob->GetNumSteps();
+  const Eigen::VectorXd fine_x = Eigen::VectorXd::LinSpaced(n_steps, 0, n_steps - 1);
+  for (int stride : info.strides)
+  {
+    std::vector<int> steps = getMultiResolutionSteps(fine_pci, stride);
+    if (static_cast<int>(steps.size()) < info.min_steps || static_cast<int>(steps.size()) >= n_steps)
+      continue;
+
+    std::shared_ptr<ProblemConstructionInfo> coarse_pci =
+        copied ? createMultiResolutionInfo(fine_pci, steps, traj) : nullptr;
+    if (coarse_pci == nullptr)
+    {
+      CONSOLE_BRIDGE_logWarn("Problem uses time or terms that cannot be coarsened, solving the full resolution only");
+      break;
+    }
+
+    TrajOptResult::Ptr coarse_result = OptimizeProblem(ConstructProblem(*coarse_pci));
+    LOG_DEBUG("multi resolution level with %i steps finished with status %s",
+              static_cast<int>(steps.size()),
+              sco::statusToString(coarse_result->status).c_str());
+
+    Eigen::VectorXd coarse_x(static_cast<Eigen::Index>(steps.size()));
+    for (std::size_t i = 0; i < steps.size(); ++i)
+      coarse_x(static_cast<Eigen::Index>(i)) = steps[i];
+
+    traj = trajopt_common::interp2d(fine_x, coarse_x, coarse_result->traj);
+  }
+
+  prob->SetInitTraj(traj);
+  return OptimizeProblem(prob, plotter);
+}
+
 TrajOptProb::Ptr ConstructProblem(const ProblemConstructionInfo& pci)
 {
   const BasicInfo& bi = pci.basic_info;
@@ -549,8 +978,20 @@ TrajOptProb::Ptr ConstructProblem(const Json::Value& root, const tesseract_envir
 
 TrajOptProb::TrajOptProb() = default;
 
+SharedContactQuery::Ptr TrajOptProb::getSharedContactQuery(const std::string& key)
+{
+  SharedContactQuery::Ptr& shared_query = m_shared_contact_queries[key];
+  if (shared_query == nullptr)
+    shared_query = std::make_shared<SharedContactQuery>();
+
+  return shared_query;
+}
+
 TrajOptProb::TrajOptProb(int n_steps, const ProblemConstructionInfo& pci)
-  : OptProb(pci.basic_info.convex_solver, pci.basic_info.convex_solver_config), m_kin(pci.kin), m_env(pci.env)
+  : OptProb(pci.basic_info.convex_solver, pci.basic_info.convex_solver_config)
+  , m_kin(pci.kin)
+  , m_env(pci.env)
+  , m_collision_snapshot(pci.collision_snapshot)
 {
   const Eigen::MatrixX2d& limits = m_kin->getLimits().joint_limits;
   auto n_dof = static_cast<int>(m_kin->numJoints());
@@ -792,19 +1233,25 @@ void DynamicCartPoseTermInfo::hatch(TrajOptProb& prob)
                                                             lower_tolerance,
                                                             upper_tolerance);
 
-    auto dfdx = std::make_shared<DynamicCartPoseJacCalculator>(
-        prob.GetKin(), source_frame, target_frame, source_frame_offset, target_frame_offset, indices);
+    auto dfdx = std::make_shared<DynamicCartPoseJacCalculator>(prob.GetKin(),
+                                                               source_frame,
+                                                               target_frame,
+                                                               source_frame_offset,
+                                                               target_frame_offset,
+                                                               indices,
+                                                               lower_tolerance,
+                                                               upper_tolerance);
 
     // Apply error calculator as either cost or constraint
     if (static_cast<bool>(term_type & TermType::TT_COST))
     {
-      prob.addCost(
-          std::make_shared<TrajOptCostFromErrFunc>(f, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name));
+      prob.addCost(std::make_shared<TrajOptCostFromErrFunc>(
+          f, dfdx, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name));
     }
     else if (static_cast<bool>(term_type & TermType::TT_CNT))
     {
       prob.addConstraint(std::make_shared<TrajOptConstraintFromErrFunc>(
-          f, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name));
+          f, dfdx, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name));
     }
     else
     {
@@ -940,10 +1387,16 @@ void CartPoseTermInfo::hatch(TrajOptProb& prob)
                                                      lower_tolerance,
                                                      upper_tolerance);
 
-    auto dfdx = std::make_shared<CartPoseJacCalculator>(
-        prob.GetKin(), source_frame, target_frame, source_frame_offset, target_frame_offset, indices);
-    prob.addCost(
-        std::make_shared<TrajOptCostFromErrFunc>(f, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name));
+    auto dfdx = std::make_shared<CartPoseJacCalculator>(prob.GetKin(),
+                                                        source_frame,
+                                                        target_frame,
+                                                        source_frame_offset,
+                                                        target_frame_offset,
+                                                        indices,
+                                                        lower_tolerance,
+                                                        upper_tolerance);
+    prob.addCost(std::make_shared<TrajOptCostFromErrFunc>(
+        f, dfdx, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name));
   }
   else if (static_cast<bool>(term_type & TermType::TT_CNT) && static_cast<bool>(~(term_type | ~TermType::TT_USE_TIME)))
   {
@@ -956,10 +1409,16 @@ void CartPoseTermInfo::hatch(TrajOptProb& prob)
                                                      lower_tolerance,
                                                      upper_tolerance);
 
-    auto dfdx = std::make_shared<CartPoseJacCalculator>(
-        prob.GetKin(), source_frame, target_frame, source_frame_offset, target_frame_offset, indices);
+    auto dfdx = std::make_shared<CartPoseJacCalculator>(prob.GetKin(),
+                                                        source_frame,
+                                                        target_frame,
+                                                        source_frame_offset,
+                                                        target_frame_offset,
+                                                        indices,
+                                                        lower_tolerance,
+                                                        upper_tolerance);
     prob.addConstraint(std::make_shared<TrajOptConstraintFromErrFunc>(
-        f, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name));
+        f, dfdx, dfdx, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name));
   }
   else
   {
@@ -1728,6 +2187,20 @@ void CollisionTermInfo::hatch(TrajOptProb& prob)
 {
   int n_dof = static_cast<int>(prob.GetKin()->numJoints());
 
+  // Collision terms checking the same states, like a cost and a constraint on the same steps, share a contact query.
+  // FIRST and LIMITED queries stop early, so checking at a larger contact distance could change the contacts found.
+  const bool share_contact_queries = (contact_test_type == tesseract_collision::ContactTestType::ALL ||
+                                      contact_test_type == tesseract_collision::ContactTestType::CLOSEST);
+  auto share_contact_query = [this, &prob, share_contact_queries](CollisionEvaluator& evaluator, int step) {
+    if (!share_contact_queries)
+      return;
+
+    const std::string key = (boost::format("%i_%i_%g_%i") % static_cast<int>(evaluator_type) %
+                             static_cast<int>(contact_test_type) % longest_valid_segment_length % step)
+                                .str();
+    evaluator.setSharedContactQuery(prob.getSharedContactQuery(key));
+  };
+
   if (term_type == TermType::TT_COST)
   {
     if (evaluator_type != CollisionEvaluatorType::SINGLE_TIMESTEP)
@@ -1771,8 +2244,10 @@ void CollisionTermInfo::hatch(TrajOptProb& prob)
                                                  prob.GetVarRow(i + 1, 0, n_dof),
                                                  expression_evaluator_type,
                                                  discrete_continuous,
-                                                 safety_margin_buffer);
+                                                 safety_margin_buffer,
+                                                 prob.getCollisionWorldSnapshot());
 
+        share_contact_query(*c->getEvaluator(), i);
         prob.addCost(c);
         prob.getCosts().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
       }
@@ -1792,8 +2267,10 @@ void CollisionTermInfo::hatch(TrajOptProb& prob)
                                                    contact_test_type,
                                                    prob.GetVarRow(i, 0, n_dof),
                                                    expression_evaluator_type,
-                                                   safety_margin_buffer);
+                                                   safety_margin_buffer,
+                                                   prob.getCollisionWorldSnapshot());
 
+          share_contact_query(*c->getEvaluator(), i);
           prob.addCost(c);
           prob.getCosts().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
         }
@@ -1843,8 +2320,10 @@ void CollisionTermInfo::hatch(TrajOptProb& prob)
                                                        prob.GetVarRow(i + 1, 0, n_dof),
                                                        expression_evaluator_type,
                                                        discrete_continuous,
-                                                       safety_margin_buffer);
+                                                       safety_margin_buffer,
+                                                       prob.getCollisionWorldSnapshot());
 
+        share_contact_query(*c->getEvaluator(), i);
         prob.addIneqConstraint(c);
         prob.getIneqConstraints().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
       }
@@ -1864,8 +2343,10 @@ void CollisionTermInfo::hatch(TrajOptProb& prob)
                                                          contact_test_type,
                                                          prob.GetVarRow(i, 0, n_dof),
                                                          expression_evaluator_type,
-                                                         safety_margin_buffer);
+                                                         safety_margin_buffer,
+                                                         prob.getCollisionWorldSnapshot());
 
+          share_contact_query(*c->getEvaluator(), i);
           prob.addIneqConstraint(c);
           prob.getIneqConstraints().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
         }
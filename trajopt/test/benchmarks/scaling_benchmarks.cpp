@@ -0,0 +1,333 @@
+#include <tesseract_common/macros.h>
+TESSERACT_COMMON_IGNORE_WARNINGS_PUSH
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+TESSERACT_COMMON_IGNORE_WARNINGS_POP
+#include <tesseract_environment/environment.h>
+#include <tesseract_common/resource_locator.h>
+
+#include <trajopt/collision_terms.hpp>
+#include <trajopt/collision_world_snapshot.hpp>
+#include <trajopt/common.hpp>
+#include <trajopt/problem_description.hpp>
+#include <trajopt_sco/optimizers.hpp>
+#include <trajopt_common/benchmark_utils.h>
+#include <trajopt_common/logging.hpp>
+#include <trajopt_common/utils.hpp>
+
+using namespace trajopt;
+using namespace std;
+using namespace trajopt_common;
+using namespace tesseract_environment;
+using namespace tesseract_collision;
+using namespace tesseract_common;
+
+/** @brief Cost wrapper which accumulates the time spent evaluating and convexifying the wrapped cost */
+class TimedCost : public sco::Cost
+{
+public:
+  TimedCost(sco::Cost::Ptr cost, double* time) : sco::Cost(cost->name()), cost_(std::move(cost)), time_(time) {}
+
+  double value(const DblVec& x) override
+  {
+    ScopedTimer timer(*time_);
+    return cost_->value(x);
+  }
+
+  sco::ConvexObjective::Ptr convex(const DblVec& x, sco::Model* model) override
+  {
+    ScopedTimer timer(*time_);
+    return cost_->convex(x, model);
+  }
+
+  sco::VarVector getVars() override { return cost_->getVars(); }
+
+private:
+  sco::Cost::Ptr cost_;
+  double* time_;
+};
+
+/**
+ * @brief Create a serial chain robot surrounded by a ring of spherical obstacles
+ * @details The chain is about 1.2m long regardless of the number of joints, which alternate about the z and y axes.
+ * The obstacles are placed on a ring of radius 0.7m at three different heights.
+ * @param dof The number of revolute joints
+ * @param n_obstacles The number of spherical obstacles
+ * @return The environment, nullptr if it failed to initialize
+ */
+static Environment::Ptr createScalingEnvironment(int dof, int n_obstacles)
+{
+  const double link_length = 1.2 / dof;
+  const double link_radius = std::min(0.04, link_length / 4.0);
+
+  std::stringstream urdf;
+  urdf << R"(<robot name="scaling_chain"><link name="base_link"/>)";
+  for (int i = 0; i < dof; ++i)
+  {
+    const std::string link = "link_" + std::to_string(i);
+    const std::string parent = (i == 0) ? "base_link" : "link_" + std::to_string(i - 1);
+    urdf << "<link name=\"" << link << "\"><collision><origin xyz=\"0 0 " << link_length << "\"/>"
+         << "<geometry><sphere radius=\"" << link_radius << "\"/></geometry></collision></link>";
+    urdf << "<joint name=\"joint_" << i << "\" type=\"revolute\"><parent link=\"" << parent << "\"/>"
+         << "<child link=\"" << link << "\"/><origin xyz=\"0 0 " << ((i == 0) ? 0.0 : link_length) << "\"/>"
+         << "<axis xyz=\"" << ((i % 2 == 0) ? "0 0 1" : "0 1 0") << "\"/>"
+         << R"(<limit lower="-3.14" upper="3.14" effort="0" velocity="2"/></joint>)";
+  }
+
+  for (int i = 0; i < n_obstacles; ++i)
+  {
+    const double angle = (2.0 * M_PI * i) / n_obstacles;
+    const double height = 0.3 + (0.3 * (i % 3));
+    const std::string link = "obstacle_" + std::to_string(i);
+    urdf << "<link name=\"" << link << "\"><collision><geometry><sphere radius=\"0.08\"/></geometry></collision>"
+         << "</link>";
+    urdf << "<joint name=\"" << link << "_joint\" type=\"fixed\"><parent link=\"base_link\"/><child link=\"" << link
+         << "\"/><origin xyz=\"" << (0.7 * std::cos(angle)) << " " << (0.7 * std::sin(angle)) << " " << height
+         << "\"/></joint>";
+  }
+  urdf << "</robot>";
+
+  std::stringstream srdf;
+  srdf << R"(<robot name="scaling_chain"><group name="manipulator">)"
+       << R"(<chain base_link="base_link" tip_link="link_)" << (dof - 1) << R"("/></group>)";
+  srdf << R"(<disable_collisions link1="base_link" link2="link_0" reason="Adjacent"/>)";
+  for (int i = 1; i < dof; ++i)
+    srdf << "<disable_collisions link1=\"link_" << (i - 1) << "\" link2=\"link_" << i << "\" reason=\"Adjacent\"/>";
+  srdf << "</robot>";
+
+  ResourceLocator::Ptr locator = std::make_shared<tesseract_common::GeneralResourceLocator>();
+  auto env = std::make_shared<Environment>();
+  if (!env->init(urdf.str(), srdf.str(), locator))
+    return nullptr;
+
+  return env;
+}
+
+/**
+ * @brief The start and end joint positions used by the scaling benchmarks
+ * @details The first joint sweeps the bent chain through the obstacle ring
+ */
+static std::pair<Eigen::VectorXd, Eigen::VectorXd> getScalingEndpoints(int dof)
+{
+  Eigen::VectorXd start = Eigen::VectorXd::Zero(dof);
+  for (Eigen::Index i = 1; i < dof; i += 2)
+    start(i) = 1.6 / dof;
+
+  Eigen::VectorXd end = start;
+  start(0) = -1.5;
+  end(0) = 1.5;
+  return { start, end };
+}
+
+/**
+ * @brief Benchmark the sco trust region solver as the waypoints, joints and obstacles are scaled
+ * @details The range is [n_steps, dof, n_obstacles]. The time spent in each phase of the solver, the time spent in the
+ * collision costs and the number of heap allocations made by the solver are reported per iteration.
+ */
+static void BM_TRAJOPT_SCALING_SOLVE(benchmark::State& state)
+{
+  const auto n_steps = static_cast<int>(state.range(0));
+  const auto dof = static_cast<int>(state.range(1));
+  const auto n_obstacles = static_cast<int>(state.range(2));
+
+  Environment::Ptr env = createScalingEnvironment(dof, n_obstacles);
+  if (env == nullptr)
+  {
+    state.SkipWithError("Failed to create the scaling environment");
+    return;
+  }
+
+  auto [start, end] = getScalingEndpoints(dof);
+  env->setState(env->getJointGroup("manipulator")->getJointNames(), start);
+
+  double convexify_time{ 0 };
+  double qp_solve_time{ 0 };
+  double evaluate_time{ 0 };
+  double collision_time{ 0 };
+  std::size_t allocations{ 0 };
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    ProblemConstructionInfo pci(env);
+    pci.basic_info.n_steps = n_steps;
+    pci.basic_info.manip = "manipulator";
+    pci.basic_info.convex_solver = sco::ModelType::OSQP;
+    pci.basic_info.fixed_timesteps = { 0 };
+    pci.basic_info.use_time = false;
+    pci.kin = env->getJointGroup("manipulator");
+    pci.init_info.type = InitInfo::JOINT_INTERPOLATED;
+    pci.init_info.data = end;
+
+    auto jv = std::make_shared<JointVelTermInfo>();
+    jv->coeffs = std::vector<double>(static_cast<std::size_t>(dof), 1.0);
+    jv->targets = std::vector<double>(static_cast<std::size_t>(dof), 0.0);
+    jv->first_step = 0;
+    jv->last_step = n_steps - 1;
+    jv->name = "joint_vel";
+    jv->term_type = trajopt::TermType::TT_COST;
+    pci.cost_infos.push_back(jv);
+
+    auto jp = std::make_shared<JointPosTermInfo>();
+    jp->coeffs = std::vector<double>(static_cast<std::size_t>(dof), 5.0);
+    jp->targets = std::vector<double>(end.data(), end.data() + end.size());
+    jp->first_step = n_steps - 1;
+    jp->last_step = n_steps - 1;
+    jp->name = "goal";
+    jp->term_type = trajopt::TermType::TT_CNT;
+    pci.cnt_infos.push_back(jp);
+
+    TrajOptProb::Ptr prob = ConstructProblem(pci);
+
+    // The collision costs are added directly so the time spent in them can be measured
+    auto margin_data = std::make_shared<SafetyMarginData>(0.025, 20);
+    for (int i = 1; i < n_steps; ++i)
+    {
+      auto cost = std::make_shared<CollisionCost>(pci.kin,
+                                                  env,
+                                                  margin_data,
+                                                  ContactTestType::ALL,
+                                                  prob->GetVarRow(i, 0, dof),
+                                                  CollisionExpressionEvaluatorType::SINGLE_TIME_STEP,
+                                                  0.05);
+      cost->setName("collision_" + std::to_string(i));
+      prob->addCost(std::make_shared<TimedCost>(cost, &collision_time));
+    }
+
+    sco::BasicTrustRegionSQP opt(prob);
+    opt.initialize(trajToDblVec(prob->GetInitTraj()));
+    state.ResumeTiming();
+
+    const std::size_t allocation_start = benchmark_allocation_count.load(std::memory_order_relaxed);
+    opt.optimize();
+    allocations += benchmark_allocation_count.load(std::memory_order_relaxed) - allocation_start;
+
+    convexify_time += opt.results().convexify_time;
+    qp_solve_time += opt.results().qp_solve_time;
+    evaluate_time += opt.results().evaluate_time;
+  }
+
+  state.counters["convexify_time"] = benchmark::Counter(convexify_time, benchmark::Counter::kAvgIterations);
+  state.counters["qp_solve_time"] = benchmark::Counter(qp_solve_time, benchmark::Counter::kAvgIterations);
+  state.counters["evaluate_time"] = benchmark::Counter(evaluate_time, benchmark::Counter::kAvgIterations);
+  state.counters["collision_time"] = benchmark::Counter(collision_time, benchmark::Counter::kAvgIterations);
+  state.counters["allocations"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief Benchmark building problems with collision terms with and without a shared collision world snapshot
+ * @details The range is [n_steps, use_snapshot]. Each iteration builds four problems with a discrete continuous
+ * collision cost and constraint, as four planner threads would, and keeps them alive until it ends. The snapshot is
+ * created once and shared by all the problems. The heap memory allocated to build the problems is reported per
+ * iteration.
+ */
+static void BM_TRAJOPT_COLLISION_CONSTRUCTION(benchmark::State& state)
+{
+  const auto n_steps = static_cast<int>(state.range(0));
+  const bool use_snapshot = (state.range(1) != 0);
+  const int dof = 7;
+  const int n_obstacles = 32;
+  const int n_problems = 4;
+
+  Environment::Ptr env = createScalingEnvironment(dof, n_obstacles);
+  if (env == nullptr)
+  {
+    state.SkipWithError("Failed to create the scaling environment");
+    return;
+  }
+
+  auto [start, end] = getScalingEndpoints(dof);
+  env->setState(env->getJointGroup("manipulator")->getJointNames(), start);
+  CollisionWorldSnapshot::ConstPtr snapshot = use_snapshot ? std::make_shared<CollisionWorldSnapshot>(*env) : nullptr;
+
+  double memory{ 0 };
+  for (auto _ : state)
+  {
+    std::vector<TrajOptProb::Ptr> probs;
+    probs.reserve(n_problems);
+    const std::size_t memory_start = benchmark_allocated_bytes.load(std::memory_order_relaxed);
+    for (int i = 0; i < n_problems; ++i)
+    {
+      ProblemConstructionInfo pci(env);
+      pci.basic_info.n_steps = n_steps;
+      pci.basic_info.manip = "manipulator";
+      pci.basic_info.use_time = false;
+      pci.kin = env->getJointGroup("manipulator");
+      pci.init_info.type = InitInfo::JOINT_INTERPOLATED;
+      pci.init_info.data = end;
+      pci.collision_snapshot = snapshot;
+
+      for (auto term_type : { trajopt::TermType::TT_COST, trajopt::TermType::TT_CNT })
+      {
+        auto collision = std::make_shared<CollisionTermInfo>();
+        collision->name = "collision";
+        collision->term_type = term_type;
+        collision->evaluator_type = trajopt::CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+        collision->first_step = 0;
+        collision->last_step = n_steps - 1;
+        collision->info = createSafetyMarginDataVector(n_steps, 0.025, 20);
+        if (term_type == trajopt::TermType::TT_COST)
+          pci.cost_infos.push_back(collision);
+        else
+          pci.cnt_infos.push_back(collision);
+      }
+
+      probs.push_back(ConstructProblem(pci));
+    }
+    memory += static_cast<double>(benchmark_allocated_bytes.load(std::memory_order_relaxed) - memory_start);
+
+    state.PauseTiming();
+    probs.clear();
+    state.ResumeTiming();
+  }
+
+  state.counters["memory"] = benchmark::Counter(memory, benchmark::Counter::kAvgIterations);
+}
+
+int main(int argc, char** argv)
+{
+  gLogLevel = trajopt_common::LevelError;
+
+  //////////////////////////////////////
+  // Scaling Solve
+  //////////////////////////////////////
+  {
+    std::string name = "BM_TRAJOPT_SCALING_SOLVE";
+    benchmark::internal::Benchmark* bm = benchmark::RegisterBenchmark(name.c_str(), BM_TRAJOPT_SCALING_SOLVE);
+    bm->ArgNames({ "n_steps", "dof", "n_obstacles" });
+
+    // Waypoints
+    for (int n_steps : { 10, 50, 100, 250, 500 })
+      bm->Args({ n_steps, 7, 8 });
+
+    // Joints
+    for (int dof : { 6, 14 })
+      bm->Args({ 50, dof, 8 });
+
+    // Obstacles
+    for (int n_obstacles : { 0, 32, 128 })
+      bm->Args({ 50, 7, n_obstacles });
+
+    bm->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond);
+  }
+
+  //////////////////////////////////////
+  // Collision Construction
+  //////////////////////////////////////
+  {
+    std::string name = "BM_TRAJOPT_COLLISION_CONSTRUCTION";
+    benchmark::internal::Benchmark* bm = benchmark::RegisterBenchmark(name.c_str(), BM_TRAJOPT_COLLISION_CONSTRUCTION);
+    bm->ArgNames({ "n_steps", "use_snapshot" });
+    for (int n_steps : { 10, 50, 100 })
+    {
+      bm->Args({ n_steps, 0 });
+      bm->Args({ n_steps, 1 });
+    }
+    bm->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+}
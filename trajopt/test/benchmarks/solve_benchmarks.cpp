@@ -57,6 +57,20 @@ static void BM_TRAJOPT_PLANNING_SOLVE(benchmark::State& state, Environment::Ptr
   }
 }
 
+/** @brief Benchmark trajopt planning solve warm started from a coarse solve */
+static void BM_TRAJOPT_MULTI_RESOLUTION_PLANNING_SOLVE(benchmark::State& state, Environment::Ptr env, Json::Value root)
+{
+  MultiResolutionInfo info;
+  info.strides = { 2 };
+  for (auto _ : state)
+  {
+    ProblemConstructionInfo pci(env);
+    pci.fromJson(root);
+    pci.basic_info.convex_solver = sco::ModelType::OSQP;
+    OptimizeProblemMultiResolution(pci, info);
+  }
+}
+
 /** @brief Benchmark trajopt simple collision solve */
 static void BM_TRAJOPT_MULTI_THREADED_SIMPLE_COLLISION_SOLVE(benchmark::State& state,
                                                              Environment::Ptr env,
@@ -160,6 +174,16 @@ int main(int argc, char** argv)
           ->MinTime(100);
     }
 
+    {
+      std::function<void(benchmark::State&, Environment::Ptr, Json::Value)> BM_SOLVE_FUNC =
+          BM_TRAJOPT_MULTI_RESOLUTION_PLANNING_SOLVE;
+      std::string name = "BM_TRAJOPT_MULTI_RESOLUTION_PLANNING_SOLVE";
+      benchmark::RegisterBenchmark(name.c_str(), BM_SOLVE_FUNC, env, root)
+          ->UseRealTime()
+          ->Unit(benchmark::TimeUnit::kMillisecond)
+          ->MinTime(100);
+    }
+
     {
       std::function<void(benchmark::State&, Environment::Ptr, Json::Value)> BM_SOLVE_FUNC =
           BM_TRAJOPT_MULTI_THREADED_PLANNING_SOLVE;
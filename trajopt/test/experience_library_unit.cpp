@@ -0,0 +1,247 @@
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unordered_map>
+#include <tesseract_common/resource_locator.h>
+#include <tesseract_geometry/impl/box.h>
+#include <tesseract_scene_graph/link.h>
+#include <tesseract_scene_graph/joint.h>
+#include <tesseract_environment/environment.h>
+#include <tesseract_environment/commands/add_link_command.h>
+#include <console_bridge/console.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/experience_library.hpp>
+
+using namespace trajopt;
+
+/** @brief Create a straight line trajectory between the start and goal */
+static TrajArray createLine(const Eigen::VectorXd& start, const Eigen::VectorXd& goal, int n_steps)
+{
+  TrajArray traj(n_steps, start.size());
+  for (int i = 0; i < n_steps; ++i)
+  {
+    const double s = static_cast<double>(i) / (n_steps - 1);
+    traj.row(i) = ((1.0 - s) * start + s * goal).transpose();
+  }
+  return traj;
+}
+
+/** @brief Create the boxbot environment with a fixed box of the given size and collision origin */
+static tesseract_environment::Environment::Ptr createEnvironment(double box_size,
+                                                                 const Eigen::Isometry3d& collision_origin)
+{
+  tesseract_common::fs::path urdf_file(std::string(TRAJOPT_DATA_DIR) + "/boxbot_world.urdf");
+  tesseract_common::fs::path srdf_file(std::string(TRAJOPT_DATA_DIR) + "/boxbot.srdf");
+
+  auto env = std::make_shared<tesseract_environment::Environment>();
+  auto locator = std::make_shared<tesseract_common::GeneralResourceLocator>();
+  EXPECT_TRUE(env->init(urdf_file, srdf_file, locator));
+
+  auto collision = std::make_shared<tesseract_scene_graph::Collision>();
+  collision->geometry = std::make_shared<tesseract_geometry::Box>(box_size, 1.0, 1.0);
+  collision->origin = collision_origin;
+
+  tesseract_scene_graph::Link link("box_world");
+  link.collision.push_back(collision);
+
+  tesseract_scene_graph::Joint joint("box_world-base_link");
+  joint.type = tesseract_scene_graph::JointType::FIXED;
+  joint.parent_link_name = "base_link";
+  joint.child_link_name = "box_world";
+  env->applyCommand(std::make_shared<tesseract_environment::AddLinkCommand>(link, joint));
+  return env;
+}
+
+TEST(ExperienceLibraryTest, adaptTrajectory)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, adaptTrajectory");
+
+  TrajArray traj = createLine(Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 2), 5);
+  TrajArray adapted = adaptTrajectory(traj, Eigen::Vector2d(0.1, 0), Eigen::Vector2d(1, 2.2), 9);
+  ASSERT_EQ(adapted.rows(), 9);
+  ASSERT_EQ(adapted.cols(), 2);
+  EXPECT_TRUE(adapted.row(0).isApprox(Eigen::RowVector2d(0.1, 0)));
+  EXPECT_TRUE(adapted.row(8).isApprox(Eigen::RowVector2d(1, 2.2)));
+  EXPECT_TRUE(adapted.row(4).isApprox(Eigen::RowVector2d(0.55, 1.1)));
+}
+
+TEST(ExperienceLibraryTest, retrieveNearest)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, retrieveNearest");
+
+  ExperienceLibrary library;
+  for (int i = 0; i < 50; ++i)
+  {
+    TrajArray traj = createLine(Eigen::Vector3d::Constant(i), Eigen::Vector3d::Constant(i + 1), 10);
+    traj(5, 0) = 100 + i;  // Tag the trajectory so it can be identified
+    library.add(traj, "env");
+  }
+  library.add(createLine(Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), 10), "env");
+  EXPECT_EQ(library.size(), 51);
+
+  TrajArray traj;
+  ASSERT_TRUE(library.retrieve(traj, Eigen::Vector3d::Constant(20.1), Eigen::Vector3d::Constant(21.1), "env", 10));
+  EXPECT_NEAR(traj(5, 0), 120.1, 1e-8);
+  EXPECT_TRUE(traj.row(0).isApprox(Eigen::RowVector3d::Constant(20.1)));
+  EXPECT_TRUE(traj.row(9).isApprox(Eigen::RowVector3d::Constant(21.1)));
+
+  // Different environment, joints or too far away
+  EXPECT_FALSE(library.retrieve(traj, Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones(), "other_env", 10));
+  EXPECT_FALSE(library.retrieve(traj, Eigen::Vector4d::Zero(), Eigen::Vector4d::Ones(), "env", 10));
+  EXPECT_FALSE(library.retrieve(traj, Eigen::Vector3d::Constant(0.5), Eigen::Vector3d::Constant(1.5), "env", 10, 0.1));
+}
+
+TEST(ExperienceLibraryTest, mergeAndEvict)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, mergeAndEvict");
+
+  ExperienceLibrary library(3);
+
+  // The same motion is merged, keeping the lowest cost
+  TrajArray traj = createLine(Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), 5);
+  library.add(traj, "env", 2);
+  traj(2, 0) = 10;
+  library.add(traj, "env", 1);
+  traj(2, 0) = 20;
+  library.add(traj, "env", 3);
+  EXPECT_EQ(library.size(), 1);
+
+  TrajArray result;
+  ASSERT_TRUE(library.retrieve(result, Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), "env", 5));
+  EXPECT_NEAR(result(2, 0), 10, 1e-8);
+
+  // The least recently used motion is evicted
+  library.add(createLine(Eigen::Vector2d::Constant(1), Eigen::Vector2d::Constant(2), 5), "env");
+  library.add(createLine(Eigen::Vector2d::Constant(2), Eigen::Vector2d::Constant(3), 5), "env");
+  EXPECT_TRUE(library.retrieve(result, Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), "env", 5, 1e-6));
+  library.add(createLine(Eigen::Vector2d::Constant(3), Eigen::Vector2d::Constant(4), 5), "env");
+  EXPECT_EQ(library.size(), 3);
+  EXPECT_TRUE(library.retrieve(result, Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), "env", 5, 1e-6));
+  EXPECT_FALSE(
+      library.retrieve(result, Eigen::Vector2d::Constant(1), Eigen::Vector2d::Constant(2), "env", 5, 1e-6));
+
+  library.setCapacity(1);
+  EXPECT_EQ(library.size(), 1);
+}
+
+TEST(ExperienceLibraryTest, evictAcrossEnvironments)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, evictAcrossEnvironments");
+
+  // Experiences are evicted in least recently used order whichever environment they belong to
+  auto getSignature = [](int i) { return std::string((i % 2 == 0) ? "a" : "b"); };
+  ExperienceLibrary library(4);
+  for (int i = 0; i < 4; ++i)
+    library.add(createLine(Eigen::Vector2d::Constant(i), Eigen::Vector2d::Constant(i + 1), 5), getSignature(i));
+
+  TrajArray result;
+  EXPECT_TRUE(library.retrieve(result, Eigen::Vector2d::Constant(0), Eigen::Vector2d::Constant(1), "a", 5, 1e-6));
+  library.add(createLine(Eigen::Vector2d::Constant(4), Eigen::Vector2d::Constant(5), 5), getSignature(4));
+  library.add(createLine(Eigen::Vector2d::Constant(5), Eigen::Vector2d::Constant(6), 5), getSignature(5));
+  EXPECT_EQ(library.size(), 4);
+  EXPECT_FALSE(library.retrieve(result, Eigen::Vector2d::Constant(1), Eigen::Vector2d::Constant(2), "b", 5, 1e-6));
+  EXPECT_FALSE(library.retrieve(result, Eigen::Vector2d::Constant(2), Eigen::Vector2d::Constant(3), "a", 5, 1e-6));
+
+  // The remaining experiences are still found after the evicted ones were replaced
+  for (int i : { 0, 3, 4, 5 })
+  {
+    ASSERT_TRUE(library.retrieve(
+        result, Eigen::Vector2d::Constant(i), Eigen::Vector2d::Constant(i + 1), getSignature(i), 5, 1e-6));
+    EXPECT_TRUE(result.isApprox(createLine(Eigen::Vector2d::Constant(i), Eigen::Vector2d::Constant(i + 1), 5)));
+  }
+}
+
+TEST(ExperienceLibraryTest, saveAndLoad)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, saveAndLoad");
+
+  ExperienceLibrary library;
+  library.add(createLine(Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones(), 4), "env_a", 1);
+  library.add(createLine(Eigen::Vector3d::Ones(), Eigen::Vector3d::Zero(), 6), "env_b", 2);
+
+  std::string file_path = testing::TempDir() + "trajopt_experience_library.json";
+  ASSERT_TRUE(library.save(file_path));
+
+  ExperienceLibrary loaded;
+  ASSERT_TRUE(loaded.load(file_path));
+  EXPECT_EQ(loaded.size(), 2);
+
+  TrajArray traj;
+  ASSERT_TRUE(loaded.retrieve(traj, Eigen::Vector3d::Ones(), Eigen::Vector3d::Zero(), "env_b", 6, 1e-6));
+  EXPECT_TRUE(traj.isApprox(createLine(Eigen::Vector3d::Ones(), Eigen::Vector3d::Zero(), 6)));
+  std::remove(file_path.c_str());
+
+  EXPECT_FALSE(loaded.load(file_path));
+}
+
+TEST(ExperienceLibraryTest, loadValidatesAndKeepsCapacity)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, loadValidatesAndKeepsCapacity");
+
+  ExperienceLibrary library(2);
+  library.add(createLine(Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), 4), "env");
+  library.add(createLine(Eigen::Vector2d::Ones(), Eigen::Vector2d::Zero(), 4), "env");
+
+  std::string file_path = testing::TempDir() + "trajopt_experience_library_capacity.json";
+  ASSERT_TRUE(library.save(file_path));
+
+  ExperienceLibrary loaded;
+  ASSERT_TRUE(loaded.load(file_path));
+  EXPECT_EQ(loaded.getCapacity(), 2);
+  EXPECT_EQ(loaded.size(), 2);
+
+  // The second experience is invalid, so the first one must not be added either
+  {
+    std::ofstream file(file_path);
+    file << R"({"capacity": 10, "experiences": [)"
+         << R"({"environment_signature": "env", "cost": 0, "rows": 2, "cols": 1, "traj": [0, 1]},)"
+         << R"({"environment_signature": "env", "cost": 0, "rows": 2, "cols": 1, "traj": [0, "one"]}]})";
+  }
+  ExperienceLibrary invalid(5);
+  EXPECT_FALSE(invalid.load(file_path));
+  EXPECT_EQ(invalid.size(), 0);
+  EXPECT_EQ(invalid.getCapacity(), 5);
+
+  {
+    std::ofstream file(file_path);
+    file << R"({"capacity": 10, "experiences": [{"environment_signature": "env", "rows": 2, "cols": 1}]})";
+  }
+  EXPECT_FALSE(invalid.load(file_path));
+  EXPECT_EQ(invalid.size(), 0);
+  EXPECT_EQ(invalid.getCapacity(), 5);
+  std::remove(file_path.c_str());
+}
+
+TEST(ExperienceLibraryTest, environmentSignature)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExperienceLibraryTest, environmentSignature");
+
+  const Eigen::Isometry3d origin = Eigen::Isometry3d::Identity();
+  auto env = createEnvironment(1, origin);
+  const std::string signature = getEnvironmentSignature(*env);
+  EXPECT_EQ(getEnvironmentSignature(*createEnvironment(1, origin)), signature);
+
+  // Moving the robot does not change the fixtures
+  std::unordered_map<std::string, double> joint_values;
+  joint_values["boxbot_x_joint"] = 1.0;
+  joint_values["boxbot_y_joint"] = -0.5;
+  env->setState(joint_values);
+  EXPECT_EQ(getEnvironmentSignature(*env), signature);
+
+  // The same links with different geometry dimensions or collision origins are different environments
+  EXPECT_NE(getEnvironmentSignature(*createEnvironment(2, origin)), signature);
+  EXPECT_NE(getEnvironmentSignature(*createEnvironment(1, origin * Eigen::Translation3d(0.5, 0, 0))), signature);
+
+  // Numerical noise below the rounding does not change it
+  EXPECT_EQ(getEnvironmentSignature(*createEnvironment(1 + 1e-9, origin)), signature);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -93,6 +93,50 @@ TEST_F(KinematicCostsTest, CartPoseJacCalculator)  // NOLINT
   checkJacobian(f, dfdx, values, 1.0e-5);
 }
 
+TEST_F(KinematicCostsTest, CartPoseJacCalculatorWithError)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("KinematicCostsTest, CartPoseJacCalculatorWithError");
+
+  tesseract_kinematics::JointGroup::Ptr kin = env_->getJointGroup("right_arm");
+
+  std::string source_frame = env_->getRootLinkName();
+  std::string target_frame = "r_gripper_tool_frame";
+  Eigen::Isometry3d source_frame_offset = env_->getState().link_transforms.at(target_frame);
+  Eigen::Isometry3d target_frame_offset =
+      Eigen::Isometry3d::Identity() * Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitZ());
+  Eigen::VectorXi indices(4);
+  indices << 0, 1, 2, 5;
+  Eigen::VectorXd lower_tolerance = Eigen::VectorXd::Constant(6, -0.01);
+  Eigen::VectorXd upper_tolerance = Eigen::VectorXd::Constant(6, 0.01);
+
+  Eigen::VectorXd values(7);
+  values << -1.1, 1.2, -3.3, -1.4, 5.5, -1.6, 7.7;
+
+  CartPoseErrCalculator f(kin,
+                          source_frame,
+                          target_frame,
+                          source_frame_offset,
+                          target_frame_offset,
+                          indices,
+                          lower_tolerance,
+                          upper_tolerance);
+  CartPoseJacCalculator dfdx(kin,
+                             source_frame,
+                             target_frame,
+                             source_frame_offset,
+                             target_frame_offset,
+                             indices,
+                             lower_tolerance,
+                             upper_tolerance);
+
+  // The combined evaluation must match the separate error and jacobian calculations
+  Eigen::VectorXd err;
+  Eigen::MatrixXd jac;
+  dfdx(values, err, jac);
+  EXPECT_TRUE(err.isApprox(f(values), 1e-8));
+  EXPECT_TRUE(jac.isApprox(dfdx(values), 1e-8));
+}
+
 // This has known issues and is not being used. Disabled due to segfaults in CI
 // TEST_F(KinematicCostsTest, DynamicCartPoseJacCalculator)  // NOLINT
 //{
@@ -159,6 +159,79 @@ TEST_F(PlanningTest, arm_around_table_multi_threaded)  // NOLINT
   runTest(env_, true);
 }
 
+TEST_F(PlanningTest, arm_around_table_multi_resolution)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("PlanningTest, arm_around_table_multi_resolution");
+
+  Json::Value root = readJsonFile(std::string(TRAJOPT_DATA_DIR) + "/config/arm_around_table.json");
+
+  std::unordered_map<std::string, double> ipos;
+  ipos["torso_lift_joint"] = 0;
+  ipos["r_shoulder_pan_joint"] = -1.832;
+  ipos["r_shoulder_lift_joint"] = -0.332;
+  ipos["r_upper_arm_roll_joint"] = -1.011;
+  ipos["r_elbow_flex_joint"] = -1.437;
+  ipos["r_forearm_roll_joint"] = -1.1;
+  ipos["r_wrist_flex_joint"] = -1.926;
+  ipos["r_wrist_roll_joint"] = 3.074;
+  env_->setState(ipos);
+
+  ProblemConstructionInfo pci(env_);
+  pci.fromJson(root);
+  pci.basic_info.convex_solver = sco::ModelType::OSQP;
+
+  MultiResolutionInfo info;
+  info.strides = { 2 };
+  TrajOptResult::Ptr result = OptimizeProblemMultiResolution(pci, info);
+  EXPECT_TRUE(result->status == sco::OptStatus::OPT_CONVERGED);
+  EXPECT_EQ(result->traj.rows(), 6);
+
+  // The term infos of pci are not hatched, hatching would apply the single joint velocity coeff to all joints
+  EXPECT_EQ(std::dynamic_pointer_cast<JointVelTermInfo>(pci.cost_infos.front())->coeffs.size(), 1);
+
+  // The coarse level keeps the stride steps, the fixed steps and the joint position target
+  std::vector<int> steps = getMultiResolutionSteps(pci, 2);
+  EXPECT_EQ(steps, std::vector<int>({ 0, 2, 4, 5 }));
+
+  // The coarse steps are not evenly spaced, so a joint velocity term is split where the gap changes
+  auto vel = std::make_shared<JointVelTermInfo>();
+  vel->term_type = TermType::TT_COST;
+  vel->first_step = 0;
+  vel->last_step = 5;
+  vel->targets = DblVec(7, 0.1);
+  ProblemConstructionInfo vel_pci(env_);
+  vel_pci.basic_info = pci.basic_info;
+  vel_pci.kin = pci.kin;
+  vel_pci.cost_infos.push_back(vel);
+
+  std::shared_ptr<ProblemConstructionInfo> coarse_pci = createMultiResolutionInfo(vel_pci, steps, result->traj);
+  ASSERT_NE(coarse_pci, nullptr);
+  ASSERT_EQ(coarse_pci->cost_infos.size(), 2);
+  auto coarse_vel0 = std::dynamic_pointer_cast<JointVelTermInfo>(coarse_pci->cost_infos[0]);
+  auto coarse_vel1 = std::dynamic_pointer_cast<JointVelTermInfo>(coarse_pci->cost_infos[1]);
+  EXPECT_EQ(coarse_vel0->first_step, 0);
+  EXPECT_EQ(coarse_vel0->last_step, 2);
+  EXPECT_NEAR(coarse_vel0->targets[0], 0.2, 1e-8);
+  EXPECT_EQ(coarse_vel1->first_step, 2);
+  EXPECT_EQ(coarse_vel1->last_step, 3);
+  EXPECT_NEAR(coarse_vel1->targets[0], 0.1, 1e-8);
+  EXPECT_NEAR(vel->targets[0], 0.1, 1e-8);
+
+  std::vector<ContactResultMap> collisions;
+  tesseract_scene_graph::StateSolver::UPtr state_solver = env_->getStateSolver();
+  ContinuousContactManager::Ptr manager = env_->getContinuousContactManager();
+
+  manager->setActiveCollisionObjects(pci.kin->getActiveLinkNames());
+  manager->setDefaultCollisionMarginData(0);
+
+  tesseract_collision::CollisionCheckConfig config;
+  config.type = tesseract_collision::CollisionEvaluatorType::CONTINUOUS;
+  config.longest_valid_segment_length = LONGEST_VALID_SEGMENT_LENGTH;
+  bool found = checkTrajectory(collisions, *manager, *state_solver, pci.kin->getJointNames(), result->traj, config);
+
+  EXPECT_FALSE(found);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -1,6 +1,8 @@
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
 #include <ctime>
+#include <thread>
 #include <gtest/gtest.h>
 #include <tesseract_common/timer.h>
 #include <tesseract_common/resource_locator.h>
@@ -14,6 +16,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/collision_terms.hpp>
+#include <trajopt/collision_world_snapshot.hpp>
 #include <trajopt/plot_callback.hpp>
 #include <trajopt/utils.hpp>
 #include <trajopt/problem_description.hpp>
@@ -134,6 +137,278 @@ TEST_F(SimpleCollisionTest, spheres_multi_threaded)  // NOLINT
   runTest(env_, plotter_, true);
 }
 
+TEST_F(SimpleCollisionTest, shared_contact_query)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SimpleCollisionTest, shared_contact_query");
+
+  Json::Value root = readJsonFile(std::string(TRAJOPT_DATA_DIR) + "/config/simple_collision_test.json");
+
+  std::unordered_map<std::string, double> ipos;
+  ipos["spherebot_x_joint"] = -0.75;
+  ipos["spherebot_y_joint"] = 0.75;
+  env_->setState(ipos);
+
+  TrajOptProb::Ptr prob = ConstructProblem(root, env_);
+  ASSERT_TRUE(!!prob);
+
+  // A cost with a large buffer and a constraint with a tight margin on the same state
+  auto create_evaluator = [&prob](double dist_pen, double coeff, double buffer) {
+    return std::make_shared<SingleTimestepCollisionEvaluator>(prob->GetKin(),
+                                                              prob->GetEnv(),
+                                                              std::make_shared<SafetyMarginData>(dist_pen, coeff),
+                                                              ContactTestType::ALL,
+                                                              prob->GetVarRow(0, 0, 2),
+                                                              CollisionExpressionEvaluatorType::SINGLE_TIME_STEP,
+                                                              buffer);
+  };
+  auto cost = create_evaluator(0.3, 1, 0.05);
+  auto cnt = create_evaluator(0.02, 20, 0);
+  auto shared_cost = create_evaluator(0.3, 1, 0.05);
+  auto shared_cnt = create_evaluator(0.02, 20, 0);
+
+  auto shared_query = std::make_shared<SharedContactQuery>();
+  shared_cnt->setSharedContactQuery(shared_query);
+  shared_cost->setSharedContactQuery(shared_query);
+  EXPECT_EQ(shared_query->num_evaluators, 2);
+  EXPECT_NEAR(shared_query->margin, 0.35, 1e-8);
+
+  // The constraint checks the state at the cost contact distance and the cost reuses the unfiltered results
+  DblVec x = trajToDblVec(prob->GetInitTraj());
+  DblVec cost_dists, cnt_dists, shared_cost_dists, shared_cnt_dists;
+  shared_cnt->CalcDists(x, shared_cnt_dists);
+  shared_cost->CalcDists(x, shared_cost_dists);
+  cost->CalcDists(x, cost_dists);
+  cnt->CalcDists(x, cnt_dists);
+
+  EXPECT_FALSE(cost_dists.empty());
+  ASSERT_EQ(shared_cost_dists.size(), cost_dists.size());
+  for (std::size_t i = 0; i < cost_dists.size(); ++i)
+    EXPECT_NEAR(shared_cost_dists[i], cost_dists[i], 1e-8);
+
+  ASSERT_EQ(shared_cnt_dists.size(), cnt_dists.size());
+  for (std::size_t i = 0; i < cnt_dists.size(); ++i)
+    EXPECT_NEAR(shared_cnt_dists[i], cnt_dists[i], 1e-8);
+}
+
+TEST_F(SimpleCollisionTest, shared_contact_query_fixed_step)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SimpleCollisionTest, shared_contact_query_fixed_step");
+
+  // A collision cost and constraint on a segment starting at a fixed step
+  auto create_problem = [this](ContactTestType contact_test_type, bool add_constraint) {
+    ProblemConstructionInfo pci(env_);
+    pci.basic_info.n_steps = 2;
+    pci.basic_info.manip = "manipulator";
+    pci.basic_info.use_time = false;
+    pci.basic_info.fixed_timesteps = { 0 };
+    pci.kin = env_->getJointGroup("manipulator");
+    pci.init_info.type = InitInfo::GIVEN_TRAJ;
+    pci.init_info.data = TrajArray::Zero(2, 2);
+
+    for (auto term_type : { TermType::TT_COST, TermType::TT_CNT })
+    {
+      auto collision = std::make_shared<CollisionTermInfo>();
+      collision->name = "collision";
+      collision->term_type = term_type;
+      collision->evaluator_type = trajopt::CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+      collision->first_step = 0;
+      collision->last_step = 1;
+      collision->fixed_steps = { 0 };
+      collision->longest_valid_segment_length = 0.05;
+      collision->contact_test_type = contact_test_type;
+      if (term_type == TermType::TT_COST)
+      {
+        collision->info = createSafetyMarginDataVector(2, 0.3, 1);
+        pci.cost_infos.push_back(collision);
+      }
+      else if (add_constraint)
+      {
+        collision->info = createSafetyMarginDataVector(2, 0.02, 20);
+        collision->safety_margin_buffer = 0;
+        pci.cnt_infos.push_back(collision);
+      }
+    }
+
+    return ConstructProblem(pci);
+  };
+
+  TrajOptProb::Ptr prob = create_problem(ContactTestType::ALL, true);
+  ASSERT_EQ(prob->getCosts().size(), 1);
+  ASSERT_EQ(prob->getIneqConstraints().size(), 1);
+  CollisionEvaluator::Ptr cost = std::dynamic_pointer_cast<CollisionCost>(prob->getCosts().front())->getEvaluator();
+  CollisionEvaluator::Ptr cnt =
+      std::dynamic_pointer_cast<CollisionConstraint>(prob->getIneqConstraints().front())->getEvaluator();
+  ASSERT_NE(cost->getSharedContactQuery(), nullptr);
+  EXPECT_EQ(cost->getSharedContactQuery(), cnt->getSharedContactQuery());
+  EXPECT_EQ(cost->getSharedContactQuery()->num_evaluators, 2);
+  EXPECT_NEAR(cost->getSharedContactQuery()->margin, 0.35, 1e-8);
+
+  // The same cost alone on its states does not use the shared query
+  TrajOptProb::Ptr single_prob = create_problem(ContactTestType::ALL, false);
+  CollisionEvaluator::Ptr single_cost =
+      std::dynamic_pointer_cast<CollisionCost>(single_prob->getCosts().front())->getEvaluator();
+  EXPECT_EQ(single_cost->getSharedContactQuery()->num_evaluators, 1);
+
+  // Queries which stop early are not shared
+  TrajOptProb::Ptr first_prob = create_problem(ContactTestType::FIRST, true);
+  CollisionEvaluator::Ptr first_cost =
+      std::dynamic_pointer_cast<CollisionCost>(first_prob->getCosts().front())->getEvaluator();
+  EXPECT_EQ(first_cost->getSharedContactQuery(), nullptr);
+
+  // The fixed start state is in contact with the sphere at the origin, once deeper and once less deep than the states
+  // after it. The contacts at the fixed state are removed but the ones after it must be kept in both cases.
+  const std::vector<std::pair<DblVec, double>> cases{ { { 0, -0.4, 0, -1.3 }, -0.55 }, { { 0, -0.9, 0, -0.2 }, -0.8 } };
+  for (const auto& [traj, expected_dist] : cases)
+  {
+
+    DblVec cost_dists, cnt_dists, single_cost_dists;
+    cnt->CalcDists(traj, cnt_dists);
+    cost->CalcDists(traj, cost_dists);
+    single_cost->CalcDists(traj, single_cost_dists);
+
+    ASSERT_FALSE(cnt_dists.empty());
+    EXPECT_NEAR(*std::min_element(cnt_dists.begin(), cnt_dists.end()), expected_dist, 1e-2);
+    ASSERT_FALSE(cost_dists.empty());
+    EXPECT_NEAR(*std::min_element(cost_dists.begin(), cost_dists.end()), expected_dist, 1e-2);
+
+    ASSERT_EQ(cost_dists.size(), single_cost_dists.size());
+    for (std::size_t i = 0; i < cost_dists.size(); ++i)
+      EXPECT_NEAR(cost_dists[i], single_cost_dists[i], 1e-8);
+  }
+}
+
+TEST_F(SimpleCollisionTest, contact_records)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SimpleCollisionTest, contact_records");
+
+  Json::Value root = readJsonFile(std::string(TRAJOPT_DATA_DIR) + "/config/simple_collision_test.json");
+
+  std::unordered_map<std::string, double> ipos;
+  ipos["spherebot_x_joint"] = -0.75;
+  ipos["spherebot_y_joint"] = 0.75;
+  env_->setState(ipos);
+
+  TrajOptProb::Ptr prob = ConstructProblem(root, env_);
+  ASSERT_TRUE(!!prob);
+
+  auto evaluator =
+      std::make_shared<SingleTimestepCollisionEvaluator>(prob->GetKin(),
+                                                         prob->GetEnv(),
+                                                         std::make_shared<SafetyMarginData>(0.3, 1),
+                                                         ContactTestType::ALL,
+                                                         prob->GetVarRow(0, 0, 2),
+                                                         CollisionExpressionEvaluatorType::SINGLE_TIME_STEP,
+                                                         0.05);
+
+  // The interned records hold the same contacts, in the same order, as the flattened contact results
+  for (const DblVec& x : { DblVec{ -0.75, 0.75 }, DblVec{ -0.2, 0.1 }, DblVec{ 0, 0 } })
+  {
+    ContactRecordsConstPtr records = evaluator->GetContactRecordsCached(x);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    ContactResultVectorConstPtr results = evaluator->GetContactResultVectorCached(x);
+#pragma GCC diagnostic pop
+
+    ASSERT_FALSE(results->empty());
+    ASSERT_EQ(records->records.size(), results->size());
+    for (std::size_t i = 0; i < records->records.size(); ++i)
+    {
+      const ContactRecord& record = records->records[i];
+      const ContactResult& result = (*results)[i];
+      EXPECT_NEAR(record.distance, result.distance, 1e-8);
+      EXPECT_EQ(evaluator->getLinkName(record.link_ids[0]), result.link_names[0]);
+      EXPECT_EQ(evaluator->getLinkName(record.link_ids[1]), result.link_names[1]);
+      EXPECT_TRUE(record.normal.isApprox(result.normal, 1e-8));
+      ASSERT_LT(record.pair_index, records->pairs.size());
+      EXPECT_GE(i, records->pairs[record.pair_index].begin);
+      EXPECT_LT(i, records->pairs[record.pair_index].end);
+    }
+
+    DblVec dists;
+    evaluator->CalcDists(x, dists);
+    ASSERT_EQ(dists.size(), results->size());
+    for (std::size_t i = 0; i < dists.size(); ++i)
+      EXPECT_NEAR(dists[i], (*results)[i].get().distance, 1e-8);
+  }
+}
+
+TEST_F(SimpleCollisionTest, collision_world_snapshot)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SimpleCollisionTest, collision_world_snapshot");
+
+  Json::Value root = readJsonFile(std::string(TRAJOPT_DATA_DIR) + "/config/simple_collision_test.json");
+
+  std::unordered_map<std::string, double> ipos;
+  ipos["spherebot_x_joint"] = -0.75;
+  ipos["spherebot_y_joint"] = 0.75;
+  env_->setState(ipos);
+
+  TrajOptProb::Ptr prob = ConstructProblem(root, env_);
+  ASSERT_TRUE(!!prob);
+
+  auto snapshot = std::make_shared<CollisionWorldSnapshot>(*env_);
+  auto create_evaluator = [&prob](double dist_pen, const CollisionWorldSnapshot::ConstPtr& snapshot) {
+    return std::make_shared<SingleTimestepCollisionEvaluator>(prob->GetKin(),
+                                                              prob->GetEnv(),
+                                                              std::make_shared<SafetyMarginData>(dist_pen, 1),
+                                                              ContactTestType::ALL,
+                                                              prob->GetVarRow(0, 0, 2),
+                                                              CollisionExpressionEvaluatorType::SINGLE_TIME_STEP,
+                                                              0.05,
+                                                              false,
+                                                              snapshot);
+  };
+  auto evaluator = create_evaluator(0.3, nullptr);
+  auto tight_evaluator = create_evaluator(0.02, nullptr);
+  auto snapshot_evaluator = create_evaluator(0.3, snapshot);
+  auto tight_snapshot_evaluator = create_evaluator(0.02, snapshot);
+  EXPECT_EQ(snapshot->getNumContactManagers(), 0);
+
+  DblVec x = trajToDblVec(prob->GetInitTraj());
+  DblVec dists, tight_dists, snapshot_dists, tight_snapshot_dists;
+  evaluator->CalcDists(x, dists);
+  tight_evaluator->CalcDists(x, tight_dists);
+
+  // The evaluators querying one after another reuse a contact manager with the contact distance of each query
+  snapshot_evaluator->CalcDists(x, snapshot_dists);
+  tight_snapshot_evaluator->CalcDists(x, tight_snapshot_dists);
+  EXPECT_EQ(snapshot->getNumContactManagers(), 1);
+
+  EXPECT_FALSE(dists.empty());
+  ASSERT_EQ(snapshot_dists.size(), dists.size());
+  for (std::size_t i = 0; i < dists.size(); ++i)
+    EXPECT_NEAR(snapshot_dists[i], dists[i], 1e-8);
+
+  ASSERT_EQ(tight_snapshot_dists.size(), tight_dists.size());
+  for (std::size_t i = 0; i < tight_dists.size(); ++i)
+    EXPECT_NEAR(tight_snapshot_dists[i], tight_dists[i], 1e-8);
+
+  // A query from another thread reuses the idle contact manager
+  DblVec thread_dists;
+  std::thread thread([&]() { create_evaluator(0.3, snapshot)->CalcDists(x, thread_dists); });
+  thread.join();
+  EXPECT_EQ(snapshot->getNumContactManagers(), 1);
+  ASSERT_EQ(thread_dists.size(), dists.size());
+  for (std::size_t i = 0; i < dists.size(); ++i)
+    EXPECT_NEAR(thread_dists[i], dists[i], 1e-8);
+
+  // A query while the contact manager is checked out gets a new one, which is returned once the query is done
+  {
+    DiscreteContactManagerHandle checked_out =
+        snapshot->getDiscreteContactManager(prob->GetKin()->getActiveLinkNames(), 0.3);
+    std::thread concurrent_thread([&]() { create_evaluator(0.3, snapshot)->CalcDists(x, thread_dists); });
+    concurrent_thread.join();
+    EXPECT_EQ(snapshot->getNumContactManagers(), 2);
+  }
+  ASSERT_EQ(thread_dists.size(), dists.size());
+  for (std::size_t i = 0; i < dists.size(); ++i)
+    EXPECT_NEAR(thread_dists[i], dists[i], 1e-8);
+
+  snapshot_evaluator->CalcDists(x, snapshot_dists);
+  tight_snapshot_evaluator->CalcDists(x, tight_snapshot_dists);
+  EXPECT_EQ(snapshot->getNumContactManagers(), 2);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,108 @@
+#ifndef TRAJOPT_COMMON_BENCHMARK_UTILS_H
+#define TRAJOPT_COMMON_BENCHMARK_UTILS_H
+
+/**
+ * @file benchmark_utils.h
+ * @brief Heap allocation counting and timing helpers shared by the benchmarks
+ * @details This header defines the C allocation functions of the process, so it must be included in exactly one
+ * translation unit of a benchmark executable and never in a library. Allocations are counted at the malloc level so
+ * operator new, Eigen's aligned allocations and the C allocations of the dependencies are all counted. Counting is only
+ * available with glibc, elsewhere the counters stay zero.
+ */
+
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt_common
+{
+/** @brief The number of heap allocations made by the process */
+inline std::atomic<std::size_t> benchmark_allocation_count{ 0 };  // NOLINT
+
+/** @brief The number of bytes requested by the heap allocations made by the process */
+inline std::atomic<std::size_t> benchmark_allocated_bytes{ 0 };  // NOLINT
+
+/** @brief Record a heap allocation of size bytes */
+inline void countAllocation(std::size_t size)
+{
+  benchmark_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  benchmark_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+/** @brief Adds the lifetime of the timer in seconds to the provided total */
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(double& total) : total_(total), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() { total_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count(); }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+  ScopedTimer(ScopedTimer&&) = delete;
+  ScopedTimer& operator=(ScopedTimer&&) = delete;
+
+private:
+  double& total_;  // NOLINT
+  std::chrono::steady_clock::time_point start_;
+};
+}  // namespace trajopt_common
+
+#if defined(__GLIBC__)
+// The allocation functions forward to the glibc implementation, free and malloc_usable_size are left untouched
+extern "C" {
+void* __libc_malloc(std::size_t size) noexcept;                           // NOLINT
+void* __libc_calloc(std::size_t n, std::size_t size) noexcept;            // NOLINT
+void* __libc_realloc(void* ptr, std::size_t size) noexcept;               // NOLINT
+void* __libc_memalign(std::size_t alignment, std::size_t size) noexcept;  // NOLINT
+
+void* malloc(std::size_t size) noexcept  // NOLINT
+{
+  trajopt_common::countAllocation(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) noexcept  // NOLINT
+{
+  trajopt_common::countAllocation(n * size);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept  // NOLINT
+{
+  trajopt_common::countAllocation(size);
+  return __libc_realloc(ptr, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept  // NOLINT
+{
+  trajopt_common::countAllocation(size);
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept  // NOLINT
+{
+  trajopt_common::countAllocation(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, std::size_t alignment, std::size_t size) noexcept  // NOLINT
+{
+  if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+
+  trajopt_common::countAllocation(size);
+  void* out = __libc_memalign(alignment, size);
+  if (out == nullptr)
+    return ENOMEM;
+
+  *ptr = out;
+  return 0;
+}
+}
+#endif
+
+#endif  // TRAJOPT_COMMON_BENCHMARK_UTILS_H
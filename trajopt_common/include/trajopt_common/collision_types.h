@@ -89,6 +89,44 @@ private:
   std::set<tesseract_common::LinkNamesPair> zero_coeff_;
 };
 
+/**
+ * @brief Continuation state used to scale the collision margins and coefficients during a solve
+ * @details The same object may be shared by the configs of several collision terms. The solver ramps the scale from
+ * the initial scale up to one while the trust region shrinks, so early iterations push out of deep penetrations with a
+ * reduced margin and weight, and the target margin and coefficients are always restored before constraint
+ * satisfaction is checked.
+ */
+struct CollisionContinuation
+{
+  using Ptr = std::shared_ptr<CollisionContinuation>;
+  using ConstPtr = std::shared_ptr<const CollisionContinuation>;
+
+  /**
+   * @param initial_scale The scale at the start of a solve, values above one are clamped to one
+   * @throws std::runtime_error if initial_scale is not positive, a zero scale would disable collision entirely
+   */
+  CollisionContinuation(double initial_scale = 0.5);
+
+  /** @brief The scale applied to the margins and coefficients at the start of a solve, in (0, 1] */
+  double initial_scale;
+
+  /** @brief The scale currently applied to the margins and coefficients */
+  double scale;
+
+  /** @brief Reset the scale to the initial scale */
+  void reset();
+
+  /**
+   * @brief Ramp the scale toward one, the scale never decreases
+   * @param progress The completed fraction of the schedule, clamped to [0, 1]
+   * @return True if the scale changed
+   */
+  bool update(double progress);
+
+  /** @brief Check if the target margins and coefficients are applied */
+  bool isComplete() const;
+};
+
 /**
  * @brief Config settings for collision terms.
  */
@@ -113,6 +151,12 @@ struct TrajOptCollisionConfig : public tesseract_collision::CollisionCheckConfig
    * It still finds all contacts but sorts based on the worst uses those up to the max_num_cnt.
    */
   int max_num_cnt{ 3 };
+
+  /** @brief Optional continuation schedule applied to the collision margins and coefficients */
+  std::shared_ptr<CollisionContinuation> continuation;
+
+  /** @brief Get the scale applied to the collision margins and coefficients, one if there is no continuation */
+  double getContinuationScale() const;
 };
 
 /** @brief A data structure to contain a links gradient results */
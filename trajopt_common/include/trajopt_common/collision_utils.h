@@ -28,6 +28,9 @@
 TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <Eigen/Eigen>
 #include <array>
+#include <set>
+#include <string>
+#include <vector>
 #include <tesseract_collision/core/types.h>
 #include <tesseract_kinematics/core/fwd.h>
 TRAJOPT_IGNORE_WARNINGS_POP
@@ -36,6 +39,7 @@ namespace trajopt_common
 {
 struct TrajOptCollisionConfig;
 struct GradientResults;
+struct GradientResultsSet;
 
 std::size_t getHash(const TrajOptCollisionConfig& collision_config, const Eigen::Ref<const Eigen::VectorXd>& dof_vals);
 std::size_t getHash(const TrajOptCollisionConfig& collision_config,
@@ -84,6 +88,99 @@ GradientResults getGradient(const Eigen::VectorXd& dofvals0,
                             double margin_buffer,
                             const tesseract_kinematics::JointGroup& manip);
 
+/**
+ * @brief Copy the transforms of the provided links into a preallocated array ordered like link_names
+ * @details The result is meant for the vector overloads of the contact managers setCollisionObjectsTransform
+ * @param link_transforms The link transforms, resized to the number of link names
+ * @param link_names The names of the links to extract
+ * @param state The transforms of the links
+ */
+void getLinkTransforms(tesseract_common::VectorIsometry3d& link_transforms,
+                       const std::vector<std::string>& link_names,
+                       const tesseract_common::TransformMap& state);
+
+/**
+ * @brief Get the link pairs of the provided gradient results sets
+ * @param gradient_results_sets The gradient results sets
+ * @return The set of link pairs
+ */
+std::set<std::pair<std::string, std::string>>
+getLinkPairs(const std::vector<GradientResultsSet>& gradient_results_sets);
+
+/**
+ * @brief Get the names of all links that take part in the provided link pairs
+ * @param link_pairs The link pairs
+ * @return The set of link names
+ */
+std::set<std::string> getLinkNames(const std::set<std::pair<std::string, std::string>>& link_pairs);
+
+/**
+ * @brief Disable every enabled collision object in the contact manager that is not in link_names
+ * @details This is used to restrict a contact test to a known set of link pairs since the contact managers do not
+ * provide a direct pair distance query. Use enableCollisionObjects to restore the previous state, or prefer
+ * DisabledCollisionObjectsGuard which also restores it if the contact test throws.
+ * @param manager The discrete or continuous contact manager
+ * @param link_names The links to leave enabled
+ * @return The names of the collision objects that were disabled
+ */
+template <typename ContactManager>
+std::vector<std::string> disableCollisionObjectsNotIn(ContactManager& manager, const std::set<std::string>& link_names)
+{
+  std::vector<std::string> disabled;
+  for (const auto& name : manager.getCollisionObjects())
+  {
+    if (link_names.find(name) == link_names.end() && manager.isCollisionObjectEnabled(name))
+    {
+      manager.disableCollisionObject(name);
+      disabled.push_back(name);
+    }
+  }
+  return disabled;
+}
+
+/**
+ * @brief Enable the provided collision objects in the contact manager
+ * @param manager The discrete or continuous contact manager
+ * @param link_names The collision objects to enable
+ */
+template <typename ContactManager>
+void enableCollisionObjects(ContactManager& manager, const std::vector<std::string>& link_names)
+{
+  for (const auto& name : link_names)
+    manager.enableCollisionObject(name);
+}
+
+/**
+ * @brief Disables every collision object not in link_names for the lifetime of the guard
+ * @details The disabled collision objects are enabled again on destruction, so the contact manager is restored even if
+ * the contact test throws.
+ */
+template <typename ContactManager>
+class DisabledCollisionObjectsGuard
+{
+public:
+  /**
+   * @param manager The discrete or continuous contact manager, it must outlive the guard
+   * @param link_names The links to leave enabled
+   */
+  DisabledCollisionObjectsGuard(ContactManager& manager, const std::set<std::string>& link_names)
+    : manager_(manager), disabled_(disableCollisionObjectsNotIn(manager, link_names))
+  {
+  }
+  ~DisabledCollisionObjectsGuard() { enableCollisionObjects(manager_, disabled_); }
+  DisabledCollisionObjectsGuard(const DisabledCollisionObjectsGuard&) = delete;
+  DisabledCollisionObjectsGuard& operator=(const DisabledCollisionObjectsGuard&) = delete;
+  DisabledCollisionObjectsGuard(DisabledCollisionObjectsGuard&&) = delete;
+  DisabledCollisionObjectsGuard& operator=(DisabledCollisionObjectsGuard&&) = delete;
+
+  /** @brief The names of the collision objects that were disabled */
+  const std::vector<std::string>& getDisabled() const { return disabled_; }
+
+private:
+  ContactManager& manager_;
+  std::vector<std::string> disabled_;
+};
+
 /**
  * @brief Print debug gradient information
  * @param res Contact Results
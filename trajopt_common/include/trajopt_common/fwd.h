@@ -5,6 +5,7 @@ namespace trajopt_common
 {
 struct SafetyMarginData;
 struct CollisionCoeffData;
+struct CollisionContinuation;
 struct TrajOptCollisionConfig;
 struct LinkGradientResults;  // NOLINT
 struct GradientResults;      // NOLINT
@@ -22,6 +22,11 @@
  * limitations under the License.
  */
 
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+TRAJOPT_IGNORE_WARNINGS_POP
+
 #include <trajopt_common/collision_types.h>
 
 namespace trajopt_common
@@ -58,11 +63,35 @@ const std::set<tesseract_common::LinkNamesPair>& CollisionCoeffData::getPairsWit
   return zero_coeff_;
 }
 
+CollisionContinuation::CollisionContinuation(double initial_scale)
+  : initial_scale(std::min(initial_scale, 1.0)), scale(this->initial_scale)
+{
+  if (!(initial_scale > 0))
+    throw std::runtime_error("CollisionContinuation, the initial scale must be positive");
+}
+
+void CollisionContinuation::reset() { scale = initial_scale; }
+
+bool CollisionContinuation::update(double progress)
+{
+  progress = std::clamp(progress, 0.0, 1.0);
+  const double new_scale = (progress >= 1) ? 1.0 : initial_scale + ((1.0 - initial_scale) * progress);
+  if (new_scale <= scale)
+    return false;
+
+  scale = new_scale;
+  return true;
+}
+
+bool CollisionContinuation::isComplete() const { return scale >= 1; }
+
 TrajOptCollisionConfig::TrajOptCollisionConfig(double margin, double coeff)
   : CollisionCheckConfig(margin), collision_coeff_data(coeff)
 {
 }
 
+double TrajOptCollisionConfig::getContinuationScale() const { return (continuation) ? continuation->scale : 1.0; }
+
 double LinkMaxError::getMaxError() const
 {
   if (has_error[0] && has_error[1])
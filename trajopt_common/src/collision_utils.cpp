@@ -39,6 +39,7 @@ std::size_t getHash(const TrajOptCollisionConfig& collision_config, const Eigen:
 {
   std::size_t seed = 0;
   boost::hash_combine(seed, &collision_config);
+  boost::hash_combine(seed, collision_config.getContinuationScale());
   for (Eigen::Index i = 0; i < dof_vals.rows(); ++i)
     boost::hash_combine(seed, dof_vals[i]);
 
@@ -51,6 +52,7 @@ std::size_t getHash(const TrajOptCollisionConfig& collision_config,
 {
   std::size_t seed = 0;
   boost::hash_combine(seed, &collision_config);
+  boost::hash_combine(seed, collision_config.getContinuationScale());
   for (Eigen::Index i = 0; i < dof_vals0.rows(); ++i)
   {
     boost::hash_combine(seed, dof_vals0[i]);
@@ -217,6 +219,36 @@ GradientResults getGradient(const Eigen::VectorXd& dofvals0,
   return results;
 }
 
+void getLinkTransforms(tesseract_common::VectorIsometry3d& link_transforms,
+                       const std::vector<std::string>& link_names,
+                       const tesseract_common::TransformMap& state)
+{
+  link_transforms.resize(link_names.size());
+  for (std::size_t i = 0; i < link_names.size(); ++i)
+    link_transforms[i] = state.at(link_names[i]);
+}
+
+std::set<std::pair<std::string, std::string>>
+getLinkPairs(const std::vector<GradientResultsSet>& gradient_results_sets)
+{
+  std::set<std::pair<std::string, std::string>> link_pairs;
+  for (const auto& grs : gradient_results_sets)
+    link_pairs.insert(grs.key);
+
+  return link_pairs;
+}
+
+std::set<std::string> getLinkNames(const std::set<std::pair<std::string, std::string>>& link_pairs)
+{
+  std::set<std::string> link_names;
+  for (const auto& link_pair : link_pairs)
+  {
+    link_names.insert(link_pair.first);
+    link_names.insert(link_pair.second);
+  }
+  return link_names;
+}
+
 void debugPrintInfo(const tesseract_collision::ContactResult& res,
                     const Eigen::VectorXd& dist_grad_A,
                     const Eigen::VectorXd& dist_grad_B,
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef VHACD_POINT_SNAP_GRID_H
+#define VHACD_POINT_SNAP_GRID_H
+#include <math.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "vhacdVector.h"
+
+namespace VHACD
+{
+// Uniform grid of points used to find if a point is within a snap distance of any of them. The cells are at least as
+// large as the snap distance, so only the 27 cells around a point need to be searched.
+class PointSnapGrid
+{
+public:
+  explicit PointSnapGrid(const double snapDistance) : m_snapDistanceSquared(snapDistance * snapDistance)
+  {
+    // Slightly larger cells make up for the rounding of the cell coordinates
+    m_cellSize = snapDistance * (1.0 + 1e-6);
+  }
+
+  bool HasPointWithin(const Vec3<double>& p) const
+  {
+    const Cell c = GetCell(p);
+    for (int64_t x = c.x - 1; x <= c.x + 1; ++x)
+    {
+      for (int64_t y = c.y - 1; y <= c.y + 1; ++y)
+      {
+        for (int64_t z = c.z - 1; z <= c.z + 1; ++z)
+        {
+          auto it = m_cells.find(Cell{ x, y, z });
+          if (it == m_cells.end())
+          {
+            continue;
+          }
+          for (const Vec3<double>& q : it->second)
+          {
+            if (q.GetDistanceSquared(p) < m_snapDistanceSquared)
+            {
+              return true;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  void AddPoint(const Vec3<double>& p)
+  {
+    m_cells[GetCell(p)].push_back(p);
+  }
+
+private:
+  struct Cell
+  {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+    bool operator==(const Cell& other) const { return x == other.x && y == other.y && z == other.z; }
+  };
+
+  struct CellHash
+  {
+    size_t operator()(const Cell& c) const
+    {
+      return static_cast<size_t>((static_cast<uint64_t>(c.x) * 73856093ULL) ^
+                                 (static_cast<uint64_t>(c.y) * 19349663ULL) ^
+                                 (static_cast<uint64_t>(c.z) * 83492791ULL));
+    }
+  };
+
+  Cell GetCell(const Vec3<double>& p) const
+  {
+    return Cell{ static_cast<int64_t>(floor(p[0] / m_cellSize)),
+                 static_cast<int64_t>(floor(p[1] / m_cellSize)),
+                 static_cast<int64_t>(floor(p[2] / m_cellSize)) };
+  }
+
+  double m_snapDistanceSquared;
+  double m_cellSize;
+  std::unordered_map<Cell, std::vector<Vec3<double>>, CellHash> m_cells;
+};
+}  // namespace VHACD
+#endif  // VHACD_POINT_SNAP_GRID_H
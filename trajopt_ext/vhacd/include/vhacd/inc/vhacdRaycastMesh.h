@@ -6,7 +6,7 @@
 
 namespace VHACD
 {
-// Very simple brute force raycast against a triangle mesh.  Tests every triangle; no hierachy.
+// Raycast against a triangle mesh, accelerated with a bounding volume hierarchy over the triangles.
 // Does a deep copy, always does calculations with full double float precision
 class RaycastMesh
 {
@@ -32,6 +32,14 @@ public:
                        double* hitLocation,  // The point where the ray hit nearest to the 'closestToPoint' location
                        double* hitDistance) = 0;  // The distance the ray traveled to the hit location
 
+  // Same as raycast but tests every triangle without the hierarchy. This is the reference for raycast and is only
+  // meant for debugging and tests.
+  virtual bool raycastBruteForce(const double* from,
+                                 const double* to,
+                                 const double* closestToPoint,
+                                 double* hitLocation,
+                                 double* hitDistance) = 0;
+
   virtual void release(void) = 0;
 
 protected:
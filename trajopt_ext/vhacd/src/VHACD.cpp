@@ -42,6 +42,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 
 #include "vhacd/inc/vhacdICHull.h"
 #include "vhacd/inc/vhacdMesh.h"
+#include "vhacd/inc/vhacdPointSnapGrid.h"
 #include "vhacd/inc/vhacdSArray.h"
 #include "vhacd/inc/vhacdTimer.h"
 #include "vhacd/inc/vhacdVHACD.h"
@@ -1650,11 +1651,11 @@ void VHACD::SimplifyConvexHull(Mesh* const ch, const size_t nvertices, const dou
     // create a
     // thin sliver in the resulting convex hull
     double snapDistanceThreshold = diagonalLength * 0.01;
-    double snapDistanceThresholdSquared = snapDistanceThreshold * snapDistanceThreshold;
 
     // Allocate buffer for projected vertices
     Vec3<double>* outputPoints = new Vec3<double>[nPoints];
     uint32_t outCount = 0;
+    PointSnapGrid snapGrid(snapDistanceThreshold);
     for (uint32_t i = 0; i < nPoints; i++)
     {
       Vec3<double>& inputPoint = inputPoints[i];
@@ -1682,19 +1683,18 @@ void VHACD::SimplifyConvexHull(Mesh* const ch, const size_t nvertices, const dou
       }
       // Ok, before we add this point, we do not want to create points which are extremely close to each other.
       // This will result in tiny sliver triangles which are really bad for collision detection.
+      // If this new point is extremely close to an existing point, we do not add it!
       bool foundNearbyPoint = false;
-      for (uint32_t j = 0; j < outCount; j++)
+      if (snapDistanceThreshold > 0)
       {
-        // If this new point is extremely close to an existing point, we do not add it!
-        double squaredDistance = outputPoints[j].GetDistanceSquared(outputPoint);
-        if (squaredDistance < snapDistanceThresholdSquared)
-        {
-          foundNearbyPoint = true;
-          break;
-        }
+        foundNearbyPoint = snapGrid.HasPointWithin(outputPoint);
       }
       if (!foundNearbyPoint)
       {
+        if (snapDistanceThreshold > 0)
+        {
+          snapGrid.AddPoint(outputPoint);
+        }
         outCount++;
       }
     }
@@ -1,6 +1,10 @@
 #include "vhacd/inc/vhacdRaycastMesh.h"
 #include <math.h>
 #include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
 
 namespace RAYCAST_MESH
 {
@@ -60,6 +64,68 @@ static double getPointDistance(const double* p1, const double* p2)
   return sqrt(dx * dx + dy * dy + dz * dz);
 }
 
+// Bounding box of a set of triangles
+struct Bounds
+{
+  double mMin[3];
+  double mMax[3];
+
+  void clear(void)
+  {
+    for (uint32_t a = 0; a < 3; a++)
+    {
+      mMin[a] = std::numeric_limits<double>::max();
+      mMax[a] = -std::numeric_limits<double>::max();
+    }
+  }
+
+  void include(const Bounds& b)
+  {
+    for (uint32_t a = 0; a < 3; a++)
+    {
+      mMin[a] = std::min(mMin[a], b.mMin[a]);
+      mMax[a] = std::max(mMax[a], b.mMax[a]);
+    }
+  }
+
+  double getHalfArea(void) const
+  {
+    double dx = mMax[0] - mMin[0];
+    double dy = mMax[1] - mMin[1];
+    double dz = mMax[2] - mMin[2];
+    return dx * dy + dy * dz + dz * dx;
+  }
+};
+
+// Computes the interval [tmin, tmax] with tmin >= 0 of the ray inside the box, returns false if the ray misses it
+static inline bool
+rayIntersectsBounds(const double* p, const double* d, const double* invD, const Bounds& b, double& tmin, double& tmax)
+{
+  tmin = 0;
+  tmax = std::numeric_limits<double>::max();
+  for (uint32_t a = 0; a < 3; a++)
+  {
+    if (d[a] == 0)
+    {
+      if (p[a] < b.mMin[a] || p[a] > b.mMax[a])
+        return false;
+      continue;
+    }
+    double t1 = (b.mMin[a] - p[a]) * invD[a];
+    double t2 = (b.mMax[a] - p[a]) * invD[a];
+    if (t1 > t2)
+      std::swap(t1, t2);
+    tmin = std::max(tmin, t1);
+    tmax = std::min(tmax, t2);
+    if (tmin > tmax)
+      return false;
+  }
+  return true;
+}
+
+// Ray casts are accelerated with a bounding volume hierarchy over the triangles, built with the surface area heuristic.
+// Nodes are visited nearest first and skipped when no point of the ray inside them can be closer to 'closestToPoint'
+// than the current hit, so the result is the same as testing every triangle.
 class MyRaycastMesh : public VHACD::RaycastMesh
 {
 public:
@@ -84,6 +150,7 @@ public:
       mIndices[i * 3 + 2] = indices[2];
       indices += 3;
     }
+    buildTree();
   }
 
   ~MyRaycastMesh(void)
@@ -108,6 +175,115 @@ public:
     dir[1] = to[1] - from[1];
     dir[2] = to[2] - from[2];
 
+    double distance = sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+    if (distance < 0.0000000001f)
+      return false;
+    double recipDistance = 1.0f / distance;
+    dir[0] *= recipDistance;
+    dir[1] *= recipDistance;
+    dir[2] *= recipDistance;
+    double invDir[3];
+    for (uint32_t a = 0; a < 3; a++)
+      invDir[a] = (dir[a] != 0) ? 1.0 / dir[a] : 0;
+
+    const uint32_t* indices = mIndices;
+    const double* vertices = mVertices;
+    double nearestDistance = distance;
+    uint32_t nearestTri = 0;
+
+    // At most one sibling per level is waiting, plus both children at the deepest level
+    std::pair<uint32_t, double> stack[MAX_TREE_DEPTH + 1];
+    uint32_t stackSize = 0;
+    double rootDistance;
+    if (!mNodes.empty() && getNodeDistance(mNodes[0], from, dir, invDir, closestToPoint, rootDistance))
+      stack[stackSize++] = std::make_pair(0, rootDistance);
+
+    while (stackSize > 0)
+    {
+      stackSize--;
+      const Node& node = mNodes[stack[stackSize].first];
+      double nodeDistance = stack[stackSize].second;
+      if (!canContainNearest(nodeDistance, nearestDistance))
+        continue;
+
+      if (node.mCount == 0)
+      {
+        // Push the farther child first so the nearer one is visited first
+        std::pair<uint32_t, double> children[2];
+        uint32_t nChildren = 0;
+        for (uint32_t c = node.mFirst; c < node.mFirst + 2; c++)
+        {
+          double childDistance;
+          if (getNodeDistance(mNodes[c], from, dir, invDir, closestToPoint, childDistance) &&
+              canContainNearest(childDistance, nearestDistance))
+            children[nChildren++] = std::make_pair(c, childDistance);
+        }
+        if (nChildren == 2 && children[0].second < children[1].second)
+          std::swap(children[0], children[1]);
+        for (uint32_t c = 0; c < nChildren; c++)
+          stack[stackSize++] = children[c];
+        continue;
+      }
+
+      for (uint32_t k = node.mFirst; k < node.mFirst + node.mCount; k++)
+      {
+        uint32_t tri = mTriangles[k];
+        uint32_t i1 = indices[tri * 3 + 0];
+        uint32_t i2 = indices[tri * 3 + 1];
+        uint32_t i3 = indices[tri * 3 + 2];
+
+        const double* p1 = &vertices[i1 * 3];
+        const double* p2 = &vertices[i2 * 3];
+        const double* p3 = &vertices[i3 * 3];
+
+        double t;
+        if (rayIntersectsTriangle(from, dir, p1, p2, p3, t))
+        {
+          double hitPos[3];
+
+          hitPos[0] = from[0] + dir[0] * t;
+          hitPos[1] = from[1] + dir[1] * t;
+          hitPos[2] = from[2] + dir[2] * t;
+
+          double pointDistance = getPointDistance(hitPos, closestToPoint);
+
+          // On a tie the lowest triangle index wins, as it would when testing the triangles in order
+          if (pointDistance < nearestDistance || (ret && pointDistance == nearestDistance && tri < nearestTri))
+          {
+            nearestDistance = pointDistance;
+            nearestTri = tri;
+            if (hitLocation)
+            {
+              hitLocation[0] = hitPos[0];
+              hitLocation[1] = hitPos[1];
+              hitLocation[2] = hitPos[2];
+            }
+            if (hitDistance)
+            {
+              *hitDistance = pointDistance;
+            }
+            ret = true;
+          }
+        }
+      }
+    }
+    return ret;
+  }
+
+  virtual bool raycastBruteForce(const double* from,
+                                 const double* to,
+                                 const double* closestToPoint,
+                                 double* hitLocation,
+                                 double* hitDistance) override final
+  {
+    bool ret = false;
+
+    double dir[3];
+
+    dir[0] = to[0] - from[0];
+    dir[1] = to[1] - from[1];
+    dir[2] = to[2] - from[2];
+
     double distance = sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
     if (distance < 0.0000000001f)
       return false;
@@ -164,6 +340,221 @@ public:
   double* mVertices;
   uint32_t mTcount;
   uint32_t* mIndices;
+
+private:
+  // A leaf holds mCount triangles starting at mTriangles[mFirst], an inner node (mCount == 0) has its two children at
+  // mNodes[mFirst] and mNodes[mFirst + 1]
+  struct Node
+  {
+    Bounds mBounds;
+    uint32_t mFirst;
+    uint32_t mCount;
+  };
+
+  static const uint32_t MAX_LEAF_TRIANGLES = 4;
+  // Deeper nodes are made leaves regardless of their triangle count, this bounds the traversal stack of raycast
+  static const uint32_t MAX_TREE_DEPTH = 64;
+  static const uint32_t SAH_BINS = 16;
+
+  std::vector<Node> mNodes;
+  std::vector<uint32_t> mTriangles;  // Triangle indices ordered by leaf
+
+  // Lower bound of the distance between 'closestToPoint' and any hit inside the node
+  static bool getNodeDistance(const Node& node,
+                              const double* from,
+                              const double* dir,
+                              const double* invDir,
+                              const double* closestToPoint,
+                              double& nodeDistance)
+  {
+    double tmin, tmax;
+    if (!rayIntersectsBounds(from, dir, invDir, node.mBounds, tmin, tmax))
+      return false;
+
+    double diff[3];
+    vector(diff, closestToPoint, from);
+    double t = std::min(std::max(innerProduct(diff, dir), tmin), tmax);
+    double nearestPos[3];
+    nearestPos[0] = from[0] + dir[0] * t;
+    nearestPos[1] = from[1] + dir[1] * t;
+    nearestPos[2] = from[2] + dir[2] * t;
+    nodeDistance = getPointDistance(nearestPos, closestToPoint);
+    return true;
+  }
+
+  // The slack keeps nodes holding a hit at exactly the nearest distance, which may win the tie on triangle index
+  static bool canContainNearest(double nodeDistance, double nearestDistance)
+  {
+    return nodeDistance <= nearestDistance * (1.0 + 1e-12);
+  }
+
+  void buildTree(void)
+  {
+    if (mTcount == 0)
+      return;
+
+    std::vector<Bounds> triBounds(mTcount);
+    std::vector<double> centroids(mTcount * 3);
+    Bounds meshBounds;
+    meshBounds.clear();
+    for (uint32_t tri = 0; tri < mTcount; tri++)
+    {
+      Bounds& b = triBounds[tri];
+      b.clear();
+      for (uint32_t v = 0; v < 3; v++)
+      {
+        const double* p = &mVertices[mIndices[tri * 3 + v] * 3];
+        for (uint32_t a = 0; a < 3; a++)
+        {
+          b.mMin[a] = std::min(b.mMin[a], p[a]);
+          b.mMax[a] = std::max(b.mMax[a], p[a]);
+        }
+      }
+      for (uint32_t a = 0; a < 3; a++)
+        centroids[tri * 3 + a] = (b.mMin[a] + b.mMax[a]) * 0.5;
+      meshBounds.include(b);
+    }
+
+    mTriangles.resize(mTcount);
+    for (uint32_t tri = 0; tri < mTcount; tri++)
+      mTriangles[tri] = tri;
+
+    mNodes.reserve(2 * mTcount);
+    mNodes.push_back(Node());
+    buildNode(0, 0, mTcount, 0, triBounds, centroids);
+
+    // Hit points are computed with rounding errors, so the boxes are grown to make sure they contain them
+    double dx = meshBounds.mMax[0] - meshBounds.mMin[0];
+    double dy = meshBounds.mMax[1] - meshBounds.mMin[1];
+    double dz = meshBounds.mMax[2] - meshBounds.mMin[2];
+    double margin = sqrt(dx * dx + dy * dy + dz * dz) * 1e-9;
+    for (auto& node : mNodes)
+    {
+      for (uint32_t a = 0; a < 3; a++)
+      {
+        node.mBounds.mMin[a] -= margin;
+        node.mBounds.mMax[a] += margin;
+      }
+    }
+  }
+
+  void buildNode(uint32_t nodeIndex,
+                 uint32_t begin,
+                 uint32_t end,
+                 uint32_t depth,
+                 const std::vector<Bounds>& triBounds,
+                 const std::vector<double>& centroids)
+  {
+    Bounds bounds;
+    bounds.clear();
+    Bounds centroidBounds;
+    centroidBounds.clear();
+    for (uint32_t k = begin; k < end; k++)
+    {
+      uint32_t tri = mTriangles[k];
+      bounds.include(triBounds[tri]);
+      for (uint32_t a = 0; a < 3; a++)
+      {
+        centroidBounds.mMin[a] = std::min(centroidBounds.mMin[a], centroids[tri * 3 + a]);
+        centroidBounds.mMax[a] = std::max(centroidBounds.mMax[a], centroids[tri * 3 + a]);
+      }
+    }
+    mNodes[nodeIndex].mBounds = bounds;
+
+    uint32_t count = end - begin;
+    if (count <= MAX_LEAF_TRIANGLES || depth == MAX_TREE_DEPTH)
+    {
+      makeLeaf(nodeIndex, begin, count);
+      return;
+    }
+
+    // Find the binned split with the lowest surface area heuristic cost
+    double bestCost = std::numeric_limits<double>::max();
+    uint32_t bestAxis = 0;
+    uint32_t bestBin = 0;
+    for (uint32_t a = 0; a < 3; a++)
+    {
+      double extent = centroidBounds.mMax[a] - centroidBounds.mMin[a];
+      if (extent <= 0)
+        continue;
+
+      Bounds binBounds[SAH_BINS];
+      uint32_t binCounts[SAH_BINS] = {};
+      for (uint32_t b = 0; b < SAH_BINS; b++)
+        binBounds[b].clear();
+      for (uint32_t k = begin; k < end; k++)
+      {
+        uint32_t tri = mTriangles[k];
+        uint32_t b = getBin(centroids[tri * 3 + a], centroidBounds.mMin[a], extent);
+        binCounts[b]++;
+        binBounds[b].include(triBounds[tri]);
+      }
+
+      double rightCosts[SAH_BINS];
+      Bounds right;
+      right.clear();
+      uint32_t rightCount = 0;
+      for (uint32_t b = SAH_BINS - 1; b > 0; b--)
+      {
+        right.include(binBounds[b]);
+        rightCount += binCounts[b];
+        rightCosts[b] = (rightCount > 0) ? right.getHalfArea() * rightCount : 0;
+      }
+
+      Bounds left;
+      left.clear();
+      uint32_t leftCount = 0;
+      for (uint32_t b = 0; b + 1 < SAH_BINS; b++)
+      {
+        left.include(binBounds[b]);
+        leftCount += binCounts[b];
+        if (leftCount == 0 || leftCount == count)
+          continue;
+        double cost = left.getHalfArea() * leftCount + rightCosts[b + 1];
+        if (cost < bestCost)
+        {
+          bestCost = cost;
+          bestAxis = a;
+          bestBin = b;
+        }
+      }
+    }
+
+    uint32_t mid;
+    if (bestCost < std::numeric_limits<double>::max())
+    {
+      double extent = centroidBounds.mMax[bestAxis] - centroidBounds.mMin[bestAxis];
+      uint32_t* split = std::partition(&mTriangles[begin], &mTriangles[0] + end, [&](uint32_t tri) {
+        return getBin(centroids[tri * 3 + bestAxis], centroidBounds.mMin[bestAxis], extent) <= bestBin;
+      });
+      mid = static_cast<uint32_t>(split - &mTriangles[0]);
+    }
+    else
+    {
+      // All the centroids are at the same point, split in the middle
+      mid = begin + count / 2;
+    }
+
+    uint32_t first = static_cast<uint32_t>(mNodes.size());
+    mNodes[nodeIndex].mFirst = first;
+    mNodes[nodeIndex].mCount = 0;
+    mNodes.push_back(Node());
+    mNodes.push_back(Node());
+    buildNode(first, begin, mid, depth + 1, triBounds, centroids);
+    buildNode(first + 1, mid, end, depth + 1, triBounds, centroids);
+  }
+
+  void makeLeaf(uint32_t nodeIndex, uint32_t begin, uint32_t count)
+  {
+    mNodes[nodeIndex].mFirst = begin;
+    mNodes[nodeIndex].mCount = count;
+  }
+
+  static uint32_t getBin(double centroid, double min, double extent)
+  {
+    uint32_t b = static_cast<uint32_t>((centroid - min) / extent * SAH_BINS);
+    return std::min(b, SAH_BINS - 1);
+  }
 };
 };  // namespace RAYCAST_MESH
 
@@ -0,0 +1,145 @@
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <vhacd/inc/vhacdPointSnapGrid.h>
+#include <vhacd/inc/vhacdRaycastMesh.h>
+
+/** @brief Create a unit sphere mesh where every triangle is stored three times, once with copied vertices */
+static void createDuplicatedSphere(std::vector<double>& vertices, std::vector<uint32_t>& indices)
+{
+  const uint32_t n_rings = 16;
+  const uint32_t n_segments = 24;
+  for (uint32_t i = 0; i <= n_rings; ++i)
+  {
+    const double theta = M_PI * i / n_rings;
+    for (uint32_t j = 0; j < n_segments; ++j)
+    {
+      const double phi = 2 * M_PI * j / n_segments;
+      vertices.insert(vertices.end(),
+                      { std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta) });
+    }
+  }
+
+  for (uint32_t i = 0; i < n_rings; ++i)
+  {
+    for (uint32_t j = 0; j < n_segments; ++j)
+    {
+      const uint32_t a = (i * n_segments) + j;
+      const uint32_t b = (i * n_segments) + ((j + 1) % n_segments);
+      const uint32_t c = a + n_segments;
+      const uint32_t d = b + n_segments;
+      indices.insert(indices.end(), { a, c, b, b, c, d });
+    }
+  }
+
+  // The same triangles again, once with the same and once with copied vertices
+  const auto n_vertices = static_cast<uint32_t>(vertices.size() / 3);
+  const std::size_t n_indices = indices.size();
+  vertices.insert(vertices.end(), vertices.begin(), vertices.end());
+  for (std::size_t i = 0; i < n_indices; ++i)
+    indices.push_back(indices[i]);
+  for (std::size_t i = 0; i < n_indices; ++i)
+    indices.push_back(indices[i] + n_vertices);
+}
+
+TEST(HullProjectionTest, raycastMatchesBruteForce)  // NOLINT
+{
+  std::vector<double> vertices;
+  std::vector<uint32_t> indices;
+  createDuplicatedSphere(vertices, indices);
+  VHACD::RaycastMesh* mesh = VHACD::RaycastMesh::createRaycastMesh(static_cast<uint32_t>(vertices.size() / 3),
+                                                                   vertices.data(),
+                                                                   static_cast<uint32_t>(indices.size() / 3),
+                                                                   indices.data());
+
+  // Rays from inside the sphere towards random points outside of it, matched to random points near the surface
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-1, 1);
+  int n_hits = 0;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const double from[3] = { 0.2 * dist(gen), 0.2 * dist(gen), 0.2 * dist(gen) };
+    const double to[3] = { 2 * dist(gen), 2 * dist(gen), 2 * dist(gen) };
+    const double closest[3] = { to[0] * 0.5, to[1] * 0.5, to[2] * 0.5 };
+
+    double location[3] = { 0, 0, 0 };
+    double distance = 0;
+    const bool hit = mesh->raycast(from, to, closest, location, &distance);
+
+    double brute_force_location[3] = { 0, 0, 0 };
+    double brute_force_distance = 0;
+    const bool brute_force_hit =
+        mesh->raycastBruteForce(from, to, closest, brute_force_location, &brute_force_distance);
+
+    // The results must be identical, not only close
+    ASSERT_EQ(hit, brute_force_hit);
+    if (!hit)
+      continue;
+
+    ++n_hits;
+    EXPECT_EQ(distance, brute_force_distance);
+    for (int j = 0; j < 3; ++j)
+    {
+      EXPECT_EQ(location[j], brute_force_location[j]);
+    }
+  }
+  EXPECT_GT(n_hits, 1000);
+  mesh->release();
+}
+
+TEST(HullProjectionTest, snapGridMatchesBruteForce)  // NOLINT
+{
+  // Points on the duplicated sphere so every point has an exact duplicate, plus random points around it
+  std::vector<double> vertices;
+  std::vector<uint32_t> indices;
+  createDuplicatedSphere(vertices, indices);
+  const std::size_t n_duplicates = vertices.size() / 6;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-1.1, 1.1);
+  for (int i = 0; i < 3000; ++i)
+    vertices.insert(vertices.end(), { dist(gen), dist(gen), dist(gen) });
+
+  for (double snap_distance : { 0.01, 0.05, 0.2 })
+  {
+    VHACD::PointSnapGrid grid(snap_distance);
+    std::vector<VHACD::Vec3<double>> added;
+    for (std::size_t i = 0; i < vertices.size(); i += 3)
+    {
+      const VHACD::Vec3<double> p(vertices[i], vertices[i + 1], vertices[i + 2]);
+      const bool found = grid.HasPointWithin(p);
+
+      // Compare with every point added so far
+      bool brute_force_found = false;
+      for (const VHACD::Vec3<double>& q : added)
+      {
+        if (q.GetDistanceSquared(p) < snap_distance * snap_distance)
+        {
+          brute_force_found = true;
+          break;
+        }
+      }
+      ASSERT_EQ(found, brute_force_found);
+
+      if (!found)
+      {
+        grid.AddPoint(p);
+        added.push_back(p);
+      }
+    }
+    // At least the duplicated vertices are snapped
+    EXPECT_GT(added.size(), 0);
+    EXPECT_LE(added.size(), (vertices.size() / 3) - n_duplicates);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -111,8 +111,8 @@ private:
   std::array<std::shared_ptr<const JointPosition>, 2> position_vars_;
   std::array<bool, 2> position_vars_fixed_;
 
-  /** @brief Used to initialize jacobian because snopt sparsity cannot change */
-  std::vector<Eigen::Triplet<double>> triplet_list_;
+  /** @brief If true the jacobian of the inactive rows is filled with zeros because snopt sparsity cannot change */
+  bool fixed_sparsity_{ false };
 
   std::shared_ptr<ContinuousCollisionEvaluator> collision_evaluator_;
 };
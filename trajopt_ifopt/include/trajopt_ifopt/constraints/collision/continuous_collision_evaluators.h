@@ -77,6 +77,21 @@ public:
                     const std::array<bool, 2>& position_vars_fixed,
                     std::size_t bounds_size) = 0;
 
+  /**
+   * @brief Re-evaluate only the link pairs found in the baseline collision data
+   * @details This is used for numerical differentiation. The result is not stored in the collision cache and the
+   * gradient results sets are not sorted.
+   * @param dof_vals0 Joint values for start state
+   * @param dof_vals1 Joint values for end state
+   * @param baseline The collision data whose link pairs are re-evaluated
+   * @return Collision data containing only link pairs found in the baseline
+   */
+  virtual std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisionDataForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                            const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                            const std::array<bool, 2>& position_vars_fixed,
+                            const trajopt_common::CollisionCacheData& baseline) = 0;
+
   /**
    * @brief Extracts the gradient information based on the contact results for the transition between dof_vals0 and
    * dof_vals1
@@ -122,6 +137,12 @@ public:
                     const std::array<bool, 2>& position_vars_fixed,
                     std::size_t bounds_size) override final;
 
+  std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisionDataForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                            const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                            const std::array<bool, 2>& position_vars_fixed,
+                            const trajopt_common::CollisionCacheData& baseline) override final;
+
   trajopt_common::GradientResults
   CalcGradientData(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                    const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
@@ -137,6 +158,8 @@ private:
   std::vector<std::string> env_active_link_names_;
   std::vector<std::string> manip_active_link_names_;
   std::vector<std::string> diff_active_link_names_;
+  tesseract_common::VectorIsometry3d manip_active_link_transforms0_;
+  tesseract_common::VectorIsometry3d manip_active_link_transforms1_;
   GetStateFn get_state_fn_;
   bool dynamic_environment_;
   std::shared_ptr<tesseract_collision::ContinuousContactManager> contact_manager_;
@@ -149,6 +172,10 @@ private:
                             const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                             const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
                             const std::array<bool, 2>& position_vars_fixed);
+
+  void CalcGradientResultsSets(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                               const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                               trajopt_common::CollisionCacheData& data);
 };
 
 /**
@@ -175,6 +202,12 @@ public:
                     const std::array<bool, 2>& position_vars_fixed,
                     std::size_t bounds_size) override final;
 
+  std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisionDataForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                            const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                            const std::array<bool, 2>& position_vars_fixed,
+                            const trajopt_common::CollisionCacheData& baseline) override final;
+
   trajopt_common::GradientResults
   CalcGradientData(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                    const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
@@ -190,6 +223,8 @@ private:
   std::vector<std::string> env_active_link_names_;
   std::vector<std::string> manip_active_link_names_;
   std::vector<std::string> diff_active_link_names_;
+  tesseract_common::VectorIsometry3d manip_active_link_transforms0_;
+  tesseract_common::VectorIsometry3d manip_active_link_transforms1_;
   GetStateFn get_state_fn_;
   bool dynamic_environment_;
   std::shared_ptr<tesseract_collision::DiscreteContactManager> contact_manager_;
@@ -202,6 +237,10 @@ private:
                             const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                             const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
                             const std::array<bool, 2>& position_vars_fixed);
+
+  void CalcGradientResultsSets(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                               const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                               trajopt_common::CollisionCacheData& data);
 };
 }  // namespace trajopt_ifopt
 #endif  // TRAJOPT_IFOPT_CONTINUOUS_COLLISION_EVALUATOR_H
@@ -110,8 +110,8 @@ private:
    */
   std::shared_ptr<const JointPosition> position_var_;
 
-  /** @brief Used to initialize jacobian because snopt sparsity cannot change */
-  std::vector<Eigen::Triplet<double>> triplet_list_;
+  /** @brief If true the jacobian of the inactive rows is filled with zeros because snopt sparsity cannot change */
+  bool fixed_sparsity_{ false };
 
   std::shared_ptr<DiscreteCollisionEvaluator> collision_evaluator_;
 };
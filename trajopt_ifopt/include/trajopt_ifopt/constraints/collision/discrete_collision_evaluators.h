@@ -72,6 +72,18 @@ public:
   virtual std::shared_ptr<const trajopt_common::CollisionCacheData>
   CalcCollisions(const Eigen::Ref<const Eigen::VectorXd>& dof_vals, std::size_t bounds_size) = 0;
 
+  /**
+   * @brief Re-evaluate only the link pairs found in the baseline collision data
+   * @details This is used for numerical differentiation. The result is not stored in the collision cache and the
+   * gradient results sets are not sorted.
+   * @param dof_vals Joint values set prior to collision checking
+   * @param baseline The collision data whose link pairs are re-evaluated
+   * @return Collision data containing only link pairs found in the baseline
+   */
+  virtual std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisionsForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
+                         const trajopt_common::CollisionCacheData& baseline) = 0;
+
   /**
    * @brief Get the safety margin information.
    * @return Safety margin information
@@ -110,6 +122,10 @@ public:
   std::shared_ptr<const trajopt_common::CollisionCacheData>
   CalcCollisions(const Eigen::Ref<const Eigen::VectorXd>& dof_vals, std::size_t bounds_size) override final;
 
+  std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisionsForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
+                         const trajopt_common::CollisionCacheData& baseline) override final;
+
   trajopt_common::GradientResults GetGradient(const Eigen::VectorXd& dofvals,
                                               const tesseract_collision::ContactResult& contact_result) override;
 
@@ -123,12 +139,16 @@ private:
   std::vector<std::string> env_active_link_names_;
   std::vector<std::string> manip_active_link_names_;
   std::vector<std::string> diff_active_link_names_;
+  tesseract_common::VectorIsometry3d manip_active_link_transforms_;
   GetStateFn get_state_fn_;
   bool dynamic_environment_;
   std::shared_ptr<tesseract_collision::DiscreteContactManager> contact_manager_;
 
   void CalcCollisionsHelper(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
                             tesseract_collision::ContactResultMap& dist_results);
+
+  void CalcGradientResultsSets(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
+                               trajopt_common::CollisionCacheData& data);
 };
 
 }  // namespace trajopt_ifopt
@@ -134,6 +134,16 @@ Eigen::VectorXd calcBoundsErrors(const Eigen::Ref<const Eigen::VectorXd>& input,
 Eigen::VectorXd calcBoundsViolations(const Eigen::Ref<const Eigen::VectorXd>& input,
                                      const std::vector<ifopt::Bounds>& bounds);
 
+/**
+ * @brief The absolute value of the Bounds Errors, written into a preallocated vector
+ * @param violations The absolute errors given the bounds, must be the same size as the input and may alias it
+ * @param input The input values
+ * @param bounds The bounds
+ */
+void calcBoundsViolations(Eigen::Ref<Eigen::VectorXd> violations,
+                          const Eigen::Ref<const Eigen::VectorXd>& input,
+                          const std::vector<ifopt::Bounds>& bounds);
+
 /**
  * @brief Calculate the numerical cost gradient at the provided values
  * @param x The variable values to calculate the gradient about
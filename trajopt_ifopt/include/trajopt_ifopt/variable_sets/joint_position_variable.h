@@ -29,6 +29,7 @@
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <ifopt/variable_set.h>
+#include <ifopt/composite.h>
 #include <ifopt/bounds.h>
 #include <Eigen/Core>
 #include <tesseract_common/fwd.h>
@@ -36,6 +37,20 @@ TRAJOPT_IGNORE_WARNINGS_POP
 
 namespace trajopt_ifopt
 {
+/**
+ * @brief Contiguous storage shared by the values of several JointPosition sets
+ * @details Each set using the storage reads and writes its values in place, so the values of all sets can be set or
+ * read with a single copy. See JointPosition::SetStorage.
+ */
+struct JointPositionStorage
+{
+  using Ptr = std::shared_ptr<JointPositionStorage>;
+  using ConstPtr = std::shared_ptr<const JointPositionStorage>;
+
+  /** @brief The values of the sets using the storage, in the order they were added */
+  Eigen::VectorXd values;
+};
+
 /** @brief Represents a single joint position in the optimization. Values are of dimension 1 x n_dof */
 class JointPosition : public ifopt::VariableSet
 {
@@ -94,12 +109,42 @@ public:
    */
   std::vector<std::string> GetJointNames() const;
 
+  /**
+   * @brief Move the values of this variable to the end of the shared storage
+   * @details Afterwards the values are read and written in place. Adding the sets to a storage in the same order as to
+   * the problem lets the QP problem set and get all of them with a single copy, see getContiguousStorage.
+   * @param storage The storage shared with other variables
+   */
+  void SetStorage(JointPositionStorage::Ptr storage);
+
+  /**
+   * @brief Get the shared storage of this variable
+   * @return The storage, nullptr if the variable owns its values
+   */
+  const JointPositionStorage::Ptr& GetStorage() const;
+
+  /**
+   * @brief Get the index of the first value of this variable in the shared storage
+   * @return The offset, zero if the variable owns its values
+   */
+  Eigen::Index GetStorageOffset() const;
+
 private:
   VecBound bounds_;
   Eigen::VectorXd values_;
   std::vector<std::string> joint_names_;
+  JointPositionStorage::Ptr storage_;
+  Eigen::Index storage_offset_{ 0 };
 };
 
+/**
+ * @brief Get the storage which holds the values of all variable sets in a composite
+ * @param variables The composite of variable sets
+ * @return The storage if the composite only contains JointPosition sets whose values fill the same storage in the
+ * order of the composite, otherwise nullptr
+ */
+JointPositionStorage::Ptr getContiguousStorage(const ifopt::Composite& variables);
+
 }  // namespace trajopt_ifopt
 
 #endif
@@ -47,6 +47,7 @@ ContinuousCollisionConstraint::ContinuousCollisionConstraint(
   : ifopt::ConstraintSet(max_num_cnt, name)
   , position_vars_(std::move(position_vars))
   , position_vars_fixed_(position_vars_fixed)
+  , fixed_sparsity_(fixed_sparsity)
   , collision_evaluator_(std::move(collision_evaluator))
 {
   if (position_vars_[0] == nullptr && position_vars_[1] == nullptr)
@@ -67,17 +68,6 @@ ContinuousCollisionConstraint::ContinuousCollisionConstraint(
     throw std::runtime_error("max_num_cnt must be greater than zero!");
 
   bounds_ = std::vector<ifopt::Bounds>(static_cast<std::size_t>(max_num_cnt), ifopt::BoundSmallerZero);
-
-  if (fixed_sparsity)
-  {
-    // Setting to zeros because snopt sparsity cannot change
-    triplet_list_.reserve(static_cast<std::size_t>(bounds_.size()) *
-                          static_cast<std::size_t>(position_vars_[0]->GetRows()));
-
-    for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(bounds_.size()); i++)  // NOLINT
-      for (Eigen::Index j = 0; j < n_dof_; j++)
-        triplet_list_.emplace_back(i, j, 0);
-  }
 }
 
 Eigen::VectorXd ContinuousCollisionConstraint::GetValues() const
@@ -134,60 +124,74 @@ void ContinuousCollisionConstraint::FillJacobianBlock(std::string var_set, Jacob
   if (var_set != position_vars_[0]->GetName() && var_set != position_vars_[1]->GetName())  // NOLINT
     return;
 
-  // Setting to zeros because snopt sparsity cannot change
-  if (!triplet_list_.empty())                                               // NOLINT
-    jac_block.setFromTriplets(triplet_list_.begin(), triplet_list_.end());  // NOLINT
+  const bool is_var0 = (var_set == position_vars_[0]->GetName());
+  const bool var_fixed = (is_var0) ? position_vars_fixed_[0] : position_vars_fixed_[1];
 
-  // Calculate collisions
-  Eigen::VectorXd joint_vals0 = this->GetVariables()->GetComponent(position_vars_[0]->GetName())->GetValues();
-  Eigen::VectorXd joint_vals1 = this->GetVariables()->GetComponent(position_vars_[1]->GetName())->GetValues();
-
-  auto collision_data =
-      collision_evaluator_->CalcCollisionData(joint_vals0, joint_vals1, position_vars_fixed_, bounds_.size());
+  // The jacobian of a fixed variable set is zero so the collision data is not needed
+  std::vector<Eigen::Triplet<double>> triplet_list;
+  std::vector<bool> active(bounds_.size(), false);
+  if (!var_fixed)
+  {
+    // Calculate collisions
+    Eigen::VectorXd joint_vals0 = this->GetVariables()->GetComponent(position_vars_[0]->GetName())->GetValues();
+    Eigen::VectorXd joint_vals1 = this->GetVariables()->GetComponent(position_vars_[1]->GetName())->GetValues();
 
-  if (collision_data->gradient_results_sets.empty())
-    return;
+    auto collision_data =
+        collision_evaluator_->CalcCollisionData(joint_vals0, joint_vals1, position_vars_fixed_, bounds_.size());
 
-  /** @todo Should use triplet list and setFromTriplets */
-  const std::size_t cnt = std::min(collision_data->gradient_results_sets.size(), bounds_.size());
-  if (var_set == position_vars_[0]->GetName() && !position_vars_fixed_[0])
-  {
+    // Only the rows with an error at this variable set's timestep are active
+    const std::size_t cnt = std::min(collision_data->gradient_results_sets.size(), bounds_.size());
+    triplet_list.reserve((fixed_sparsity_ ? bounds_.size() : cnt) * static_cast<std::size_t>(n_dof_));
     for (std::size_t i = 0; i < cnt; ++i)
     {
       const trajopt_common::GradientResultsSet& r = collision_data->gradient_results_sets[i];
-      if (r.max_error[0].has_error[0] || r.max_error[1].has_error[0])
+      Eigen::VectorXd grad_vec;
+      if (is_var0)
       {
+        if (!r.max_error[0].has_error[0] && !r.max_error[1].has_error[0])
+          continue;
+
         double max_error_with_buffer = r.getMaxErrorWithBufferT0();
         if (!position_vars_fixed_[1])
           max_error_with_buffer = r.getMaxErrorWithBuffer();
 
-        Eigen::VectorXd grad_vec = getWeightedAvgGradientT0(r, max_error_with_buffer, position_vars_[0]->GetRows());
-
-        // Collision is 1 x n_dof
-        for (int j = 0; j < n_dof_; j++)
-          jac_block.coeffRef(static_cast<int>(i), j) = -1.0 * grad_vec[j];
+        grad_vec = getWeightedAvgGradientT0(r, max_error_with_buffer, position_vars_[0]->GetRows());
       }
-    }
-  }
-  else if (var_set == position_vars_[1]->GetName() && !position_vars_fixed_[1])
-  {
-    for (std::size_t i = 0; i < cnt; ++i)
-    {
-      const trajopt_common::GradientResultsSet& r = collision_data->gradient_results_sets[i];
-      if (r.max_error[0].has_error[1] || r.max_error[1].has_error[1])
+      else
       {
+        if (!r.max_error[0].has_error[1] && !r.max_error[1].has_error[1])
+          continue;
+
         double max_error_with_buffer = r.getMaxErrorWithBufferT1();
         if (!position_vars_fixed_[0])
           max_error_with_buffer = r.getMaxErrorWithBuffer();
 
-        Eigen::VectorXd grad_vec = getWeightedAvgGradientT1(r, max_error_with_buffer, position_vars_[1]->GetRows());
-
-        // Collision is 1 x n_dof
-        for (int j = 0; j < n_dof_; j++)
-          jac_block.coeffRef(static_cast<int>(i), j) = -1.0 * grad_vec[j];
+        grad_vec = getWeightedAvgGradientT1(r, max_error_with_buffer, position_vars_[1]->GetRows());
       }
+
+      // Collision is 1 x n_dof
+      active[i] = true;
+      for (int j = 0; j < n_dof_; j++)
+        triplet_list.emplace_back(static_cast<int>(i), j, -1.0 * grad_vec[j]);
+    }
+  }
+
+  // Setting the inactive rows to zeros because snopt sparsity cannot change
+  if (fixed_sparsity_)
+  {
+    triplet_list.reserve(bounds_.size() * static_cast<std::size_t>(n_dof_));
+    for (std::size_t i = 0; i < bounds_.size(); ++i)
+    {
+      if (active[i])
+        continue;
+
+      for (int j = 0; j < n_dof_; j++)
+        triplet_list.emplace_back(static_cast<int>(i), j, 0);
     }
   }
+
+  if (!triplet_list.empty())
+    jac_block.setFromTriplets(triplet_list.begin(), triplet_list.end());  // NOLINT
 }
 
 void ContinuousCollisionConstraint::SetBounds(const std::vector<ifopt::Bounds>& bounds)
@@ -103,44 +103,7 @@ LVSContinuousCollisionEvaluator::CalcCollisionData(const Eigen::Ref<const Eigen:
   auto data = std::make_shared<trajopt_common::CollisionCacheData>();
   CalcCollisionsHelper(data->contact_results_map, dof_vals0, dof_vals1, position_vars_fixed);
 
-  for (const auto& pair : data->contact_results_map)
-  {
-    using ShapeGrsType = std::map<std::pair<std::size_t, std::size_t>, trajopt_common::GradientResultsSet>;
-    ShapeGrsType shape_grs;
-    const double coeff =
-        collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
-    for (const tesseract_collision::ContactResult& dist_result : pair.second)
-    {
-      const std::size_t shape_hash0 = trajopt_common::cantorHash(dist_result.shape_id[0], dist_result.subshape_id[0]);
-      const std::size_t shape_hash1 = trajopt_common::cantorHash(dist_result.shape_id[1], dist_result.subshape_id[1]);
-      auto shape_key = std::make_pair(shape_hash0, shape_hash1);
-      auto it = shape_grs.find(shape_key);
-      if (it == shape_grs.end())
-      {
-        trajopt_common::GradientResultsSet grs;
-        grs.key = pair.first;
-        grs.shape_key = shape_key;
-        grs.coeff = coeff;
-        grs.is_continuous = true;
-        grs.results.reserve(pair.second.size());
-        grs.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
-        shape_grs[shape_key] = grs;
-      }
-      else
-      {
-        it->second.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
-      }
-    }
-
-    // This is not as efficient as it could be. Need to update Tesseract to store per subhshape key
-    const std::size_t new_size = data->gradient_results_sets.size() + shape_grs.size();
-    data->gradient_results_sets.reserve(new_size);
-
-    std::transform(shape_grs.begin(),
-                   shape_grs.end(),
-                   std::back_inserter(data->gradient_results_sets),
-                   std::bind(&ShapeGrsType::value_type::second, std::placeholders::_1));  // NOLINT
-  }
+  CalcGradientResultsSets(dof_vals0, dof_vals1, *data);
 
   if (data->gradient_results_sets.size() > bounds_size)
   {
@@ -174,6 +137,35 @@ LVSContinuousCollisionEvaluator::CalcCollisionData(const Eigen::Ref<const Eigen:
   return data;
 }
 
+std::shared_ptr<const trajopt_common::CollisionCacheData>
+LVSContinuousCollisionEvaluator::CalcCollisionDataForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                                                           const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                                                           const std::array<bool, 2>& position_vars_fixed,
+                                                           const trajopt_common::CollisionCacheData& baseline)
+{
+  auto data = std::make_shared<trajopt_common::CollisionCacheData>();
+  if (baseline.gradient_results_sets.empty())
+    return data;
+
+  // The contact managers do not provide a pair distance query so only the links in the baseline pairs are left
+  // enabled, which skips the narrowphase for every other object
+  const auto link_pairs = trajopt_common::getLinkPairs(baseline.gradient_results_sets);
+  {
+    const trajopt_common::DisabledCollisionObjectsGuard<tesseract_collision::ContinuousContactManager> guard(
+        *contact_manager_, trajopt_common::getLinkNames(link_pairs));
+    CalcCollisionsHelper(data->contact_results_map, dof_vals0, dof_vals1, position_vars_fixed);
+  }
+
+  // Two links from different baseline pairs may also be in contact, these are not part of the baseline
+  data->contact_results_map.filter([&link_pairs](tesseract_collision::ContactResultMap::PairType& pair) {
+    if (link_pairs.find(pair.first) == link_pairs.end())
+      pair.second.clear();
+  });
+
+  CalcGradientResultsSets(dof_vals0, dof_vals1, *data);
+  return data;
+}
+
 void LVSContinuousCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::ContactResultMap& dist_results,
                                                            const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                                                            const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
@@ -196,7 +188,9 @@ void LVSContinuousCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::
   // Don't include contacts at the fixed state
   // Don't include contacts with zero coeffs
   const auto& zero_coeff_pairs = collision_config_->collision_coeff_data.getPairsWithZeroCoeff();
-  auto filter = [this, &zero_coeff_pairs, &position_vars_fixed](tesseract_collision::ContactResultMap::PairType& pair) {
+  const double scale = collision_config_->getContinuationScale();
+  auto filter = [this, scale, &zero_coeff_pairs, &position_vars_fixed](
+                    tesseract_collision::ContactResultMap::PairType& pair) {
     // Remove pairs with zero coeffs
     if (zero_coeff_pairs.find(pair.first) != zero_coeff_pairs.end())
     {
@@ -208,7 +202,7 @@ void LVSContinuousCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::
     double dist = collision_config_->contact_manager_config.margin_data.getPairCollisionMargin(pair.first.first,
                                                                                                pair.first.second);
     double coeff = collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
-    const Eigen::Vector3d data = { dist, collision_config_->collision_margin_buffer, coeff };
+    const Eigen::Vector3d data = { scale * dist, collision_config_->collision_margin_buffer, scale * coeff };
     trajopt_common::removeInvalidContactResults(pair.second, data, position_vars_fixed);
   };
 
@@ -227,13 +221,17 @@ void LVSContinuousCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::
     tesseract_collision::ContactResultMap contacts{ dist_results };
     int last_state_idx{ static_cast<int>(subtraj.rows()) - 1 };
     double dt = 1.0 / double(last_state_idx);
+    // The end state of a segment is the start state of the next one so its link transforms are reused
+    trajopt_common::getLinkTransforms(
+        manip_active_link_transforms1_, manip_active_link_names_, get_state_fn_(subtraj.row(0)));
     for (int i = 0; i < subtraj.rows() - 1; ++i)
     {
-      tesseract_common::TransformMap state0 = get_state_fn_(subtraj.row(i));
-      tesseract_common::TransformMap state1 = get_state_fn_(subtraj.row(i + 1));
+      std::swap(manip_active_link_transforms0_, manip_active_link_transforms1_);
+      trajopt_common::getLinkTransforms(
+          manip_active_link_transforms1_, manip_active_link_names_, get_state_fn_(subtraj.row(i + 1)));
 
-      for (const auto& link_name : manip_active_link_names_)
-        contact_manager_->setCollisionObjectsTransform(link_name, state0[link_name], state1[link_name]);
+      contact_manager_->setCollisionObjectsTransform(
+          manip_active_link_names_, manip_active_link_transforms0_, manip_active_link_transforms1_);
 
       contact_manager_->contactTest(contacts, collision_config_->contact_request);
       if (!contacts.empty())
@@ -246,10 +244,12 @@ void LVSContinuousCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::
   }
   else
   {
-    tesseract_common::TransformMap state0 = get_state_fn_(dof_vals0);
-    tesseract_common::TransformMap state1 = get_state_fn_(dof_vals1);
-    for (const auto& link_name : manip_active_link_names_)
-      contact_manager_->setCollisionObjectsTransform(link_name, state0[link_name], state1[link_name]);
+    trajopt_common::getLinkTransforms(
+        manip_active_link_transforms0_, manip_active_link_names_, get_state_fn_(dof_vals0));
+    trajopt_common::getLinkTransforms(
+        manip_active_link_transforms1_, manip_active_link_names_, get_state_fn_(dof_vals1));
+    contact_manager_->setCollisionObjectsTransform(
+        manip_active_link_names_, manip_active_link_transforms0_, manip_active_link_transforms1_);
 
     contact_manager_->contactTest(dist_results, collision_config_->contact_request);
 
@@ -257,6 +257,51 @@ void LVSContinuousCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::
   }
 }
 
+void LVSContinuousCollisionEvaluator::CalcGradientResultsSets(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                                                              const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                                                              trajopt_common::CollisionCacheData& data)
+{
+  const double scale = collision_config_->getContinuationScale();
+  for (const auto& pair : data.contact_results_map)
+  {
+    using ShapeGrsType = std::map<std::pair<std::size_t, std::size_t>, trajopt_common::GradientResultsSet>;
+    ShapeGrsType shape_grs;
+    const double coeff =
+        scale * collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
+    for (const tesseract_collision::ContactResult& dist_result : pair.second)
+    {
+      const std::size_t shape_hash0 = trajopt_common::cantorHash(dist_result.shape_id[0], dist_result.subshape_id[0]);
+      const std::size_t shape_hash1 = trajopt_common::cantorHash(dist_result.shape_id[1], dist_result.subshape_id[1]);
+      auto shape_key = std::make_pair(shape_hash0, shape_hash1);
+      auto it = shape_grs.find(shape_key);
+      if (it == shape_grs.end())
+      {
+        trajopt_common::GradientResultsSet grs;
+        grs.key = pair.first;
+        grs.shape_key = shape_key;
+        grs.coeff = coeff;
+        grs.is_continuous = true;
+        grs.results.reserve(pair.second.size());
+        grs.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
+        shape_grs[shape_key] = grs;
+      }
+      else
+      {
+        it->second.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
+      }
+    }
+
+    // This is not as efficient as it could be. Need to update Tesseract to store per subhshape key
+    const std::size_t new_size = data.gradient_results_sets.size() + shape_grs.size();
+    data.gradient_results_sets.reserve(new_size);
+
+    std::transform(shape_grs.begin(),
+                   shape_grs.end(),
+                   std::back_inserter(data.gradient_results_sets),
+                   std::bind(&ShapeGrsType::value_type::second, std::placeholders::_1));  // NOLINT
+  }
+}
+
 trajopt_common::GradientResults
 LVSContinuousCollisionEvaluator::CalcGradientData(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                                                   const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
@@ -265,6 +310,7 @@ LVSContinuousCollisionEvaluator::CalcGradientData(const Eigen::Ref<const Eigen::
   // Contains the contact distance threshold and coefficient for the given link pair
   double margin = collision_config_->contact_manager_config.margin_data.getPairCollisionMargin(
       contact_results.link_names[0], contact_results.link_names[1]);
+  margin *= collision_config_->getContinuationScale();
 
   return trajopt_common::getGradient(
       dof_vals0, dof_vals1, contact_results, margin, collision_config_->collision_margin_buffer, *manip_);
@@ -340,44 +386,7 @@ LVSDiscreteCollisionEvaluator::CalcCollisionData(const Eigen::Ref<const Eigen::V
 
   auto data = std::make_shared<trajopt_common::CollisionCacheData>();
   CalcCollisionsHelper(data->contact_results_map, dof_vals0, dof_vals1, position_vars_fixed);
-  for (const auto& pair : data->contact_results_map)
-  {
-    using ShapeGrsType = std::map<std::pair<std::size_t, std::size_t>, trajopt_common::GradientResultsSet>;
-    ShapeGrsType shape_grs;
-    const double coeff =
-        collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
-    for (const tesseract_collision::ContactResult& dist_result : pair.second)
-    {
-      const std::size_t shape_hash0 = trajopt_common::cantorHash(dist_result.shape_id[0], dist_result.subshape_id[0]);
-      const std::size_t shape_hash1 = trajopt_common::cantorHash(dist_result.shape_id[1], dist_result.subshape_id[1]);
-      auto shape_key = std::make_pair(shape_hash0, shape_hash1);
-      auto it = shape_grs.find(shape_key);
-      if (it == shape_grs.end())
-      {
-        trajopt_common::GradientResultsSet grs;
-        grs.key = pair.first;
-        grs.shape_key = shape_key;
-        grs.coeff = coeff;
-        grs.is_continuous = true;
-        grs.results.reserve(pair.second.size());
-        grs.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
-        shape_grs[shape_key] = grs;
-      }
-      else
-      {
-        it->second.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
-      }
-    }
-
-    // This is not as efficient as it could be. Need to update Tesseract to store per subhshape key
-    const std::size_t new_size = data->gradient_results_sets.size() + shape_grs.size();
-    data->gradient_results_sets.reserve(new_size);
-
-    std::transform(shape_grs.begin(),
-                   shape_grs.end(),
-                   std::back_inserter(data->gradient_results_sets),
-                   std::bind(&ShapeGrsType::value_type::second, std::placeholders::_1));  // NOLINT
-  }
+  CalcGradientResultsSets(dof_vals0, dof_vals1, *data);
 
   if (data->gradient_results_sets.size() > bounds_size)
   {
@@ -411,6 +420,35 @@ LVSDiscreteCollisionEvaluator::CalcCollisionData(const Eigen::Ref<const Eigen::V
   return data;
 }
 
+std::shared_ptr<const trajopt_common::CollisionCacheData>
+LVSDiscreteCollisionEvaluator::CalcCollisionDataForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                                                         const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                                                         const std::array<bool, 2>& position_vars_fixed,
+                                                         const trajopt_common::CollisionCacheData& baseline)
+{
+  auto data = std::make_shared<trajopt_common::CollisionCacheData>();
+  if (baseline.gradient_results_sets.empty())
+    return data;
+
+  // The contact managers do not provide a pair distance query so only the links in the baseline pairs are left
+  // enabled, which skips the narrowphase for every other object
+  const auto link_pairs = trajopt_common::getLinkPairs(baseline.gradient_results_sets);
+  {
+    const trajopt_common::DisabledCollisionObjectsGuard<tesseract_collision::DiscreteContactManager> guard(
+        *contact_manager_, trajopt_common::getLinkNames(link_pairs));
+    CalcCollisionsHelper(data->contact_results_map, dof_vals0, dof_vals1, position_vars_fixed);
+  }
+
+  // Two links from different baseline pairs may also be in contact, these are not part of the baseline
+  data->contact_results_map.filter([&link_pairs](tesseract_collision::ContactResultMap::PairType& pair) {
+    if (link_pairs.find(pair.first) == link_pairs.end())
+      pair.second.clear();
+  });
+
+  CalcGradientResultsSets(dof_vals0, dof_vals1, *data);
+  return data;
+}
+
 void LVSDiscreteCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::ContactResultMap& dist_results,
                                                          const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                                                          const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
@@ -428,7 +466,9 @@ void LVSDiscreteCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::Co
   // Don't include contacts at the fixed state
   // Don't include contacts with zero coeffs
   const auto& zero_coeff_pairs = collision_config_->collision_coeff_data.getPairsWithZeroCoeff();
-  auto filter = [this, &zero_coeff_pairs, &position_vars_fixed](tesseract_collision::ContactResultMap::PairType& pair) {
+  const double scale = collision_config_->getContinuationScale();
+  auto filter = [this, scale, &zero_coeff_pairs, &position_vars_fixed](
+                    tesseract_collision::ContactResultMap::PairType& pair) {
     // Remove pairs with zero coeffs
     if (zero_coeff_pairs.find(pair.first) != zero_coeff_pairs.end())
     {
@@ -440,7 +480,7 @@ void LVSDiscreteCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::Co
     double dist = collision_config_->contact_manager_config.margin_data.getPairCollisionMargin(pair.first.first,
                                                                                                pair.first.second);
     double coeff = collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
-    const Eigen::Vector3d data = { dist, collision_config_->collision_margin_buffer, coeff };
+    const Eigen::Vector3d data = { scale * dist, collision_config_->collision_margin_buffer, scale * coeff };
 
     // Don't include contacts at the fixed state
     trajopt_common::removeInvalidContactResults(pair.second, data, position_vars_fixed);
@@ -469,10 +509,9 @@ void LVSDiscreteCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::Co
   double dt = 1.0 / double(last_state_idx);
   for (int i = 0; i < subtraj.rows(); ++i)
   {
-    tesseract_common::TransformMap state0 = get_state_fn_(subtraj.row(i));
-
-    for (const auto& link_name : manip_active_link_names_)
-      contact_manager_->setCollisionObjectsTransform(link_name, state0[link_name]);
+    trajopt_common::getLinkTransforms(
+        manip_active_link_transforms0_, manip_active_link_names_, get_state_fn_(subtraj.row(i)));
+    contact_manager_->setCollisionObjectsTransform(manip_active_link_names_, manip_active_link_transforms0_);
 
     contact_manager_->contactTest(contacts, collision_config_->contact_request);
 
@@ -485,6 +524,51 @@ void LVSDiscreteCollisionEvaluator::CalcCollisionsHelper(tesseract_collision::Co
   }
 }
 
+void LVSDiscreteCollisionEvaluator::CalcGradientResultsSets(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
+                                                            const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
+                                                            trajopt_common::CollisionCacheData& data)
+{
+  const double scale = collision_config_->getContinuationScale();
+  for (const auto& pair : data.contact_results_map)
+  {
+    using ShapeGrsType = std::map<std::pair<std::size_t, std::size_t>, trajopt_common::GradientResultsSet>;
+    ShapeGrsType shape_grs;
+    const double coeff =
+        scale * collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
+    for (const tesseract_collision::ContactResult& dist_result : pair.second)
+    {
+      const std::size_t shape_hash0 = trajopt_common::cantorHash(dist_result.shape_id[0], dist_result.subshape_id[0]);
+      const std::size_t shape_hash1 = trajopt_common::cantorHash(dist_result.shape_id[1], dist_result.subshape_id[1]);
+      auto shape_key = std::make_pair(shape_hash0, shape_hash1);
+      auto it = shape_grs.find(shape_key);
+      if (it == shape_grs.end())
+      {
+        trajopt_common::GradientResultsSet grs;
+        grs.key = pair.first;
+        grs.shape_key = shape_key;
+        grs.coeff = coeff;
+        grs.is_continuous = true;
+        grs.results.reserve(pair.second.size());
+        grs.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
+        shape_grs[shape_key] = grs;
+      }
+      else
+      {
+        it->second.add(CalcGradientData(dof_vals0, dof_vals1, dist_result));
+      }
+    }
+
+    // This is not as efficient as it could be. Need to update Tesseract to store per subhshape key
+    const std::size_t new_size = data.gradient_results_sets.size() + shape_grs.size();
+    data.gradient_results_sets.reserve(new_size);
+
+    std::transform(shape_grs.begin(),
+                   shape_grs.end(),
+                   std::back_inserter(data.gradient_results_sets),
+                   std::bind(&ShapeGrsType::value_type::second, std::placeholders::_1));  // NOLINT
+  }
+}
+
 trajopt_common::GradientResults
 LVSDiscreteCollisionEvaluator::CalcGradientData(const Eigen::Ref<const Eigen::VectorXd>& dof_vals0,
                                                 const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
@@ -493,6 +577,7 @@ LVSDiscreteCollisionEvaluator::CalcGradientData(const Eigen::Ref<const Eigen::Ve
   // Contains the contact distance threshold and coefficient for the given link pair
   double margin = collision_config_->contact_manager_config.margin_data.getPairCollisionMargin(
       contact_results.link_names[0], contact_results.link_names[1]);
+  margin *= collision_config_->getContinuationScale();
 
   return trajopt_common::getGradient(
       dof_vals0, dof_vals1, contact_results, margin, collision_config_->collision_margin_buffer, *manip_);
@@ -156,7 +156,7 @@ void ContinuousCollisionNumericalConstraint::FillJacobianBlock(std::string var_s
   {
     jv(j) = joint_vals0(j) + delta;
     auto collision_data_delta =
-        collision_evaluator_->CalcCollisionData(jv, joint_vals1, position_vars_fixed_, bounds_.size());
+        collision_evaluator_->CalcCollisionDataForPairs(jv, joint_vals1, position_vars_fixed_, *collision_data);
 
     for (int i = 0; i < static_cast<int>(cnt); ++i)
     {
@@ -46,6 +46,7 @@ DiscreteCollisionConstraint::DiscreteCollisionConstraint(
     const std::string& name)
   : ifopt::ConstraintSet(max_num_cnt, name)
   , position_var_(std::move(position_var))
+  , fixed_sparsity_(fixed_sparsity)
   , collision_evaluator_(std::move(collision_evaluator))
 {
   // Set n_dof_ for convenience
@@ -56,16 +57,6 @@ DiscreteCollisionConstraint::DiscreteCollisionConstraint(
     throw std::runtime_error("max_num_cnt must be greater than zero!");
 
   bounds_ = std::vector<ifopt::Bounds>(static_cast<std::size_t>(max_num_cnt), ifopt::BoundSmallerZero);
-
-  // Setting to zeros because snopt sparsity cannot change
-  if (fixed_sparsity)
-  {
-    triplet_list_.reserve(static_cast<std::size_t>(bounds_.size()) *
-                          static_cast<std::size_t>(position_var_->GetRows()));
-    for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(bounds_.size()); i++)
-      for (Eigen::Index j = 0; j < n_dof_; j++)
-        triplet_list_.emplace_back(i, j, 0);
-  }
 }
 
 Eigen::VectorXd DiscreteCollisionConstraint::GetValues() const
@@ -121,17 +112,17 @@ void DiscreteCollisionConstraint::SetBounds(const std::vector<ifopt::Bounds>& bo
 void DiscreteCollisionConstraint::CalcJacobianBlock(const Eigen::Ref<const Eigen::VectorXd>& joint_vals,
                                                     Jacobian& jac_block) const
 {
-  // Setting to zeros because snopt sparsity cannot change
-  if (!triplet_list_.empty())                                               // NOLINT
-    jac_block.setFromTriplets(triplet_list_.begin(), triplet_list_.end());  // NOLINT
-
   trajopt_common::CollisionCacheData::ConstPtr collision_data =
       collision_evaluator_->CalcCollisions(joint_vals, bounds_.size());
-  if (collision_data->gradient_results_sets.empty())
-    return;
 
-  /** @todo Probably should use a triplet list and setFromTriplets */
+  // Only the rows associated with a contact are active, the remaining rows are padding with a zero jacobian
   const std::size_t cnt = std::min(bounds_.size(), collision_data->gradient_results_sets.size());
+  if (cnt == 0 && !fixed_sparsity_)
+    return;
+
+  const auto n_dof = static_cast<std::size_t>(n_dof_);
+  std::vector<Eigen::Triplet<double>> triplet_list;
+  triplet_list.reserve((fixed_sparsity_ ? bounds_.size() : cnt) * n_dof);
   for (std::size_t i = 0; i < cnt; ++i)
   {
     const trajopt_common::GradientResultsSet& r = collision_data->gradient_results_sets[i];
@@ -139,8 +130,18 @@ void DiscreteCollisionConstraint::CalcJacobianBlock(const Eigen::Ref<const Eigen
 
     // Collision is 1 x n_dof
     for (int j = 0; j < n_dof_; j++)
-      jac_block.coeffRef(static_cast<int>(i), j) = -1.0 * grad_vec[j];
+      triplet_list.emplace_back(static_cast<int>(i), j, -1.0 * grad_vec[j]);
+  }
+
+  // Setting the inactive rows to zeros because snopt sparsity cannot change
+  if (fixed_sparsity_)
+  {
+    for (std::size_t i = cnt; i < bounds_.size(); ++i)
+      for (int j = 0; j < n_dof_; j++)
+        triplet_list.emplace_back(static_cast<int>(i), j, 0);
   }
+
+  jac_block.setFromTriplets(triplet_list.begin(), triplet_list.end());  // NOLINT
 }
 
 std::shared_ptr<DiscreteCollisionEvaluator> DiscreteCollisionConstraint::GetCollisionEvaluator() const
@@ -99,43 +99,7 @@ SingleTimestepCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::V
   auto data = std::make_shared<trajopt_common::CollisionCacheData>();
   CalcCollisionsHelper(dof_vals, data->contact_results_map);
 
-  for (const auto& pair : data->contact_results_map)
-  {
-    using ShapeGrsType = std::map<std::pair<std::size_t, std::size_t>, trajopt_common::GradientResultsSet>;
-    ShapeGrsType shape_grs;
-    const double coeff =
-        collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
-    for (const tesseract_collision::ContactResult& dist_result : pair.second)
-    {
-      const std::size_t shape_hash0 = trajopt_common::cantorHash(dist_result.shape_id[0], dist_result.subshape_id[0]);
-      const std::size_t shape_hash1 = trajopt_common::cantorHash(dist_result.shape_id[1], dist_result.subshape_id[1]);
-      auto shape_key = std::make_pair(shape_hash0, shape_hash1);
-      auto it = shape_grs.find(shape_key);
-      if (it == shape_grs.end())
-      {
-        trajopt_common::GradientResultsSet grs;
-        grs.key = pair.first;
-        grs.shape_key = shape_key;
-        grs.coeff = coeff;
-        grs.results.reserve(pair.second.size());
-        grs.add(GetGradient(dof_vals, dist_result));
-        shape_grs[shape_key] = grs;
-      }
-      else
-      {
-        it->second.add(GetGradient(dof_vals, dist_result));
-      }
-    }
-
-    // This is not as efficient as it could be. Need to update Tesseract to store per subhshape key
-    const std::size_t new_size = data->gradient_results_sets.size() + shape_grs.size();
-    data->gradient_results_sets.reserve(new_size);
-
-    std::transform(shape_grs.begin(),
-                   shape_grs.end(),
-                   std::back_inserter(data->gradient_results_sets),
-                   std::bind(&ShapeGrsType::value_type::second, std::placeholders::_1));  // NOLINT
-  }
+  CalcGradientResultsSets(dof_vals, *data);
 
   if (data->gradient_results_sets.size() > bounds_size)
   {
@@ -150,6 +114,33 @@ SingleTimestepCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::V
   return data;
 }
 
+std::shared_ptr<const trajopt_common::CollisionCacheData>
+SingleTimestepCollisionEvaluator::CalcCollisionsForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
+                                                         const trajopt_common::CollisionCacheData& baseline)
+{
+  auto data = std::make_shared<trajopt_common::CollisionCacheData>();
+  if (baseline.gradient_results_sets.empty())
+    return data;
+
+  // The contact managers do not provide a pair distance query so only the links in the baseline pairs are left
+  // enabled, which skips the narrowphase for every other object
+  const auto link_pairs = trajopt_common::getLinkPairs(baseline.gradient_results_sets);
+  {
+    const trajopt_common::DisabledCollisionObjectsGuard<tesseract_collision::DiscreteContactManager> guard(
+        *contact_manager_, trajopt_common::getLinkNames(link_pairs));
+    CalcCollisionsHelper(dof_vals, data->contact_results_map);
+  }
+
+  // Two links from different baseline pairs may also be in contact, these are not part of the baseline
+  data->contact_results_map.filter([&link_pairs](tesseract_collision::ContactResultMap::PairType& pair) {
+    if (link_pairs.find(pair.first) == link_pairs.end())
+      pair.second.clear();
+  });
+
+  CalcGradientResultsSets(dof_vals, *data);
+  return data;
+}
+
 void SingleTimestepCollisionEvaluator::CalcCollisionsHelper(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
                                                             tesseract_collision::ContactResultMap& dist_results)
 {
@@ -159,15 +150,16 @@ void SingleTimestepCollisionEvaluator::CalcCollisionsHelper(const Eigen::Ref<con
   for (const auto& link_name : diff_active_link_names_)
     contact_manager_->setCollisionObjectsTransform(link_name, state[link_name]);
 
-  for (const auto& link_name : manip_active_link_names_)
-    contact_manager_->setCollisionObjectsTransform(link_name, state[link_name]);
+  trajopt_common::getLinkTransforms(manip_active_link_transforms_, manip_active_link_names_, state);
+  contact_manager_->setCollisionObjectsTransform(manip_active_link_names_, manip_active_link_transforms_);
 
   contact_manager_->contactTest(dist_results, collision_config_->contact_request);
 
   // Don't include contacts at the fixed state
   // Don't include contacts with zero coeffs
   const auto& zero_coeff_pairs = collision_config_->collision_coeff_data.getPairsWithZeroCoeff();
-  auto filter = [this, &zero_coeff_pairs](tesseract_collision::ContactResultMap::PairType& pair) {
+  const double scale = collision_config_->getContinuationScale();
+  auto filter = [this, scale, &zero_coeff_pairs](tesseract_collision::ContactResultMap::PairType& pair) {
     // Remove pairs with zero coeffs
     if (zero_coeff_pairs.find(pair.first) != zero_coeff_pairs.end())
     {
@@ -179,7 +171,7 @@ void SingleTimestepCollisionEvaluator::CalcCollisionsHelper(const Eigen::Ref<con
     double dist = collision_config_->contact_manager_config.margin_data.getPairCollisionMargin(pair.first.first,
                                                                                                pair.first.second);
     double coeff = collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
-    const Eigen::Vector2d data = { dist, coeff };
+    const Eigen::Vector2d data = { scale * dist, scale * coeff };
     auto end = std::remove_if(
         pair.second.begin(), pair.second.end(), [&data, this](const tesseract_collision::ContactResult& r) {
           return (!((data[0] + collision_config_->collision_margin_buffer) > r.distance));
@@ -190,6 +182,49 @@ void SingleTimestepCollisionEvaluator::CalcCollisionsHelper(const Eigen::Ref<con
   dist_results.filter(filter);
 }
 
+void SingleTimestepCollisionEvaluator::CalcGradientResultsSets(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
+                                                               trajopt_common::CollisionCacheData& data)
+{
+  const double scale = collision_config_->getContinuationScale();
+  for (const auto& pair : data.contact_results_map)
+  {
+    using ShapeGrsType = std::map<std::pair<std::size_t, std::size_t>, trajopt_common::GradientResultsSet>;
+    ShapeGrsType shape_grs;
+    const double coeff =
+        scale * collision_config_->collision_coeff_data.getPairCollisionCoeff(pair.first.first, pair.first.second);
+    for (const tesseract_collision::ContactResult& dist_result : pair.second)
+    {
+      const std::size_t shape_hash0 = trajopt_common::cantorHash(dist_result.shape_id[0], dist_result.subshape_id[0]);
+      const std::size_t shape_hash1 = trajopt_common::cantorHash(dist_result.shape_id[1], dist_result.subshape_id[1]);
+      auto shape_key = std::make_pair(shape_hash0, shape_hash1);
+      auto it = shape_grs.find(shape_key);
+      if (it == shape_grs.end())
+      {
+        trajopt_common::GradientResultsSet grs;
+        grs.key = pair.first;
+        grs.shape_key = shape_key;
+        grs.coeff = coeff;
+        grs.results.reserve(pair.second.size());
+        grs.add(GetGradient(dof_vals, dist_result));
+        shape_grs[shape_key] = grs;
+      }
+      else
+      {
+        it->second.add(GetGradient(dof_vals, dist_result));
+      }
+    }
+
+    // This is not as efficient as it could be. Need to update Tesseract to store per subhshape key
+    const std::size_t new_size = data.gradient_results_sets.size() + shape_grs.size();
+    data.gradient_results_sets.reserve(new_size);
+
+    std::transform(shape_grs.begin(),
+                   shape_grs.end(),
+                   std::back_inserter(data.gradient_results_sets),
+                   std::bind(&ShapeGrsType::value_type::second, std::placeholders::_1));  // NOLINT
+  }
+}
+
 trajopt_common::GradientResults
 SingleTimestepCollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals,
                                               const tesseract_collision::ContactResult& contact_result)
@@ -197,6 +232,7 @@ SingleTimestepCollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals,
   // Contains the contact distance threshold and coefficient for the given link pair
   double margin = collision_config_->contact_manager_config.margin_data.getPairCollisionMargin(
       contact_result.link_names[0], contact_result.link_names[1]);
+  margin *= collision_config_->getContinuationScale();
 
   return trajopt_common::getGradient(
       dofvals, contact_result, margin, collision_config_->collision_margin_buffer, *manip_);
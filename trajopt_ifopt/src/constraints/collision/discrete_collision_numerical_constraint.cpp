@@ -138,7 +138,7 @@ void DiscreteCollisionNumericalConstraint::CalcJacobianBlock(const Eigen::Ref<co
   for (int j = 0; j < n_dof_; j++)
   {
     jv(j) = joint_vals(j) + delta;
-    auto collision_data_delta = collision_evaluator_->CalcCollisions(jv, bounds_.size());
+    auto collision_data_delta = collision_evaluator_->CalcCollisionsForPairs(jv, *collision_data);
     for (int i = 0; i < static_cast<int>(cnt); ++i)
     {
       const auto& baseline = collision_data->gradient_results_sets[static_cast<std::size_t>(i)];
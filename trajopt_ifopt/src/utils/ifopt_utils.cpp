@@ -26,6 +26,8 @@
 
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <cmath>
 #include <ifopt/composite.h>
 #include <ifopt/constraint_set.h>
 #include <ifopt/problem.h>
@@ -138,6 +140,22 @@ Eigen::VectorXd calcBoundsViolations(const Eigen::Ref<const Eigen::VectorXd>& in
   return calcBoundsErrors(input, bounds).cwiseAbs();  // NOLINT
 }
 
+void calcBoundsViolations(Eigen::Ref<Eigen::VectorXd> violations,
+                          const Eigen::Ref<const Eigen::VectorXd>& input,
+                          const std::vector<ifopt::Bounds>& bounds)
+{
+  assert(input.rows() == static_cast<Eigen::Index>(bounds.size()));  // NOLINT
+  assert(violations.rows() == input.rows());                         // NOLINT
+
+  for (std::size_t i = 0; i < bounds.size(); i++)
+  {
+    const auto idx = static_cast<Eigen::Index>(i);
+    const double dist_from_lower = std::min(input[idx] - bounds[i].lower_, 0.0);
+    const double dist_from_upper = std::max(input[idx] - bounds[i].upper_, 0.0);
+    violations[idx] = std::max(std::abs(dist_from_lower), std::abs(dist_from_upper));
+  }
+}
+
 ifopt::VectorXd calcNumericalCostGradient(const double* x, ifopt::Problem& nlp, double epsilon)
 {
   auto cache_vars = nlp.GetVariableValues();
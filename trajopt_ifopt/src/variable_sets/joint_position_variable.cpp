@@ -25,6 +25,7 @@
  */
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <stdexcept>
 #include <console_bridge/console.h>
 #include <tesseract_common/kinematic_limits.h>
 TRAJOPT_IGNORE_WARNINGS_POP
@@ -83,9 +84,21 @@ JointPosition::JointPosition(const Eigen::Ref<const Eigen::VectorXd>& init_value
   }
 }
 
-void JointPosition::SetVariables(const Eigen::VectorXd& x) { values_ = x; }
+void JointPosition::SetVariables(const Eigen::VectorXd& x)
+{
+  if (storage_ != nullptr)
+    storage_->values.segment(storage_offset_, GetRows()) = x;
+  else
+    values_ = x;
+}
+
+Eigen::VectorXd JointPosition::GetValues() const
+{
+  if (storage_ != nullptr)
+    return storage_->values.segment(storage_offset_, GetRows());
 
-Eigen::VectorXd JointPosition::GetValues() const { return values_; }
+  return values_;
+}
 
 JointPosition::VecBound JointPosition::GetBounds() const { return bounds_; }
 
@@ -94,4 +107,48 @@ void JointPosition::SetBounds(VecBound& new_bounds) { bounds_ = new_bounds; }
 void JointPosition::SetBounds(const Eigen::Ref<const Eigen::MatrixX2d>& bounds) { bounds_ = toBounds(bounds); }
 
 std::vector<std::string> JointPosition::GetJointNames() const { return joint_names_; }
+
+void JointPosition::SetStorage(JointPositionStorage::Ptr storage)
+{
+  if (storage == nullptr)
+    throw std::runtime_error("JointPosition, the storage must not be a nullptr");
+
+  const Eigen::VectorXd values = GetValues();
+  const Eigen::Index offset = storage->values.size();
+  storage->values.conservativeResize(offset + GetRows());
+  storage->values.tail(GetRows()) = values;
+
+  storage_ = std::move(storage);
+  storage_offset_ = offset;
+  values_.resize(0);
+}
+
+const JointPositionStorage::Ptr& JointPosition::GetStorage() const { return storage_; }
+
+Eigen::Index JointPosition::GetStorageOffset() const { return storage_offset_; }
+
+JointPositionStorage::Ptr getContiguousStorage(const ifopt::Composite& variables)
+{
+  JointPositionStorage::Ptr storage;
+  Eigen::Index offset{ 0 };
+  for (const auto& component : variables.GetComponents())
+  {
+    auto joint_position = std::dynamic_pointer_cast<const JointPosition>(component);
+    if (joint_position == nullptr || joint_position->GetStorage() == nullptr)
+      return nullptr;
+
+    if (storage == nullptr)
+      storage = joint_position->GetStorage();
+
+    if (joint_position->GetStorage() != storage || joint_position->GetStorageOffset() != offset)
+      return nullptr;
+
+    offset += joint_position->GetRows();
+  }
+
+  if (storage == nullptr || offset != storage->values.size())
+    return nullptr;
+
+  return storage;
+}
 }  // namespace trajopt_ifopt
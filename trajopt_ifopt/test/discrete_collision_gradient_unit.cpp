@@ -38,6 +38,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <ifopt/problem.h>
 #include <ifopt/ipopt_solver.h>
 #include <trajopt_common/collision_types.h>
+#include <trajopt_common/collision_utils.h>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_ifopt/utils/numeric_differentiation.h>
@@ -131,6 +132,44 @@ TEST_F(DiscreteCollisionGradientTest, DiscreteCollisionGradientTest)  // NOLINT
   runDiscreteGradientTest(env, 10);
 }
 
+TEST_F(DiscreteCollisionGradientTest, CalcCollisionsForPairs)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("DiscreteCollisionGradientTest, CalcCollisionsForPairs");
+  tesseract_kinematics::JointGroup::ConstPtr manip = env->getJointGroup("manipulator");
+
+  auto trajopt_collision_config = std::make_shared<trajopt_common::TrajOptCollisionConfig>(0.2, 1);
+  trajopt_collision_config->collision_margin_buffer = 0.0;
+
+  auto collision_cache = std::make_shared<trajopt_ifopt::CollisionCache>(100);
+  auto collision_evaluator = std::make_shared<trajopt_ifopt::SingleTimestepCollisionEvaluator>(
+      collision_cache, manip, env, trajopt_collision_config);
+
+  Eigen::VectorXd pos(2);
+  pos << -0.75, 0.75;
+  auto baseline = collision_evaluator->CalcCollisions(pos, 3);
+  ASSERT_FALSE(baseline->gradient_results_sets.empty());
+
+  // The pair restricted check must match a full check and must not be stored in the cache
+  Eigen::VectorXd perturbed = pos;
+  perturbed(0) += 1e-3;
+  auto pair_data = collision_evaluator->CalcCollisionsForPairs(perturbed, *baseline);
+  EXPECT_TRUE(collision_cache->get(trajopt_common::getHash(*trajopt_collision_config, perturbed)) == nullptr);
+
+  auto full_data = collision_evaluator->CalcCollisions(perturbed, 3);
+  EXPECT_FALSE(pair_data->gradient_results_sets.empty());
+  EXPECT_LE(pair_data->gradient_results_sets.size(), full_data->gradient_results_sets.size());
+  for (const auto& grs : pair_data->gradient_results_sets)
+  {
+    auto it = std::find_if(full_data->gradient_results_sets.begin(),
+                           full_data->gradient_results_sets.end(),
+                           [&grs](const trajopt_common::GradientResultsSet& cr) {
+                             return (cr.key == grs.key && cr.shape_key == grs.shape_key);
+                           });
+    ASSERT_TRUE(it != full_data->gradient_results_sets.end());
+    EXPECT_NEAR(grs.getMaxErrorT0(), it->getMaxErrorT0(), 1e-8);
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
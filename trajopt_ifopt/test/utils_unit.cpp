@@ -254,6 +254,19 @@ TEST(UtilsUnit, calcBoundsErrorsAndViolations)  // NOLINT
     Eigen::VectorXd output2 = trajopt_ifopt::calcBoundsViolations(input, bounds);
     EXPECT_TRUE(output2.isApprox(output.cwiseAbs()));
   }
+
+  {  // Preallocated output, including in place
+    std::vector<ifopt::Bounds> bounds = { ifopt::BoundSmallerZero, ifopt::BoundGreaterZero, ifopt::Bounds(-3, 6) };
+    Eigen::VectorXd input(3);
+    input << 3.5, -1.5, 1;
+    Eigen::VectorXd output(3);
+    trajopt_ifopt::calcBoundsViolations(output, input, bounds);
+    EXPECT_TRUE(output.isApprox(trajopt_ifopt::calcBoundsViolations(input, bounds)));
+    EXPECT_NEAR(output(2), 0, 1e-8);
+
+    trajopt_ifopt::calcBoundsViolations(input, input, bounds);
+    EXPECT_TRUE(input.isApprox(output));
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
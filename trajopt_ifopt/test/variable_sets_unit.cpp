@@ -71,6 +71,44 @@ TEST(VariableSetsUnit, joint_position_1)  // NOLINT
   }
 }
 
+/**
+ * @brief Tests joint position variables sharing a contiguous storage
+ */
+TEST(VariableSetsUnit, joint_position_storage)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("VariableSetsUnit, joint_position_storage");
+
+  auto storage = std::make_shared<JointPositionStorage>();
+  auto variables = std::make_shared<ifopt::Composite>("variable-sets", false);
+  for (int i = 0; i < 3; ++i)
+  {
+    auto var = std::make_shared<JointPosition>(
+        Eigen::VectorXd::Constant(2, i), std::vector<std::string>(), "Joint_Position_" + std::to_string(i));
+    var->SetStorage(storage);
+    EXPECT_EQ(var->GetStorage(), storage);
+    EXPECT_EQ(var->GetStorageOffset(), 2 * i);
+    variables->AddComponent(var);
+  }
+  ASSERT_EQ(getContiguousStorage(*variables), storage);
+
+  Eigen::VectorXd expected(6);
+  expected << 0, 0, 1, 1, 2, 2;
+  EXPECT_TRUE(expected.isApprox(storage->values));
+  EXPECT_TRUE(expected.isApprox(variables->GetValues()));
+
+  // Setting the storage sets the variables and setting the variables sets the storage
+  storage->values << 10, 11, 12, 13, 14, 15;
+  EXPECT_TRUE(Eigen::Vector2d(12, 13).isApprox(variables->GetComponent("Joint_Position_1")->GetValues()));
+
+  expected << 20, 21, 22, 23, 24, 25;
+  variables->SetVariables(expected);
+  EXPECT_TRUE(expected.isApprox(storage->values));
+
+  // A variable which owns its values
+  variables->AddComponent(std::make_shared<JointPosition>(Eigen::VectorXd::Zero(2), std::vector<std::string>()));
+  EXPECT_EQ(getContiguousStorage(*variables), nullptr);
+}
+
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv)
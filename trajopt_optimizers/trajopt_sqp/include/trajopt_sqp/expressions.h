@@ -4,6 +4,7 @@
 #include <vector>
 
 #include <trajopt_sqp/eigen_types.h>
+#include <trajopt_sqp/types.h>
 
 namespace trajopt_sqp
 {
@@ -56,6 +57,13 @@ struct QuadExprs : Exprs
   SparseMatrix objective_quadratic_coeffs;
 
   Eigen::VectorXd values(const Eigen::Ref<Eigen::VectorXd>& x) const override final;
+
+  /**
+   * @brief Evaluate the equations at x without allocating
+   * @param values The value of each equation, must be preallocated to the number of equations
+   * @param x The variable values
+   */
+  void values(Eigen::Ref<Eigen::VectorXd> values, const Eigen::Ref<const Eigen::VectorXd>& x) const;
 };
 
 /**
@@ -110,6 +118,84 @@ QuadExprs createQuadExprs(const Eigen::Ref<const Eigen::VectorXd>& func_errors,
 
 QuadExprs squareAffExprs(const AffExprs& aff_expr);
 
+/**
+ * @brief Assemble the triplets into the matrix while keeping its existing sparsity pattern
+ * @details If every triplet falls within the current pattern the values are updated in place and entries not provided
+ * (e.g. inactive constraint rows) are stored as explicit zeros, so no allocation is required. Otherwise the matrix is
+ * rebuilt from the triplets and the previous pattern, so the pattern only grows between iterations.
+ * @param matrix The matrix to assemble into
+ * @param rows The number of rows of the matrix
+ * @param cols The number of columns of the matrix
+ * @param triplets The matrix entries, duplicates are summed. Entries may be appended if the matrix is rebuilt.
+ * @return True if the existing sparsity pattern was reused, otherwise false
+ */
+bool assembleSparseMatrix(SparseMatrix& matrix,
+                          Eigen::Index rows,
+                          Eigen::Index cols,
+                          std::vector<Eigen::Triplet<double>>& triplets);
+
+/**
+ * @brief Evaluate constants + matrix.middleRows(start_row, values.size()) * x without allocating
+ * @details Only the first x.size() columns of the matrix are used, so the NLP rows of the QP constraint matrix can be
+ * evaluated without the slack variables.
+ * @param values The result, must be preallocated to the number of rows evaluated
+ * @param matrix The matrix
+ * @param start_row The first row of the matrix evaluated
+ * @param constants The constant of each row evaluated
+ * @param x The values of the first columns of the matrix
+ */
+void evaluateLinearRows(Eigen::Ref<Eigen::VectorXd> values,
+                        const SparseMatrix& matrix,
+                        Eigen::Index start_row,
+                        const Eigen::Ref<const Eigen::VectorXd>& constants,
+                        const Eigen::Ref<const Eigen::VectorXd>& x);
+
+/**
+ * @brief Evaluate x^T * matrix * x without allocating
+ * @param matrix The square matrix
+ * @param x The variable values
+ * @return The value of the quadratic form
+ */
+double evaluateQuadraticForm(const SparseMatrix& matrix, const Eigen::Ref<const Eigen::VectorXd>& x);
+
+/**
+ * @brief Calculate the values the quadratic constraint penalty of addQuadraticConstraintPenalty pulls each linearized
+ * constraint towards
+ * @details The penalty of constraint i is mask[i] * coeffs[i] * (value[i] - targets[i])^2, where value is the
+ * linearized constraint value. This is used to evaluate the penalty the QP minimizes.
+ * @param targets The values minus the errors
+ * @param mask One if the constraint is penalized, zero for inequality constraints satisfied at x_initial
+ * @param values The constraint values at x_initial
+ * @param errors The signed constraint errors at x_initial, zero if the constraint is satisfied
+ * @param types The type of each constraint
+ */
+void calcQuadraticPenaltyTargets(Eigen::VectorXd& targets,
+                                 Eigen::VectorXd& mask,
+                                 const Eigen::Ref<const Eigen::VectorXd>& values,
+                                 const Eigen::Ref<const Eigen::VectorXd>& errors,
+                                 const std::vector<ConstraintType>& types);
+
+/**
+ * @brief Add a quadratic penalty of the linearized constraint errors to a QP objective x^T * H * x + g^T * x
+ * @details The penalty of constraint i is coeffs[i] * (errors[i] + jacobian.row(i) * (x - x_initial))^2. Equality
+ * constraints are always penalized, so a satisfied one is held at its current value, while inequality constraints are
+ * only penalized while they are violated at x_initial.
+ * @param hessian The QP hessian, the penalty is added to the block of the NLP variables
+ * @param gradient The QP gradient, the penalty is added to the head of the NLP variables
+ * @param jacobian The constraint jacobian with one column per NLP variable
+ * @param errors The signed constraint errors at x_initial, zero if the constraint is satisfied
+ * @param x_initial The NLP variable values the constraints were linearized about
+ * @param types The type of each constraint
+ * @param coeffs The penalty coefficient of each constraint
+ */
+void addQuadraticConstraintPenalty(SparseMatrix& hessian,
+                                   Eigen::Ref<Eigen::VectorXd> gradient,
+                                   const SparseMatrix& jacobian,
+                                   const Eigen::Ref<const Eigen::VectorXd>& errors,
+                                   const Eigen::Ref<const Eigen::VectorXd>& x_initial,
+                                   const std::vector<ConstraintType>& types,
+                                   const Eigen::Ref<const Eigen::VectorXd>& coeffs);
+
 }  // namespace trajopt_sqp
 
 #endif  // TRAJOPT_SQP_EXPRESSIONS_H
@@ -27,6 +27,8 @@
 #define TRAJOPT_SQP_IFOPT_QP_PROBLEM_H_
 
 #include <memory>
+#include <vector>
+#include <ifopt/bounds.h>
 #include <trajopt_sqp/types.h>
 #include <trajopt_sqp/qp_problem.h>
 
@@ -35,6 +37,11 @@ namespace ifopt
 class Problem;
 }
 
+namespace trajopt_ifopt
+{
+struct JointPositionStorage;
+}
+
 namespace trajopt_sqp
 {
 /** @brief Converts a general NLP into a convexified QP that can be solved by a QP solver */
@@ -65,6 +72,9 @@ public:
 
   Eigen::VectorXd evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
+  void evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                           Eigen::Ref<Eigen::VectorXd> costs) override;
+
   double evaluateTotalExactCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
   Eigen::VectorXd evaluateExactCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
@@ -73,6 +83,9 @@ public:
 
   Eigen::VectorXd evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
+  void evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                          Eigen::Ref<Eigen::VectorXd> violations) override;
+
   Eigen::VectorXd evaluateExactConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
   Eigen::VectorXd getExactConstraintViolations() override;
@@ -83,8 +96,18 @@ public:
 
   void setConstraintMeritCoeff(const Eigen::Ref<const Eigen::VectorXd>& merit_coeff) override;
 
+  void setConstraintPenaltyType(CostPenaltyType penalty_type) override;
+
+  CostPenaltyType getConstraintPenaltyType() const override { return constraint_penalty_type_; }
+
   Eigen::VectorXd getBoxSize() const override;
 
+  Eigen::MatrixX2d getNLPVariableBounds() const override;
+
+  SparseMatrix getNLPConstraintJacobian() override;
+
+  Eigen::Index getNLPConstraintQPRowOffset() const override { return 0; }
+
   /** @brief Prints all members to the terminal in a human readable form */
   void print() const override;
 
@@ -109,6 +132,8 @@ public:
 
 protected:
   std::shared_ptr<ifopt::Problem> nlp_;
+  /** @brief The storage holding the values of all variable sets, nullptr if they are not stored contiguously */
+  std::shared_ptr<trajopt_ifopt::JointPositionStorage> variable_storage_;
 
   Eigen::Index num_nlp_vars_{ 0 };
   Eigen::Index num_nlp_cnts_{ 0 };
@@ -119,13 +144,21 @@ protected:
   std::vector<std::string> cost_names_;
 
   std::vector<ConstraintType> constraint_types_;
+  CostPenaltyType constraint_penalty_type_{ CostPenaltyType::ABSOLUTE };
 
   /** @brief Box size - constraint is set at current_val +/- box_size */
   Eigen::VectorXd box_size_;
   Eigen::VectorXd constraint_merit_coeff_;
+  /** @brief The values the quadratic constraint penalty pulls each linearized constraint towards */
+  Eigen::VectorXd quadratic_penalty_targets_;
+  /** @brief One if the quadratic constraint penalty applies to the constraint, zero for satisfied inequalities */
+  Eigen::VectorXd quadratic_penalty_mask_;
 
   SparseMatrix hessian_;
   Eigen::VectorXd gradient_;
+  /** @brief The hessian and gradient of the NLP costs, the QP objective may also include the constraint penalty */
+  SparseMatrix cost_hessian_;
+  Eigen::VectorXd cost_gradient_;
   Eigen::VectorXd cost_constant_;
 
   SparseMatrix constraint_matrix_;
@@ -133,6 +166,8 @@ protected:
   Eigen::VectorXd bounds_upper_;
   // This should be the center of the bounds
   Eigen::VectorXd constraint_constant_;
+  /** @brief The bounds of the NLP constraints, cached by convexify() */
+  std::vector<ifopt::Bounds> constraint_bounds_;
 
   /**
    * @brief Helper that updates the cost QP hessian
@@ -141,11 +176,17 @@ protected:
   void updateHessian();
 
   /**
-   * @brief Helper that updates the cost gradient including slack variables
-   * @details Called by convexify()
+   * @brief Helper that updates the cost gradient of the NLP variables
+   * @details Called by convexify(), the slack variable gradient is left unchanged
    */
   void updateGradient();
 
+  /**
+   * @brief Helper that updates the gradient of the slack variables from the constraint merit coefficients
+   * @details Called by updateQPSize() and setConstraintMeritCoeff()
+   */
+  void updateSlackGradient();
+
   /**
    * @brief Helper that linearizes the constraints about the current point, storing the
    * jacobian as the constraint matrix and adding slack variables.
@@ -153,6 +194,15 @@ protected:
    */
   void linearizeConstraints();
 
+  /**
+   * @brief Helper that adds the quadratic penalty of the constraints to the hessian and gradient
+   * @details Called by convexify() when the constraint penalty type is SQUARED
+   */
+  void updateQuadraticConstraintPenalty();
+
+  /** @brief Helper that updates the number of QP variables and constraints for the constraint penalty type */
+  void updateQPSize();
+
   /**
    * @brief Helper that updates the NLP constraint bounds (top section)
    * @details Called by convexify()
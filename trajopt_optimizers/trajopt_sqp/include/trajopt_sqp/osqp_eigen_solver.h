@@ -26,6 +26,7 @@
 #ifndef TRAJOPT_SQP_INCLUDE_OSQP_EIGEN_SOLVER_H_
 #define TRAJOPT_SQP_INCLUDE_OSQP_EIGEN_SOLVER_H_
 
+#include <vector>
 #include <trajopt_sqp/qp_solver.h>
 
 namespace OsqpEigen
@@ -59,6 +60,8 @@ public:
 
   Eigen::VectorXd getSolution() override;
 
+  Eigen::VectorXd getDualSolution() override;
+
   bool updateHessianMatrix(const SparseMatrix& hessian) override;
 
   bool updateGradient(const Eigen::Ref<const Eigen::VectorXd>& gradient) override;
@@ -76,7 +79,52 @@ public:
 
   std::unique_ptr<OsqpEigen::Solver> solver_;
 
+  /**
+   * @brief If true the sparsity pattern of the QP only depends on the structure of the problem
+   * @details Explicit zeros are kept instead of pruning small values, and the workspace is not cleared between
+   * iterations. When the pattern of the hessian and constraint matrix is unchanged only their values are copied into
+   * the OSQP workspace, otherwise the workspace is rebuilt.
+   */
+  bool structural_sparsity{ false };
+
 private:
+  /** @brief A column-major copy of a QP matrix which can be updated from a row-major matrix with the same pattern */
+  struct CSCMatrix
+  {
+    /** @brief The column-major matrix passed to OSQP */
+    Eigen::SparseMatrix<double> matrix;
+    /** @brief The index into the row-major values for each column-major value */
+    std::vector<Eigen::Index> value_map;
+    /** @brief The outer indices of the row-major matrix the pattern was created from */
+    std::vector<SparseMatrix::StorageIndex> outer;
+    /** @brief The inner indices of the row-major matrix the pattern was created from */
+    std::vector<SparseMatrix::StorageIndex> inner;
+
+    /** @brief Returns true if the compressed row-major matrix has the same pattern as the one last set */
+    bool samePattern(const SparseMatrix& rm) const;
+
+    /**
+     * @brief Set the pattern and values from the compressed row-major matrix
+     * @param upper If true only the upper triangular part is stored
+     */
+    void setPattern(const SparseMatrix& rm, double scale, bool upper);
+
+    /** @brief Copy the values of a compressed row-major matrix with the same pattern without allocating */
+    void setValues(const SparseMatrix& rm, double scale);
+  };
+
+  /** @brief Update the hessian or constraint matrix keeping explicit zeros */
+  bool updateStructuralMatrix(const SparseMatrix& matrix, bool hessian);
+
+  /** @brief Pass the column-major hessian or constraint matrix to the OSQP data */
+  bool setStructuralMatrixData(bool hessian);
+
+  /** @brief Clear the OSQP workspace and pass all of the current data to it */
+  bool resetStructuralData();
+
+  CSCMatrix hessian_csc_;
+  CSCMatrix constraint_matrix_csc_;
+
   // Depending on what they decide to do with this issue, these could be dropped
   // https://github.com/robotology/osqp-eigen/issues/17
   Eigen::VectorXd bounds_lower_;
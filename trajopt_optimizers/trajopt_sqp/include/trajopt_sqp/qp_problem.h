@@ -83,6 +83,14 @@ public:
    */
   virtual Eigen::VectorXd evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals) = 0;
 
+  /**
+   * @brief Evaluates the cost of each convexified cost term at var_vals without allocating
+   * @param var_vals Point at which the convex cost is calculated. Should be size num_qp_vars
+   * @param costs Cost associated with each cost term in the problem, must be preallocated to num_nlp_costs
+   */
+  virtual void evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                   Eigen::Ref<Eigen::VectorXd> costs) = 0;
+
   /**
    * @brief Evaluates the sum of the cost functions at var_vals
    * @note This will be relatively computationally expensive, as we will have to loop through all the cost components in
@@ -114,6 +122,16 @@ public:
    */
   virtual Eigen::VectorXd evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals) = 0;
 
+  /**
+   * @brief Evaluates the constraint violations of the convexified function at var_vals without allocating
+   * @param var_vals Point at which the violations are calculated. Should be size num_qp_vars
+   * @param violations The constraint violations, must be preallocated to num_nlp_constraints. Values > 0 are violations
+   * @note With the SQUARED constraint penalty these are the linearized errors penalized by the QP, so the squared
+   * values weighted by the merit coefficients are the constraint penalty the QP minimizes
+   */
+  virtual void evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                                  Eigen::Ref<Eigen::VectorXd> violations) = 0;
+
   /**
    * @brief Evaluate NLP constraint violations at the provided var_vals. Values > 0 are violations
    * @return Vector of constraint violations. Values > 0 are violations
@@ -143,12 +161,44 @@ public:
    */
   virtual void setConstraintMeritCoeff(const Eigen::Ref<const Eigen::VectorXd>& merit_coeff) = 0;
 
+  /**
+   * @brief Set how the NLP constraints are penalized in the QP
+   * @details ABSOLUTE (the default) adds slack variables so the QP minimizes the exact l1 penalty of the linearized
+   * constraints (a hinge for inequality constraints). SQUARED removes the slack variables and adds a quadratic penalty
+   * of the linearized constraint errors to the objective, which makes the QP smaller but is not exact. The number of QP
+   * variables and constraints changes, so the QP solver must be initialized again.
+   * @param penalty_type ABSOLUTE or SQUARED
+   */
+  virtual void setConstraintPenaltyType(CostPenaltyType penalty_type) = 0;
+
+  /** @brief Get how the NLP constraints are penalized in the QP */
+  virtual CostPenaltyType getConstraintPenaltyType() const = 0;
+
   /**
    * @brief Returns the box size
    * @return The box size for each variable
    */
   virtual Eigen::VectorXd getBoxSize() const = 0;
 
+  /**
+   * @brief Get the bounds of the NLP variables
+   * @return The lower bounds in the first column and the upper bounds in the second column
+   */
+  virtual Eigen::MatrixX2d getNLPVariableBounds() const = 0;
+
+  /**
+   * @brief Evaluate the jacobian of the NLP constraints at the current variable values
+   * @return The jacobian with one row per NLP constraint and one column per NLP variable
+   */
+  virtual SparseMatrix getNLPConstraintJacobian() = 0;
+
+  /**
+   * @brief Get the row of the first NLP constraint in the QP constraint matrix
+   * @details The NLP constraints occupy consecutive rows, so this maps the QP multipliers back to the NLP constraints
+   * @return The row index of the first NLP constraint
+   */
+  virtual Eigen::Index getNLPConstraintQPRowOffset() const = 0;
+
   /** @brief Prints all members to the terminal in a human readable form */
   virtual void print() const = 0;
 
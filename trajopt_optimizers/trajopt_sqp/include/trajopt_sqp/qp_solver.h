@@ -85,6 +85,12 @@ public:
    */
   virtual Eigen::VectorXd getSolution() = 0;
 
+  /**
+   * @brief Gets the dual solution
+   * @return The Lagrange multipliers of the QP constraints. Should be n_constraints x 1
+   */
+  virtual Eigen::VectorXd getDualSolution() = 0;
+
   /**
    * @brief Updates the cost hessian
    * @param hessian The QP hessian. Should be n_vars x n_vars
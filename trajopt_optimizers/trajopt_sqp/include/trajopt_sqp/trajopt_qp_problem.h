@@ -38,6 +38,9 @@ public:
 
   Eigen::VectorXd evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
+  void evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                           Eigen::Ref<Eigen::VectorXd> costs) override;
+
   double evaluateTotalExactCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
   Eigen::VectorXd evaluateExactCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
@@ -46,6 +49,9 @@ public:
 
   Eigen::VectorXd evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
+  void evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                          Eigen::Ref<Eigen::VectorXd> violations) override;
+
   Eigen::VectorXd evaluateExactConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals) override;
 
   Eigen::VectorXd getExactConstraintViolations() override;
@@ -56,8 +62,31 @@ public:
 
   void setConstraintMeritCoeff(const Eigen::Ref<const Eigen::VectorXd>& merit_coeff) override;
 
+  void setConstraintPenaltyType(CostPenaltyType penalty_type) override;
+
+  CostPenaltyType getConstraintPenaltyType() const override;
+
   Eigen::VectorXd getBoxSize() const override;
 
+  Eigen::MatrixX2d getNLPVariableBounds() const override;
+
+  SparseMatrix getNLPConstraintJacobian() override;
+
+  Eigen::Index getNLPConstraintQPRowOffset() const override;
+
+  /**
+   * @brief Leave the hinge costs which cannot become positive in the current trust box out of the QP
+   * @details A hinge cost row is screened when its value plus the box size weighted L1 norm of its jacobian row stays
+   * within its bounds. Its jacobian entries are not added to the constraint matrix, so the QP solver factors fewer
+   * nonzeros, while its slack variable stays in place with a zero value. The QP layout and solution are unchanged. The
+   * trust box only shrinks between convexifications, so the screening is repeated by every call to convexify().
+   * @param enable True to screen the inactive hinge costs
+   */
+  void setScreenInactiveHinges(bool enable);
+
+  /** @brief The number of hinge cost rows screened by the last call to convexify() */
+  Eigen::Index getNumScreenedHinges() const;
+
   void print() const override;
 
   Eigen::Index getNumNLPVars() const override;
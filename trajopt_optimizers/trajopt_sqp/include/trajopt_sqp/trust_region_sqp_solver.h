@@ -36,6 +36,7 @@
 
 #include <trajopt_sqp/fwd.h>
 #include <trajopt_sqp/types.h>
+#include <trajopt_common/fwd.h>
 
 namespace trajopt_sqp
 {
@@ -93,6 +94,12 @@ public:
    */
   void setBoxSize(double box_size);
 
+  /**
+   * @brief Get the trust region box size, excluding the per variable scaling
+   * @return The box size
+   */
+  double getBoxSize() const;
+
   /**
    * @brief Calls all registered callbacks with the current state of of the problem
    * @return Returns false if any single callback returned false
@@ -105,6 +112,14 @@ public:
   /** @brief Registers an optimization callback */
   void registerCallback(const std::shared_ptr<SQPCallback>& callback);
 
+  /**
+   * @brief Set the continuation schedule applied to the collision margins and coefficients
+   * @details The continuation must be shared with the collision configs of the problem. It is reset on init(), ramped
+   * toward the target while the trust region shrinks and completed before constraint satisfaction is checked.
+   * @param continuation The continuation, nullptr disables it
+   */
+  void setCollisionContinuation(std::shared_ptr<trajopt_common::CollisionContinuation> continuation);
+
   /** @brief Gets the optimization status (currently unset) */
   const SQPStatus& getStatus();
 
@@ -127,8 +142,55 @@ protected:
   SQPStatus status_{ SQPStatus::QP_SOLVER_ERROR };
   SQPResults results_;
   std::vector<std::shared_ptr<SQPCallback>> callbacks_;
+  std::shared_ptr<trajopt_common::CollisionContinuation> collision_continuation_;
 
   void constraintMeritCoeffChanged();
+
+  /**
+   * @brief Update the merit coefficients of the violated constraints from the QP multipliers
+   * @details Called by adjustPenalty() when SQPParameters::multiplier_merit_update is enabled
+   * @return True if any merit coefficient changed
+   */
+  bool updatePenaltyFromMultipliers();
+
+  /** @brief Ramp the collision continuation based on how far the trust region has shrunk */
+  void updateCollisionContinuation();
+
+  /**
+   * @brief Apply the target collision margins and coefficients if the continuation is not complete
+   * @return True if the continuation was completed, so the problem changed
+   */
+  bool completeCollisionContinuation();
+
+  /** @brief Re-evaluate the best solution after the collision continuation scale changed */
+  void collisionContinuationChanged();
+
+  /**
+   * @brief Switch the QP problem from the quadratic constraint penalty to the exact l1 penalty
+   * @return True if the quadratic penalty was used, so the problem changed
+   */
+  bool completeQuadraticConstraintPenalty();
+
+  /**
+   * @brief Calculate the merit of costs and constraint violations with the current constraint penalty type
+   * @details The violations are weighted by the merit coefficients, squared first with the SQUARED penalty, so the
+   * exact and convexified merits use the same penalty as the QP objective
+   */
+  double calcMerit(const Eigen::Ref<const Eigen::VectorXd>& costs,
+                   const Eigen::Ref<const Eigen::VectorXd>& constraint_violations) const;
+
+  /**
+   * @brief Calculate the box scaling and scale the merit coefficients of the constraints
+   * @details Called by init() when SQPParameters::automatic_scaling is enabled
+   */
+  void calcAutomaticScaling();
+
+  /**
+   * @brief Search for a fraction of the rejected step which improves the exact merit enough
+   * @details If one is found it becomes the best solution. See SQPParameters::line_search.
+   * @return The accepted step fraction, zero if none was accepted
+   */
+  double runLineSearch();
 };
 
 }  // namespace trajopt_sqp
@@ -79,8 +79,49 @@ struct SQPParameters
   double initial_merit_error_coeff = 10;
   /** @brief If true, only the constraints that are violated will be inflated */
   bool inflate_constraints_individually = true;
+  /**
+   * @brief If true, the merit coefficients of violated constraints are updated from the QP multipliers
+   * @details A coefficient whose multiplier is at its bound is inflated by merit_coeff_increase_ratio, because the QP
+   * needed the slack variable and the multiplier is only a lower bound on the coefficient required. Any other violated
+   * constraint is only raised to (1 + merit_coeff_multiplier_margin) * |multiplier|, because the multiplier already
+   * gives the coefficient required for the exact penalty. If no coefficient changes, the default update is used.
+   */
+  bool multiplier_merit_update = false;
+  /** @brief The relative margin added to the multiplier magnitude, see multiplier_merit_update */
+  double merit_coeff_multiplier_margin = 0.5;
+  /**
+   * @brief If true, the constraints start with a quadratic penalty in the QP objective instead of slack variables
+   * @details The quadratic penalty is smooth and removes the slack variables, so each QP is smaller while far from
+   * feasibility. It is not exact, so the exact l1 penalty is used once the max constraint violation is below
+   * quadratic_constraint_penalty_tolerance or the convexification loop converges.
+   */
+  bool quadratic_constraint_penalty = false;
+  /** @brief The max constraint violation below which the exact penalty is used, see quadratic_constraint_penalty */
+  double quadratic_constraint_penalty_tolerance = 1e-2;
+  /**
+   * @brief If true, a backtracking line search on the exact merit is run along a rejected step before the trust region
+   * is shrunk
+   * @details A fraction of the step is accepted if its exact improvement is positive and at least
+   * improve_ratio_threshold times the fraction of the approximate improvement. The trust region is then scaled by the
+   * accepted fraction. This costs exact evaluations but no QP solve.
+   */
+  bool line_search = false;
+  /** @brief The maximum number of step fractions evaluated by the line search */
+  int max_line_search_steps = 3;
+  /** @brief The step fraction is scaled by this for each line search step, starting from the full step */
+  double line_search_shrink_ratio = 0.5;
   /** @brief Initial size of the trust region */
   double initial_trust_box_size = 1e-1;
+  /**
+   * @brief If true, the trust region of each variable and the merit coefficient of each constraint are scaled
+   * @details The trust region of a variable is scaled by the range of its bounds relative to the median range. The
+   * merit coefficient of a constraint is divided by the max norm of its jacobian row at the initial values relative
+   * to the median row. This keeps variables and constraints with mixed units (meters, radians, seconds) equally
+   * conditioned.
+   */
+  bool automatic_scaling = false;
+  /** @brief The automatic scaling factors are limited to [1 / max_automatic_scaling, max_automatic_scaling] */
+  double max_automatic_scaling = 10;
   /** @brief Unused */
   bool log_results = false;
   /** @brief Unused */
@@ -104,7 +145,7 @@ struct SQPResults
   /** @brief The convexified cost achieved this iteration */
   double new_approx_merit{ std::numeric_limits<double>::max() };
 
-  /** @brief Variable values associated with best_exact_merit */
+  /** @brief Values of the NLP variables associated with best_exact_merit */
   Eigen::VectorXd best_var_vals;
   /** @brief Variable values associated with this iteration */
   Eigen::VectorXd new_var_vals;
@@ -118,8 +159,15 @@ struct SQPResults
 
   /** @brief Vector defing the box size. The box is var_vals +/- box_size */
   Eigen::VectorXd box_size;
+  /** @brief The box size of each variable relative to the trust region size, see SQPParameters::automatic_scaling */
+  Eigen::VectorXd box_scaling;
   /** @brief Coefficients used to weight the constraint violations */
   Eigen::VectorXd merit_error_coeffs;
+  /**
+   * @brief The QP multipliers of the NLP constraints from the last successful QP solve, ordered as constraint_names
+   * @details Positive when the upper bound of the constraint is active and negative when the lower bound is active
+   */
+  Eigen::VectorXd constraint_multipliers;
 
   /** @brief Vector of the constraint violations. Positive is a violation */
   Eigen::VectorXd best_constraint_violations;
@@ -150,6 +198,17 @@ struct SQPResults
   int convexify_iteration{ 0 };
   int trust_region_iteration{ 0 };
   int overall_iteration{ 0 };
+  /** @brief Number of rejected steps for which the line search accepted a fraction, each saves at least one QP solve */
+  int line_search_steps{ 0 };
+  /** @brief Number of exact evaluations done by the line search */
+  int line_search_evaluations{ 0 };
+
+  /** @brief Time in seconds spent convexifying the problem and loading it into the QP solver */
+  double convexify_time{ 0 };
+  /** @brief Time in seconds spent solving QPs */
+  double qp_solve_time{ 0 };
+  /** @brief Time in seconds spent evaluating the convexified and exact merit of new solutions */
+  double evaluate_time{ 0 };
 
   void print() const;
 };
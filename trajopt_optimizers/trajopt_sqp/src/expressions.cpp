@@ -1,4 +1,6 @@
 #include <trajopt_sqp/expressions.h>
+#include <algorithm>
+#include <cassert>
 
 namespace trajopt_sqp
 {
@@ -27,6 +29,18 @@ Eigen::VectorXd QuadExprs::values(const Eigen::Ref<Eigen::VectorXd>& x) const
   return result_quad;
 }
 
+void QuadExprs::values(Eigen::Ref<Eigen::VectorXd> values, const Eigen::Ref<const Eigen::VectorXd>& x) const
+{
+  assert(values.rows() == static_cast<Eigen::Index>(quadratic_coeffs.size()));
+  evaluateLinearRows(values, linear_coeffs, 0, constants, x);
+  for (std::size_t i = 0; i < quadratic_coeffs.size(); ++i)
+  {
+    const auto& eq_quad_coeffs = quadratic_coeffs[i];
+    if (eq_quad_coeffs.nonZeros() > 0)
+      values(static_cast<Eigen::Index>(i)) += evaluateQuadraticForm(eq_quad_coeffs, x);
+  }
+}
+
 AffExprs createAffExprs(const Eigen::Ref<const Eigen::VectorXd>& func_error,
                         const Eigen::Ref<const SparseMatrix>& func_jacobian,
                         const Eigen::Ref<const Eigen::VectorXd>& x)
@@ -94,4 +108,121 @@ QuadExprs squareAffExprs(const AffExprs& aff_expr)
 
   return quad_expr;
 }
+
+bool assembleSparseMatrix(SparseMatrix& matrix,
+                          Eigen::Index rows,
+                          Eigen::Index cols,
+                          std::vector<Eigen::Triplet<double>>& triplets)
+{
+  const bool same_size = (matrix.rows() == rows && matrix.cols() == cols && matrix.isCompressed());
+  if (same_size)
+  {
+    std::fill(matrix.valuePtr(), matrix.valuePtr() + matrix.nonZeros(), 0.0);
+
+    bool within_pattern = true;
+    const auto* outer = matrix.outerIndexPtr();
+    const auto* inner = matrix.innerIndexPtr();
+    for (const auto& t : triplets)
+    {
+      const auto* begin = inner + outer[t.row()];
+      const auto* end = inner + outer[t.row() + 1];
+      const auto* it = std::lower_bound(begin, end, t.col());
+      if (it == end || *it != t.col())
+      {
+        within_pattern = false;
+        break;
+      }
+      matrix.valuePtr()[it - inner] += t.value();
+    }
+
+    if (within_pattern)
+      return true;
+
+    // Keep the previous pattern as explicit zeros so entries that become inactive do not change it
+    for (int k = 0; k < matrix.outerSize(); ++k)
+    {
+      for (SparseMatrix::InnerIterator it(matrix, k); it; ++it)
+        triplets.emplace_back(it.row(), it.col(), 0.0);
+    }
+  }
+
+  matrix.resize(rows, cols);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());  // NOLINT
+  return false;
+}
+
+void evaluateLinearRows(Eigen::Ref<Eigen::VectorXd> values,
+                        const SparseMatrix& matrix,
+                        Eigen::Index start_row,
+                        const Eigen::Ref<const Eigen::VectorXd>& constants,
+                        const Eigen::Ref<const Eigen::VectorXd>& x)
+{
+  assert(constants.rows() == values.rows());
+  assert(start_row + values.rows() <= matrix.rows());
+  assert(x.rows() <= matrix.cols());
+  for (Eigen::Index i = 0; i < values.rows(); ++i)
+  {
+    double value = constants(i);
+    // The columns of a compressed row are sorted
+    for (SparseMatrix::InnerIterator it(matrix, start_row + i); it && it.col() < x.rows(); ++it)
+      value += it.value() * x(it.col());
+
+    values(i) = value;
+  }
+}
+
+double evaluateQuadraticForm(const SparseMatrix& matrix, const Eigen::Ref<const Eigen::VectorXd>& x)
+{
+  assert(matrix.rows() == x.rows() && matrix.cols() == x.rows());
+  double value{ 0 };
+  for (Eigen::Index k = 0; k < matrix.outerSize(); ++k)
+  {
+    for (SparseMatrix::InnerIterator it(matrix, k); it; ++it)
+      value += x(it.row()) * it.value() * x(it.col());
+  }
+  return value;
+}
+
+void calcQuadraticPenaltyTargets(Eigen::VectorXd& targets,
+                                 Eigen::VectorXd& mask,
+                                 const Eigen::Ref<const Eigen::VectorXd>& values,
+                                 const Eigen::Ref<const Eigen::VectorXd>& errors,
+                                 const std::vector<ConstraintType>& types)
+{
+  assert(values.size() == errors.size());
+  assert(static_cast<std::size_t>(values.size()) == types.size());
+
+  targets = values - errors;
+  mask.resize(values.size());
+  for (Eigen::Index i = 0; i < mask.size(); ++i)
+    mask[i] = (types[static_cast<std::size_t>(i)] == ConstraintType::INEQ && errors[i] == 0) ? 0 : 1;
+}
+
+void addQuadraticConstraintPenalty(SparseMatrix& hessian,
+                                   Eigen::Ref<Eigen::VectorXd> gradient,
+                                   const SparseMatrix& jacobian,
+                                   const Eigen::Ref<const Eigen::VectorXd>& errors,
+                                   const Eigen::Ref<const Eigen::VectorXd>& x_initial,
+                                   const std::vector<ConstraintType>& types,
+                                   const Eigen::Ref<const Eigen::VectorXd>& coeffs)
+{
+  assert(jacobian.rows() == errors.size() && jacobian.rows() == coeffs.size());
+  assert(static_cast<std::size_t>(jacobian.rows()) == types.size());
+  assert(hessian.rows() >= jacobian.cols() && gradient.size() >= jacobian.cols());
+
+  Eigen::VectorXd weights = coeffs;
+  for (Eigen::Index i = 0; i < weights.size(); ++i)
+  {
+    if (types[static_cast<std::size_t>(i)] == ConstraintType::INEQ && errors[i] == 0)
+      weights[i] = 0;
+  }
+
+  // w * (e + J * (x - x0))^2 = x^T * (J^T * w * J) * x + 2 * (e - J * x0)^T * w * J * x + constant
+  SparseMatrix weighted_jacobian = weights.asDiagonal() * jacobian;
+  SparseMatrix penalty_hessian = jacobian.transpose() * weighted_jacobian;
+  penalty_hessian.conservativeResize(hessian.rows(), hessian.cols());
+  hessian += penalty_hessian;
+  gradient.head(jacobian.cols()) += 2.0 * (weighted_jacobian.transpose() * (errors - jacobian * x_initial));
+}
+
 }  // namespace trajopt_sqp
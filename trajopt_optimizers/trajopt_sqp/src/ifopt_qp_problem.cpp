@@ -24,9 +24,11 @@
  * limitations under the License.
  */
 #include <trajopt_sqp/ifopt_qp_problem.h>
+#include <trajopt_sqp/expressions.h>
 #include <trajopt_ifopt/utils/ifopt_utils.h>
 #include <trajopt_ifopt/costs/squared_cost.h>
 #include <trajopt_ifopt/costs/absolute_cost.h>
+#include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 #include <ifopt/problem.h>
 #include <iostream>
 
@@ -38,6 +40,7 @@ IfoptQPProblem::IfoptQPProblem(std::shared_ptr<ifopt::Problem> nlp) : nlp_(std::
 void IfoptQPProblem::addVariableSet(std::shared_ptr<ifopt::VariableSet> variable_set)
 {
   nlp_->AddVariableSet(variable_set);
+  variable_storage_ = nullptr;
 }
 
 void IfoptQPProblem::addConstraintSet(std::shared_ptr<ifopt::ConstraintSet> constraint_set)
@@ -75,10 +78,9 @@ void IfoptQPProblem::setup()
   num_nlp_vars_ = nlp_->GetNumberOfOptimizationVariables();
   num_nlp_cnts_ = nlp_->GetNumberOfConstraints();
   num_nlp_costs_ = nlp_->GetCosts().GetRows();
+  variable_storage_ = trajopt_ifopt::getContiguousStorage(*nlp_->GetOptVariables());
   cost_constant_ = Eigen::VectorXd::Zero(1);
 
-  num_qp_vars_ = num_nlp_vars_;
-  num_qp_cnts_ = num_nlp_cnts_ + num_nlp_vars_;
   box_size_ = Eigen::VectorXd::Constant(num_nlp_vars_, 1e-1);
   constraint_merit_coeff_ = Eigen::VectorXd::Constant(num_nlp_cnts_, 10);
 
@@ -99,7 +101,8 @@ void IfoptQPProblem::setup()
   Eigen::VectorXd nlp_bounds_l(num_nlp_cnts_);
   Eigen::VectorXd nlp_bounds_u(num_nlp_cnts_);
   // Convert constraint bounds to VectorXd
-  std::vector<ifopt::Bounds> cnt_bounds = nlp_->GetBoundsOnConstraints();
+  constraint_bounds_ = nlp_->GetBoundsOnConstraints();
+  const std::vector<ifopt::Bounds>& cnt_bounds = constraint_bounds_;
   for (Eigen::Index i = 0; i < num_nlp_cnts_; i++)
   {
     nlp_bounds_l[i] = cnt_bounds[static_cast<std::size_t>(i)].lower_;
@@ -112,31 +115,60 @@ void IfoptQPProblem::setup()
   for (std::size_t i = 0; i < static_cast<std::size_t>(nlp_bounds_diff.size()); i++)
   {
     if (std::abs(nlp_bounds_diff[static_cast<Eigen::Index>(i)]) < 1e-3)
-    {
       constraint_types_[i] = ConstraintType::EQ;
-      // Add 2 slack variables for L1 loss
-      num_qp_vars_ += 2;
-      num_qp_cnts_ += 2;
-    }
     else
-    {
       constraint_types_[i] = ConstraintType::INEQ;
-      // Add 1 slack variable for hinge loss
-      num_qp_vars_ += 1;
-      num_qp_cnts_ += 1;
+  }
+
+  updateQPSize();
+}
+
+void IfoptQPProblem::updateQPSize()
+{
+  num_qp_vars_ = num_nlp_vars_;
+  num_qp_cnts_ = num_nlp_cnts_ + num_nlp_vars_;
+  if (constraint_penalty_type_ == CostPenaltyType::ABSOLUTE)
+  {
+    for (const auto& constraint_type : constraint_types_)
+    {
+      // Add 2 slack variables for L1 loss or 1 slack variable for hinge loss
+      const Eigen::Index num_slack = (constraint_type == ConstraintType::EQ) ? 2 : 1;
+      num_qp_vars_ += num_slack;
+      num_qp_cnts_ += num_slack;
     }
   }
 
   // Initialize the constraint bounds
   bounds_lower_ = Eigen::VectorXd::Constant(num_qp_cnts_, -double(INFINITY));
   bounds_upper_ = Eigen::VectorXd::Constant(num_qp_cnts_, double(INFINITY));
+
+  // Initialize the gradient, the NLP variable block is set by convexify()
+  gradient_ = Eigen::VectorXd::Zero(num_qp_vars_);
+  updateSlackGradient();
 }
 
-void IfoptQPProblem::setVariables(const double* x) { nlp_->SetVariables(x); }
-Eigen::VectorXd IfoptQPProblem::getVariableValues() const { return nlp_->GetVariableValues(); }
+void IfoptQPProblem::setVariables(const double* x)
+{
+  // Contiguous variable sets are set with a single copy instead of a copy per set
+  if (variable_storage_ != nullptr)
+    variable_storage_->values = Eigen::Map<const Eigen::VectorXd>(x, variable_storage_->values.size());
+  else
+    nlp_->SetVariables(x);
+}
+
+Eigen::VectorXd IfoptQPProblem::getVariableValues() const
+{
+  if (variable_storage_ != nullptr)
+    return variable_storage_->values;
+
+  return nlp_->GetVariableValues();
+}
 
 void IfoptQPProblem::convexify()
 {
+  // Cache the bounds so evaluating the convexified problem does not allocate
+  constraint_bounds_ = nlp_->GetBoundsOnConstraints();
+
   // This must be called prior to updateGradient
   updateHessian();
 
@@ -150,6 +182,9 @@ void IfoptQPProblem::convexify()
 
   updateConstraintsConstantExpression();
 
+  if (constraint_penalty_type_ == CostPenaltyType::SQUARED)
+    updateQuadraticConstraintPenalty();
+
   updateNLPConstraintBounds();
 
   updateNLPVariableBounds();
@@ -162,12 +197,14 @@ void IfoptQPProblem::updateHessian()
   ////////////////////////////////////////////////////////
   // Set the Hessian (empty for now)
   ////////////////////////////////////////////////////////
-  hessian_.resize(num_qp_vars_, num_qp_vars_);
+  cost_hessian_.resize(num_nlp_vars_, num_nlp_vars_);
   /**
    * @note See CostFromFunc::convex in modeling_utils.cpp.
    * This should be multiplied by 0.5 when implemented
-   * hessian_ = 0.5 * nlp_->GetHessianOfCosts();
+   * cost_hessian_ = 0.5 * nlp_->GetHessianOfCosts();
    */
+  hessian_ = cost_hessian_;
+  hessian_.conservativeResize(num_qp_vars_, num_qp_vars_);
 }
 
 void IfoptQPProblem::updateGradient()
@@ -175,7 +212,10 @@ void IfoptQPProblem::updateGradient()
   ////////////////////////////////////////////////////////
   // Set the gradient of the NLP costs
   ////////////////////////////////////////////////////////
-  gradient_ = Eigen::VectorXd::Zero(num_qp_vars_);
+  if (cost_gradient_.rows() != num_nlp_vars_)
+    cost_gradient_.resize(num_nlp_vars_);
+
+  cost_gradient_.setZero();
   SparseMatrix cost_jac = nlp_->GetJacobianOfCosts();
   /**
    * @note See CostFromFunc::convex in modeling_utils.cpp. Once Hessian has been implemented
@@ -220,12 +260,24 @@ void IfoptQPProblem::updateGradient()
    * }
    */
 
-  if (cost_jac.nonZeros() > 0)
-    gradient_.topRows(num_nlp_vars_) = cost_jac.toDense().transpose();
+  // Scatter the nonzeros of the cost jacobian, the costs are summed so each row adds to the gradient
+  for (Eigen::Index k = 0; k < cost_jac.outerSize(); ++k)
+  {
+    for (SparseMatrix::InnerIterator it(cost_jac, k); it; ++it)
+      cost_gradient_(it.col()) += it.value();
+  }
+
+  // The slack variable gradient is only updated when the merit coefficients change
+  assert(gradient_.rows() == num_qp_vars_);
+  gradient_.head(num_nlp_vars_) = cost_gradient_;
+}
 
+void IfoptQPProblem::updateSlackGradient()
+{
   ////////////////////////////////////////////////////////
   // Set the gradient of the constraint slack variables
   ////////////////////////////////////////////////////////
+  if (constraint_penalty_type_ == CostPenaltyType::ABSOLUTE)
   {
     Eigen::Index current_var_index = num_nlp_vars_;
     for (Eigen::Index i = 0; i < num_nlp_cnts_; i++)
@@ -266,7 +318,7 @@ void IfoptQPProblem::linearizeConstraints()
 
   // Add the slack variables to each constraint
   Eigen::Index current_column_index = num_nlp_vars_;
-  for (Eigen::Index i = 0; i < num_nlp_cnts_; i++)
+  for (Eigen::Index i = 0; i < num_nlp_cnts_ && constraint_penalty_type_ == CostPenaltyType::ABSOLUTE; i++)
   {
     if (constraint_types_[static_cast<std::size_t>(i)] == ConstraintType::EQ)
     {
@@ -286,10 +338,28 @@ void IfoptQPProblem::linearizeConstraints()
   for (Eigen::Index i = 0; i < num_qp_vars_; i++)
     tripletList.emplace_back(i + jac.rows(), i, 1);
 
-  // Insert the triplet list into the sparse matrix
-  constraint_matrix_.resize(num_qp_cnts_, num_qp_vars_);
-  constraint_matrix_.reserve(jac.nonZeros() + num_qp_vars_);
-  constraint_matrix_.setFromTriplets(tripletList.begin(), tripletList.end());  // NOLINT
+  // Insert the triplet list into the sparse matrix, reusing the pattern of the previous linearization
+  assembleSparseMatrix(constraint_matrix_, num_qp_cnts_, num_qp_vars_, tripletList);
+}
+
+void IfoptQPProblem::updateQuadraticConstraintPenalty()
+{
+  if (num_nlp_cnts_ == 0)
+    return;
+
+  Eigen::VectorXd x_initial = nlp_->GetVariableValues().head(num_nlp_vars_);
+  SparseMatrix jac = constraint_matrix_.block(0, 0, num_nlp_cnts_, num_nlp_vars_);
+  Eigen::VectorXd cnt_values = constraint_constant_ + jac * x_initial;
+  Eigen::VectorXd cnt_errors = trajopt_ifopt::calcBoundsErrors(cnt_values, constraint_bounds_);
+  calcQuadraticPenaltyTargets(
+      quadratic_penalty_targets_, quadratic_penalty_mask_, cnt_values, cnt_errors, constraint_types_);
+  addQuadraticConstraintPenalty(hessian_,
+                                gradient_,
+                                jac,
+                                cnt_errors,
+                                x_initial,
+                                constraint_types_,
+                                constraint_merit_coeff_);
 }
 
 void IfoptQPProblem::updateCostsConstantExpression()
@@ -316,8 +386,8 @@ void IfoptQPProblem::updateCostsConstantExpression()
 
   // The block excludes the slack variables
   /** @todo I am not sure this is correct because the gradient_ is not each individual cost function gradient */
-  Eigen::VectorXd result_quad = x_initial.transpose() * hessian_.block(0, 0, num_nlp_vars_, num_nlp_vars_) * x_initial;
-  Eigen::VectorXd result_lin = x_initial.transpose() * gradient_.block(0, 0, num_nlp_vars_, num_nlp_costs_);
+  Eigen::VectorXd result_quad = x_initial.transpose() * cost_hessian_ * x_initial;
+  Eigen::VectorXd result_lin = x_initial.transpose() * cost_gradient_.block(0, 0, num_nlp_vars_, num_nlp_costs_);
   cost_constant_ = cost_initial_value - result_quad - result_lin;
 }
 
@@ -358,7 +428,7 @@ void IfoptQPProblem::updateNLPConstraintBounds()
   Eigen::VectorXd cnt_bound_upper(num_nlp_cnts_);
 
   // Convert constraint bounds to VectorXd
-  std::vector<ifopt::Bounds> cnt_bounds = nlp_->GetBoundsOnConstraints();
+  const std::vector<ifopt::Bounds>& cnt_bounds = constraint_bounds_;
   for (Eigen::Index i = 0; i < num_nlp_cnts_; i++)
   {
     cnt_bound_lower[i] = cnt_bounds[static_cast<std::size_t>(i)].lower_;
@@ -368,6 +438,13 @@ void IfoptQPProblem::updateNLPConstraintBounds()
   Eigen::VectorXd linearized_cnt_lower = cnt_bound_lower - constraint_constant_;
   Eigen::VectorXd linearized_cnt_upper = cnt_bound_upper - constraint_constant_;
 
+  // The quadratic penalty replaces the constraints, the rows are left unbounded so the QP layout does not change
+  if (constraint_penalty_type_ == CostPenaltyType::SQUARED)
+  {
+    linearized_cnt_lower.setConstant(-double(INFINITY));
+    linearized_cnt_upper.setConstant(double(INFINITY));
+  }
+
   // Insert linearized constraint bounds
   bounds_lower_.topRows(num_nlp_cnts_) = linearized_cnt_lower;
   bounds_upper_.topRows(num_nlp_cnts_) = linearized_cnt_upper;
@@ -403,6 +480,9 @@ void IfoptQPProblem::updateNLPVariableBounds()
 
 void IfoptQPProblem::updateSlackVariableBounds()
 {
+  if (constraint_penalty_type_ != CostPenaltyType::ABSOLUTE)
+    return;
+
   Eigen::Index current_cnt_index = num_nlp_cnts_ + num_nlp_vars_;
   for (Eigen::Index i = 0; i < num_nlp_cnts_; i++)
   {
@@ -432,13 +512,22 @@ double IfoptQPProblem::evaluateTotalConvexCost(const Eigen::Ref<const Eigen::Vec
 
 Eigen::VectorXd IfoptQPProblem::evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
+  Eigen::VectorXd costs(num_nlp_costs_);
+  evaluateConvexCosts(var_vals, costs);
+  return costs;
+}
+
+void IfoptQPProblem::evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                         Eigen::Ref<Eigen::VectorXd> costs)
+{
+  assert(costs.rows() == num_nlp_costs_);
   if (num_nlp_costs_ == 0)
-    return {};
+    return;
 
+  // The ifopt costs are summed into a single row
+  assert(num_nlp_costs_ == 1);
   auto var_block = var_vals.head(num_nlp_vars_);
-  Eigen::VectorXd result_quad = var_block.transpose() * hessian_.block(0, 0, num_nlp_vars_, num_nlp_vars_) * var_block;
-  Eigen::VectorXd result_lin = var_block.transpose() * gradient_.block(0, 0, num_nlp_vars_, num_nlp_costs_);
-  return cost_constant_ + result_lin + result_quad;
+  costs(0) = cost_constant_(0) + cost_gradient_.dot(var_block) + evaluateQuadraticForm(cost_hessian_, var_block);
 }
 
 double IfoptQPProblem::evaluateTotalExactCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
@@ -455,14 +544,24 @@ Eigen::VectorXd IfoptQPProblem::evaluateExactCosts(const Eigen::Ref<const Eigen:
   return nlp_->GetCosts().GetValues();
 }
 
-Eigen::VectorXd IfoptQPProblem::getExactCosts() { return evaluateExactCosts(nlp_->GetOptVariables()->GetValues()); }
+Eigen::VectorXd IfoptQPProblem::getExactCosts() { return evaluateExactCosts(getVariableValues()); }
 
 Eigen::VectorXd IfoptQPProblem::evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
-  Eigen::VectorXd result_lin =
-      constraint_matrix_.block(0, 0, num_nlp_cnts_, num_nlp_vars_) * var_vals.head(num_nlp_vars_);  // NOLINT
-  Eigen::VectorXd constraint_value = constraint_constant_ + result_lin;
-  return trajopt_ifopt::calcBoundsViolations(constraint_value, nlp_->GetBoundsOnConstraints());
+  Eigen::VectorXd violations(num_nlp_cnts_);
+  evaluateConvexConstraintViolations(var_vals, violations);
+  return violations;
+}
+
+void IfoptQPProblem::evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                                        Eigen::Ref<Eigen::VectorXd> violations)
+{
+  assert(violations.rows() == num_nlp_cnts_);
+  evaluateLinearRows(violations, constraint_matrix_, 0, constraint_constant_, var_vals.head(num_nlp_vars_));
+  if (constraint_penalty_type_ == CostPenaltyType::SQUARED)
+    violations = (violations - quadratic_penalty_targets_).cwiseAbs().cwiseProduct(quadratic_penalty_mask_);
+  else
+    trajopt_ifopt::calcBoundsViolations(violations, violations, constraint_bounds_);
 }
 
 Eigen::VectorXd IfoptQPProblem::evaluateExactConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
@@ -473,7 +572,7 @@ Eigen::VectorXd IfoptQPProblem::evaluateExactConstraintViolations(const Eigen::R
 
 Eigen::VectorXd IfoptQPProblem::getExactConstraintViolations()
 {
-  return evaluateExactConstraintViolations(nlp_->GetOptVariables()->GetValues());  // NOLINT
+  return evaluateExactConstraintViolations(getVariableValues());  // NOLINT
 }
 
 void IfoptQPProblem::scaleBoxSize(double& scale)
@@ -493,10 +592,34 @@ void IfoptQPProblem::setConstraintMeritCoeff(const Eigen::Ref<const Eigen::Vecto
 {
   assert(merit_coeff.size() == num_nlp_cnts_);
   constraint_merit_coeff_ = merit_coeff;
+  updateSlackGradient();
+}
+
+void IfoptQPProblem::setConstraintPenaltyType(CostPenaltyType penalty_type)
+{
+  if (penalty_type != CostPenaltyType::ABSOLUTE && penalty_type != CostPenaltyType::SQUARED)
+    throw std::runtime_error("IfoptQPProblem: Unsupported constraint penalty type!");
+
+  constraint_penalty_type_ = penalty_type;
+  updateQPSize();
 }
 
 Eigen::VectorXd IfoptQPProblem::getBoxSize() const { return box_size_; }
 
+Eigen::MatrixX2d IfoptQPProblem::getNLPVariableBounds() const
+{
+  std::vector<ifopt::Bounds> var_bounds = nlp_->GetBoundsOnOptimizationVariables();
+  Eigen::MatrixX2d bounds(num_nlp_vars_, 2);
+  for (Eigen::Index i = 0; i < num_nlp_vars_; i++)
+  {
+    bounds(i, 0) = var_bounds[static_cast<std::size_t>(i)].lower_;
+    bounds(i, 1) = var_bounds[static_cast<std::size_t>(i)].upper_;
+  }
+  return bounds;
+}
+
+SparseMatrix IfoptQPProblem::getNLPConstraintJacobian() { return nlp_->GetJacobianOfConstraints(); }
+
 void IfoptQPProblem::print() const
 {
   Eigen::IOFormat format(3);
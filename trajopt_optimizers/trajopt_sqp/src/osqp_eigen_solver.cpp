@@ -26,6 +26,7 @@
 #include <trajopt_sqp/osqp_eigen_solver.h>
 
 #include <trajopt_common/macros.h>
+#include <algorithm>
 
 #include <OsqpEigen/OsqpEigen.h>
 
@@ -51,6 +52,14 @@ OSQPEigenSolver::~OSQPEigenSolver() = default;
 
 bool OSQPEigenSolver::init(Eigen::Index num_vars, Eigen::Index num_cnts)
 {
+  // The workspace kept by the structural sparsity mode can only be reused if the problem size is unchanged
+  if (structural_sparsity && (num_vars != num_vars_ || num_cnts != num_cnts_))
+  {
+    solver_->clearSolver();
+    solver_->data()->clearHessianMatrix();
+    solver_->data()->clearLinearConstraintsMatrix();
+  }
+
   // Set the solver size
   num_cnts_ = num_cnts;
   num_vars_ = num_vars;
@@ -64,6 +73,10 @@ bool OSQPEigenSolver::init(Eigen::Index num_vars, Eigen::Index num_cnts)
 
 bool OSQPEigenSolver::clear()
 {
+  // Keep the workspace so only the values need to be updated when the sparsity pattern does not change
+  if (structural_sparsity)
+    return true;
+
   // Clear all data
   solver_->clearSolver();
   solver_->data()->clearHessianMatrix();
@@ -183,6 +196,12 @@ Eigen::VectorXd OSQPEigenSolver::getSolution()
   return solution;
 }
 
+Eigen::VectorXd OSQPEigenSolver::getDualSolution()
+{
+  Eigen::VectorXd dual_solution = solver_->getDualSolution();
+  return dual_solution;
+}
+
 // This code is required because there is a bug in OSQP 0.6.X scs_spalloc method
 /** @todo Remove when upgrading to OSQP 1.0.0 */
 TRAJOPT_IGNORE_WARNINGS_PUSH
@@ -236,8 +255,142 @@ csc* csc_spalloc_fix(c_int m, c_int n, c_int nzmax, c_int values, c_int triplet)
 }
 TRAJOPT_IGNORE_WARNINGS_POP
 
+bool OSQPEigenSolver::CSCMatrix::samePattern(const SparseMatrix& rm) const
+{
+  if (!rm.isCompressed() || matrix.rows() != rm.rows() || matrix.cols() != rm.cols() ||
+      outer.size() != static_cast<std::size_t>(rm.outerSize() + 1) ||
+      inner.size() != static_cast<std::size_t>(rm.nonZeros()))
+    return false;
+
+  return (std::equal(outer.begin(), outer.end(), rm.outerIndexPtr()) &&
+          std::equal(inner.begin(), inner.end(), rm.innerIndexPtr()));
+}
+
+void OSQPEigenSolver::CSCMatrix::setPattern(const SparseMatrix& rm, double scale, bool upper)
+{
+  outer.assign(rm.outerIndexPtr(), rm.outerIndexPtr() + rm.outerSize() + 1);
+  inner.assign(rm.innerIndexPtr(), rm.innerIndexPtr() + rm.nonZeros());
+
+  // Store the index of each row-major value so the conversion to column-major provides the map between the two
+  SparseMatrix indices = rm;
+  for (Eigen::Index k = 0; k < indices.nonZeros(); ++k)
+    indices.valuePtr()[k] = static_cast<double>(k);
+
+  if (upper)
+    matrix = indices.triangularView<Eigen::Upper>();
+  else
+    matrix = indices;
+  matrix.makeCompressed();
+
+  value_map.resize(static_cast<std::size_t>(matrix.nonZeros()));
+  for (std::size_t k = 0; k < value_map.size(); ++k)
+    value_map[k] = static_cast<Eigen::Index>(matrix.valuePtr()[k]);
+
+  setValues(rm, scale);
+}
+
+void OSQPEigenSolver::CSCMatrix::setValues(const SparseMatrix& rm, double scale)
+{
+  const double* src = rm.valuePtr();
+  double* dst = matrix.valuePtr();
+  for (std::size_t k = 0; k < value_map.size(); ++k)
+    dst[k] = scale * src[value_map[k]];
+}
+
+bool OSQPEigenSolver::setStructuralMatrixData(bool hessian)
+{
+  const Eigen::SparseMatrix<double>& matrix = hessian ? hessian_csc_.matrix : constraint_matrix_csc_.matrix;
+
+  bool success{ false };
+  if (hessian)
+  {
+    solver_->data()->clearHessianMatrix();
+    success = solver_->data()->setHessianMatrix(matrix);
+  }
+  else
+  {
+    solver_->data()->clearLinearConstraintsMatrix();
+    success = solver_->data()->setLinearConstraintsMatrix(matrix);
+  }
+
+  if (matrix.nonZeros() == 0) /** @todo Remove when upgrading to OSQP 1.0.0 */
+  {
+    csc*& data_matrix = hessian ? solver_->data()->getData()->P : solver_->data()->getData()->A;
+    csc_spfree_fix(data_matrix);
+    data_matrix = nullptr;
+    data_matrix = csc_spalloc_fix(matrix.rows(), matrix.cols(), 0, 1, 0);
+  }
+
+  return success;
+}
+
+bool OSQPEigenSolver::resetStructuralData()
+{
+  solver_->clearSolver();
+
+  bool success{ true };
+  if (hessian_csc_.matrix.rows() == num_vars_)
+    success &= setStructuralMatrixData(true);
+
+  if (constraint_matrix_csc_.matrix.rows() == num_cnts_ && constraint_matrix_csc_.matrix.cols() == num_vars_)
+    success &= setStructuralMatrixData(false);
+
+  if (gradient_.rows() == num_vars_)
+    success &= solver_->data()->setGradient(gradient_);
+
+  if (bounds_lower_.rows() == num_cnts_ && bounds_upper_.rows() == num_cnts_)
+  {
+    success &= solver_->data()->setLowerBound(bounds_lower_);
+    success &= solver_->data()->setUpperBound(bounds_upper_);
+  }
+
+  return success;
+}
+
+bool OSQPEigenSolver::updateStructuralMatrix(const SparseMatrix& matrix, bool hessian)
+{
+  SparseMatrix compressed;
+  const SparseMatrix* rm = &matrix;
+  if (!matrix.isCompressed())
+  {
+    compressed = matrix;
+    compressed.makeCompressed();
+    rm = &compressed;
+  }
+
+  // Multiply the hessian by 2 because OSQP is multiplying by (1/2) for the objective fuction
+  CSCMatrix& csc = hessian ? hessian_csc_ : constraint_matrix_csc_;
+  const double scale = hessian ? 2.0 : 1.0;
+  if (!csc.samePattern(*rm))
+  {
+    csc.setPattern(*rm, scale, hessian);
+    if (solver_->isInitialized())
+      return resetStructuralData();
+
+    return setStructuralMatrixData(hessian);
+  }
+
+  csc.setValues(*rm, scale);
+  if (!solver_->isInitialized())
+    return setStructuralMatrixData(hessian);
+
+  // The workspace was created from the same pattern so the values can be copied directly into it
+  const auto nnz = static_cast<c_int>(csc.matrix.nonZeros());
+  if (nnz == 0)
+    return true;
+
+  OSQPWorkspace* work = &(*solver_->workspace());
+  if (hessian)
+    return (osqp_update_P(work, csc.matrix.valuePtr(), OSQP_NULL, nnz) == 0);
+
+  return (osqp_update_A(work, csc.matrix.valuePtr(), OSQP_NULL, nnz) == 0);
+}
+
 bool OSQPEigenSolver::updateHessianMatrix(const SparseMatrix& hessian)
 {
+  if (structural_sparsity)
+    return updateStructuralMatrix(hessian, true);
+
   // Clean up values close to 0
   // Also multiply by 2 because OSQP is multiplying by (1/2) for the objective fuction
   SparseMatrix cleaned = 2.0 * hessian.pruned(1e-7, 1);  // Any value < 1e-7 will be removed
@@ -307,6 +460,9 @@ bool OSQPEigenSolver::updateLinearConstraintsMatrix(const SparseMatrix& linearCo
   assert(num_cnts_ == linearConstraintsMatrix.rows());
   assert(num_vars_ == linearConstraintsMatrix.cols());
 
+  if (structural_sparsity)
+    return updateStructuralMatrix(linearConstraintsMatrix, false);
+
   solver_->data()->clearLinearConstraintsMatrix();
   SparseMatrix cleaned = linearConstraintsMatrix.pruned(1e-7, 1);  // Any value < 1e-7 will be removed
 
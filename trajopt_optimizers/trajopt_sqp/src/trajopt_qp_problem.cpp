@@ -7,6 +7,7 @@
 #include <trajopt_sqp/types.h>
 
 #include <trajopt_ifopt/utils/ifopt_utils.h>
+#include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 
 #include <utility>
 #include <iostream>
@@ -52,6 +53,8 @@ struct TrajOptQPProblem::Implementation
 
   bool initialized_{ false };
   ifopt::Composite::Ptr variables_;
+  /** @brief The storage holding the values of all variable sets, nullptr if they are not stored contiguously */
+  trajopt_ifopt::JointPositionStorage::Ptr variable_storage_;
   ifopt::Composite constraints_;
   ifopt::Composite squared_costs_;
   ifopt::Composite hinge_costs_;
@@ -61,6 +64,7 @@ struct TrajOptQPProblem::Implementation
   Eigen::VectorXd squared_costs_target_;
 
   std::vector<ConstraintType> constraint_types_;
+  CostPenaltyType constraint_penalty_type_{ CostPenaltyType::ABSOLUTE };
 
   Eigen::Index num_qp_vars_{ 0 };
   Eigen::Index num_qp_cnts_{ 0 };
@@ -71,6 +75,10 @@ struct TrajOptQPProblem::Implementation
   /** @brief Box size - constraint is set at current_val +/- box_size */
   Eigen::VectorXd box_size_;
   Eigen::VectorXd constraint_merit_coeff_;
+  /** @brief The values the quadratic constraint penalty pulls each linearized constraint towards */
+  Eigen::VectorXd quadratic_penalty_targets_;
+  /** @brief One if the quadratic constraint penalty applies to the constraint, zero for satisfied inequalities */
+  Eigen::VectorXd quadratic_penalty_mask_;
 
   SparseMatrix hessian_;
   Eigen::VectorXd gradient_;
@@ -82,6 +90,17 @@ struct TrajOptQPProblem::Implementation
   // This should be the center of the bounds
   Eigen::VectorXd constraint_constant_;
 
+  /** @brief The bounds of the constraints and the hinge and absolute costs, cached by convexify() */
+  std::vector<ifopt::Bounds> constraint_bounds_;
+  std::vector<ifopt::Bounds> hinge_cost_bounds_;
+  std::vector<ifopt::Bounds> abs_cost_bounds_;
+
+  /** @brief If true, hinge costs which cannot become positive in the trust box are screened by convexify() */
+  bool screen_inactive_hinges_{ false };
+  /** @brief Flags the hinge cost rows screened by the last linearization */
+  std::vector<bool> screened_hinges_;
+  Eigen::Index num_screened_hinges_{ 0 };
+
   void addVariableSet(const std::shared_ptr<ifopt::VariableSet>& variable_set);
 
   void addConstraintSet(const std::shared_ptr<ifopt::ConstraintSet>& constraint_set);
@@ -98,12 +117,17 @@ struct TrajOptQPProblem::Implementation
 
   Eigen::VectorXd evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals);
 
+  void evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals, Eigen::Ref<Eigen::VectorXd> costs);
+
   double evaluateTotalExactCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals);
 
   Eigen::VectorXd evaluateExactCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals);
 
   Eigen::VectorXd evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals);
 
+  void evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                          Eigen::Ref<Eigen::VectorXd> violations);
+
   Eigen::VectorXd evaluateExactConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals);
 
   void scaleBoxSize(double& scale);
@@ -112,6 +136,8 @@ struct TrajOptQPProblem::Implementation
 
   void setConstraintMeritCoeff(const Eigen::Ref<const Eigen::VectorXd>& merit_coeff);
 
+  void setConstraintPenaltyType(CostPenaltyType penalty_type);
+
   void print() const;
 
   Eigen::Index getNumNLPVars() const;
@@ -131,6 +157,15 @@ struct TrajOptQPProblem::Implementation
    */
   void linearizeConstraints();
 
+  /**
+   * @brief Helper that adds the quadratic penalty of the NLP constraints to the hessian and gradient
+   * @details Called by convexify() when the constraint penalty type is SQUARED
+   */
+  void updateQuadraticConstraintPenalty();
+
+  /** @brief Helper that updates the number of QP variables and constraints for the constraint penalty type */
+  void updateQPSize();
+
   /**
    * @brief Helper that updates the NLP constraint bounds (top section)
    * @details Called by convexify()
@@ -183,6 +218,7 @@ struct TrajOptQPProblem::Implementation
 void TrajOptQPProblem::Implementation::addVariableSet(const std::shared_ptr<ifopt::VariableSet>& variable_set)
 {
   variables_->AddComponent(variable_set);
+  variable_storage_ = nullptr;
   initialized_ = false;
 }
 
@@ -246,11 +282,8 @@ void TrajOptQPProblem::Implementation::setup()
 {
   hinge_constraints_.ClearComponents();
   abs_constraints_.ClearComponents();
+  variable_storage_ = trajopt_ifopt::getContiguousStorage(*variables_);
   squared_costs_target_ = Eigen::VectorXd::Zero(squared_costs_.GetRows());
-  // Hinge cost adds a variable and an inequality constraint which equals two constraints added to the qp problem
-  // Absolute cost add two variables and an equality constraint which equals three constraints added to the qp problem
-  num_qp_vars_ = getNumNLPVars() + hinge_costs_.GetRows() + (2L * abs_costs_.GetRows());
-  num_qp_cnts_ = getNumNLPConstraints() + getNumNLPVars() + (2L * hinge_costs_.GetRows()) + (3L * abs_costs_.GetRows());
   box_size_ = Eigen::VectorXd::Constant(getNumNLPVars(), 1e-1);
   constraint_merit_coeff_ = Eigen::VectorXd::Constant(getNumNLPConstraints(), 10);
   constraint_constant_ = Eigen::VectorXd::Zero(getNumNLPConstraints() + hinge_costs_.GetRows() + abs_costs_.GetRows());
@@ -320,40 +353,65 @@ void TrajOptQPProblem::Implementation::setup()
   for (std::size_t i = 0; i < static_cast<std::size_t>(nlp_bounds_diff.size()); i++)
   {
     if (std::abs(nlp_bounds_diff[static_cast<Eigen::Index>(i)]) < 1e-3)
-    {
       constraint_types_[i] = ConstraintType::EQ;
-      // Add 2 slack variables for L1 loss
-      num_qp_vars_ += 2;
-      num_qp_cnts_ += 2;
-    }
     else
-    {
       constraint_types_[i] = ConstraintType::INEQ;
-      // Add 1 slack variable for hinge loss
-      num_qp_vars_ += 1;
-      num_qp_cnts_ += 1;
+  }
+
+  updateQPSize();
+
+  // Set initialized
+  initialized_ = true;
+}
+
+void TrajOptQPProblem::Implementation::updateQPSize()
+{
+  // Hinge cost adds a variable and an inequality constraint which equals two constraints added to the qp problem
+  // Absolute cost add two variables and an equality constraint which equals three constraints added to the qp problem
+  num_qp_vars_ = getNumNLPVars() + hinge_costs_.GetRows() + (2L * abs_costs_.GetRows());
+  num_qp_cnts_ = getNumNLPConstraints() + getNumNLPVars() + (2L * hinge_costs_.GetRows()) + (3L * abs_costs_.GetRows());
+  if (constraint_penalty_type_ == CostPenaltyType::ABSOLUTE)
+  {
+    for (const auto& constraint_type : constraint_types_)
+    {
+      // Add 2 slack variables for L1 loss or 1 slack variable for hinge loss
+      const Eigen::Index num_slack = (constraint_type == ConstraintType::EQ) ? 2 : 1;
+      num_qp_vars_ += num_slack;
+      num_qp_cnts_ += num_slack;
     }
   }
 
   // Initialize the constraint bounds
   bounds_lower_ = Eigen::VectorXd::Constant(num_qp_cnts_, -double(INFINITY));
   bounds_upper_ = Eigen::VectorXd::Constant(num_qp_cnts_, double(INFINITY));
-
-  // Set initialized
-  initialized_ = true;
 }
 
 void TrajOptQPProblem::Implementation::setVariables(const double* x)
 {
-  variables_->SetVariables(Eigen::Map<const Eigen::VectorXd>(x, variables_->GetRows()));
+  // Contiguous variable sets are set with a single copy instead of a copy per set
+  if (variable_storage_ != nullptr)
+    variable_storage_->values = Eigen::Map<const Eigen::VectorXd>(x, variable_storage_->values.size());
+  else
+    variables_->SetVariables(Eigen::Map<const Eigen::VectorXd>(x, variables_->GetRows()));
 }
 
-Eigen::VectorXd TrajOptQPProblem::Implementation::getVariableValues() const { return variables_->GetValues(); }
+Eigen::VectorXd TrajOptQPProblem::Implementation::getVariableValues() const
+{
+  if (variable_storage_ != nullptr)
+    return variable_storage_->values;
+
+  return variables_->GetValues();
+}
 
 void TrajOptQPProblem::Implementation::convexify()
 {
   assert(initialized_);  // NOLINT
 
+  // Cache the bounds so evaluating the convexified problem does not allocate
+  constraint_bounds_ = constraints_.GetBounds();
+  hinge_cost_bounds_ = hinge_costs_.GetBounds();
+  abs_cost_bounds_ = abs_costs_.GetBounds();
+
   // This must be called prior to updateGradient
   convexifyCosts();  // NOLINT
 
@@ -363,6 +421,9 @@ void TrajOptQPProblem::Implementation::convexify()
 
   updateConstraintsConstantExpression();
 
+  if (constraint_penalty_type_ == CostPenaltyType::SQUARED)
+    updateQuadraticConstraintPenalty();
+
   updateNLPConstraintBounds();
 
   updateNLPVariableBounds();
@@ -372,42 +433,45 @@ void TrajOptQPProblem::Implementation::convexify()
 
 Eigen::VectorXd TrajOptQPProblem::Implementation::evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
+  Eigen::VectorXd costs(getNumNLPCosts());
+  evaluateConvexCosts(var_vals, costs);
+  return costs;
+}
+
+void TrajOptQPProblem::Implementation::evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                                           Eigen::Ref<Eigen::VectorXd> costs)
+{
+  assert(costs.rows() == getNumNLPCosts());
   if (getNumNLPCosts() == 0)
-    return {};
+    return;
 
-  Eigen::VectorXd var_block = var_vals.head(getNumNLPVars());
-  Eigen::VectorXd costs = Eigen::VectorXd::Zero(getNumNLPCosts());
+  auto var_block = var_vals.head(getNumNLPVars());
   if (squared_costs_.GetRows() > 0)
   {
-    costs.head(squared_costs_.GetRows()) = squared_objective_nlp_.values(var_block);
+    squared_objective_nlp_.values(costs.head(squared_costs_.GetRows()), var_block);
     assert(!(costs.head(squared_costs_.GetRows()).array() < -1e-8).any());
   }
 
   if (hinge_costs_.GetRows() > 0)
   {
-    Eigen::VectorXd hinge_cnt_constant = constraint_constant_.topRows(hinge_costs_.GetRows());
-    auto hinge_cnt_jac = constraint_matrix_.block(0, 0, hinge_constraints_.GetRows(), getNumNLPVars());
-
-    Eigen::VectorXd hinge_convex_value = hinge_cnt_constant + hinge_cnt_jac * var_block;
-    Eigen::VectorXd hinge_cost = trajopt_ifopt::calcBoundsViolations(hinge_convex_value, hinge_costs_.GetBounds());
-
-    costs.middleRows(squared_costs_.GetRows(), hinge_costs_.GetRows()) = hinge_cost;
-    assert(!(costs.middleRows(squared_costs_.GetRows(), hinge_costs_.GetRows()).array() < -1e-8).any());
+    auto hinge_cost = costs.middleRows(squared_costs_.GetRows(), hinge_costs_.GetRows());
+    evaluateLinearRows(
+        hinge_cost, constraint_matrix_, 0, constraint_constant_.topRows(hinge_costs_.GetRows()), var_block);
+    trajopt_ifopt::calcBoundsViolations(hinge_cost, hinge_cost, hinge_cost_bounds_);
+    assert(!(hinge_cost.array() < -1e-8).any());
   }
 
   if (abs_costs_.GetRows() > 0)
   {
-    Eigen::VectorXd abs_cnt_constant = constraint_constant_.middleRows(hinge_costs_.GetRows(), abs_costs_.GetRows());
-    auto abs_cnt_jac = constraint_matrix_.block(hinge_costs_.GetRows(), 0, abs_constraints_.GetRows(), getNumNLPVars());
-
-    Eigen::VectorXd abs_convex_value = abs_cnt_constant + abs_cnt_jac * var_block;
-    Eigen::VectorXd abs_cost = trajopt_ifopt::calcBoundsViolations(abs_convex_value, abs_costs_.GetBounds()).cwiseAbs();
-
-    costs.middleRows(squared_costs_.GetRows() + hinge_costs_.GetRows(), abs_costs_.GetRows()) = abs_cost;
-    assert(!(costs.middleRows(squared_costs_.GetRows() + hinge_costs_.GetRows(), abs_costs_.GetRows()).array() < -1e-8)
-                .any());
+    auto abs_cost = costs.middleRows(squared_costs_.GetRows() + hinge_costs_.GetRows(), abs_costs_.GetRows());
+    evaluateLinearRows(abs_cost,
+                       constraint_matrix_,
+                       hinge_costs_.GetRows(),
+                       constraint_constant_.middleRows(hinge_costs_.GetRows(), abs_costs_.GetRows()),
+                       var_block);
+    trajopt_ifopt::calcBoundsViolations(abs_cost, abs_cost, abs_cost_bounds_);
+    assert(!(abs_cost.array() < -1e-8).any());
   }
-  return costs;
 }
 
 double TrajOptQPProblem::Implementation::evaluateTotalExactCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
@@ -478,12 +542,26 @@ Eigen::VectorXd TrajOptQPProblem::Implementation::evaluateExactCosts(const Eigen
 Eigen::VectorXd
 TrajOptQPProblem::Implementation::evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
+  Eigen::VectorXd violations(getNumNLPConstraints());
+  evaluateConvexConstraintViolations(var_vals, violations);
+  return violations;
+}
+
+void TrajOptQPProblem::Implementation::evaluateConvexConstraintViolations(
+    const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+    Eigen::Ref<Eigen::VectorXd> violations)
+{
+  assert(violations.rows() == getNumNLPConstraints());
   Eigen::Index row_index = hinge_constraints_.GetRows() + abs_costs_.GetRows();
-  // NOLINTNEXTLINE
-  Eigen::VectorXd result_lin = constraint_matrix_.block(row_index, 0, getNumNLPConstraints(), getNumNLPVars()) *
-                               var_vals.head(getNumNLPVars());  // NOLINT
-  Eigen::VectorXd constraint_value = constraint_constant_.middleRows(row_index, getNumNLPConstraints()) + result_lin;
-  return trajopt_ifopt::calcBoundsViolations(constraint_value, constraints_.GetBounds());
+  evaluateLinearRows(violations,
+                     constraint_matrix_,
+                     row_index,
+                     constraint_constant_.middleRows(row_index, getNumNLPConstraints()),
+                     var_vals.head(getNumNLPVars()));
+  if (constraint_penalty_type_ == CostPenaltyType::SQUARED)
+    violations = (violations - quadratic_penalty_targets_).cwiseAbs().cwiseProduct(quadratic_penalty_mask_);
+  else
+    trajopt_ifopt::calcBoundsViolations(violations, violations, constraint_bounds_);
 }
 
 Eigen::VectorXd
@@ -513,6 +591,16 @@ void TrajOptQPProblem::Implementation::setConstraintMeritCoeff(const Eigen::Ref<
   constraint_merit_coeff_ = merit_coeff;
 }
 
+void TrajOptQPProblem::Implementation::setConstraintPenaltyType(CostPenaltyType penalty_type)
+{
+  if (penalty_type != CostPenaltyType::ABSOLUTE && penalty_type != CostPenaltyType::SQUARED)
+    throw std::runtime_error("Unsupport constraint CostPenaltyType!");
+
+  constraint_penalty_type_ = penalty_type;
+  if (initialized_)
+    updateQPSize();
+}
+
 void TrajOptQPProblem::Implementation::print() const
 {
   Eigen::IOFormat format(3);
@@ -559,7 +647,7 @@ Eigen::Index TrajOptQPProblem::Implementation::getNumNLPVars() const { return va
 
 Eigen::Index TrajOptQPProblem::Implementation::getNumNLPConstraints() const
 {
-  return static_cast<Eigen::Index>(constraints_.GetBounds().size());
+  return constraints_.GetRows();
 }
 
 Eigen::Index TrajOptQPProblem::Implementation::getNumNLPCosts() const
@@ -579,7 +667,7 @@ void TrajOptQPProblem::Implementation::convexifyCosts()
   ////////////////////////////////////////////////////////
   gradient_ = Eigen::VectorXd::Zero(num_qp_vars_);
 
-  Eigen::VectorXd x_initial = variables_->GetValues().head(getNumNLPVars());
+  Eigen::VectorXd x_initial = getVariableValues();
 
   // Create triplet list of nonzero gradients
   std::vector<Eigen::Triplet<double>> grad_triplet_list;
@@ -670,7 +758,7 @@ void TrajOptQPProblem::Implementation::convexifyCosts()
   ////////////////////////////////////////////////////////
   // Set the gradient of the constraint slack variables
   ////////////////////////////////////////////////////////
-  for (Eigen::Index i = 0; i < getNumNLPConstraints(); i++)
+  for (Eigen::Index i = 0; i < getNumNLPConstraints() && constraint_penalty_type_ == CostPenaltyType::ABSOLUTE; i++)
   {
     if (constraint_types_[static_cast<std::size_t>(i)] == ConstraintType::EQ)
     {
@@ -697,9 +785,34 @@ void TrajOptQPProblem::Implementation::linearizeConstraints()
                                                abs_cnt_jac.nonZeros() + num_qp_vars_) *
                       3);
 
+  // Screen the hinge costs which stay inactive over the whole trust box
+  screened_hinges_.assign(static_cast<std::size_t>(hinge_cnt_jac.rows()), false);
+  num_screened_hinges_ = 0;
+  if (screen_inactive_hinges_ && hinge_cnt_jac.rows() > 0)
+  {
+    Eigen::VectorXd hinge_cnt_values = hinge_constraints_.GetValues();
+    for (Eigen::Index i = 0; i < hinge_cnt_jac.rows(); ++i)
+    {
+      // The largest change of the linearized hinge inside the trust box
+      double max_change{ 0 };
+      for (SparseMatrix::InnerIterator it(hinge_cnt_jac, i); it; ++it)
+        max_change += std::abs(it.value()) * box_size_[it.col()];
+
+      const ifopt::Bounds& bounds = hinge_cost_bounds_[static_cast<std::size_t>(i)];
+      if (hinge_cnt_values[i] - max_change >= bounds.lower_ && hinge_cnt_values[i] + max_change <= bounds.upper_)
+      {
+        screened_hinges_[static_cast<std::size_t>(i)] = true;
+        ++num_screened_hinges_;
+      }
+    }
+  }
+
   // Add hinge solver constraint jacobian to triplet list
   for (int k = 0; k < hinge_cnt_jac.outerSize(); ++k)
   {
+    if (screened_hinges_[static_cast<std::size_t>(k)])
+      continue;
+
     for (SparseMatrix::InnerIterator it(hinge_cnt_jac, k); it; ++it)
     {
       tripletList.emplace_back(it.row(), it.col(), it.value());
@@ -741,7 +854,10 @@ void TrajOptQPProblem::Implementation::linearizeConstraints()
 
   // Add the slack variables to each constraint
   current_row_index += abs_costs_.GetRows();
-  for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(constraint_types_.size()); i++)
+  // The quadratic constraint penalty does not use slack variables
+  const Eigen::Index num_slack_cnts =
+      (constraint_penalty_type_ == CostPenaltyType::ABSOLUTE) ? static_cast<Eigen::Index>(constraint_types_.size()) : 0;
+  for (Eigen::Index i = 0; i < num_slack_cnts; i++)
   {
     if (constraint_types_[static_cast<std::size_t>(i)] == ConstraintType::EQ)
     {
@@ -760,10 +876,29 @@ void TrajOptQPProblem::Implementation::linearizeConstraints()
   for (Eigen::Index i = 0; i < num_qp_vars_; i++)
     tripletList.emplace_back(current_row_index + i, i, 1);
 
-  // Insert the triplet list into the sparse matrix
-  constraint_matrix_.resize(num_qp_cnts_, num_qp_vars_);
-  constraint_matrix_.reserve(nlp_cnt_jac.nonZeros() + hinge_cnt_jac.nonZeros() + abs_cnt_jac.nonZeros() + num_qp_vars_);
-  constraint_matrix_.setFromTriplets(tripletList.begin(), tripletList.end());  // NOLINT
+  // Insert the triplet list into the sparse matrix, reusing the pattern of the previous linearization
+  assembleSparseMatrix(constraint_matrix_, num_qp_cnts_, num_qp_vars_, tripletList);
+}
+
+void TrajOptQPProblem::Implementation::updateQuadraticConstraintPenalty()
+{
+  if (getNumNLPConstraints() == 0)
+    return;
+
+  Eigen::VectorXd x_initial = getVariableValues();
+  Eigen::Index row_index = hinge_constraints_.GetRows() + abs_constraints_.GetRows();
+  SparseMatrix jac = constraint_matrix_.block(row_index, 0, getNumNLPConstraints(), getNumNLPVars());
+  Eigen::VectorXd cnt_values = constraint_constant_.middleRows(row_index, getNumNLPConstraints()) + jac * x_initial;
+  Eigen::VectorXd cnt_errors = trajopt_ifopt::calcBoundsErrors(cnt_values, constraints_.GetBounds());
+  calcQuadraticPenaltyTargets(
+      quadratic_penalty_targets_, quadratic_penalty_mask_, cnt_values, cnt_errors, constraint_types_);
+  addQuadraticConstraintPenalty(hessian_,
+                                gradient_,
+                                jac,
+                                cnt_errors,
+                                x_initial,
+                                constraint_types_,
+                                constraint_merit_coeff_);
 }
 
 void TrajOptQPProblem::Implementation::updateConstraintsConstantExpression()
@@ -773,7 +908,7 @@ void TrajOptQPProblem::Implementation::updateConstraintsConstantExpression()
     return;
 
   // Get values about which we will linearize
-  Eigen::VectorXd x_initial = variables_->GetValues().head(getNumNLPVars());
+  Eigen::VectorXd x_initial = getVariableValues();
   Eigen::Index current_row_index = 0;
   if (hinge_constraints_.GetRows() > 0)
   {  // Get values about which we will linearize
@@ -888,6 +1023,13 @@ void TrajOptQPProblem::Implementation::updateNLPConstraintBounds()
   Eigen::VectorXd linearized_cnt_lower = cnt_bound_lower - constraint_constant_;
   Eigen::VectorXd linearized_cnt_upper = cnt_bound_upper - constraint_constant_;
 
+  // The quadratic penalty replaces the NLP constraints, the rows are left unbounded so the QP layout does not change
+  if (constraint_penalty_type_ == CostPenaltyType::SQUARED)
+  {
+    linearized_cnt_lower.tail(getNumNLPConstraints()).setConstant(-double(INFINITY));
+    linearized_cnt_upper.tail(getNumNLPConstraints()).setConstant(double(INFINITY));
+  }
+
   // Insert linearized constraint bounds
   bounds_lower_.topRows(total_num_cnt) = linearized_cnt_lower;
   bounds_upper_.topRows(total_num_cnt) = linearized_cnt_upper;
@@ -896,7 +1038,7 @@ void TrajOptQPProblem::Implementation::updateNLPConstraintBounds()
 void TrajOptQPProblem::Implementation::updateNLPVariableBounds()
 {
   // This is eqivalent to BasicTrustRegionSQP::setTrustBoxConstraints
-  Eigen::VectorXd x_initial = variables_->GetValues();
+  Eigen::VectorXd x_initial = getVariableValues();
 
   // Calculate box constraints
   Eigen::VectorXd lower_box_cnt = x_initial - box_size_;
@@ -941,7 +1083,7 @@ void TrajOptQPProblem::Implementation::updateSlackVariableBounds()
     bounds_upper_[current_cnt_index++] = double(INFINITY);
   }
 
-  for (Eigen::Index i = 0; i < getNumNLPConstraints(); i++)
+  for (Eigen::Index i = 0; i < getNumNLPConstraints() && constraint_penalty_type_ == CostPenaltyType::ABSOLUTE; i++)
   {
     if (constraint_types_[static_cast<std::size_t>(i)] == ConstraintType::EQ)
     {
@@ -999,6 +1141,12 @@ Eigen::VectorXd TrajOptQPProblem::evaluateConvexCosts(const Eigen::Ref<const Eig
   return impl_->evaluateConvexCosts(var_vals);
 }
 
+void TrajOptQPProblem::evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                           Eigen::Ref<Eigen::VectorXd> costs)
+{
+  impl_->evaluateConvexCosts(var_vals, costs);
+}
+
 double TrajOptQPProblem::evaluateTotalExactCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
   return impl_->evaluateTotalExactCost(var_vals);
@@ -1009,13 +1157,19 @@ Eigen::VectorXd TrajOptQPProblem::evaluateExactCosts(const Eigen::Ref<const Eige
   return impl_->evaluateExactCosts(var_vals);
 }
 
-Eigen::VectorXd TrajOptQPProblem::getExactCosts() { return evaluateExactCosts(impl_->variables_->GetValues()); }
+Eigen::VectorXd TrajOptQPProblem::getExactCosts() { return evaluateExactCosts(getVariableValues()); }
 
 Eigen::VectorXd TrajOptQPProblem::evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
   return impl_->evaluateConvexConstraintViolations(var_vals);
 }
 
+void TrajOptQPProblem::evaluateConvexConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals,
+                                                          Eigen::Ref<Eigen::VectorXd> violations)
+{
+  impl_->evaluateConvexConstraintViolations(var_vals, violations);
+}
+
 Eigen::VectorXd TrajOptQPProblem::evaluateExactConstraintViolations(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
   return impl_->evaluateExactConstraintViolations(var_vals);
@@ -1023,7 +1177,7 @@ Eigen::VectorXd TrajOptQPProblem::evaluateExactConstraintViolations(const Eigen:
 
 Eigen::VectorXd TrajOptQPProblem::getExactConstraintViolations()
 {
-  return evaluateExactConstraintViolations(impl_->variables_->GetValues());  // NOLINT
+  return evaluateExactConstraintViolations(getVariableValues());  // NOLINT
 }
 
 void TrajOptQPProblem::scaleBoxSize(double& scale) { impl_->scaleBoxSize(scale); }
@@ -1035,8 +1189,45 @@ void TrajOptQPProblem::setConstraintMeritCoeff(const Eigen::Ref<const Eigen::Vec
   impl_->setConstraintMeritCoeff(merit_coeff);
 }
 
+void TrajOptQPProblem::setConstraintPenaltyType(CostPenaltyType penalty_type)
+{
+  impl_->setConstraintPenaltyType(penalty_type);
+}
+
+CostPenaltyType TrajOptQPProblem::getConstraintPenaltyType() const
+{
+  return std::as_const<Implementation>(*impl_).constraint_penalty_type_;
+}
+
 Eigen::VectorXd TrajOptQPProblem::getBoxSize() const { return std::as_const<Implementation>(*impl_).box_size_; }
 
+Eigen::MatrixX2d TrajOptQPProblem::getNLPVariableBounds() const
+{
+  std::vector<ifopt::Bounds> var_bounds = impl_->variables_->GetBounds();
+  Eigen::MatrixX2d bounds(static_cast<Eigen::Index>(var_bounds.size()), 2);
+  for (Eigen::Index i = 0; i < bounds.rows(); i++)
+  {
+    bounds(i, 0) = var_bounds[static_cast<std::size_t>(i)].lower_;
+    bounds(i, 1) = var_bounds[static_cast<std::size_t>(i)].upper_;
+  }
+  return bounds;
+}
+
+SparseMatrix TrajOptQPProblem::getNLPConstraintJacobian() { return impl_->constraints_.GetJacobian(); }
+
+Eigen::Index TrajOptQPProblem::getNLPConstraintQPRowOffset() const
+{
+  // The hinge and absolute cost constraints are stored above the NLP constraints
+  return (impl_->hinge_constraints_.GetRows() + impl_->abs_constraints_.GetRows());
+}
+
+void TrajOptQPProblem::setScreenInactiveHinges(bool enable) { impl_->screen_inactive_hinges_ = enable; }
+
+Eigen::Index TrajOptQPProblem::getNumScreenedHinges() const
+{
+  return std::as_const<Implementation>(*impl_).num_screened_hinges_;
+}
+
 void TrajOptQPProblem::print() const { std::as_const<Implementation>(*impl_).print(); }
 
 Eigen::Index TrajOptQPProblem::getNumNLPVars() const { return std::as_const<Implementation>(*impl_).getNumNLPVars(); }
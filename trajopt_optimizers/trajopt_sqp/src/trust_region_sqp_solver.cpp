@@ -32,9 +32,12 @@
 #include <trajopt_sqp/qp_problem.h>
 #include <trajopt_sqp/qp_solver.h>
 #include <trajopt_sqp/sqp_callback.h>
+#include <trajopt_common/collision_types.h>
 
 #include <console_bridge/console.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 namespace trajopt_sqp
 {
@@ -45,13 +48,23 @@ TrustRegionSQPSolver::TrustRegionSQPSolver(QPSolver::Ptr qp_solver) : qp_solver(
 bool TrustRegionSQPSolver::init(QPProblem::Ptr qp_prob)
 {
   qp_problem = std::move(qp_prob);
+  qp_problem->setConstraintPenaltyType(params.quadratic_constraint_penalty ? CostPenaltyType::SQUARED :
+                                                                             CostPenaltyType::ABSOLUTE);
 
   // Initialize optimization parameters
   results_ = SQPResults(qp_problem->getNumNLPVars(), qp_problem->getNumNLPConstraints(), qp_problem->getNumNLPCosts());
   results_.best_var_vals = qp_problem->getVariableValues();
+  results_.constraint_names = qp_problem->getNLPConstraintNames();
+  results_.cost_names = qp_problem->getNLPCostNames();
   results_.merit_error_coeffs =
       Eigen::VectorXd::Constant(qp_problem->getNumNLPConstraints(), params.initial_merit_error_coeff);
 
+  if (params.automatic_scaling)
+    calcAutomaticScaling();
+
+  if (collision_continuation_)
+    collision_continuation_->reset();
+
   // Evaluate exact constraint violations (expensive)
   results_.best_costs = qp_problem->getExactCosts();
 
@@ -65,21 +78,146 @@ bool TrustRegionSQPSolver::init(QPProblem::Ptr qp_prob)
 
 void TrustRegionSQPSolver::setBoxSize(double box_size)
 {
-  qp_problem->setBoxSize(Eigen::VectorXd::Constant(qp_problem->getNumNLPVars(), box_size));
+  qp_problem->setBoxSize(box_size * results_.box_scaling);
   results_.box_size = qp_problem->getBoxSize();
 }
 
+double TrustRegionSQPSolver::getBoxSize() const
+{
+  if (results_.box_size.size() == 0)
+    return 0;
+
+  return results_.box_size.cwiseQuotient(results_.box_scaling).maxCoeff();
+}
+
+/**
+ * @brief Scale each value relative to the median of the valid values
+ * @details Values that are not finite and positive get a scale of one
+ * @param values The values to scale
+ * @param max_scaling The scale is limited to [1 / max_scaling, max_scaling]
+ * @return The scale of each value
+ */
+static Eigen::VectorXd calcRelativeScaling(const Eigen::Ref<const Eigen::VectorXd>& values, double max_scaling)
+{
+  std::vector<double> valid;
+  valid.reserve(static_cast<std::size_t>(values.size()));
+  for (Eigen::Index i = 0; i < values.size(); ++i)
+  {
+    if (std::isfinite(values[i]) && values[i] > 0)
+      valid.push_back(values[i]);
+  }
+
+  Eigen::VectorXd scaling = Eigen::VectorXd::Ones(values.size());
+  if (valid.empty())
+    return scaling;
+
+  auto median_it = valid.begin() + static_cast<std::ptrdiff_t>(valid.size() / 2);
+  std::nth_element(valid.begin(), median_it, valid.end());
+  const double median = *median_it;
+  for (Eigen::Index i = 0; i < values.size(); ++i)
+  {
+    if (std::isfinite(values[i]) && values[i] > 0)
+      scaling[i] = std::clamp(values[i] / median, 1.0 / max_scaling, max_scaling);
+  }
+  return scaling;
+}
+
+void TrustRegionSQPSolver::calcAutomaticScaling()
+{
+  // Variables with a larger range get a larger trust region
+  Eigen::MatrixX2d var_bounds = qp_problem->getNLPVariableBounds();
+  results_.box_scaling = calcRelativeScaling(var_bounds.col(1) - var_bounds.col(0), params.max_automatic_scaling);
+
+  // Constraints with a larger gradient get a smaller merit coefficient so a violation of each costs about the same
+  if (qp_problem->getNumNLPConstraints() == 0)
+    return;
+
+  SparseMatrix jac = qp_problem->getNLPConstraintJacobian();
+  Eigen::VectorXd row_norms = Eigen::VectorXd::Zero(jac.rows());
+  for (int k = 0; k < jac.outerSize(); ++k)  // NOLINT
+  {
+    for (SparseMatrix::InnerIterator it(jac, k); it; ++it)
+      row_norms[it.row()] = std::max(row_norms[it.row()], std::abs(it.value()));
+  }
+  results_.merit_error_coeffs =
+      results_.merit_error_coeffs.cwiseQuotient(calcRelativeScaling(row_norms, params.max_automatic_scaling));
+}
+
 void TrustRegionSQPSolver::constraintMeritCoeffChanged()
 {
   qp_problem->setConstraintMeritCoeff(results_.merit_error_coeffs);
 
   // Recalculate the best exact merit because merit coeffs may have changed
-  results_.best_exact_merit =
-      results_.best_costs.sum() + results_.best_constraint_violations.dot(results_.merit_error_coeffs);
+  results_.best_exact_merit = calcMerit(results_.best_costs, results_.best_constraint_violations);
+}
+
+double TrustRegionSQPSolver::calcMerit(const Eigen::Ref<const Eigen::VectorXd>& costs,
+                                       const Eigen::Ref<const Eigen::VectorXd>& constraint_violations) const
+{
+  if (qp_problem->getConstraintPenaltyType() == CostPenaltyType::SQUARED)
+    return costs.sum() + constraint_violations.cwiseAbs2().dot(results_.merit_error_coeffs);
+
+  return costs.sum() + constraint_violations.dot(results_.merit_error_coeffs);
 }
 
 void TrustRegionSQPSolver::registerCallback(const SQPCallback::Ptr& callback) { callbacks_.push_back(callback); }
 
+void TrustRegionSQPSolver::setCollisionContinuation(std::shared_ptr<trajopt_common::CollisionContinuation> continuation)
+{
+  collision_continuation_ = std::move(continuation);
+}
+
+void TrustRegionSQPSolver::updateCollisionContinuation()
+{
+  if (!collision_continuation_ || collision_continuation_->isComplete())
+    return;
+
+  // Progress is measured on a log scale from the initial to the minimum trust region size
+  double progress = 1;
+  const double range = params.initial_trust_box_size / params.min_trust_box_size;
+  if (range > 1 && getBoxSize() > 0)
+    progress = std::log(params.initial_trust_box_size / getBoxSize()) / std::log(range);
+
+  if (collision_continuation_->update(progress))
+    collisionContinuationChanged();
+}
+
+bool TrustRegionSQPSolver::completeCollisionContinuation()
+{
+  if (!collision_continuation_ || collision_continuation_->isComplete())
+    return false;
+
+  CONSOLE_BRIDGE_logInform("Applying the target collision margins and coefficients");
+  collision_continuation_->update(1);
+  collisionContinuationChanged();
+  setBoxSize(fmax(getBoxSize(), params.min_trust_box_size / params.trust_shrink_ratio * 1.5));
+  return true;
+}
+
+bool TrustRegionSQPSolver::completeQuadraticConstraintPenalty()
+{
+  if (qp_problem->getConstraintPenaltyType() != CostPenaltyType::SQUARED)
+    return false;
+
+  CONSOLE_BRIDGE_logInform("Switching from the quadratic to the exact constraint penalty");
+  qp_problem->setConstraintPenaltyType(CostPenaltyType::ABSOLUTE);
+
+  // The merit of the best solution changes with the penalty
+  constraintMeritCoeffChanged();
+  return true;
+}
+
+void TrustRegionSQPSolver::collisionContinuationChanged()
+{
+  CONSOLE_BRIDGE_logDebug("Collision continuation scale: %.3f", collision_continuation_->scale);
+
+  // The collision terms changed so the best solution must be evaluated again
+  qp_problem->setVariables(results_.best_var_vals.data());
+  results_.best_costs = qp_problem->getExactCosts();
+  results_.best_constraint_violations = qp_problem->getExactConstraintViolations();
+  constraintMeritCoeffChanged();
+}
+
 const SQPStatus& TrustRegionSQPSolver::getStatus() { return status_; }
 
 const SQPResults& TrustRegionSQPSolver::getResults() { return results_; }
@@ -123,6 +261,25 @@ void TrustRegionSQPSolver::solve(const QPProblem::Ptr& qp_problem)
         break;
     }
 
+    // The constraints are only checked with the target collision margins, this does not count as a penalty iteration
+    if (status_ != SQPStatus::ITERATION_LIMIT && status_ != SQPStatus::OPT_TIME_LIMIT &&
+        completeCollisionContinuation())
+    {
+      status_ = SQPStatus::RUNNING;
+      --penalty_iteration;
+      continue;
+    }
+
+    // The quadratic constraint penalty is not exact so the convexification loop is run again with the exact penalty
+    if (status_ != SQPStatus::ITERATION_LIMIT && status_ != SQPStatus::OPT_TIME_LIMIT &&
+        completeQuadraticConstraintPenalty())
+    {
+      setBoxSize(fmax(getBoxSize(), params.min_trust_box_size / params.trust_shrink_ratio * 1.5));
+      status_ = SQPStatus::RUNNING;
+      --penalty_iteration;
+      continue;
+    }
+
     // Check if constraints are satisfied
     if (verifySQPSolverConvergence())
     {
@@ -152,6 +309,12 @@ void TrustRegionSQPSolver::solve(const QPProblem::Ptr& qp_problem)
   }
 
   // Final Cleanup
+  if (collision_continuation_ && !collision_continuation_->isComplete())
+  {
+    collision_continuation_->update(1);
+    collisionContinuationChanged();
+  }
+
   if (SUPER_DEBUG_MODE)
     results_.print();
 
@@ -176,32 +339,79 @@ bool TrustRegionSQPSolver::verifySQPSolverConvergence()
   return false;
 }
 
+bool TrustRegionSQPSolver::updatePenaltyFromMultipliers()
+{
+  if (results_.constraint_multipliers.size() != results_.merit_error_coeffs.size())
+    return false;
+
+  // The slack cost bounds the multiplier by the merit coefficient, so a multiplier within this tolerance of it is
+  // considered at its bound
+  const double bound_tolerance = 1e-3;
+
+  bool changed{ false };
+  for (Eigen::Index idx = 0; idx < results_.best_constraint_violations.size(); idx++)
+  {
+    if (results_.best_constraint_violations[idx] <= params.cnt_tolerance)
+      continue;
+
+    double& coeff = results_.merit_error_coeffs[idx];
+    const double multiplier = std::abs(results_.constraint_multipliers[idx]);
+    if (multiplier >= (1.0 - bound_tolerance) * coeff)
+    {
+      CONSOLE_BRIDGE_logInform("Constraint %d multiplier is at its bound. Increasing constraint penalty", idx);
+      coeff *= params.merit_coeff_increase_ratio;
+      changed = true;
+    }
+    else if ((1.0 + params.merit_coeff_multiplier_margin) * multiplier > coeff)
+    {
+      CONSOLE_BRIDGE_logInform("Increasing constraint penalty for %d to its multiplier plus margin", idx);
+      coeff = (1.0 + params.merit_coeff_multiplier_margin) * multiplier;
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
 void TrustRegionSQPSolver::adjustPenalty()
 {
-  if (params.inflate_constraints_individually)
+  // Fall back to inflating the merit coefficients if the multipliers did not change any of them
+  if (!params.multiplier_merit_update || !updatePenaltyFromMultipliers())
   {
-    assert(results_.best_constraint_violations.size() == results_.merit_error_coeffs.size());
-    for (Eigen::Index idx = 0; idx < results_.best_constraint_violations.size(); idx++)
+    if (params.inflate_constraints_individually)
     {
-      if (results_.best_constraint_violations[idx] > params.cnt_tolerance)
+      assert(results_.best_constraint_violations.size() == results_.merit_error_coeffs.size());
+      for (Eigen::Index idx = 0; idx < results_.best_constraint_violations.size(); idx++)
       {
-        CONSOLE_BRIDGE_logInform("Not all constraints are satisfied. Increasing constraint penalties for %d", idx);
-        results_.merit_error_coeffs[idx] *= params.merit_coeff_increase_ratio;
+        if (results_.best_constraint_violations[idx] > params.cnt_tolerance)
+        {
+          CONSOLE_BRIDGE_logInform("Not all constraints are satisfied. Increasing constraint penalties for %d", idx);
+          results_.merit_error_coeffs[idx] *= params.merit_coeff_increase_ratio;
+        }
       }
     }
+    else
+    {
+      CONSOLE_BRIDGE_logInform("Not all constraints are satisfied. Increasing constraint penalties uniformly");
+      results_.merit_error_coeffs *= params.merit_coeff_increase_ratio;
+    }
   }
-  else
-  {
-    CONSOLE_BRIDGE_logInform("Not all constraints are satisfied. Increasing constraint penalties uniformly");
-    results_.merit_error_coeffs *= params.merit_coeff_increase_ratio;
-  }
-  setBoxSize(fmax(results_.box_size[0], params.min_trust_box_size / params.trust_shrink_ratio * 1.5));
+  setBoxSize(fmax(getBoxSize(), params.min_trust_box_size / params.trust_shrink_ratio * 1.5));
   constraintMeritCoeffChanged();
 }
 
 bool TrustRegionSQPSolver::stepSQPSolver()
 {
   results_.convexify_iteration++;
+  updateCollisionContinuation();
+
+  // The quadratic constraint penalty is only used far from feasibility
+  if (results_.best_constraint_violations.size() == 0 ||
+      results_.best_constraint_violations.maxCoeff() < params.quadratic_constraint_penalty_tolerance)
+    completeQuadraticConstraintPenalty();
+
+  using Clock = std::chrono::steady_clock;
+  auto convexify_start_time = Clock::now();
   qp_problem->convexify();
 
   // TODO: Look into not clearing and reinitializing the workspace each iteration. It should be as simple as
@@ -214,6 +424,7 @@ bool TrustRegionSQPSolver::stepSQPSolver()
   qp_solver->updateGradient(qp_problem->getGradient());
   qp_solver->updateLinearConstraintsMatrix(qp_problem->getConstraintMatrix());
   qp_solver->updateBounds(qp_problem->getBoundsLower(), qp_problem->getBoundsUpper());
+  results_.convexify_time += std::chrono::duration<double>(Clock::now() - convexify_start_time).count();
 
   // Trust region loop
   runTrustRegionLoop();
@@ -222,7 +433,7 @@ bool TrustRegionSQPSolver::stepSQPSolver()
   if (status_ == SQPStatus::NLP_CONVERGED)
     return true;
 
-  if (results_.box_size.maxCoeff() < params.min_trust_box_size)
+  if (getBoxSize() < params.min_trust_box_size)
   {
     CONSOLE_BRIDGE_logInform("Converged because trust region is tiny");
     status_ = SQPStatus::NLP_CONVERGED;
@@ -235,7 +446,7 @@ void TrustRegionSQPSolver::runTrustRegionLoop()
 {
   results_.trust_region_iteration = 0;
   int qp_solver_failures = 0;
-  while (results_.box_size.maxCoeff() >= params.min_trust_box_size)
+  while (getBoxSize() >= params.min_trust_box_size)
   {
     if (SUPER_DEBUG_MODE)
       qp_problem->print();
@@ -257,18 +468,17 @@ void TrustRegionSQPSolver::runTrustRegionLoop()
         qp_solver->updateBounds(qp_problem->getBoundsLower(), qp_problem->getBoundsUpper());
         results_.box_size = qp_problem->getBoxSize();
 
-        CONSOLE_BRIDGE_logDebug("Shrunk trust region. New box size: %.4f", results_.box_size[0]);
+        CONSOLE_BRIDGE_logDebug("Shrunk trust region. New box size: %.4f", getBoxSize());
         continue;
       }
 
       if (qp_solver_failures == params.max_qp_solver_failures)
       {
         // Convex solver failed and this is the last attempt so setting the trust region to the minimum
-        qp_problem->setBoxSize(Eigen::VectorXd::Constant(qp_problem->getNumNLPVars(), params.min_trust_box_size));
+        setBoxSize(params.min_trust_box_size);
         qp_solver->updateBounds(qp_problem->getBoundsLower(), qp_problem->getBoundsUpper());
-        results_.box_size = qp_problem->getBoxSize();
 
-        CONSOLE_BRIDGE_logDebug("Shrunk trust region to minimum. New box size: %.4f", results_.box_size[0]);
+        CONSOLE_BRIDGE_logDebug("Shrunk trust region to minimum. New box size: %.4f", getBoxSize());
         continue;
       }
 
@@ -306,15 +516,28 @@ void TrustRegionSQPSolver::runTrustRegionLoop()
     // This happens if the exact solution got worse or if the QP approximation deviates from the exact by too much
     if (results_.exact_merit_improve < 0 || results_.merit_improve_ratio < params.improve_ratio_threshold)
     {
+      // A fraction of the step may be accepted without solving a new QP
+      double step_fraction = params.line_search ? runLineSearch() : 0;
+      if (step_fraction > 0)
+      {
+        qp_problem->scaleBoxSize(step_fraction);
+        qp_solver->updateBounds(qp_problem->getBoundsLower(), qp_problem->getBoundsUpper());
+        results_.box_size = qp_problem->getBoxSize();
+        CONSOLE_BRIDGE_logDebug(
+            "Line search accepted %.3f of the step. new box size: %.4f", step_fraction, getBoxSize());
+        return;
+      }
+
       qp_problem->scaleBoxSize(params.trust_shrink_ratio);
       qp_solver->updateBounds(qp_problem->getBoundsLower(), qp_problem->getBoundsUpper());
       results_.box_size = qp_problem->getBoxSize();
 
-      CONSOLE_BRIDGE_logDebug("Shrunk trust region. new box size: %.4f", results_.box_size[0]);
+      CONSOLE_BRIDGE_logDebug("Shrunk trust region. new box size: %.4f", getBoxSize());
     }
     else
     {
-      results_.best_var_vals = results_.new_var_vals;
+      // The QP solution also holds the slack variables, only the NLP variables are kept like in the line search
+      results_.best_var_vals = results_.new_var_vals.head(qp_problem->getNumNLPVars());
 
       results_.best_exact_merit = results_.new_exact_merit;
       results_.best_constraint_violations = results_.new_constraint_violations;
@@ -332,33 +555,95 @@ void TrustRegionSQPSolver::runTrustRegionLoop()
       qp_problem->scaleBoxSize(params.trust_expand_ratio);
       qp_solver->updateBounds(qp_problem->getBoundsLower(), qp_problem->getBoundsUpper());
       results_.box_size = qp_problem->getBoxSize();
-      CONSOLE_BRIDGE_logDebug("Expanded trust region. new box size: %.4f", results_.box_size[0]);
+      CONSOLE_BRIDGE_logDebug("Expanded trust region. new box size: %.4f", getBoxSize());
       return;
     }
   }  // Trust region loop
 }
 
+double TrustRegionSQPSolver::runLineSearch()
+{
+  using Clock = std::chrono::steady_clock;
+  auto evaluate_start_time = Clock::now();
+
+  const Eigen::Index num_nlp_vars = qp_problem->getNumNLPVars();
+  const Eigen::VectorXd start_var_vals = results_.best_var_vals.head(num_nlp_vars);
+  const Eigen::VectorXd step = results_.new_var_vals.head(num_nlp_vars) - start_var_vals;
+
+  double step_fraction{ 1 };
+  double accepted_step_fraction{ 0 };
+  Eigen::VectorXd trial_var_vals(num_nlp_vars);
+  for (int i = 0; i < params.max_line_search_steps; ++i)
+  {
+    step_fraction *= params.line_search_shrink_ratio;
+    trial_var_vals = start_var_vals + step_fraction * step;
+
+    Eigen::VectorXd costs = qp_problem->evaluateExactCosts(trial_var_vals);
+    Eigen::VectorXd constraint_violations = qp_problem->evaluateExactConstraintViolations(trial_var_vals);
+    results_.line_search_evaluations++;
+
+    // The convex model improves by at least step_fraction * approx_merit_improve along the step
+    const double exact_merit = calcMerit(costs, constraint_violations);
+    const double exact_merit_improve = results_.best_exact_merit - exact_merit;
+    CONSOLE_BRIDGE_logDebug(
+        "Line search step fraction %.3e: exact merit improve %.3e", step_fraction, exact_merit_improve);
+    if (exact_merit_improve > 0 &&
+        exact_merit_improve >= params.improve_ratio_threshold * step_fraction * results_.approx_merit_improve)
+    {
+      results_.best_var_vals = trial_var_vals;
+
+      results_.best_exact_merit = exact_merit;
+      results_.best_constraint_violations = constraint_violations;
+      results_.best_costs = costs;
+
+      qp_problem->evaluateConvexConstraintViolations(trial_var_vals, results_.best_approx_constraint_violations);
+      qp_problem->evaluateConvexCosts(trial_var_vals, results_.best_approx_costs);
+      results_.best_approx_merit = calcMerit(results_.best_approx_costs, results_.best_approx_constraint_violations);
+
+      results_.line_search_steps++;
+      accepted_step_fraction = step_fraction;
+      break;
+    }
+  }
+
+  // The exact evaluations change the variables of the problem
+  qp_problem->setVariables(results_.best_var_vals.data());
+  results_.evaluate_time += std::chrono::duration<double>(Clock::now() - evaluate_start_time).count();
+  return accepted_step_fraction;
+}
+
 SQPStatus TrustRegionSQPSolver::solveQPProblem()
 {
   // Solve the QP
+  using Clock = std::chrono::steady_clock;
+  auto qp_start_time = Clock::now();
   bool succeed = qp_solver->solve();
+  results_.qp_solve_time += std::chrono::duration<double>(Clock::now() - qp_start_time).count();
 
   if (succeed)
   {
+    auto evaluate_start_time = Clock::now();
     results_.new_var_vals = qp_solver->getSolution();
 
+    // Store the multipliers of the NLP constraints
+    Eigen::VectorXd dual_solution = qp_solver->getDualSolution();
+    if (dual_solution.size() == qp_problem->getNumQPConstraints())
+    {
+      results_.constraint_multipliers =
+          dual_solution.segment(qp_problem->getNLPConstraintQPRowOffset(), qp_problem->getNumNLPConstraints());
+    }
+
     // Calculate approximate QP merits (cheap)
     qp_problem->setVariables(results_.new_var_vals.data());
 
     // Evaluate convexified constraint violations (expensive)
-    results_.new_approx_constraint_violations = qp_problem->evaluateConvexConstraintViolations(results_.new_var_vals);
+    qp_problem->evaluateConvexConstraintViolations(results_.new_var_vals, results_.new_approx_constraint_violations);
 
     // Evaluate convexified costs (expensive)
-    results_.new_approx_costs = qp_problem->evaluateConvexCosts(results_.new_var_vals);
+    qp_problem->evaluateConvexCosts(results_.new_var_vals, results_.new_approx_costs);
 
     // Convexified merit
-    results_.new_approx_merit =
-        results_.new_approx_costs.sum() + results_.new_approx_constraint_violations.dot(results_.merit_error_coeffs);
+    results_.new_approx_merit = calcMerit(results_.new_approx_costs, results_.new_approx_constraint_violations);
 
     results_.approx_merit_improve = results_.best_exact_merit - results_.new_approx_merit;
 
@@ -369,14 +654,14 @@ SQPStatus TrustRegionSQPSolver::solveQPProblem()
     results_.new_constraint_violations = qp_problem->evaluateExactConstraintViolations(results_.new_var_vals);
 
     // Calculate exact NLP merits (expensive) - TODO: Look into caching for qp_solver->Convexify()
-    results_.new_exact_merit =
-        results_.new_costs.sum() + results_.new_constraint_violations.dot(results_.merit_error_coeffs);
+    results_.new_exact_merit = calcMerit(results_.new_costs, results_.new_constraint_violations);
     results_.exact_merit_improve = results_.best_exact_merit - results_.new_exact_merit;
     results_.merit_improve_ratio = results_.exact_merit_improve / results_.approx_merit_improve;
 
     // The variable are changed to the new values to calculated data but must be set
     // to best var vals because the new values may not improve the merit which is determined later.
     qp_problem->setVariables(results_.best_var_vals.data());
+    results_.evaluate_time += std::chrono::duration<double>(Clock::now() - evaluate_start_time).count();
 
     // Print debugging info
     if (verbose)
@@ -421,7 +706,7 @@ void TrustRegionSQPSolver::printStepInfo() const
   std::printf("| %s %s (Box Size: %-3.9f) %s |\n",
               std::string(26, ' ').c_str(),
               "Iteration",
-              results_.box_size(0),
+              getBoxSize(),
               std::string(27, ' ').c_str());
   std::printf("| %s |\n", std::string(88, '-').c_str());
   std::printf("| %14s: %-4d | %14s: %-4d | %15s: %-3d | %14s: %-3d |\n",
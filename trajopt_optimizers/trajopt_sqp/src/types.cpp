@@ -45,7 +45,9 @@ SQPResults::SQPResults(Eigen::Index num_vars, Eigen::Index num_cnts, Eigen::Inde
   best_var_vals = Eigen::VectorXd::Zero(num_vars);
   new_var_vals = Eigen::VectorXd::Zero(num_vars);
   box_size = Eigen::VectorXd::Ones(num_vars);
+  box_scaling = Eigen::VectorXd::Ones(num_vars);
   merit_error_coeffs = Eigen::VectorXd::Ones(num_cnts);
+  constraint_multipliers = Eigen::VectorXd::Zero(num_cnts);
 }
 
 void SQPResults::print() const
@@ -66,7 +68,9 @@ void SQPResults::print() const
   std::cout << "merit_improve_ratio: " << merit_improve_ratio << std::endl;
 
   std::cout << "box_size: " << box_size.transpose().format(format) << std::endl;
+  std::cout << "box_scaling: " << box_scaling.transpose().format(format) << std::endl;
   std::cout << "merit_error_coeffs: " << merit_error_coeffs.transpose().format(format) << std::endl;
+  std::cout << "constraint_multipliers: " << constraint_multipliers.transpose().format(format) << std::endl;
 
   std::cout << "best_constraint_violations: " << best_constraint_violations.transpose().format(format) << std::endl;
   std::cout << "new_constraint_violations: " << new_constraint_violations.transpose().format(format) << std::endl;
@@ -84,6 +88,11 @@ void SQPResults::print() const
   std::cout << "convexify_iteration: " << convexify_iteration << std::endl;
   std::cout << "trust_region_iteration: " << trust_region_iteration << std::endl;
   std::cout << "overall_iteration: " << overall_iteration << std::endl;
+  std::cout << "line_search_steps: " << line_search_steps << std::endl;
+  std::cout << "line_search_evaluations: " << line_search_evaluations << std::endl;
+  std::cout << "convexify_time: " << convexify_time << std::endl;
+  std::cout << "qp_solve_time: " << qp_solve_time << std::endl;
+  std::cout << "evaluate_time: " << evaluate_time << std::endl;
 }
 
 }  // namespace trajopt_sqp
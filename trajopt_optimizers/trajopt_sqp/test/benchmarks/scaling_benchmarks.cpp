@@ -0,0 +1,461 @@
+#include <tesseract_common/macros.h>
+TESSERACT_COMMON_IGNORE_WARNINGS_PUSH
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+TESSERACT_COMMON_IGNORE_WARNINGS_POP
+
+#include <tesseract_environment/environment.h>
+#include <tesseract_common/resource_locator.h>
+
+#include <trajopt_common/benchmark_utils.h>
+#include <trajopt_common/collision_types.h>
+#include <trajopt_ifopt/constraints/collision/discrete_collision_constraint.h>
+#include <trajopt_ifopt/constraints/collision/discrete_collision_evaluators.h>
+#include <trajopt_ifopt/constraints/joint_position_constraint.h>
+#include <trajopt_ifopt/constraints/joint_velocity_constraint.h>
+#include <trajopt_ifopt/variable_sets/joint_position_variable.h>
+
+#include <trajopt_sqp/trajopt_qp_problem.h>
+#include <trajopt_sqp/trust_region_sqp_solver.h>
+#include <trajopt_sqp/osqp_eigen_solver.h>
+
+using namespace trajopt_ifopt;
+using namespace tesseract_environment;
+using namespace tesseract_collision;
+using namespace tesseract_common;
+
+/** @brief Collision evaluator wrapper which accumulates the time spent in the wrapped evaluator */
+class TimedCollisionEvaluator : public DiscreteCollisionEvaluator
+{
+public:
+  TimedCollisionEvaluator(DiscreteCollisionEvaluator::Ptr evaluator, double* time)
+    : evaluator_(std::move(evaluator)), time_(time)
+  {
+  }
+
+  std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisions(const Eigen::Ref<const Eigen::VectorXd>& dof_vals, std::size_t bounds_size) override
+  {
+    trajopt_common::ScopedTimer timer(*time_);
+    return evaluator_->CalcCollisions(dof_vals, bounds_size);
+  }
+
+  std::shared_ptr<const trajopt_common::CollisionCacheData>
+  CalcCollisionsForPairs(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
+                         const trajopt_common::CollisionCacheData& baseline) override
+  {
+    trajopt_common::ScopedTimer timer(*time_);
+    return evaluator_->CalcCollisionsForPairs(dof_vals, baseline);
+  }
+
+  const trajopt_common::TrajOptCollisionConfig& GetCollisionConfig() const override
+  {
+    return evaluator_->GetCollisionConfig();
+  }
+
+  trajopt_common::GradientResults GetGradient(const Eigen::VectorXd& dofvals,
+                                              const tesseract_collision::ContactResult& contact_result) override
+  {
+    trajopt_common::ScopedTimer timer(*time_);
+    return evaluator_->GetGradient(dofvals, contact_result);
+  }
+
+private:
+  DiscreteCollisionEvaluator::Ptr evaluator_;
+  double* time_;
+};
+
+/**
+ * @brief Create a serial chain robot surrounded by a ring of spherical obstacles
+ * @details The chain is about 1.2m long regardless of the number of joints, which alternate about the z and y axes.
+ * The obstacles are placed on a ring of radius 0.7m at three different heights.
+ * @param dof The number of revolute joints
+ * @param n_obstacles The number of spherical obstacles
+ * @return The environment, nullptr if it failed to initialize
+ */
+static Environment::Ptr createScalingEnvironment(int dof, int n_obstacles)
+{
+  const double link_length = 1.2 / dof;
+  const double link_radius = std::min(0.04, link_length / 4.0);
+
+  std::stringstream urdf;
+  urdf << R"(<robot name="scaling_chain"><link name="base_link"/>)";
+  for (int i = 0; i < dof; ++i)
+  {
+    const std::string link = "link_" + std::to_string(i);
+    const std::string parent = (i == 0) ? "base_link" : "link_" + std::to_string(i - 1);
+    urdf << "<link name=\"" << link << "\"><collision><origin xyz=\"0 0 " << link_length << "\"/>"
+         << "<geometry><sphere radius=\"" << link_radius << "\"/></geometry></collision></link>";
+    urdf << "<joint name=\"joint_" << i << "\" type=\"revolute\"><parent link=\"" << parent << "\"/>"
+         << "<child link=\"" << link << "\"/><origin xyz=\"0 0 " << ((i == 0) ? 0.0 : link_length) << "\"/>"
+         << "<axis xyz=\"" << ((i % 2 == 0) ? "0 0 1" : "0 1 0") << "\"/>"
+         << R"(<limit lower="-3.14" upper="3.14" effort="0" velocity="2"/></joint>)";
+  }
+
+  for (int i = 0; i < n_obstacles; ++i)
+  {
+    const double angle = (2.0 * M_PI * i) / n_obstacles;
+    const double height = 0.3 + (0.3 * (i % 3));
+    const std::string link = "obstacle_" + std::to_string(i);
+    urdf << "<link name=\"" << link << "\"><collision><geometry><sphere radius=\"0.08\"/></geometry></collision>"
+         << "</link>";
+    urdf << "<joint name=\"" << link << "_joint\" type=\"fixed\"><parent link=\"base_link\"/><child link=\"" << link
+         << "\"/><origin xyz=\"" << (0.7 * std::cos(angle)) << " " << (0.7 * std::sin(angle)) << " " << height
+         << "\"/></joint>";
+  }
+  urdf << "</robot>";
+
+  std::stringstream srdf;
+  srdf << R"(<robot name="scaling_chain"><group name="manipulator">)"
+       << R"(<chain base_link="base_link" tip_link="link_)" << (dof - 1) << R"("/></group>)";
+  srdf << R"(<disable_collisions link1="base_link" link2="link_0" reason="Adjacent"/>)";
+  for (int i = 1; i < dof; ++i)
+    srdf << "<disable_collisions link1=\"link_" << (i - 1) << "\" link2=\"link_" << i << "\" reason=\"Adjacent\"/>";
+  srdf << "</robot>";
+
+  ResourceLocator::Ptr locator = std::make_shared<tesseract_common::GeneralResourceLocator>();
+  auto env = std::make_shared<Environment>();
+  if (!env->init(urdf.str(), srdf.str(), locator))
+    return nullptr;
+
+  return env;
+}
+
+/**
+ * @brief The start and end joint positions used by the scaling benchmarks
+ * @details The first joint sweeps the bent chain through the obstacle ring
+ */
+static std::pair<Eigen::VectorXd, Eigen::VectorXd> getScalingEndpoints(int dof)
+{
+  Eigen::VectorXd start = Eigen::VectorXd::Zero(dof);
+  for (Eigen::Index i = 1; i < dof; i += 2)
+    start(i) = 1.6 / dof;
+
+  Eigen::VectorXd end = start;
+  start(0) = -1.5;
+  end(0) = 1.5;
+  return { start, end };
+}
+
+/**
+ * @brief Benchmark the trajopt_sqp trust region solver as the waypoints, joints and obstacles are scaled
+ * @details The range is [n_steps, dof, n_obstacles]. The time spent in each phase of the solver, the time spent in the
+ * collision evaluators and the number of heap allocations made by the solver are reported per iteration.
+ */
+static void BM_TRAJOPT_IFOPT_SCALING_SOLVE(benchmark::State& state)
+{
+  const auto n_steps = static_cast<int>(state.range(0));
+  const auto dof = static_cast<int>(state.range(1));
+  const auto n_obstacles = static_cast<int>(state.range(2));
+
+  Environment::Ptr env = createScalingEnvironment(dof, n_obstacles);
+  if (env == nullptr)
+  {
+    state.SkipWithError("Failed to create the scaling environment");
+    return;
+  }
+
+  auto [start, end] = getScalingEndpoints(dof);
+  tesseract_kinematics::JointGroup::ConstPtr manip = env->getJointGroup("manipulator");
+
+  double convexify_time{ 0 };
+  double qp_solve_time{ 0 };
+  double evaluate_time{ 0 };
+  double collision_time{ 0 };
+  std::size_t allocations{ 0 };
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+
+    // Add Variables
+    std::vector<JointPosition::ConstPtr> vars;
+    for (int i = 0; i < n_steps; ++i)
+    {
+      const double t = static_cast<double>(i) / (n_steps - 1);
+      Eigen::VectorXd pos = start + (t * (end - start));
+      auto var = std::make_shared<JointPosition>(pos, manip->getJointNames(), "Joint_Position_" + std::to_string(i));
+      var->SetBounds(manip->getLimits().joint_limits);
+      vars.push_back(var);
+      qp_problem->addVariableSet(var);
+    }
+
+    // Add costs
+    {
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(1, 1);
+      auto cost = std::make_shared<JointVelConstraint>(Eigen::VectorXd::Zero(dof), vars, coeffs);
+      qp_problem->addCostSet(cost, trajopt_sqp::CostPenaltyType::SQUARED);
+    }
+
+    // Add constraints
+    {  // Fix start position
+      std::vector<JointPosition::ConstPtr> fixed_vars = { vars.front() };
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(dof, 5);
+      auto cnt = std::make_shared<JointPosConstraint>(start, fixed_vars, coeffs);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    {  // Fix end position
+      std::vector<JointPosition::ConstPtr> fixed_vars = { vars.back() };
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(dof, 5);
+      auto cnt = std::make_shared<JointPosConstraint>(end, fixed_vars, coeffs);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    // The collision evaluators are wrapped so the time spent in them can be measured
+    auto collision_config = std::make_shared<trajopt_common::TrajOptCollisionConfig>(0.025, 20);
+    collision_config->collision_margin_buffer = 0.05;
+    auto collision_cache = std::make_shared<CollisionCache>(static_cast<std::size_t>(n_steps) * 4);
+    for (std::size_t i = 1; i < (vars.size() - 1); ++i)
+    {
+      auto collision_evaluator =
+          std::make_shared<SingleTimestepCollisionEvaluator>(collision_cache, manip, env, collision_config);
+      auto timed_evaluator = std::make_shared<TimedCollisionEvaluator>(collision_evaluator, &collision_time);
+      auto cost = std::make_shared<DiscreteCollisionConstraint>(timed_evaluator, vars[i], 3);
+      qp_problem->addCostSet(cost, trajopt_sqp::CostPenaltyType::HINGE);
+    }
+
+    qp_problem->setup();
+
+    // Setup solver
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    qp_solver->solver_->settings()->setVerbosity(false);
+    qp_solver->solver_->settings()->setWarmStart(true);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setMaxIteration(8192);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+    solver.verbose = false;
+    state.ResumeTiming();
+
+    const std::size_t allocation_start = trajopt_common::benchmark_allocation_count.load(std::memory_order_relaxed);
+    solver.solve(qp_problem);
+    allocations += trajopt_common::benchmark_allocation_count.load(std::memory_order_relaxed) - allocation_start;
+
+    convexify_time += solver.getResults().convexify_time;
+    qp_solve_time += solver.getResults().qp_solve_time;
+    evaluate_time += solver.getResults().evaluate_time;
+  }
+
+  state.counters["convexify_time"] = benchmark::Counter(convexify_time, benchmark::Counter::kAvgIterations);
+  state.counters["qp_solve_time"] = benchmark::Counter(qp_solve_time, benchmark::Counter::kAvgIterations);
+  state.counters["evaluate_time"] = benchmark::Counter(evaluate_time, benchmark::Counter::kAvgIterations);
+  state.counters["collision_time"] = benchmark::Counter(collision_time, benchmark::Counter::kAvgIterations);
+  state.counters["allocations"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief Benchmark the exact l1 and the quadratic constraint penalty with the collisions as constraints
+ * @details The range is [n_steps, quadratic_constraint_penalty]. The size of the first QP, the time spent solving the
+ * QPs and the number of SQP iterations are reported per iteration.
+ */
+static void BM_TRAJOPT_IFOPT_CONSTRAINT_PENALTY_SOLVE(benchmark::State& state)
+{
+  const auto n_steps = static_cast<int>(state.range(0));
+  const bool quadratic_constraint_penalty = (state.range(1) != 0);
+  const int dof = 7;
+
+  Environment::Ptr env = createScalingEnvironment(dof, 8);
+  if (env == nullptr)
+  {
+    state.SkipWithError("Failed to create the scaling environment");
+    return;
+  }
+
+  auto [start, end] = getScalingEndpoints(dof);
+  tesseract_kinematics::JointGroup::ConstPtr manip = env->getJointGroup("manipulator");
+
+  Eigen::Index qp_vars{ 0 };
+  Eigen::Index qp_cnts{ 0 };
+  double qp_solve_time{ 0 };
+  int iterations{ 0 };
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+
+    // Add Variables
+    std::vector<JointPosition::ConstPtr> vars;
+    for (int i = 0; i < n_steps; ++i)
+    {
+      const double t = static_cast<double>(i) / (n_steps - 1);
+      Eigen::VectorXd pos = start + (t * (end - start));
+      auto var = std::make_shared<JointPosition>(pos, manip->getJointNames(), "Joint_Position_" + std::to_string(i));
+      var->SetBounds(manip->getLimits().joint_limits);
+      vars.push_back(var);
+      qp_problem->addVariableSet(var);
+    }
+
+    // Add costs
+    {
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(1, 1);
+      auto cost = std::make_shared<JointVelConstraint>(Eigen::VectorXd::Zero(dof), vars, coeffs);
+      qp_problem->addCostSet(cost, trajopt_sqp::CostPenaltyType::SQUARED);
+    }
+
+    // Add constraints
+    {  // Fix start position
+      std::vector<JointPosition::ConstPtr> fixed_vars = { vars.front() };
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(dof, 5);
+      auto cnt = std::make_shared<JointPosConstraint>(start, fixed_vars, coeffs);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    {  // Fix end position
+      std::vector<JointPosition::ConstPtr> fixed_vars = { vars.back() };
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(dof, 5);
+      auto cnt = std::make_shared<JointPosConstraint>(end, fixed_vars, coeffs);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    auto collision_config = std::make_shared<trajopt_common::TrajOptCollisionConfig>(0.025, 20);
+    collision_config->collision_margin_buffer = 0.05;
+    auto collision_cache = std::make_shared<CollisionCache>(static_cast<std::size_t>(n_steps) * 4);
+    for (std::size_t i = 1; i < (vars.size() - 1); ++i)
+    {
+      auto collision_evaluator =
+          std::make_shared<SingleTimestepCollisionEvaluator>(collision_cache, manip, env, collision_config);
+      auto cnt = std::make_shared<DiscreteCollisionConstraint>(collision_evaluator, vars[i], 3);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    qp_problem->setup();
+    qp_problem->setConstraintPenaltyType(quadratic_constraint_penalty ? trajopt_sqp::CostPenaltyType::SQUARED :
+                                                                        trajopt_sqp::CostPenaltyType::ABSOLUTE);
+    qp_vars = qp_problem->getNumQPVars();
+    qp_cnts = qp_problem->getNumQPConstraints();
+
+    // Setup solver
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    qp_solver->solver_->settings()->setVerbosity(false);
+    qp_solver->solver_->settings()->setWarmStart(true);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setMaxIteration(8192);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+    solver.verbose = false;
+    solver.params.quadratic_constraint_penalty = quadratic_constraint_penalty;
+    state.ResumeTiming();
+
+    solver.solve(qp_problem);
+
+    qp_solve_time += solver.getResults().qp_solve_time;
+    iterations = solver.getResults().overall_iteration;
+  }
+
+  state.counters["qp_vars"] = static_cast<double>(qp_vars);
+  state.counters["qp_cnts"] = static_cast<double>(qp_cnts);
+  state.counters["qp_solve_time"] = benchmark::Counter(qp_solve_time, benchmark::Counter::kAvgIterations);
+  state.counters["sqp_iterations"] = iterations;
+}
+
+/**
+ * @brief Benchmark setting and getting the variables of a QP problem as the waypoints are scaled
+ * @details The range is [n_steps, contiguous]. When contiguous is non-zero the joint positions share a storage. The
+ * number of heap allocations per set and get is reported.
+ */
+static void BM_TRAJOPT_IFOPT_SET_VARIABLES(benchmark::State& state)
+{
+  const auto n_steps = static_cast<int>(state.range(0));
+  const bool contiguous = (state.range(1) != 0);
+  const int dof = 7;
+
+  auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+  auto storage = std::make_shared<JointPositionStorage>();
+  std::vector<JointPosition::ConstPtr> vars;
+  for (int i = 0; i < n_steps; ++i)
+  {
+    auto var = std::make_shared<JointPosition>(
+        Eigen::VectorXd::Zero(dof), std::vector<std::string>(dof), "Joint_Position_" + std::to_string(i));
+    if (contiguous)
+      var->SetStorage(storage);
+    vars.push_back(var);
+    qp_problem->addVariableSet(var);
+  }
+
+  auto cost = std::make_shared<JointVelConstraint>(Eigen::VectorXd::Zero(dof), vars, Eigen::VectorXd::Ones(1));
+  qp_problem->addCostSet(cost, trajopt_sqp::CostPenaltyType::SQUARED);
+  qp_problem->setup();
+
+  Eigen::VectorXd x = Eigen::VectorXd::Random(n_steps * dof);
+  std::size_t allocations{ 0 };
+  for (auto _ : state)
+  {
+    const std::size_t allocation_start = trajopt_common::benchmark_allocation_count.load(std::memory_order_relaxed);
+    qp_problem->setVariables(x.data());
+    benchmark::DoNotOptimize(qp_problem->getVariableValues());
+    allocations += trajopt_common::benchmark_allocation_count.load(std::memory_order_relaxed) - allocation_start;
+  }
+
+  state.counters["allocations"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+int main(int argc, char** argv)
+{
+  //////////////////////////////////////
+  // Scaling Solve
+  //////////////////////////////////////
+  {
+    std::string name = "BM_TRAJOPT_IFOPT_SCALING_SOLVE";
+    benchmark::internal::Benchmark* bm = benchmark::RegisterBenchmark(name.c_str(), BM_TRAJOPT_IFOPT_SCALING_SOLVE);
+    bm->ArgNames({ "n_steps", "dof", "n_obstacles" });
+
+    // Waypoints
+    for (int n_steps : { 10, 50, 100, 250, 500 })
+      bm->Args({ n_steps, 7, 8 });
+
+    // Joints
+    for (int dof : { 6, 14 })
+      bm->Args({ 50, dof, 8 });
+
+    // Obstacles
+    for (int n_obstacles : { 0, 32, 128 })
+      bm->Args({ 50, 7, n_obstacles });
+
+    bm->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond);
+  }
+
+  //////////////////////////////////////
+  // Constraint Penalty Solve
+  //////////////////////////////////////
+  {
+    std::string name = "BM_TRAJOPT_IFOPT_CONSTRAINT_PENALTY_SOLVE";
+    benchmark::internal::Benchmark* bm =
+        benchmark::RegisterBenchmark(name.c_str(), BM_TRAJOPT_IFOPT_CONSTRAINT_PENALTY_SOLVE);
+    bm->ArgNames({ "n_steps", "quadratic_constraint_penalty" });
+    for (int n_steps : { 10, 50, 100 })
+    {
+      bm->Args({ n_steps, 0 });
+      bm->Args({ n_steps, 1 });
+    }
+
+    bm->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond);
+  }
+
+  //////////////////////////////////////
+  // Set Variables
+  //////////////////////////////////////
+  {
+    std::string name = "BM_TRAJOPT_IFOPT_SET_VARIABLES";
+    benchmark::internal::Benchmark* bm = benchmark::RegisterBenchmark(name.c_str(), BM_TRAJOPT_IFOPT_SET_VARIABLES);
+    bm->ArgNames({ "n_steps", "contiguous" });
+    for (int n_steps : { 10, 50, 200 })
+    {
+      bm->Args({ n_steps, 0 });
+      bm->Args({ n_steps, 1 });
+    }
+
+    bm->UseRealTime()->Unit(benchmark::TimeUnit::kMicrosecond);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+}
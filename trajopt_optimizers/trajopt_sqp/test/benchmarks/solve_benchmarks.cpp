@@ -326,6 +326,74 @@ static void BM_TRAJOPT_IFOPT_PLANNING_SOLVE(benchmark::State& state, Environment
   }
 }
 
+/**
+ * @brief Benchmark a trajectory with a prismatic rail in meters and revolute joints in radians
+ * @details The number of SQP iterations is reported so the effect of automatic scaling can be compared
+ */
+static void BM_TRAJOPT_IFOPT_MIXED_UNITS_SOLVE(benchmark::State& state, bool automatic_scaling)
+{
+  const Eigen::Index n_steps = 10;
+  int iterations{ 0 };
+  for (auto _ : state)
+  {
+    auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+    std::vector<std::string> joint_names{ "rail", "joint_1", "joint_2", "joint_3" };
+    Eigen::MatrixX2d bounds(4, 2);
+    bounds << -20, 20, -M_PI, M_PI, -M_PI, M_PI, -M_PI, M_PI;
+
+    std::vector<trajopt_ifopt::JointPosition::ConstPtr> vars;
+    for (Eigen::Index i = 0; i < n_steps; ++i)
+    {
+      auto var = std::make_shared<trajopt_ifopt::JointPosition>(
+          Eigen::VectorXd::Zero(4), joint_names, "Joint_Position_" + std::to_string(i));
+      var->SetBounds(bounds);
+      vars.push_back(var);
+      qp_problem->addVariableSet(var);
+    }
+
+    {
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(1, 1);
+      auto cost = std::make_shared<JointVelConstraint>(Eigen::VectorXd::Zero(4), vars, coeffs);
+      qp_problem->addCostSet(cost, trajopt_sqp::CostPenaltyType::SQUARED);
+    }
+
+    {  // Fix start position
+      std::vector<JointPosition::ConstPtr> fixed_vars = { vars.front() };
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(4, 5);
+      auto cnt = std::make_shared<JointPosConstraint>(Eigen::VectorXd::Zero(4), fixed_vars, coeffs);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    {  // Fix end position
+      Eigen::VectorXd end_pos(4);
+      end_pos << 15, 1, -1, 0.5;
+      std::vector<JointPosition::ConstPtr> fixed_vars = { vars.back() };
+      Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(4, 5);
+      auto cnt = std::make_shared<JointPosConstraint>(end_pos, fixed_vars, coeffs);
+      qp_problem->addConstraintSet(cnt);
+    }
+
+    qp_problem->setup();
+
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    qp_solver->solver_->settings()->setVerbosity(false);
+    qp_solver->solver_->settings()->setWarmStart(true);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setMaxIteration(8192);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+
+    solver.verbose = false;
+    solver.params.max_iterations = 200;
+    solver.params.automatic_scaling = automatic_scaling;
+    solver.solve(qp_problem);
+    iterations = solver.getResults().overall_iteration;
+  }
+  state.counters["sqp_iterations"] = iterations;
+}
+
 int main(int argc, char** argv)
 {
   //////////////////////////////////////
@@ -382,6 +450,22 @@ int main(int argc, char** argv)
         ->MinTime(6);
   }
 
+  //////////////////////////////////////
+  // Mixed Units Solve
+  //////////////////////////////////////
+  {
+    std::function<void(benchmark::State&, bool)> BM_SOLVE_FUNC = BM_TRAJOPT_IFOPT_MIXED_UNITS_SOLVE;
+    std::string name = "BM_TRAJOPT_IFOPT_MIXED_UNITS_SOLVE";
+    benchmark::RegisterBenchmark(name.c_str(), BM_SOLVE_FUNC, false)
+        ->UseRealTime()
+        ->Unit(benchmark::TimeUnit::kMillisecond);
+
+    name = "BM_TRAJOPT_IFOPT_MIXED_UNITS_SOLVE_AUTOMATIC_SCALING";
+    benchmark::RegisterBenchmark(name.c_str(), BM_SOLVE_FUNC, true)
+        ->UseRealTime()
+        ->Unit(benchmark::TimeUnit::kMillisecond);
+  }
+
   benchmark::Initialize(&argc, argv);
   benchmark::RunSpecifiedBenchmarks();
 }
@@ -155,6 +155,134 @@ TEST(ExpressionsTest, squareAffExprs2)  // NOLINT
   EXPECT_NEAR(quad_exprs.values(x)(0), std::pow(e(0), 2.0), 1e-8);
 }
 
+TEST(ExpressionsTest, addQuadraticConstraintPenalty)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExpressionsTest, addQuadraticConstraintPenalty");
+  // g0 = x(0) + 2 * x(1) (equality), g1 = x(1) - x(2) (satisfied inequality), g2 = 3 * x(2) (violated inequality)
+  Eigen::MatrixXd J(3, 3);
+  J << 1, 2, 0, 0, 1, -1, 0, 0, 3;
+  Eigen::Vector3d x0(0.1, 0.2, 0.3);
+  Eigen::Vector3d errors(0.5, 0, -0.2);
+  Eigen::Vector3d coeffs(2, 3, 4);
+  std::vector<trajopt_sqp::ConstraintType> types{ trajopt_sqp::ConstraintType::EQ,
+                                                  trajopt_sqp::ConstraintType::INEQ,
+                                                  trajopt_sqp::ConstraintType::INEQ };
+
+  // The QP has an extra variable which is not penalized
+  trajopt_sqp::SparseMatrix hessian(4, 4);
+  Eigen::VectorXd gradient = Eigen::VectorXd::Zero(4);
+  trajopt_sqp::addQuadraticConstraintPenalty(hessian, gradient, J.sparseView(), errors, x0, types, coeffs);
+
+  // The objective must match the penalty up to a constant, so compare the difference between two points
+  auto objective = [&](const Eigen::Vector4d& x) { return x.dot(hessian * x) + gradient.dot(x); };
+  auto penalty = [&](const Eigen::Vector4d& x) {
+    Eigen::Vector3d r = errors + J * (x.head(3) - x0);
+    return (coeffs(0) * r(0) * r(0)) + (coeffs(2) * r(2) * r(2));
+  };
+  Eigen::Vector4d x1(1, -2, 0.5, 7);
+  Eigen::Vector4d x2(-0.3, 0.4, 2, -1);
+  EXPECT_NEAR(objective(x1) - objective(x2), penalty(x1) - penalty(x2), 1e-8);
+  EXPECT_NEAR(gradient(3), 0, 1e-8);
+  EXPECT_NEAR(hessian.coeff(3, 3), 0, 1e-8);
+
+  // The targets give the same penalty from the linearized constraint values, as used for the convexified merit
+  Eigen::Vector3d values0(0.7, -0.1, 0.9);
+  Eigen::VectorXd targets;
+  Eigen::VectorXd mask;
+  trajopt_sqp::calcQuadraticPenaltyTargets(targets, mask, values0, errors, types);
+  EXPECT_TRUE(mask.isApprox(Eigen::Vector3d(1, 0, 1)));
+  auto target_penalty = [&](const Eigen::Vector4d& x) {
+    Eigen::VectorXd r = (values0 + J * (x.head(3) - x0) - targets).cwiseProduct(mask);
+    return r.cwiseAbs2().dot(coeffs);
+  };
+  EXPECT_NEAR(target_penalty(x1), penalty(x1), 1e-8);
+  EXPECT_NEAR(target_penalty(x2), penalty(x2), 1e-8);
+}
+
+TEST(ExpressionsTest, evaluateWithoutAllocating)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExpressionsTest, evaluateWithoutAllocating");
+  // The last column is a slack variable which is not evaluated
+  Eigen::MatrixXd A(3, 4);
+  A << 1, 2, 0, 5, 0, -1, 3, 6, 4, 0, 1, 7;
+  trajopt_sqp::SparseMatrix sparse_a = A.sparseView();
+  Eigen::Vector2d constants(0.5, -1);
+  Eigen::Vector3d x(0.1, -0.2, 0.3);
+
+  Eigen::Vector2d values;
+  trajopt_sqp::evaluateLinearRows(values, sparse_a, 1, constants, x);
+  EXPECT_TRUE(values.isApprox(constants + A.block(1, 0, 2, 3) * x, 1e-8));
+
+  Eigen::Matrix3d H;
+  H << 2, 1, 0, 1, 3, 0, 0, 0, 4;
+  trajopt_sqp::SparseMatrix sparse_h = H.sparseView();
+  EXPECT_NEAR(trajopt_sqp::evaluateQuadraticForm(sparse_h, x), x.dot(H * x), 1e-8);
+
+  // The preallocated quadratic expression values must match the allocating version
+  Eigen::Vector2d e(1, 2);
+  Eigen::Vector2d x2(5, 1);
+  Eigen::MatrixXd J(2, 2);
+  J << 2, -2, 1, 3;
+  QuadExprs quad_exprs = trajopt_sqp::squareAffExprs(trajopt_sqp::createAffExprs(e, J.sparseView(), x2));
+  Eigen::VectorXd x3 = Eigen::Vector2d(4, 3);
+  Eigen::Vector2d quad_values;
+  quad_exprs.values(quad_values, x3);
+  EXPECT_TRUE(quad_values.isApprox(quad_exprs.values(x3), 1e-8));
+}
+
+TEST(ExpressionsTest, assembleSparseMatrix)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("ExpressionsTest, assembleSparseMatrix");
+  // Row 1 is a collision constraint, its jacobian is only provided while it is active
+  std::vector<Eigen::Triplet<double>> active{ { 0, 0, 1 }, { 0, 2, 2 }, { 1, 1, 3 }, { 1, 2, 4 }, { 2, 3, 5 } };
+  Eigen::MatrixXd expected(3, 4);
+  expected << 1, 0, 2, 0, 0, 3, 4, 0, 0, 0, 0, 5;
+
+  // The first assembly builds the pattern
+  trajopt_sqp::SparseMatrix matrix;
+  std::vector<Eigen::Triplet<double>> triplets = active;
+  EXPECT_FALSE(trajopt_sqp::assembleSparseMatrix(matrix, 3, 4, triplets));
+  EXPECT_EQ(matrix.nonZeros(), 5);
+  EXPECT_TRUE(Eigen::MatrixXd(matrix).isApprox(expected, 1e-8));
+
+  // The same pattern with new values is updated in place, duplicates are summed
+  triplets = active;
+  triplets.emplace_back(2, 3, 1);
+  expected(2, 3) = 6;
+  EXPECT_TRUE(trajopt_sqp::assembleSparseMatrix(matrix, 3, 4, triplets));
+  EXPECT_EQ(matrix.nonZeros(), 5);
+  EXPECT_TRUE(Eigen::MatrixXd(matrix).isApprox(expected, 1e-8));
+
+  // The inactive collision row provides no entries, they are kept as explicit zeros
+  triplets = { { 0, 0, 1 }, { 0, 2, 2 }, { 2, 3, 5 } };
+  expected.row(1).setZero();
+  expected(2, 3) = 5;
+  EXPECT_TRUE(trajopt_sqp::assembleSparseMatrix(matrix, 3, 4, triplets));
+  EXPECT_EQ(matrix.nonZeros(), 5);
+  EXPECT_TRUE(Eigen::MatrixXd(matrix).isApprox(expected, 1e-8));
+
+  // An entry outside of the pattern rebuilds the matrix, the previous pattern is kept
+  triplets = { { 0, 0, 1 }, { 0, 2, 2 }, { 2, 0, 7 }, { 2, 3, 5 } };
+  expected(2, 0) = 7;
+  EXPECT_FALSE(trajopt_sqp::assembleSparseMatrix(matrix, 3, 4, triplets));
+  EXPECT_EQ(matrix.nonZeros(), 6);
+  EXPECT_TRUE(Eigen::MatrixXd(matrix).isApprox(expected, 1e-8));
+
+  // The grown pattern is reused once the collision row is active again
+  triplets = active;
+  triplets.emplace_back(2, 0, 7);
+  expected.row(1) << 0, 3, 4, 0;
+  EXPECT_TRUE(trajopt_sqp::assembleSparseMatrix(matrix, 3, 4, triplets));
+  EXPECT_EQ(matrix.nonZeros(), 6);
+  EXPECT_TRUE(Eigen::MatrixXd(matrix).isApprox(expected, 1e-8));
+
+  // A different size always rebuilds the matrix
+  triplets = active;
+  EXPECT_FALSE(trajopt_sqp::assembleSparseMatrix(matrix, 4, 4, triplets));
+  EXPECT_EQ(matrix.rows(), 4);
+  EXPECT_EQ(matrix.nonZeros(), 5);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -56,6 +56,56 @@ public:
   }
 };
 
+/** @brief Exposes the merit coefficient update from the QP multipliers */
+class MultiplierMeritSQPSolver : public trajopt_sqp::TrustRegionSQPSolver
+{
+public:
+  using trajopt_sqp::TrustRegionSQPSolver::TrustRegionSQPSolver;
+  using trajopt_sqp::TrustRegionSQPSolver::updatePenaltyFromMultipliers;
+  trajopt_sqp::SQPResults& getMutableResults() { return results_; }
+};
+
+/**
+ * @brief Keeps the joint positions inside a circle
+ * @details y(x) = x0^2 + x1^2 - radius^2 <= 0
+ */
+class CircleConstraint : public ifopt::ConstraintSet
+{
+public:
+  CircleConstraint(trajopt_ifopt::JointPosition::ConstPtr position_var,
+                   double radius,
+                   const std::string& name = "CircleConstraint")
+    : ifopt::ConstraintSet(1, name), position_var_(std::move(position_var)), radius_(radius)
+  {
+  }
+
+  Eigen::VectorXd GetValues() const final
+  {
+    Eigen::VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+    Eigen::VectorXd output(1);
+    output(0) = joint_vals.head<2>().squaredNorm() - radius_ * radius_;
+    return output;
+  }
+
+  std::vector<ifopt::Bounds> GetBounds() const final { return { ifopt::BoundSmallerZero }; }
+
+  void FillJacobianBlock(std::string var_set, Jacobian& jac_block) const final
+  {
+    // Only modify the jacobian if this constraint uses var_set
+    if (var_set != position_var_->GetName())  // NOLINT
+      return;
+
+    Eigen::VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+    jac_block.reserve(2);
+    jac_block.coeffRef(0, 0) = 2 * joint_vals(0);
+    jac_block.coeffRef(0, 1) = 2 * joint_vals(1);
+  }
+
+private:
+  trajopt_ifopt::JointPosition::ConstPtr position_var_;
+  double radius_;
+};
+
 void runJointPositionOptimizationTest(const trajopt_sqp::QPProblem::Ptr& qp_problem)
 {
   auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
@@ -189,6 +239,271 @@ TEST_F(JointPositionOptimization, joint_position_optimization_trajopt_problem)
   runJointPositionOptimizationTest(qp_problem);
 }
 
+/**
+ * @brief Moves a variable with a large range next to variables with a small range, with and without automatic scaling
+ */
+TEST_F(JointPositionOptimization, joint_position_optimization_automatic_scaling)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("JointPositionOptimization, joint_position_optimization_automatic_scaling");
+
+  auto solve = [](bool automatic_scaling) {
+    auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+    auto var = std::make_shared<trajopt_ifopt::JointPosition>(
+        Eigen::VectorXd::Zero(3), std::vector<std::string>{ "rail", "joint_1", "joint_2" }, "Joint_Position_0");
+    Eigen::MatrixX2d bounds(3, 2);
+    bounds << -50, 50, -M_PI, M_PI, -M_PI, M_PI;
+    var->SetBounds(bounds);
+    qp_problem->addVariableSet(var);
+
+    std::vector<trajopt_ifopt::JointPosition::ConstPtr> vars{ var };
+    Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(3, 1);
+    auto cnt = std::make_shared<trajopt_ifopt::JointPosConstraint>(Eigen::Vector3d(40, 1, 1), vars, coeffs);
+    qp_problem->addConstraintSet(cnt);
+    qp_problem->setup();
+
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    qp_solver->solver_->settings()->setVerbosity(DEBUG);
+    qp_solver->solver_->settings()->setWarmStart(true);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setMaxIteration(8192);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    solver.params.automatic_scaling = automatic_scaling;
+    solver.verbose = DEBUG;
+    solver.solve(qp_problem);
+    EXPECT_EQ(solver.getStatus(), trajopt_sqp::SQPStatus::NLP_CONVERGED);
+    EXPECT_TRUE(qp_problem->getVariableValues().isApprox(Eigen::Vector3d(40, 1, 1), 1e-4));
+    return solver.getResults();
+  };
+
+  trajopt_sqp::SQPResults unscaled = solve(false);
+  trajopt_sqp::SQPResults scaled = solve(true);
+  EXPECT_TRUE(unscaled.box_scaling.isOnes());
+  EXPECT_NEAR(scaled.box_scaling[0], 10, 1e-8);
+  EXPECT_NEAR(scaled.box_scaling[1], 1, 1e-8);
+  EXPECT_LT(scaled.overall_iteration, unscaled.overall_iteration);
+}
+
+/**
+ * @brief Applies a joint position constraint with the merit coefficients updated from the QP multipliers
+ */
+TEST_F(JointPositionOptimization, joint_position_optimization_multiplier_merit_update)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("JointPositionOptimization, joint_position_optimization_multiplier_merit_update");
+
+  std::vector<trajopt_sqp::QPProblem::Ptr> qp_problems{ std::make_shared<trajopt_sqp::IfoptQPProblem>(),
+                                                        std::make_shared<trajopt_sqp::TrajOptQPProblem>() };
+  for (const auto& qp_problem : qp_problems)
+  {
+    auto var = std::make_shared<trajopt_ifopt::JointPosition>(
+        Eigen::VectorXd::Zero(3), std::vector<std::string>(3, "name"), "Joint_Position_0");
+    qp_problem->addVariableSet(var);
+
+    std::vector<trajopt_ifopt::JointPosition::ConstPtr> vars{ var };
+    Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(3, 1);
+    auto cnt = std::make_shared<trajopt_ifopt::JointPosConstraint>(Eigen::Vector3d(5, 1, -1), vars, coeffs);
+    qp_problem->addConstraintSet(cnt);
+    qp_problem->setup();
+
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    qp_solver->solver_->settings()->setVerbosity(DEBUG);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+
+    MultiplierMeritSQPSolver solver(qp_solver);
+    solver.params.multiplier_merit_update = true;
+    solver.params.merit_coeff_multiplier_margin = 0.5;
+    solver.params.initial_merit_error_coeff = 0.1;
+    solver.verbose = DEBUG;
+    solver.solve(qp_problem);
+    EXPECT_EQ(solver.getStatus(), trajopt_sqp::SQPStatus::NLP_CONVERGED);
+    EXPECT_TRUE(qp_problem->getVariableValues().isApprox(Eigen::Vector3d(5, 1, -1), 1e-4));
+    ASSERT_EQ(solver.getResults().constraint_multipliers.size(), 3);
+    EXPECT_EQ(solver.getResults().constraint_names, qp_problem->getNLPConstraintNames());
+
+    // The slack cost bounds each multiplier by its merit coefficient
+    for (Eigen::Index i = 0; i < 3; ++i)
+    {
+      EXPECT_LE(std::abs(solver.getResults().constraint_multipliers[i]),
+                solver.getResults().merit_error_coeffs[i] * (1 + 1e-3));
+    }
+
+    // A violated constraint whose multiplier is at its bound is inflated, one below it is raised to the multiplier
+    // plus the margin and a satisfied constraint is unchanged
+    trajopt_sqp::SQPResults& results = solver.getMutableResults();
+    results.best_constraint_violations = Eigen::Vector3d(1, 1, 0);
+    results.merit_error_coeffs = Eigen::Vector3d::Ones();
+    results.constraint_multipliers = Eigen::Vector3d(-1, 0.8, 0.9);
+    EXPECT_TRUE(solver.updatePenaltyFromMultipliers());
+    EXPECT_TRUE(results.merit_error_coeffs.isApprox(Eigen::Vector3d(solver.params.merit_coeff_increase_ratio, 1.2, 1)));
+
+    // A multiplier with enough margin leaves its coefficient unchanged
+    results.constraint_multipliers = Eigen::Vector3d(0, 0.5, 0.9);
+    EXPECT_FALSE(solver.updatePenaltyFromMultipliers());
+    EXPECT_TRUE(results.merit_error_coeffs.isApprox(Eigen::Vector3d(solver.params.merit_coeff_increase_ratio, 1.2, 1)));
+  }
+}
+
+/**
+ * @brief Applies a joint position constraint with hinge costs which are never active screened from the QP
+ */
+TEST_F(JointPositionOptimization, joint_position_optimization_screen_inactive_hinges)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("JointPositionOptimization, joint_position_optimization_screen_inactive_hinges");
+
+  auto solve = [](bool screen_inactive_hinges) {
+    auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+    auto var = std::make_shared<trajopt_ifopt::JointPosition>(
+        Eigen::VectorXd::Zero(3), std::vector<std::string>(3, "name"), "Joint_Position_0");
+    qp_problem->addVariableSet(var);
+
+    std::vector<trajopt_ifopt::JointPosition::ConstPtr> vars{ var };
+    Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(3, 1);
+    auto cnt = std::make_shared<trajopt_ifopt::JointPosConstraint>(Eigen::Vector3d(5, 1, -1), vars, coeffs);
+    qp_problem->addConstraintSet(cnt);
+
+    std::vector<ifopt::Bounds> far_bounds(3, ifopt::Bounds(-20, 20));
+    auto far_cost = std::make_shared<trajopt_ifopt::JointPosConstraint>(far_bounds, vars, coeffs, "FarJointPos");
+    qp_problem->addCostSet(far_cost, trajopt_sqp::CostPenaltyType::HINGE);
+    qp_problem->setScreenInactiveHinges(screen_inactive_hinges);
+    qp_problem->setup();
+
+    // The screened hinges keep their slack variables but add no jacobian entries
+    qp_problem->convexify();
+    EXPECT_EQ(qp_problem->getNumScreenedHinges(), screen_inactive_hinges ? 3 : 0);
+    const Eigen::Index num_nonzeros = qp_problem->getConstraintMatrix().nonZeros();
+
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    qp_solver->solver_->settings()->setVerbosity(DEBUG);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    solver.verbose = DEBUG;
+    solver.solve(qp_problem);
+    EXPECT_EQ(solver.getStatus(), trajopt_sqp::SQPStatus::NLP_CONVERGED);
+    EXPECT_TRUE(qp_problem->getVariableValues().isApprox(Eigen::Vector3d(5, 1, -1), 1e-4));
+    return std::make_pair(qp_problem->getVariableValues(), num_nonzeros);
+  };
+
+  auto [full_values, full_num_nonzeros] = solve(false);
+  auto [screened_values, screened_num_nonzeros] = solve(true);
+  EXPECT_EQ(screened_num_nonzeros, full_num_nonzeros - 3);
+  EXPECT_TRUE(screened_values.isApprox(full_values, 1e-4));
+}
+
+/**
+ * @brief Applies a joint position constraint starting with the quadratic constraint penalty
+ */
+TEST_F(JointPositionOptimization, joint_position_optimization_quadratic_constraint_penalty)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("JointPositionOptimization, joint_position_optimization_quadratic_constraint_penalty");
+
+  std::vector<trajopt_sqp::QPProblem::Ptr> qp_problems{ std::make_shared<trajopt_sqp::IfoptQPProblem>(),
+                                                        std::make_shared<trajopt_sqp::TrajOptQPProblem>() };
+  for (const auto& qp_problem : qp_problems)
+  {
+    auto var = std::make_shared<trajopt_ifopt::JointPosition>(
+        Eigen::VectorXd::Zero(3), std::vector<std::string>(3, "name"), "Joint_Position_0");
+    qp_problem->addVariableSet(var);
+
+    std::vector<trajopt_ifopt::JointPosition::ConstPtr> vars{ var };
+    Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(3, 1);
+    auto cnt = std::make_shared<trajopt_ifopt::JointPosConstraint>(Eigen::Vector3d(5, 1, -1), vars, coeffs);
+    qp_problem->addConstraintSet(cnt);
+    qp_problem->setup();
+
+    // Each equality constraint adds two slack variables with a bound on each
+    EXPECT_EQ(qp_problem->getNumQPVars(), 9);
+    EXPECT_EQ(qp_problem->getNumQPConstraints(), 12);
+    qp_problem->setConstraintPenaltyType(trajopt_sqp::CostPenaltyType::SQUARED);
+    EXPECT_EQ(qp_problem->getNumQPVars(), 3);
+    EXPECT_EQ(qp_problem->getNumQPConstraints(), 6);
+
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    qp_solver->solver_->settings()->setVerbosity(DEBUG);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    solver.params.quadratic_constraint_penalty = true;
+    solver.verbose = DEBUG;
+    solver.solve(qp_problem);
+    EXPECT_EQ(solver.getStatus(), trajopt_sqp::SQPStatus::NLP_CONVERGED);
+    EXPECT_TRUE(qp_problem->getVariableValues().isApprox(Eigen::Vector3d(5, 1, -1), 1e-4));
+
+    // The exact penalty is always used to converge
+    EXPECT_EQ(qp_problem->getConstraintPenaltyType(), trajopt_sqp::CostPenaltyType::ABSOLUTE);
+    EXPECT_EQ(qp_problem->getNumQPVars(), 9);
+  }
+}
+
+/**
+ * @brief Pulls the joint positions towards a point outside of a circle constraint with a large initial trust region
+ * @details The first full steps fail the ratio test, the line search accepts fractions of them instead of solving new
+ * QPs
+ */
+TEST_F(JointPositionOptimization, joint_position_optimization_line_search)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("JointPositionOptimization, joint_position_optimization_line_search");
+
+  auto solve = [](bool line_search) {
+    auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+    auto var = std::make_shared<trajopt_ifopt::JointPosition>(
+        Eigen::Vector2d(10, 1), std::vector<std::string>(2, "name"), "Joint_Position_0");
+    qp_problem->addVariableSet(var);
+
+    std::vector<trajopt_ifopt::JointPosition::ConstPtr> vars{ var };
+    qp_problem->addConstraintSet(std::make_shared<CircleConstraint>(var, 2));
+
+    Eigen::VectorXd coeffs = Eigen::VectorXd::Constant(2, 1);
+    auto cost = std::make_shared<trajopt_ifopt::JointPosConstraint>(Eigen::Vector2d(3, 3), vars, coeffs, "Target");
+    qp_problem->addCostSet(cost, trajopt_sqp::CostPenaltyType::SQUARED);
+    qp_problem->setup();
+
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    qp_solver->solver_->settings()->setVerbosity(DEBUG);
+    qp_solver->solver_->settings()->setPolish(true);
+    qp_solver->solver_->settings()->setAdaptiveRho(false);
+    qp_solver->solver_->settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_->settings()->setRelativeTolerance(1e-6);
+
+    trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
+    solver.params.initial_trust_box_size = 10;
+    solver.params.initial_merit_error_coeff = 1;
+    solver.params.min_trust_box_size = 1e-5;
+    solver.params.max_iterations = 100;
+    solver.params.line_search = line_search;
+    solver.verbose = DEBUG;
+    solver.solve(qp_problem);
+    EXPECT_EQ(solver.getStatus(), trajopt_sqp::SQPStatus::NLP_CONVERGED);
+    EXPECT_TRUE(qp_problem->getVariableValues().isApprox(Eigen::Vector2d::Constant(std::sqrt(2.)), 1e-2));
+
+    // Steps accepted by the line search and by the trust region both leave the NLP variables of the best solution
+    const Eigen::VectorXd& best_var_vals = solver.getResults().best_var_vals;
+    EXPECT_EQ(best_var_vals.size(), qp_problem->getNumNLPVars());
+    EXPECT_TRUE(qp_problem->getVariableValues().isApprox(best_var_vals));
+    return std::make_pair(qp_problem->getVariableValues(), solver.getResults());
+  };
+
+  auto [shrink_values, shrink_results] = solve(false);
+  auto [line_search_values, line_search_results] = solve(true);
+  EXPECT_EQ(shrink_results.line_search_steps, 0);
+  EXPECT_EQ(shrink_results.line_search_evaluations, 0);
+  EXPECT_GT(line_search_results.line_search_steps, 0);
+  EXPECT_LE(line_search_results.line_search_steps, line_search_results.line_search_evaluations);
+  EXPECT_TRUE(line_search_values.isApprox(shrink_values, 1e-3));
+}
+
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv)
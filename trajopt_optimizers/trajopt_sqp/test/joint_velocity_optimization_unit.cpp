@@ -58,9 +58,11 @@ public:
   }
 };
 
-void runVelocityConstraintOptimizationTest(const trajopt_sqp::QPProblem::Ptr& qp_problem)
+void runVelocityConstraintOptimizationTest(const trajopt_sqp::QPProblem::Ptr& qp_problem,
+                                          bool structural_sparsity = false)
 {
   auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+  qp_solver->structural_sparsity = structural_sparsity;
   trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
   qp_solver->solver_->settings()->setVerbosity(DEBUG);
   qp_solver->solver_->settings()->setWarmStart(true);
@@ -232,6 +234,14 @@ TEST_F(VelocityConstraintOptimization, velocity_constraint_optimization_trajopt_
   runVelocityConstraintOptimizationTest(qp_problem);
 }
 
+/** @brief Same as above but the QP solver keeps explicit zeros and only updates the values between iterations */
+TEST_F(VelocityConstraintOptimization, velocity_constraint_optimization_structural_sparsity)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("VelocityConstraintOptimization, velocity_constraint_optimization_structural_sparsity");
+  runVelocityConstraintOptimizationTest(std::make_shared<trajopt_sqp::IfoptQPProblem>(), true);
+  runVelocityConstraintOptimizationTest(std::make_shared<trajopt_sqp::TrajOptQPProblem>(), true);
+}
+
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv)
@@ -215,7 +215,9 @@ public:
   }
 };
 
-void runSimpleCollisionTest(const trajopt_sqp::QPProblem::Ptr& qp_problem, const Environment::Ptr& env)
+void runSimpleCollisionTest(const trajopt_sqp::QPProblem::Ptr& qp_problem,
+                            const Environment::Ptr& env,
+                            bool use_continuation = false)
 {
   std::unordered_map<std::string, double> ipos;
   ipos["spherebot_x_joint"] = -0.75;
@@ -247,8 +249,13 @@ void runSimpleCollisionTest(const trajopt_sqp::QPProblem::Ptr& qp_problem, const
   }
 
   // Step 3: Setup collision
+  trajopt_common::CollisionContinuation::Ptr continuation;
+  if (use_continuation)
+    continuation = std::make_shared<trajopt_common::CollisionContinuation>(0.25);
+
   auto trajopt_collision_cnt_config = std::make_shared<trajopt_common::TrajOptCollisionConfig>(0.2, 1);
   trajopt_collision_cnt_config->collision_margin_buffer = 0.05;
+  trajopt_collision_cnt_config->continuation = continuation;
 
   auto collision_cnt_cache = std::make_shared<trajopt_ifopt::CollisionCache>(100);
   trajopt_ifopt::DiscreteCollisionEvaluator::Ptr collision_cnt_evaluator =
@@ -259,6 +266,7 @@ void runSimpleCollisionTest(const trajopt_sqp::QPProblem::Ptr& qp_problem, const
 
   auto trajopt_collision_cost_config = std::make_shared<trajopt_common::TrajOptCollisionConfig>(0.3, 1);
   trajopt_collision_cost_config->collision_margin_buffer = 0.05;
+  trajopt_collision_cost_config->continuation = continuation;
 
   auto collision_cost_cache = std::make_shared<trajopt_ifopt::CollisionCache>(100);
   trajopt_ifopt::DiscreteCollisionEvaluator::Ptr collision_cost_evaluator =
@@ -291,6 +299,7 @@ void runSimpleCollisionTest(const trajopt_sqp::QPProblem::Ptr& qp_problem, const
 
   // 6) solve
   solver.verbose = false;
+  solver.setCollisionContinuation(continuation);
 
   tesseract_common::Timer stopwatch;
   stopwatch.start();
@@ -298,6 +307,12 @@ void runSimpleCollisionTest(const trajopt_sqp::QPProblem::Ptr& qp_problem, const
   stopwatch.stop();
   CONSOLE_BRIDGE_logError("Test took %f seconds.", stopwatch.elapsedSeconds());
 
+  // The solution must always be checked against the target margins
+  if (continuation)
+  {
+    EXPECT_TRUE(continuation->isComplete());
+  }
+
   Eigen::VectorXd x = qp_problem->getVariableValues();
 
   std::cout << x.transpose() << std::endl;
@@ -340,6 +355,15 @@ TEST_F(SimpleCollisionTest, spheres_trajopt_problem)  // NOLINT
   runSimpleCollisionTest(qp_problem, env);  // NOLINT
 }
 
+TEST_F(SimpleCollisionTest, spheres_trajopt_problem_collision_continuation)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SimpleCollisionTest, spheres_trajopt_problem_collision_continuation");
+  EXPECT_ANY_THROW(trajopt_common::CollisionContinuation(0));  // NOLINT
+  EXPECT_ANY_THROW(trajopt_common::CollisionContinuation(-0.5));  // NOLINT
+  auto qp_problem = std::make_shared<trajopt_sqp::TrajOptQPProblem>();
+  runSimpleCollisionTest(qp_problem, env, true);  // NOLINT
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
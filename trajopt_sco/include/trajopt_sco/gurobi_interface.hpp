@@ -47,6 +47,7 @@ public:
   void setObjective(const QuadExpr&) override;
   void setVarBounds(const VarVector&, const DblVec& lower, const DblVec& upper) override;
   DblVec getVarValues(const VarVector&) const override;
+  DblVec getCntDuals(const CntVector&) const override;
   void writeToFile(const std::string& fname) const override;
   VarVector getVars() const override;
 
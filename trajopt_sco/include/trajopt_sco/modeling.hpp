@@ -45,11 +45,29 @@ public:
   void addL2Norm(const AffExprVector&);
   void addMax(const AffExprVector&);
 
+  /**
+   * @brief Drop the hinges that cannot become positive anywhere in the trust box around x
+   * @details A hinge is dropped when its argument is negative for every point with |y_i - x_i| <= trust_box_size. Its
+   * inequality, its auxiliary variable and its cost term are removed, which does not change the convex problem inside
+   * the trust box. This must be called before addConstraintsToModel.
+   * @param x The current solution, indexed by the problem variables
+   * @param trust_box_size The current size of the trust region (component-wise)
+   * @return The number of hinges that were dropped
+   */
+  std::size_t screenInactiveHinges(const DblVec& x, double trust_box_size);
+
   bool inModel() const { return model_ != nullptr; }
   void addConstraintsToModel();
   void removeFromModel();
   double value(const DblVec& x) const;
 
+  /**
+   * @brief Get the dual values of the constraints from the last solve of the model
+   * @details The order is eqs_ followed by the INEQ constraints as they were before screenInactiveHinges, the dual of
+   * a screened hinge is zero. This must be called after addConstraintsToModel.
+   */
+  DblVec getDuals() const;
+
   Model* model_;
   /// The objective Function
   QuadExpr quad_;
@@ -58,6 +76,12 @@ public:
   AffExprVector eqs_;
   // INEQ Constraints
   AffExprVector ineqs_;
+  /// Indices of the INEQ Constraints added by addHinge, the hinge variable is the last term of each
+  std::vector<std::size_t> hinge_ineqs_;
+  /// Index before screenInactiveHinges of each INEQ Constraint
+  std::vector<std::size_t> unscreened_ineqs_;
+  /// The number of INEQ Constraints before screenInactiveHinges, zero if no hinge was dropped
+  std::size_t n_unscreened_ineqs_{ 0 };
   CntVector cnts_;
 };
 
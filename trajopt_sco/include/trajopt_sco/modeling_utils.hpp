@@ -66,6 +66,14 @@ public:
                   const Eigen::Ref<const Eigen::VectorXd>& coeffs,
                   PenaltyType pen_type,
                   const std::string& name);
+  /// supply error function, gradient and a calculator returning both, which must agree with f and dfdx
+  CostFromErrFunc(VectorOfVector::Ptr f,
+                  MatrixOfVector::Ptr dfdx,
+                  std::shared_ptr<const VectorAndMatrixOfVector> f_and_dfdx,
+                  VarVector vars,
+                  const Eigen::Ref<const Eigen::VectorXd>& coeffs,
+                  PenaltyType pen_type,
+                  const std::string& name);
   double value(const DblVec& x) override;
   ConvexObjective::Ptr convex(const DblVec& x, Model* model) override;
   VarVector getVars() override { return vars_; }
@@ -73,10 +81,15 @@ public:
 protected:
   VectorOfVector::Ptr f_;
   MatrixOfVector::Ptr dfdx_;
+  /** @brief Optional calculator used by convex() instead of f_ and dfdx_, avoiding a second error evaluation */
+  std::shared_ptr<const VectorAndMatrixOfVector> f_and_dfdx_;
   VarVector vars_;
   Eigen::VectorXd coeffs_;
   PenaltyType pen_type_;
   double epsilon_;
+
+  /** @brief Calculate the error and jacobian, using the combined calculator when available */
+  void calcErrAndJac(const Eigen::VectorXd& x, Eigen::VectorXd& y, Eigen::MatrixXd& jac) const;
 };
 
 class ConstraintFromErrFunc : public Constraint
@@ -97,6 +110,14 @@ public:
                         const Eigen::Ref<const Eigen::VectorXd>& coeffs,
                         ConstraintType type,
                         const std::string& name);
+  /// supply error function, gradient and a calculator returning both, which must agree with f and dfdx
+  ConstraintFromErrFunc(VectorOfVector::Ptr f,
+                        MatrixOfVector::Ptr dfdx,
+                        std::shared_ptr<const VectorAndMatrixOfVector> f_and_dfdx,
+                        VarVector vars,
+                        const Eigen::Ref<const Eigen::VectorXd>& coeffs,
+                        ConstraintType type,
+                        const std::string& name);
   DblVec value(const DblVec& x) override;
   ConvexConstraints::Ptr convex(const DblVec& x, Model* model) override;
   ConstraintType type() override { return type_; }
@@ -105,11 +126,16 @@ public:
 protected:
   VectorOfVector::Ptr f_;
   MatrixOfVector::Ptr dfdx_;
+  /** @brief Optional calculator used by convex() instead of f_ and dfdx_, avoiding a second error evaluation */
+  std::shared_ptr<const VectorAndMatrixOfVector> f_and_dfdx_;
   VarVector vars_;
   Eigen::VectorXd coeffs_;
   ConstraintType type_;
   double epsilon_;
   Eigen::VectorXd scaling_;
+
+  /** @brief Calculate the error and jacobian, using the combined calculator when available */
+  void calcErrAndJac(const Eigen::VectorXd& x, Eigen::VectorXd& y, Eigen::MatrixXd& jac) const;
 };
 
 std::string AffExprToString(const AffExpr& aff);
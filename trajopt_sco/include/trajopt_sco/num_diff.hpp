@@ -69,6 +69,33 @@ public:
   static MatrixOfVector::Ptr construct(func f);
 };
 
+/**
+ * @brief Optional interface for jacobian calculators that can also produce the error value
+ * @details Implementations compute both from a single evaluation (e.g. one forward kinematics call) so the
+ * convexification of CostFromErrFunc and ConstraintFromErrFunc does not need to call the error function again.
+ */
+class VectorAndMatrixOfVector
+{
+public:
+  using Ptr = std::shared_ptr<VectorAndMatrixOfVector>;
+
+  VectorAndMatrixOfVector() = default;
+  virtual ~VectorAndMatrixOfVector() = default;
+  VectorAndMatrixOfVector(const VectorAndMatrixOfVector&) = default;
+  VectorAndMatrixOfVector& operator=(const VectorAndMatrixOfVector&) = default;
+  VectorAndMatrixOfVector(VectorAndMatrixOfVector&&) = default;
+  VectorAndMatrixOfVector& operator=(VectorAndMatrixOfVector&&) = default;
+
+  /**
+   * @brief Calculate the error and jacobian at x
+   * @param x The input values
+   * @param y The error at x
+   * @param jac The jacobian of the error at x
+   */
+  virtual void operator()(const Eigen::VectorXd& x, Eigen::VectorXd& y, Eigen::MatrixXd& jac) const = 0;
+  void call(const Eigen::VectorXd& x, Eigen::VectorXd& y, Eigen::MatrixXd& jac) const { operator()(x, y, jac); }
+};
+
 Eigen::VectorXd calcForwardNumGrad(const ScalarOfVector& f, const Eigen::VectorXd& x, double epsilon);
 Eigen::MatrixXd calcForwardNumJac(const VectorOfVector& f, const Eigen::VectorXd& x, double epsilon);
 void calcGradAndDiagHess(const ScalarOfVector& f,
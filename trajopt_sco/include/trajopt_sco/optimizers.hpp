@@ -7,6 +7,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/modeling.hpp>
+#include <trajopt_sco/task_executor.hpp>
 
 /*
  * Algorithms for non-convex, constrained optimization
@@ -34,7 +35,30 @@ struct OptResults
   double total_cost{ 0 };
   DblVec cost_vals;
   DblVec cnt_viols;
+  /**
+   * @brief Multiplier estimates of each constraint from the duals of the last solved convex subproblem
+   * @details Indexed like cnt_viols, with one value per row of the convexified constraint (equalities followed by
+   * inequalities). The multiplier of an active inequality is in [0, merit coeff].
+   */
+  std::vector<DblVec> cnt_duals;
   int n_func_evals{ 0 }, n_qp_solves{ 0 };
+  /** @brief Number of exact evaluations stopped early because the step was known to be rejected */
+  int n_early_exits{ 0 };
+  /**
+   * @brief Number of rejected steps for which the line search accepted a fraction of the step
+   * @details Each of them saves at least one QP solve, which would otherwise be needed after shrinking the trust region
+   */
+  int n_line_search_steps{ 0 };
+  /** @brief Number of exact evaluations done by the line search, they are also counted in n_func_evals */
+  int n_line_search_evals{ 0 };
+  /** @brief Number of hinges dropped from the convex subproblems by screen_inactive_hinges, summed over all of them */
+  int n_screened_hinges{ 0 };
+  /** @brief Time in seconds spent convexifying the costs and constraints and building the convex model */
+  double convexify_time{ 0 };
+  /** @brief Time in seconds spent in the convex solver */
+  double qp_solve_time{ 0 };
+  /** @brief Time in seconds spent evaluating the model and exact merit of new solutions */
+  double evaluate_time{ 0 };
   void clear()
   {
     x.clear();
@@ -42,8 +66,16 @@ struct OptResults
     total_cost = 0;
     cost_vals.clear();
     cnt_viols.clear();
+    cnt_duals.clear();
     n_func_evals = 0;
     n_qp_solves = 0;
+    n_early_exits = 0;
+    n_line_search_steps = 0;
+    n_line_search_evals = 0;
+    n_screened_hinges = 0;
+    convexify_time = 0;
+    qp_solve_time = 0;
+    evaluate_time = 0;
   }
   OptResults() { clear(); }
 };
@@ -111,14 +143,67 @@ struct BasicTrustRegionSQPParameters
   /** @brief If true, merit coeffs will only be inflated for the constaints that failed. This can help when there are
    * lots of constraints */
   bool inflate_constraints_individually = true;
+  /**
+   * @brief If true, the merit coefficients of violated constraints are updated from the multipliers of the last QP
+   * @details A coefficient whose largest multiplier magnitude is at its bound is inflated by
+   * merit_coeff_increase_ratio, because the QP needed the slack variable and the multiplier is only a lower bound on
+   * the coefficient required. Any other violated constraint is only raised to (1 + merit_coeff_multiplier_margin)
+   * times its largest multiplier magnitude. If no coefficient changes, the default update is used.
+   */
+  bool multiplier_merit_update = false;
+  /** @brief The relative margin added to the multiplier magnitude, see multiplier_merit_update */
+  double merit_coeff_multiplier_margin = 0.5;
   /** @brief Current size of trust region (component-wise) */
   double trust_box_size = 1e-1;
   /** @brief Log results to file */
   bool log_results = false;
   /** @brief Directory to store log results */
   std::string log_dir = "/tmp";
-  /** @brief If greater than one, multi threaded functions are called */
+  /**
+   * @brief The maximum number of threads used by the multi threaded optimizer, including the calling thread.
+   * @details Zero and one run everything on the calling thread, a negative value uses the concurrency of the task
+   * executor.
+   */
   int num_threads = 0;
+  /**
+   * @brief If true, the exact constraint violations of a candidate step are evaluated in chunks, cheapest first, and
+   * the evaluation stops once a lower bound on the merit shows the step will be rejected.
+   * @details Costs are always evaluated completely. Accepted steps are always evaluated completely, so the ratio test
+   * is unchanged for them.
+   */
+  bool streaming_constraint_eval = false;
+  /** @brief The number of constraints evaluated between checks of the merit lower bound */
+  int streaming_constraint_chunk_size = 4;
+  /**
+   * @brief If true, a backtracking line search on the exact merit is run along a rejected step before the trust region
+   * is shrunk
+   * @details A fraction of the step is accepted if its exact improvement is positive and at least
+   * improve_ratio_threshold times the fraction of the approximate improvement, which bounds the improvement of the
+   * convex model along the step. The trust region is then scaled by the accepted fraction. This costs exact evaluations
+   * but no QP solve.
+   */
+  bool line_search = false;
+  /** @brief The maximum number of step fractions evaluated by the line search */
+  int max_line_search_steps = 3;
+  /** @brief The step fraction is scaled by this for each line search step, starting from the full step */
+  double line_search_shrink_ratio = 0.5;
+  /**
+   * @brief If true, hinges that cannot become positive anywhere in the current trust box are left out of the QP
+   * @details A hinge is dropped together with its auxiliary variable when its linearization plus the trust box size
+   * times the L1 norm of its gradient is negative. The QP solution is unchanged. The screening is repeated after every
+   * convexification so the hinges come back once the trust box grows.
+   */
+  bool screen_inactive_hinges = false;
+  /**
+   * @brief If true, the trust region of each variable and the merit coefficient of each constraint are scaled
+   * @details The trust region of a variable is scaled by the range of its bounds relative to the median range. The
+   * merit coefficient of a constraint is divided by the largest coefficient of its linearization at the initial
+   * values relative to the median constraint. This keeps variables and constraints with mixed units equally
+   * conditioned.
+   */
+  bool automatic_scaling = false;
+  /** @brief The automatic scaling factors are limited to [1 / max_automatic_scaling, max_automatic_scaling] */
+  double max_automatic_scaling = 10;
 };
 
 class BasicTrustRegionSQP : public Optimizer
@@ -164,6 +249,30 @@ public:
 
   virtual DblVec evaluateModelCntViols(const std::vector<ConvexConstraints::Ptr>& cnts, const DblVec& x) const;
 
+  /** @brief Evaluate the exact costs and constraint violations, by default calls evaluateCosts and
+   * evaluateConstraintViols */
+  virtual void evaluateCostsAndConstraintViols(const std::vector<Cost::Ptr>& costs,
+                                               const std::vector<Constraint::Ptr>& cnts,
+                                               const DblVec& x,
+                                               DblVec& cost_vals,
+                                               DblVec& cnt_viols) const;
+
+  /** @brief Convexify the costs and constraints, by default calls convexifyCosts and convexifyConstraints */
+  virtual void convexifyCostsAndConstraints(const std::vector<Cost::Ptr>& costs,
+                                            const std::vector<Constraint::Ptr>& cnts,
+                                            const DblVec& x,
+                                            Model* model,
+                                            std::vector<ConvexObjective::Ptr>& cost_models,
+                                            std::vector<ConvexConstraints::Ptr>& cnt_models) const;
+
+  /** @brief Evaluate the model costs and constraint violations, by default calls evaluateModelCosts and
+   * evaluateModelCntViols */
+  virtual void evaluateModelCostsAndCntViols(const std::vector<ConvexObjective::Ptr>& costs,
+                                             const std::vector<ConvexConstraints::Ptr>& cnts,
+                                             const DblVec& x,
+                                             DblVec& cost_vals,
+                                             DblVec& cnt_viols) const;
+
   virtual std::vector<std::string> getCostNames(const std::vector<Cost::Ptr>& costs) const;
 
   virtual std::vector<std::string> getCntNames(const std::vector<Constraint::Ptr>& cnts) const;
@@ -175,17 +284,54 @@ protected:
   void adjustTrustRegion(double ratio);
   void setTrustRegionSize(double trust_box_size);
   void setTrustBoxConstraints(const DblVec& x);
+  void calcAutomaticScaling(const std::vector<Constraint::Ptr>& cnts, std::vector<double>& merit_error_coeffs);
+
+  /**
+   * @brief Search for a fraction of the rejected step from results_.x to new_x which improves the exact merit enough
+   * @details If one is found, results_ is moved to it. See BasicTrustRegionSQPParameters::line_search.
+   * @param new_x The variable values of the rejected step
+   * @param old_merit The exact merit at results_.x
+   * @param approx_merit_improve The improvement of the convex model for the full step
+   * @param constraints The constraints of the problem
+   * @param merit_error_coeffs The coefficients of the constraint violations in the merit
+   * @return The accepted step fraction, zero if none was accepted
+   */
+  double lineSearch(const DblVec& new_x,
+                    double old_merit,
+                    double approx_merit_improve,
+                    const std::vector<Constraint::Ptr>& constraints,
+                    const std::vector<double>& merit_error_coeffs);
+
+  /**
+   * @brief Update the merit coefficients of the violated constraints from results_.cnt_duals
+   * @details See BasicTrustRegionSQPParameters::multiplier_merit_update
+   * @param merit_error_coeffs The coefficients of the constraint violations in the merit
+   * @return True if any merit coefficient changed
+   */
+  bool updateMeritCoeffsFromDuals(std::vector<double>& merit_error_coeffs) const;
 
   Model::Ptr model_;
   BasicTrustRegionSQPParameters param_;
+  /** @brief The trust region size of each variable relative to param_.trust_box_size */
+  DblVec box_scaling_;
 };
 
+/**
+ * @brief A BasicTrustRegionSQP which evaluates and convexifies the costs and constraints in parallel
+ * @details The work runs on a TaskExecutor, by default the process wide executor returned by getDefaultTaskExecutor()
+ */
 class BasicTrustRegionSQPMultiThreaded : public BasicTrustRegionSQP
 {
 public:
   using Ptr = std::shared_ptr<BasicTrustRegionSQPMultiThreaded>;
   using BasicTrustRegionSQP::BasicTrustRegionSQP;
 
+  /** @brief Set the task executor, a nullptr uses the default task executor */
+  void setTaskExecutor(TaskExecutor::Ptr executor);
+
+  /** @brief Get the task executor used by the optimizer */
+  TaskExecutor::Ptr getTaskExecutor() const;
+
   // Utility functions, exposed to allow overriding for multi threaded implementations
   DblVec evaluateCosts(const std::vector<Cost::Ptr>& costs, const DblVec& x) const override final;
 
@@ -202,6 +348,41 @@ public:
   DblVec evaluateModelCosts(const std::vector<ConvexObjective::Ptr>& costs, const DblVec& x) const override final;
 
   DblVec evaluateModelCntViols(const std::vector<ConvexConstraints::Ptr>& cnts, const DblVec& x) const override final;
+
+  /**
+   * @brief The fused versions run costs and constraints in a single parallel region.
+   * @details Terms are scheduled longest first, using the evaluation times measured in the previous call, so the few
+   * expensive terms (collision, singularity avoidance) do not end up at the tail of the region.
+   */
+  void evaluateCostsAndConstraintViols(const std::vector<Cost::Ptr>& costs,
+                                       const std::vector<Constraint::Ptr>& cnts,
+                                       const DblVec& x,
+                                       DblVec& cost_vals,
+                                       DblVec& cnt_viols) const override final;
+
+  void convexifyCostsAndConstraints(const std::vector<Cost::Ptr>& costs,
+                                    const std::vector<Constraint::Ptr>& cnts,
+                                    const DblVec& x,
+                                    Model* model,
+                                    std::vector<ConvexObjective::Ptr>& cost_models,
+                                    std::vector<ConvexConstraints::Ptr>& cnt_models) const override final;
+
+  void evaluateModelCostsAndCntViols(const std::vector<ConvexObjective::Ptr>& costs,
+                                     const std::vector<ConvexConstraints::Ptr>& cnts,
+                                     const DblVec& x,
+                                     DblVec& cost_vals,
+                                     DblVec& cnt_viols) const override final;
+
+private:
+  TaskExecutor::Ptr executor_;
+
+  /** @brief The max_concurrency passed to the task executor, based on param_.num_threads */
+  std::size_t getMaxConcurrency() const;
+
+  /** @brief Measured time of each term (costs followed by constraints) in the last call of each fused phase */
+  mutable std::vector<double> eval_times_;
+  mutable std::vector<double> convexify_times_;
+  mutable std::vector<double> model_eval_times_;
 };
 
 /**
@@ -254,6 +435,11 @@ struct BasicTrustRegionSQPResults
    * merit_improve_ratio = exact_merit_improve / approx_merit_improve;
    */
   double merit_improve_ratio{ 0 };
+  /**
+   * @brief True if the exact constraint evaluation stopped early because the step was known to be rejected.
+   * @details In that case the unevaluated entries of new_cnt_viols are zero and new_merit is a lower bound.
+   */
+  bool exact_evaluation_aborted{ false };
   /** @brief This is the penalty applied to the constraints for this iteration */
   std::vector<double> merit_error_coeffs;
   /** @brief Variable names */
@@ -303,5 +489,18 @@ struct BasicTrustRegionSQPResults
 
 private:
   const BasicTrustRegionSQP& parent_;
+  /** @brief Estimated evaluation time of each exact constraint, used to evaluate cheap constraints first */
+  std::vector<double> cnt_eval_times_;
+
+  /**
+   * @brief Evaluate the exact constraint violations at new_x in chunks, cheapest first
+   * @param constraints The current exact constraints
+   * @param chunk_size The number of constraints evaluated between checks
+   * @param rejection_merit Any merit above this value leads to the step being rejected
+   * @return True if the evaluation stopped early because the step will be rejected
+   */
+  bool evaluateConstraintViolsStreaming(const std::vector<Constraint::Ptr>& constraints,
+                                        std::size_t chunk_size,
+                                        double rejection_merit);
 };
 }  // namespace sco
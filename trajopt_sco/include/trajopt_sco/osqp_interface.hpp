@@ -59,6 +59,7 @@ class OSQPModel : public Model
   AffExprVector cnt_exprs_;        /**< constraints expressions */
   ConstraintTypeVector cnt_types_; /**< constraints types */
   DblVec solution_;                /**< optimizizer's solution for current model */
+  DblVec duals_;                   /**< optimizizer's dual values of the constraints for current model */
 
   std::unique_ptr<csc, decltype(&free)> P_; /**< Takes ownership of OSQPData.P to avoid having to deallocate manually */
   std::unique_ptr<csc, decltype(&free)> A_; /**< Takes ownership of OSQPData.A to avoid having to deallocate manually */
@@ -101,6 +102,7 @@ public:
   void setObjective(const QuadExpr&) override;
   void setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper) override;
   DblVec getVarValues(const VarVector& vars) const override;
+  DblVec getCntDuals(const CntVector& cnts) const override;
   void writeToFile(const std::string& fname) const override;
   VarVector getVars() const override;
 };
@@ -59,6 +59,7 @@ class qpOASESModel : public Model
   AffExprVector cnt_exprs_;        /**< constraints expressions */
   ConstraintTypeVector cnt_types_; /**< constraints types */
   DblVec solution_;                /**< optimizizer's solution for current model */
+  DblVec duals_;                   /**< optimizizer's dual values of the constraints for current model */
 
   IntVec H_row_indices_;     /**< row indices for Hessian, CSC format */
   IntVec H_column_pointers_; /**< column pointers for Hessian, CSC format */
@@ -97,6 +98,7 @@ public:
   void setObjective(const QuadExpr&) override;
   void setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper) override;
   DblVec getVarValues(const VarVector& vars) const override;
+  DblVec getCntDuals(const CntVector& cnts) const override;
   void writeToFile(const std::string& fname) const override;
   VarVector getVars() const override;
 };
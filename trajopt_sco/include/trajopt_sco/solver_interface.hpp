@@ -94,6 +94,15 @@ public:
   virtual void setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper) = 0;
   virtual double getVarValue(const Var& var) const;
   virtual DblVec getVarValues(const VarVector& vars) const = 0;
+
+  /**
+   * @brief Get the dual values of constraints from the last successful optimize
+   * @details The dual is the multiplier y of the constraint in the lagrangian f(x) + y * expr(x), so it is non-negative
+   * for an active inequality and zero for an inactive one. Solvers that do not provide dual values return zeros.
+   */
+  virtual double getCntDual(const Cnt& cnt) const;
+  virtual DblVec getCntDuals(const CntVector& cnts) const;
+
   virtual CvxOptStatus optimize() = 0;
 
   virtual void setObjective(const AffExpr&) = 0;
@@ -0,0 +1,96 @@
+#pragma once
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace sco
+{
+/**
+ * @brief Runs the tasks of the multi threaded optimizers
+ * @details Implement this to run the optimizer work on an existing scheduler of the application
+ */
+class TaskExecutor
+{
+public:
+  using Ptr = std::shared_ptr<TaskExecutor>;
+  using ConstPtr = std::shared_ptr<const TaskExecutor>;
+
+  TaskExecutor() = default;
+  virtual ~TaskExecutor() = default;
+  TaskExecutor(const TaskExecutor&) = delete;
+  TaskExecutor& operator=(const TaskExecutor&) = delete;
+  TaskExecutor(TaskExecutor&&) = delete;
+  TaskExecutor& operator=(TaskExecutor&&) = delete;
+
+  /**
+   * @brief Call fn for each index in [0, n) and return once all calls have finished
+   * @details Indices are claimed in increasing order. It may be called concurrently and from within fn. If fn throws,
+   * the remaining indices are skipped and the first exception is rethrown.
+   * @param n The number of indices
+   * @param max_concurrency The maximum number of threads calling fn, including the caller. Zero uses the executor
+   * default.
+   * @param fn The function called with each index
+   */
+  virtual void parallelFor(std::size_t n, std::size_t max_concurrency, const std::function<void(std::size_t)>& fn) = 0;
+
+  /** @brief The maximum number of threads the executor runs tasks on, including the caller */
+  virtual std::size_t getConcurrency() const = 0;
+};
+
+/**
+ * @brief A task executor with a fixed set of persistent worker threads
+ * @details The calling thread works on its own tasks along with the workers, so a parallelFor called from a task
+ * always completes even if all workers are busy. Concurrent callers share the workers, so the total number of threads
+ * running tasks is bounded by the number of workers plus the number of callers.
+ */
+class ThreadPoolExecutor : public TaskExecutor
+{
+public:
+  using Ptr = std::shared_ptr<ThreadPoolExecutor>;
+  using ConstPtr = std::shared_ptr<const ThreadPoolExecutor>;
+
+  /** @param num_threads The number of threads running tasks, including the caller. Zero uses the number of cores. */
+  explicit ThreadPoolExecutor(std::size_t num_threads = 0);
+  ~ThreadPoolExecutor() override;
+  ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+  ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+  ThreadPoolExecutor(ThreadPoolExecutor&&) = delete;
+  ThreadPoolExecutor& operator=(ThreadPoolExecutor&&) = delete;
+
+  void parallelFor(std::size_t n, std::size_t max_concurrency, const std::function<void(std::size_t)>& fn) override;
+
+  std::size_t getConcurrency() const override;
+
+private:
+  struct Job;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  /** @brief One entry per worker requested by a job, a job is queued as many times as workers can help with it */
+  std::deque<std::shared_ptr<Job>> queue_;
+  bool stop_{ false };
+
+  void workerLoop();
+};
+
+/**
+ * @brief Get the task executor used by optimizers which were not given one
+ * @details A ThreadPoolExecutor with one thread per core is created on first use
+ */
+TaskExecutor::Ptr getDefaultTaskExecutor();
+
+/**
+ * @brief Replace the task executor used by optimizers which were not given one
+ * @details Use this to cap the parallelism of all optimizers in the process. Calls already running keep the previous
+ * executor. A nullptr restores the default thread pool.
+ */
+void setDefaultTaskExecutor(TaskExecutor::Ptr executor);
+}  // namespace sco
@@ -228,6 +228,19 @@ DblVec GurobiModel::getVarValues(const VarVector& vars) const
   return out;
 }
 
+DblVec GurobiModel::getCntDuals(const CntVector& cnts) const
+{
+  assert((cnts.size() == 0) || (cnts[0].cnt_rep->creator == this));
+  IntVec inds;
+  cnts2inds(cnts, inds);
+  DblVec out(inds.size());
+  ENSURE_SUCCESS(GRBgetdblattrlist(m_model, GRB_DBL_ATTR_PI, static_cast<int>(inds.size()), inds.data(), out.data()));
+  // Gurobi duals of less equal constraints are non-positive when minimizing
+  for (double& dual : out)
+    dual = -dual;
+  return out;
+}
+
 CvxOptStatus GurobiModel::optimize()
 {
   ENSURE_SUCCESS(GRBoptimize(m_model));
@@ -1,9 +1,11 @@
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
 #include <boost/format.hpp>
 #include <cstdio>
 #include <iostream>
 #include <sstream>
+#include <unordered_set>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/expr_ops.hpp>
@@ -20,6 +22,7 @@ void ConvexObjective::addHinge(const AffExpr& affexpr, double coeff)
 {
   Var hinge = model_->addVar("hinge", 0, static_cast<double>(INFINITY));
   vars_.push_back(hinge);
+  hinge_ineqs_.push_back(ineqs_.size());
   ineqs_.push_back(affexpr);
   exprDec(ineqs_.back(), hinge);
   AffExpr hinge_cost = exprMult(AffExpr(hinge), coeff);
@@ -55,6 +58,7 @@ void ConvexObjective::addHinges(const AffExprVector& ev)
 {
   vars_.reserve(vars_.size() + ev.size());
   ineqs_.reserve(ineqs_.size() + ev.size());
+  hinge_ineqs_.reserve(hinge_ineqs_.size() + ev.size());
   for (const auto& i : ev)
     addHinge(i, 1);
 }
@@ -84,6 +88,99 @@ void ConvexObjective::addMax(const AffExprVector& ev)
   }
 }
 
+std::size_t ConvexObjective::screenInactiveHinges(const DblVec& x, double trust_box_size)
+{
+  assert(cnts_.empty());
+  std::vector<bool> drop(ineqs_.size(), false);
+  std::unordered_set<const VarRep*> dropped_reps;
+  VarVector dropped_vars;
+  for (std::size_t idx : hinge_ineqs_)
+  {
+    // Upper bound of the hinge argument over the trust box, the hinge variable itself is the last term
+    const AffExpr& aff = ineqs_[idx];
+    double upper = aff.constant;
+    bool bounded = true;
+    for (std::size_t i = 0; i + 1 < aff.vars.size(); ++i)
+    {
+      const std::size_t var_idx = aff.vars[i].var_rep->index;
+      if (var_idx >= x.size())
+      {
+        bounded = false;
+        break;
+      }
+      upper += (aff.coeffs[i] * x[var_idx]) + (fabs(aff.coeffs[i]) * trust_box_size);
+    }
+
+    if (bounded && upper < 0)
+    {
+      drop[idx] = true;
+      dropped_reps.insert(aff.vars.back().var_rep.get());
+      dropped_vars.push_back(aff.vars.back());
+    }
+  }
+
+  if (dropped_vars.empty())
+    return 0;
+
+  auto is_dropped = [&dropped_reps](const Var& var) {
+    return dropped_reps.find(var.var_rep.get()) != dropped_reps.end();
+  };
+
+  // Remove the hinge costs from the objective
+  AffExpr& affexpr = quad_.affexpr;
+  std::size_t n_kept = 0;
+  for (std::size_t i = 0; i < affexpr.vars.size(); ++i)
+  {
+    if (is_dropped(affexpr.vars[i]))
+      continue;
+
+    affexpr.vars[n_kept] = affexpr.vars[i];
+    affexpr.coeffs[n_kept] = affexpr.coeffs[i];
+    ++n_kept;
+  }
+  affexpr.vars.resize(n_kept);
+  affexpr.coeffs.resize(n_kept);
+
+  // Remove the inequalities and update the indices of the remaining hinges
+  std::vector<std::size_t> new_idx(ineqs_.size());
+  n_kept = 0;
+  for (std::size_t i = 0; i < ineqs_.size(); ++i)
+  {
+    new_idx[i] = n_kept;
+    if (drop[i])
+      continue;
+
+    if (n_kept != i)
+      ineqs_[n_kept] = std::move(ineqs_[i]);
+    ++n_kept;
+  }
+  ineqs_.resize(n_kept);
+
+  std::vector<std::size_t> unscreened_ineqs;
+  unscreened_ineqs.reserve(n_kept);
+  for (std::size_t i = 0; i < drop.size(); ++i)
+  {
+    if (!drop[i])
+      unscreened_ineqs.push_back((n_unscreened_ineqs_ == 0) ? i : unscreened_ineqs_[i]);
+  }
+  if (n_unscreened_ineqs_ == 0)
+    n_unscreened_ineqs_ = drop.size();
+  unscreened_ineqs_ = std::move(unscreened_ineqs);
+
+  std::vector<std::size_t> hinge_ineqs;
+  hinge_ineqs.reserve(hinge_ineqs_.size() - dropped_vars.size());
+  for (std::size_t idx : hinge_ineqs_)
+  {
+    if (!drop[idx])
+      hinge_ineqs.push_back(new_idx[idx]);
+  }
+  hinge_ineqs_ = std::move(hinge_ineqs);
+
+  vars_.erase(std::remove_if(vars_.begin(), vars_.end(), is_dropped), vars_.end());
+  model_->removeVars(dropped_vars);
+  return dropped_vars.size();
+}
+
 void ConvexObjective::addConstraintsToModel()
 {
   cnts_.reserve(eqs_.size() + ineqs_.size());
@@ -148,6 +245,20 @@ ConvexConstraints::~ConvexConstraints()
 }
 
 double ConvexObjective::value(const DblVec& x) const { return quad_.value(x); }
+
+DblVec ConvexObjective::getDuals() const
+{
+  DblVec duals = model_->getCntDuals(cnts_);
+  if (n_unscreened_ineqs_ == 0)
+    return duals;
+
+  DblVec out(eqs_.size() + n_unscreened_ineqs_, 0);
+  std::copy(duals.begin(), duals.begin() + static_cast<long int>(eqs_.size()), out.begin());
+  for (std::size_t i = 0; i < unscreened_ineqs_.size(); ++i)
+    out[eqs_.size() + unscreened_ineqs_[i]] = duals[eqs_.size() + i];
+
+  return out;
+}
 DblVec Constraint::violations(const DblVec& x)
 {
   DblVec val = value(x);
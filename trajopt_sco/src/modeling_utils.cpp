@@ -140,6 +140,23 @@ CostFromErrFunc::CostFromErrFunc(VectorOfVector::Ptr f,
   , epsilon_(DEFAULT_EPSILON)
 {
 }
+CostFromErrFunc::CostFromErrFunc(VectorOfVector::Ptr f,
+                                 MatrixOfVector::Ptr dfdx,
+                                 std::shared_ptr<const VectorAndMatrixOfVector> f_and_dfdx,
+                                 VarVector vars,
+                                 const Eigen::Ref<const Eigen::VectorXd>& coeffs,
+                                 PenaltyType pen_type,
+                                 const std::string& name)
+  : Cost(name)
+  , f_(std::move(f))
+  , dfdx_(std::move(dfdx))
+  , f_and_dfdx_(std::move(f_and_dfdx))
+  , vars_(std::move(vars))
+  , coeffs_(coeffs)
+  , pen_type_(pen_type)
+  , epsilon_(DEFAULT_EPSILON)
+{
+}
 double CostFromErrFunc::value(const DblVec& x)
 {
   Eigen::VectorXd x_eigen = getVec(x, vars_);
@@ -165,12 +182,25 @@ double CostFromErrFunc::value(const DblVec& x)
 
   return err.array().sum();
 }
+void CostFromErrFunc::calcErrAndJac(const Eigen::VectorXd& x, Eigen::VectorXd& y, Eigen::MatrixXd& jac) const
+{
+  if (f_and_dfdx_)
+  {
+    f_and_dfdx_->call(x, y, jac);
+    return;
+  }
+
+  jac = (dfdx_) ? dfdx_->call(x) : calcForwardNumJac(*f_, x, epsilon_);
+  y = f_->call(x);
+}
+
 ConvexObjective::Ptr CostFromErrFunc::convex(const DblVec& x, Model* model)
 {
   Eigen::VectorXd x_eigen = getVec(x, vars_);
-  Eigen::MatrixXd jac = (dfdx_) ? dfdx_->call(x_eigen) : calcForwardNumJac(*f_, x_eigen, epsilon_);
+  Eigen::VectorXd y;
+  Eigen::MatrixXd jac;
+  calcErrAndJac(x_eigen, y, jac);
   auto out = std::make_shared<ConvexObjective>(model);
-  Eigen::VectorXd y = f_->call(x_eigen);
   for (int i = 0; i < jac.rows(); ++i)
   {
     AffExpr aff = affFromValGrad(y[i], x_eigen, jac.row(i), vars_);
@@ -235,6 +265,24 @@ ConstraintFromErrFunc::ConstraintFromErrFunc(VectorOfVector::Ptr f,
 {
 }
 
+ConstraintFromErrFunc::ConstraintFromErrFunc(VectorOfVector::Ptr f,
+                                             MatrixOfVector::Ptr dfdx,
+                                             std::shared_ptr<const VectorAndMatrixOfVector> f_and_dfdx,
+                                             VarVector vars,
+                                             const Eigen::Ref<const Eigen::VectorXd>& coeffs,
+                                             ConstraintType type,
+                                             const std::string& name)
+  : Constraint(name)
+  , f_(std::move(f))
+  , dfdx_(std::move(dfdx))
+  , f_and_dfdx_(std::move(f_and_dfdx))
+  , vars_(std::move(vars))
+  , coeffs_(coeffs)
+  , type_(type)
+  , epsilon_(DEFAULT_EPSILON)
+{
+}
+
 DblVec ConstraintFromErrFunc::value(const DblVec& x)
 {
   Eigen::VectorXd x_eigen = getVec(x, vars_);
@@ -244,12 +292,25 @@ DblVec ConstraintFromErrFunc::value(const DblVec& x)
   return trajopt_common::toDblVec(err);
 }
 
+void ConstraintFromErrFunc::calcErrAndJac(const Eigen::VectorXd& x, Eigen::VectorXd& y, Eigen::MatrixXd& jac) const
+{
+  if (f_and_dfdx_)
+  {
+    f_and_dfdx_->call(x, y, jac);
+    return;
+  }
+
+  jac = (dfdx_) ? dfdx_->call(x) : calcForwardNumJac(*f_, x, epsilon_);
+  y = f_->call(x);
+}
+
 ConvexConstraints::Ptr ConstraintFromErrFunc::convex(const DblVec& x, Model* model)
 {
   Eigen::VectorXd x_eigen = getVec(x, vars_);
-  Eigen::MatrixXd jac = (dfdx_) ? dfdx_->call(x_eigen) : calcForwardNumJac(*f_, x_eigen, epsilon_);
+  Eigen::VectorXd y;
+  Eigen::MatrixXd jac;
+  calcErrAndJac(x_eigen, y, jac);
   auto out = std::make_shared<ConvexConstraints>(model);
-  Eigen::VectorXd y = f_->call(x_eigen);
   for (int i = 0; i < jac.rows(); ++i)
   {
     AffExpr aff = affFromValGrad(y[i], x_eigen, jac.row(i), vars_);
@@ -1,9 +1,11 @@
 #include <trajopt_common/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
 #include <boost/format.hpp>
 #include <cmath>
 #include <chrono>
 #include <cstdio>
+#include <numeric>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/expr_ops.hpp>
@@ -25,7 +27,14 @@ std::ostream& operator<<(std::ostream& o, const OptResults& r)
     << "cost values: " << trajopt_common::Str(r.cost_vals) << std::endl
     << "constraint violations: " << trajopt_common::Str(r.cnt_viols) << std::endl
     << "n func evals: " << r.n_func_evals << std::endl
-    << "n qp solves: " << r.n_qp_solves << std::endl;
+    << "n qp solves: " << r.n_qp_solves << std::endl
+    << "n early exits: " << r.n_early_exits << std::endl
+    << "n line search steps: " << r.n_line_search_steps << std::endl
+    << "n line search evals: " << r.n_line_search_evals << std::endl
+    << "n screened hinges: " << r.n_screened_hinges << std::endl
+    << "convexify time: " << r.convexify_time << std::endl
+    << "qp solve time: " << r.qp_solve_time << std::endl
+    << "evaluate time: " << r.evaluate_time << std::endl;
   return o;
 }
 
@@ -87,6 +96,49 @@ void BasicTrustRegionSQP::ctor(const OptProb::Ptr& prob)
 
 void BasicTrustRegionSQP::adjustTrustRegion(double ratio) { setTrustRegionSize(param_.trust_box_size * ratio); }
 void BasicTrustRegionSQP::setTrustRegionSize(double trust_box_size) { param_.trust_box_size = trust_box_size; }
+double BasicTrustRegionSQP::lineSearch(const DblVec& new_x,
+                                       double old_merit,
+                                       double approx_merit_improve,
+                                       const std::vector<Constraint::Ptr>& constraints,
+                                       const std::vector<double>& merit_error_coeffs)
+{
+  using Clock = std::chrono::high_resolution_clock;
+  auto evaluate_start_time = Clock::now();
+
+  DblVec trial_x(results_.x.size());
+  DblVec cost_vals;
+  DblVec cnt_viols;
+  double step_fraction = 1;
+  double accepted_step_fraction = 0;
+  for (int i = 0; i < param_.max_line_search_steps; ++i)
+  {
+    step_fraction *= param_.line_search_shrink_ratio;
+    for (std::size_t j = 0; j < trial_x.size(); ++j)
+      trial_x[j] = results_.x[j] + (step_fraction * (new_x[j] - results_.x[j]));
+
+    evaluateCostsAndConstraintViols(prob_->getCosts(), constraints, trial_x, cost_vals, cnt_viols);
+    ++results_.n_func_evals;
+    ++results_.n_line_search_evals;
+
+    // The convex model improves by at least step_fraction * approx_merit_improve along the step
+    const double exact_merit_improve = old_merit - (vecSum(cost_vals) + vecDot(cnt_viols, merit_error_coeffs));
+    LOG_DEBUG("line search step fraction %.3e: exact merit improve %.3e", step_fraction, exact_merit_improve);
+    if (exact_merit_improve > 0 &&
+        exact_merit_improve >= param_.improve_ratio_threshold * step_fraction * approx_merit_improve)
+    {
+      results_.x = trial_x;
+      results_.cost_vals = cost_vals;
+      results_.cnt_viols = cnt_viols;
+      ++results_.n_line_search_steps;
+      accepted_step_fraction = step_fraction;
+      break;
+    }
+  }
+
+  results_.evaluate_time += std::chrono::duration<double>(Clock::now() - evaluate_start_time).count();
+  return accepted_step_fraction;
+}
+
 void BasicTrustRegionSQP::setTrustBoxConstraints(const DblVec& x)
 {
   const VarVector& vars = prob_->getVars();
@@ -95,12 +147,113 @@ void BasicTrustRegionSQP::setTrustBoxConstraints(const DblVec& x)
   DblVec lbtrust(x.size()), ubtrust(x.size());
   for (size_t i = 0; i < x.size(); ++i)
   {
-    lbtrust[i] = fmax(x[i] - param_.trust_box_size, lb[i]);
-    ubtrust[i] = fmin(x[i] + param_.trust_box_size, ub[i]);
+    const double trust_box_size = param_.trust_box_size * (box_scaling_.empty() ? 1 : box_scaling_[i]);
+    lbtrust[i] = fmax(x[i] - trust_box_size, lb[i]);
+    ubtrust[i] = fmin(x[i] + trust_box_size, ub[i]);
   }
   model_->setVarBounds(vars, lbtrust, ubtrust);
 }
 
+/**
+ * @brief Scale each value relative to the median of the valid values
+ * @details Values that are not finite and positive get a scale of one
+ */
+static DblVec calcRelativeScaling(const DblVec& values, double max_scaling)
+{
+  DblVec valid;
+  valid.reserve(values.size());
+  for (double value : values)
+  {
+    if (std::isfinite(value) && value > 0)
+      valid.push_back(value);
+  }
+
+  DblVec scaling(values.size(), 1);
+  if (valid.empty())
+    return scaling;
+
+  auto median_it = valid.begin() + static_cast<std::ptrdiff_t>(valid.size() / 2);
+  std::nth_element(valid.begin(), median_it, valid.end());
+  const double median = *median_it;
+  for (std::size_t i = 0; i < values.size(); ++i)
+  {
+    if (std::isfinite(values[i]) && values[i] > 0)
+      scaling[i] = std::clamp(values[i] / median, 1.0 / max_scaling, max_scaling);
+  }
+  return scaling;
+}
+
+bool BasicTrustRegionSQP::updateMeritCoeffsFromDuals(std::vector<double>& merit_error_coeffs) const
+{
+  if (results_.cnt_duals.size() != merit_error_coeffs.size() || results_.cnt_viols.size() != merit_error_coeffs.size())
+    return false;
+
+  // The slack cost bounds each multiplier by the merit coefficient, so a multiplier within this tolerance of it is
+  // considered at its bound
+  const double bound_tolerance = 1e-3;
+
+  bool changed{ false };
+  for (std::size_t idx = 0; idx < merit_error_coeffs.size(); ++idx)
+  {
+    if (results_.cnt_viols[idx] <= param_.cnt_tolerance)
+      continue;
+
+    double multiplier{ 0 };
+    for (double dual : results_.cnt_duals[idx])
+      multiplier = std::max(multiplier, std::abs(dual));
+
+    double& coeff = merit_error_coeffs[idx];
+    if (multiplier >= (1.0 - bound_tolerance) * coeff)
+    {
+      LOG_INFO("Constraint %i multiplier is at its bound. Increasing constraint penalty", static_cast<int>(idx));
+      coeff *= param_.merit_coeff_increase_ratio;
+      changed = true;
+    }
+    else if ((1.0 + param_.merit_coeff_multiplier_margin) * multiplier > coeff)
+    {
+      LOG_INFO("Increasing constraint penalty for %i to its multiplier plus margin", static_cast<int>(idx));
+      coeff = (1.0 + param_.merit_coeff_multiplier_margin) * multiplier;
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+void BasicTrustRegionSQP::calcAutomaticScaling(const std::vector<Constraint::Ptr>& cnts,
+                                               std::vector<double>& merit_error_coeffs)
+{
+  // Variables with a larger range get a larger trust region
+  const DblVec &lb = prob_->getLowerBounds(), ub = prob_->getUpperBounds();
+  DblVec ranges(lb.size());
+  for (std::size_t i = 0; i < lb.size(); ++i)
+    ranges[i] = ub[i] - lb[i];
+  box_scaling_ = calcRelativeScaling(ranges, param_.max_automatic_scaling);
+
+  // Constraints with larger coefficients get a smaller merit coefficient so a violation of each costs about the same
+  if (cnts.empty())
+    return;
+
+  std::vector<ConvexConstraints::Ptr> cnt_models = convexifyConstraints(cnts, results_.x, model_.get());
+  DblVec coeff_norms(cnt_models.size(), 0);
+  for (std::size_t i = 0; i < cnt_models.size(); ++i)
+  {
+    for (const AffExprVector* exprs : { &cnt_models[i]->eqs_, &cnt_models[i]->ineqs_ })
+    {
+      for (const AffExpr& aff : *exprs)
+      {
+        for (double coeff : aff.coeffs)
+          coeff_norms[i] = fmax(coeff_norms[i], fabs(coeff));
+      }
+    }
+  }
+
+  DblVec cnt_scaling = calcRelativeScaling(coeff_norms, param_.max_automatic_scaling);
+  for (std::size_t i = 0; i < merit_error_coeffs.size(); ++i)
+    merit_error_coeffs[i] /= cnt_scaling[i];
+  LOG_DEBUG("automatic scaling merit_error_coeffs: %s", CSTR(merit_error_coeffs));
+}
+
 //////////////////////////////////////////////////
 ////// protected utility functions for  sqp //////
 //////////////////////////////////////////////////
@@ -164,6 +317,37 @@ DblVec BasicTrustRegionSQP::evaluateModelCntViols(const std::vector<ConvexConstr
   return out;
 }
 
+void BasicTrustRegionSQP::evaluateCostsAndConstraintViols(const std::vector<Cost::Ptr>& costs,
+                                                          const std::vector<Constraint::Ptr>& cnts,
+                                                          const DblVec& x,
+                                                          DblVec& cost_vals,
+                                                          DblVec& cnt_viols) const
+{
+  cnt_viols = evaluateConstraintViols(cnts, x);
+  cost_vals = evaluateCosts(costs, x);
+}
+
+void BasicTrustRegionSQP::convexifyCostsAndConstraints(const std::vector<Cost::Ptr>& costs,
+                                                       const std::vector<Constraint::Ptr>& cnts,
+                                                       const DblVec& x,
+                                                       Model* model,
+                                                       std::vector<ConvexObjective::Ptr>& cost_models,
+                                                       std::vector<ConvexConstraints::Ptr>& cnt_models) const
+{
+  cost_models = convexifyCosts(costs, x, model);
+  cnt_models = convexifyConstraints(cnts, x, model);
+}
+
+void BasicTrustRegionSQP::evaluateModelCostsAndCntViols(const std::vector<ConvexObjective::Ptr>& costs,
+                                                        const std::vector<ConvexConstraints::Ptr>& cnts,
+                                                        const DblVec& x,
+                                                        DblVec& cost_vals,
+                                                        DblVec& cnt_viols) const
+{
+  cost_vals = evaluateModelCosts(costs, x);
+  cnt_viols = evaluateModelCntViols(cnts, x);
+}
+
 std::vector<std::string> BasicTrustRegionSQP::getCostNames(const std::vector<Cost::Ptr>& costs) const
 {
   std::vector<std::string> out(costs.size());
@@ -190,14 +374,26 @@ std::vector<std::string> BasicTrustRegionSQP::getVarNames(const VarVector& vars)
   return out;
 }
 
+void BasicTrustRegionSQPMultiThreaded::setTaskExecutor(TaskExecutor::Ptr executor) { executor_ = std::move(executor); }
+
+TaskExecutor::Ptr BasicTrustRegionSQPMultiThreaded::getTaskExecutor() const
+{
+  return (executor_ != nullptr) ? executor_ : getDefaultTaskExecutor();
+}
+
+std::size_t BasicTrustRegionSQPMultiThreaded::getMaxConcurrency() const
+{
+  if (param_.num_threads < 0)
+    return 0;
+
+  return static_cast<std::size_t>(std::max(param_.num_threads, 1));
+}
+
 DblVec BasicTrustRegionSQPMultiThreaded::evaluateCosts(const std::vector<Cost::Ptr>& costs, const DblVec& x) const
 {
   DblVec out(costs.size());
-#pragma omp parallel for schedule(dynamic) num_threads(param_.num_threads) shared(out, costs, x)
-  for (int i = 0; i < static_cast<int>(costs.size()); ++i)
-  {
-    out[static_cast<std::size_t>(i)] = costs[static_cast<std::size_t>(i)]->value(x);
-  }
+  getTaskExecutor()->parallelFor(
+      costs.size(), getMaxConcurrency(), [&](std::size_t i) { out[i] = costs[i]->value(x); });
 
   return out;
 }
@@ -206,11 +402,8 @@ DblVec BasicTrustRegionSQPMultiThreaded::evaluateConstraintViols(const std::vect
                                                                  const DblVec& x) const
 {
   DblVec out(cnts.size());
-#pragma omp parallel for schedule(dynamic) num_threads(param_.num_threads) shared(out, cnts, x)
-  for (int i = 0; i < static_cast<int>(cnts.size()); ++i)
-  {
-    out[static_cast<std::size_t>(i)] = cnts[static_cast<std::size_t>(i)]->violation(x);
-  }
+  getTaskExecutor()->parallelFor(
+      cnts.size(), getMaxConcurrency(), [&](std::size_t i) { out[i] = cnts[i]->violation(x); });
 
   return out;
 }
@@ -220,11 +413,8 @@ std::vector<ConvexObjective::Ptr> BasicTrustRegionSQPMultiThreaded::convexifyCos
                                                                                    Model* model) const
 {
   std::vector<ConvexObjective::Ptr> out(costs.size());
-#pragma omp parallel for schedule(dynamic) num_threads(param_.num_threads) shared(out, costs, x, model)
-  for (int i = 0; i < static_cast<int>(costs.size()); ++i)
-  {
-    out[static_cast<std::size_t>(i)] = costs[static_cast<std::size_t>(i)]->convex(x, model);
-  }
+  getTaskExecutor()->parallelFor(
+      costs.size(), getMaxConcurrency(), [&](std::size_t i) { out[i] = costs[i]->convex(x, model); });
 
   return out;
 }
@@ -235,11 +425,8 @@ BasicTrustRegionSQPMultiThreaded::convexifyConstraints(const std::vector<Constra
                                                        Model* model) const
 {
   std::vector<ConvexConstraints::Ptr> out(cnts.size());
-#pragma omp parallel for schedule(dynamic) num_threads(param_.num_threads) shared(out, cnts, x, model)
-  for (int i = 0; i < static_cast<int>(cnts.size()); ++i)
-  {
-    out[static_cast<std::size_t>(i)] = cnts[static_cast<std::size_t>(i)]->convex(x, model);
-  }
+  getTaskExecutor()->parallelFor(
+      cnts.size(), getMaxConcurrency(), [&](std::size_t i) { out[i] = cnts[i]->convex(x, model); });
 
   return out;
 }
@@ -248,11 +435,8 @@ DblVec BasicTrustRegionSQPMultiThreaded::evaluateModelCosts(const std::vector<Co
                                                             const DblVec& x) const
 {
   DblVec out(costs.size());
-#pragma omp parallel for schedule(dynamic) num_threads(param_.num_threads) shared(out, costs, x)
-  for (int i = 0; i < static_cast<int>(costs.size()); ++i)
-  {
-    out[static_cast<std::size_t>(i)] = costs[static_cast<std::size_t>(i)]->value(x);
-  }
+  getTaskExecutor()->parallelFor(
+      costs.size(), getMaxConcurrency(), [&](std::size_t i) { out[i] = costs[i]->value(x); });
 
   return out;
 }
@@ -261,15 +445,107 @@ DblVec BasicTrustRegionSQPMultiThreaded::evaluateModelCntViols(const std::vector
                                                                const DblVec& x) const
 {
   DblVec out(cnts.size());
-#pragma omp parallel for schedule(dynamic) num_threads(param_.num_threads) shared(out, cnts, x)
-  for (int i = 0; i < static_cast<int>(cnts.size()); ++i)
-  {
-    out[static_cast<std::size_t>(i)] = cnts[static_cast<std::size_t>(i)]->violation(x);
-  }
+  getTaskExecutor()->parallelFor(
+      cnts.size(), getMaxConcurrency(), [&](std::size_t i) { out[i] = cnts[i]->violation(x); });
 
   return out;
 }
 
+namespace
+{
+/**
+ * @brief Run cost_fn for each cost and cnt_fn for each constraint in a single parallel region
+ * @details Terms are scheduled longest first based on times, which is updated with the measured time of each term
+ */
+template <typename CostFn, typename CntFn>
+void runCostsAndConstraints(std::size_t n_costs,
+                            std::size_t n_cnts,
+                            TaskExecutor& executor,
+                            std::size_t max_concurrency,
+                            std::vector<double>& times,
+                            const CostFn& cost_fn,
+                            const CntFn& cnt_fn)
+{
+  using Clock = std::chrono::high_resolution_clock;
+
+  const std::size_t n_terms = n_costs + n_cnts;
+  if (times.size() != n_terms)
+    times.assign(n_terms, 0);
+
+  std::vector<std::size_t> order(n_terms);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+      order.begin(), order.end(), [&times](std::size_t a, std::size_t b) { return times[a] > times[b]; });
+
+  executor.parallelFor(n_terms, max_concurrency, [&](std::size_t k) {
+    const std::size_t i = order[k];
+    auto start_time = Clock::now();
+    if (i < n_costs)
+      cost_fn(i);
+    else
+      cnt_fn(i - n_costs);
+
+    times[i] = std::chrono::duration<double>(Clock::now() - start_time).count();
+  });
+}
+}  // namespace
+
+void BasicTrustRegionSQPMultiThreaded::evaluateCostsAndConstraintViols(const std::vector<Cost::Ptr>& costs,
+                                                                       const std::vector<Constraint::Ptr>& cnts,
+                                                                       const DblVec& x,
+                                                                       DblVec& cost_vals,
+                                                                       DblVec& cnt_viols) const
+{
+  cost_vals.resize(costs.size());
+  cnt_viols.resize(cnts.size());
+  runCostsAndConstraints(
+      costs.size(),
+      cnts.size(),
+      *getTaskExecutor(),
+      getMaxConcurrency(),
+      eval_times_,
+      [&](std::size_t i) { cost_vals[i] = costs[i]->value(x); },
+      [&](std::size_t i) { cnt_viols[i] = cnts[i]->violation(x); });
+}
+
+void BasicTrustRegionSQPMultiThreaded::convexifyCostsAndConstraints(
+    const std::vector<Cost::Ptr>& costs,
+    const std::vector<Constraint::Ptr>& cnts,
+    const DblVec& x,
+    Model* model,
+    std::vector<ConvexObjective::Ptr>& cost_models,
+    std::vector<ConvexConstraints::Ptr>& cnt_models) const
+{
+  cost_models.assign(costs.size(), nullptr);
+  cnt_models.assign(cnts.size(), nullptr);
+  runCostsAndConstraints(
+      costs.size(),
+      cnts.size(),
+      *getTaskExecutor(),
+      getMaxConcurrency(),
+      convexify_times_,
+      [&](std::size_t i) { cost_models[i] = costs[i]->convex(x, model); },
+      [&](std::size_t i) { cnt_models[i] = cnts[i]->convex(x, model); });
+}
+
+void BasicTrustRegionSQPMultiThreaded::evaluateModelCostsAndCntViols(const std::vector<ConvexObjective::Ptr>& costs,
+                                                                     const std::vector<ConvexConstraints::Ptr>& cnts,
+                                                                     const DblVec& x,
+                                                                     DblVec& cost_vals,
+                                                                     DblVec& cnt_viols) const
+{
+  cost_vals.resize(costs.size());
+  cnt_viols.resize(cnts.size());
+  runCostsAndConstraints(
+      costs.size(),
+      cnts.size(),
+      *getTaskExecutor(),
+      getMaxConcurrency(),
+      model_eval_times_,
+      [&](std::size_t i) { cost_vals[i] = costs[i]->value(x); },
+      [&](std::size_t i) { cnt_viols[i] = cnts[i]->violation(x); });
+}
+
 #if 0
 struct MultiCritFilter {
   /**
@@ -320,8 +596,7 @@ void BasicTrustRegionSQPResults::update(const OptResults& prev_opt_results,
 {
   this->merit_error_coeffs = merit_error_coeffs;
   model_var_vals = model.getVarValues(model.getVars());
-  model_cost_vals = parent_.evaluateModelCosts(cost_models, model_var_vals);
-  model_cnt_viols = parent_.evaluateModelCntViols(cnt_models, model_var_vals);
+  parent_.evaluateModelCostsAndCntViols(cost_models, cnt_models, model_var_vals, model_cost_vals, model_cnt_viols);
 
   // the n variables of the OptProb happen to be the first n variables in
   // the Model
@@ -340,13 +615,27 @@ void BasicTrustRegionSQPResults::update(const OptResults& prev_opt_results,
 
   old_cost_vals = prev_opt_results.cost_vals;
   old_cnt_viols = prev_opt_results.cnt_viols;
-  new_cost_vals = parent_.evaluateCosts(costs, new_x);
-  new_cnt_viols = parent_.evaluateConstraintViols(constraints, new_x);
-
   old_merit = vecSum(old_cost_vals) + vecDot(old_cnt_viols, merit_error_coeffs);
   model_merit = vecSum(model_cost_vals) + vecDot(model_cnt_viols, merit_error_coeffs);
-  new_merit = vecSum(new_cost_vals) + vecDot(new_cnt_viols, merit_error_coeffs);
   approx_merit_improve = old_merit - model_merit;
+
+  const BasicTrustRegionSQPParameters& param = parent_.getParameters();
+  if (param.streaming_constraint_eval && approx_merit_improve > 0)
+  {
+    new_cost_vals = parent_.evaluateCosts(costs, new_x);
+
+    // The step is rejected if exact_merit_improve < 0 or merit_improve_ratio < improve_ratio_threshold
+    double rejection_merit = std::min(old_merit, old_merit - (param.improve_ratio_threshold * approx_merit_improve));
+    exact_evaluation_aborted = evaluateConstraintViolsStreaming(
+        constraints, static_cast<std::size_t>(std::max(param.streaming_constraint_chunk_size, 1)), rejection_merit);
+  }
+  else
+  {
+    parent_.evaluateCostsAndConstraintViols(costs, constraints, new_x, new_cost_vals, new_cnt_viols);
+    exact_evaluation_aborted = false;
+  }
+
+  new_merit = vecSum(new_cost_vals) + vecDot(new_cnt_viols, merit_error_coeffs);
   exact_merit_improve = old_merit - new_merit;
   merit_improve_ratio = exact_merit_improve / approx_merit_improve;
 
@@ -357,6 +646,61 @@ void BasicTrustRegionSQPResults::update(const OptResults& prev_opt_results,
   }
 }
 
+bool BasicTrustRegionSQPResults::evaluateConstraintViolsStreaming(const std::vector<Constraint::Ptr>& constraints,
+                                                                  std::size_t chunk_size,
+                                                                  double rejection_merit)
+{
+  using Clock = std::chrono::high_resolution_clock;
+
+  if (cnt_eval_times_.size() != constraints.size())
+    cnt_eval_times_.assign(constraints.size(), 0);
+
+  // Cheapest first, based on the times measured in previous evaluations
+  std::vector<std::size_t> order(constraints.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+    return cnt_eval_times_[a] < cnt_eval_times_[b];
+  });
+
+  // Costs are not bounded from below so they are always evaluated, constraint violations are non-negative
+  new_cnt_viols.assign(constraints.size(), 0);
+  double merit_lower_bound = vecSum(new_cost_vals);
+
+  std::vector<Constraint::Ptr> chunk;
+  chunk.reserve(chunk_size);
+  for (std::size_t start = 0; start < order.size(); start += chunk_size)
+  {
+    const std::size_t end = std::min(start + chunk_size, order.size());
+    chunk.clear();
+    for (std::size_t i = start; i < end; ++i)
+      chunk.push_back(constraints[order[i]]);
+
+    auto chunk_start_time = Clock::now();
+    DblVec chunk_viols = parent_.evaluateConstraintViols(chunk, new_x);
+    double chunk_time = std::chrono::duration<double>(Clock::now() - chunk_start_time).count();
+
+    for (std::size_t i = start; i < end; ++i)
+    {
+      const std::size_t idx = order[i];
+      new_cnt_viols[idx] = chunk_viols[i - start];
+      cnt_eval_times_[idx] = chunk_time / static_cast<double>(end - start);
+      merit_lower_bound += merit_error_coeffs[idx] * new_cnt_viols[idx];
+    }
+
+    if (end < order.size() && merit_lower_bound > rejection_merit)
+    {
+      LOG_DEBUG("stopped exact constraint evaluation after %i of %i constraints, merit lower bound %.3e > %.3e",
+                static_cast<int>(end),
+                static_cast<int>(order.size()),
+                merit_lower_bound,
+                rejection_merit);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void BasicTrustRegionSQPResults::print() const
 {
   // Print Header
@@ -656,6 +1000,10 @@ OptStatus BasicTrustRegionSQP::optimize()
 
   results_.x = prob_->getClosestFeasiblePoint(results_.x);
 
+  box_scaling_ = DblVec(results_.x.size(), 1);
+  if (param_.automatic_scaling)
+    calcAutomaticScaling(constraints, merit_error_coeffs);
+
   assert(results_.x.size() == prob_->getVars().size());
   assert(!prob_->getCosts().empty() || !constraints.empty());
 
@@ -692,8 +1040,8 @@ OptStatus BasicTrustRegionSQP::optimize()
       // that
       if (results_.cost_vals.empty() && results_.cnt_viols.empty())
       {  // only happens on the first iteration
-        results_.cnt_viols = evaluateConstraintViols(constraints, results_.x);
-        results_.cost_vals = evaluateCosts(prob_->getCosts(), results_.x);
+        evaluateCostsAndConstraintViols(
+            prob_->getCosts(), constraints, results_.x, results_.cost_vals, results_.cnt_viols);
         assert(results_.n_func_evals == 0);
         ++results_.n_func_evals;
       }
@@ -710,9 +1058,23 @@ OptStatus BasicTrustRegionSQP::optimize()
       //   results_.cost_vals[i] << endl;
       // }
 
-      std::vector<ConvexObjective::Ptr> cost_models = convexifyCosts(prob_->getCosts(), results_.x, model_.get());
-      std::vector<ConvexConstraints::Ptr> cnt_models = convexifyConstraints(constraints, results_.x, model_.get());
+      auto convexify_start_time = Clock::now();
+      std::vector<ConvexObjective::Ptr> cost_models;
+      std::vector<ConvexConstraints::Ptr> cnt_models;
+      convexifyCostsAndConstraints(prob_->getCosts(), constraints, results_.x, model_.get(), cost_models, cnt_models);
       std::vector<ConvexObjective::Ptr> cnt_cost_models = cntsToCosts(cnt_models, merit_error_coeffs, model_.get());
+      if (param_.screen_inactive_hinges)
+      {
+        // The trust box only shrinks until the next convexification so the screening stays valid for every QP solve
+        const double trust_box_size = param_.trust_box_size * vecMax(box_scaling_);
+        std::size_t n_screened{ 0 };
+        for (ConvexObjective::Ptr& cost : cost_models)
+          n_screened += cost->screenInactiveHinges(results_.x, trust_box_size);
+        for (ConvexObjective::Ptr& cost : cnt_cost_models)
+          n_screened += cost->screenInactiveHinges(results_.x, trust_box_size);
+        LOG_DEBUG("screened %i inactive hinges", static_cast<int>(n_screened));
+        results_.n_screened_hinges += static_cast<int>(n_screened);
+      }
       model_->update();
       for (ConvexObjective::Ptr& cost : cost_models)
         cost->addConstraintsToModel();
@@ -727,6 +1089,7 @@ OptStatus BasicTrustRegionSQP::optimize()
 
       //    objective = cleanupExpr(objective);
       model_->setObjective(objective);
+      results_.convexify_time += std::chrono::duration<double>(Clock::now() - convexify_start_time).count();
 
       //    if (logging::filter() >= IPI_LEVEL_DEBUG) {
       //      DblVec model_cost_vals;
@@ -741,7 +1104,9 @@ OptStatus BasicTrustRegionSQP::optimize()
       while (param_.trust_box_size >= param_.min_trust_box_size)
       {
         setTrustBoxConstraints(results_.x);
+        auto qp_start_time = Clock::now();
         CvxOptStatus status = model_->optimize();
+        results_.qp_solve_time += std::chrono::duration<double>(Clock::now() - qp_start_time).count();
 
         ++results_.n_qp_solves;
         if (status != CVX_SOLVED)
@@ -773,6 +1138,7 @@ OptStatus BasicTrustRegionSQP::optimize()
           goto cleanup;
         }
 
+        auto evaluate_start_time = Clock::now();
         iteration_results.update(results_,
                                  *model_,
                                  cost_models,
@@ -781,6 +1147,10 @@ OptStatus BasicTrustRegionSQP::optimize()
                                  constraints,
                                  prob_->getCosts(),
                                  merit_error_coeffs);
+        results_.cnt_duals.resize(cnt_cost_models.size());
+        for (std::size_t i = 0; i < cnt_cost_models.size(); ++i)
+          results_.cnt_duals[i] = cnt_cost_models[i]->getDuals();
+        results_.evaluate_time += std::chrono::duration<double>(Clock::now() - evaluate_start_time).count();
         if (SUPER_DEBUG_MODE)
         {
           model_->writeToFile("trajopt_model.txt");
@@ -803,6 +1173,8 @@ OptStatus BasicTrustRegionSQP::optimize()
         }
 
         ++results_.n_func_evals;
+        if (iteration_results.exact_evaluation_aborted)
+          ++results_.n_early_exits;
 
         if (iteration_results.approx_merit_improve < -1e-5)
         {
@@ -828,9 +1200,25 @@ OptStatus BasicTrustRegionSQP::optimize()
           retval = OPT_CONVERGED;
           goto penaltyadjustment;
         }
-        else if (iteration_results.exact_merit_improve < 0 ||
+        else if (iteration_results.exact_evaluation_aborted || iteration_results.exact_merit_improve < 0 ||
                  iteration_results.merit_improve_ratio < param_.improve_ratio_threshold)
         {
+          if (param_.line_search)
+          {
+            const double step_fraction = lineSearch(iteration_results.new_x,
+                                                    iteration_results.old_merit,
+                                                    iteration_results.approx_merit_improve,
+                                                    constraints,
+                                                    merit_error_coeffs);
+            if (step_fraction > 0)
+            {
+              adjustTrustRegion(step_fraction);
+              LOG_INFO("line search accepted %.3f of the step. new box size: %.4f",
+                       step_fraction,
+                       param_.trust_box_size);
+              break;
+            }
+          }
           adjustTrustRegion(param_.trust_shrink_ratio);
           LOG_INFO("shrunk trust region. new box size: %.4f", param_.trust_box_size);
         }
@@ -876,7 +1264,12 @@ OptStatus BasicTrustRegionSQP::optimize()
     }
     else
     {
-      if (param_.inflate_constraints_individually)
+      // Fall back to inflating the merit coefficients if the multipliers did not change any of them
+      if (param_.multiplier_merit_update && updateMeritCoeffsFromDuals(merit_error_coeffs))
+      {
+        LOG_INFO("Not all constraints are satisfied. Updated constraint penalties from the multipliers");
+      }
+      else if (param_.inflate_constraints_individually)
       {
         assert(results_.cnt_viols.size() == merit_error_coeffs.size());
         for (std::size_t idx = 0; idx < results_.cnt_viols.size(); idx++)
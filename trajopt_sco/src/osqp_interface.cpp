@@ -275,6 +275,17 @@ DblVec OSQPModel::getVarValues(const VarVector& vars) const
   return out;
 }
 
+DblVec OSQPModel::getCntDuals(const CntVector& cnts) const
+{
+  DblVec out(cnts.size());
+  for (unsigned i = 0; i < cnts.size(); ++i)
+  {
+    const std::size_t cntind = cnts[i].cnt_rep->index;
+    out[i] = duals_[cntind];
+  }
+  return out;
+}
+
 CvxOptStatus OSQPModel::optimize()
 {
   update();
@@ -342,6 +353,8 @@ CvxOptStatus OSQPModel::optimize()
   {
     // opt += m_objective.affexpr.constant;
     solution_ = DblVec(osqp_workspace_->solution->x, osqp_workspace_->solution->x + vars_.size());
+    // The first rows are the constraints, followed by the variable bounds
+    duals_ = DblVec(osqp_workspace_->solution->y, osqp_workspace_->solution->y + cnts_.size());
     auto status = static_cast<int>(osqp_workspace_->info->status_val);
 
     if (OSQP_COMPARE_DEBUG_MODE)
@@ -218,6 +218,17 @@ DblVec qpOASESModel::getVarValues(const VarVector& vars) const
   return out;
 }
 
+DblVec qpOASESModel::getCntDuals(const CntVector& cnts) const
+{
+  DblVec out(cnts.size());
+  for (size_t i = 0; i < cnts.size(); ++i)
+  {
+    const size_t cntind = cnts[i].cnt_rep->index;
+    out[i] = duals_[cntind];
+  }
+  return out;
+}
+
 CvxOptStatus qpOASESModel::optimize()
 {
   update();
@@ -250,6 +261,14 @@ CvxOptStatus qpOASESModel::optimize()
     solution_.resize(vars_.size(), 0.);
     //    val = qpoases_problem_->getPrimalSolution(solution_.data());
     qpoases_problem_->getPrimalSolution(solution_.data());
+
+    // qpOASES returns the duals of the bounds followed by the constraints, with the opposite sign convention
+    DblVec duals(vars_.size() + cnts_.size(), 0.);
+    qpoases_problem_->getDualSolution(duals.data());
+    duals_.resize(cnts_.size());
+    for (size_t i = 0; i < cnts_.size(); ++i)
+      duals_[i] = -duals[vars_.size() + i];
+
     return CVX_SOLVED;
   }
 
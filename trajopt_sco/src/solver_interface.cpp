@@ -131,6 +131,14 @@ double Model::getVarValue(const Var& var) const
   return getVarValues(vars)[0];
 }
 
+double Model::getCntDual(const Cnt& cnt) const
+{
+  CntVector cnts(1, cnt);
+  return getCntDuals(cnts)[0];
+}
+
+DblVec Model::getCntDuals(const CntVector& cnts) const { return DblVec(cnts.size(), 0); }
+
 void Model::setVarBounds(const Var& var, double lower, double upper)
 {
   DblVec lowers(1, lower), uppers(1, upper);
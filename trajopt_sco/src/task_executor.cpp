@@ -0,0 +1,159 @@
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <atomic>
+#include <exception>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/task_executor.hpp>
+
+namespace sco
+{
+struct ThreadPoolExecutor::Job
+{
+  const std::function<void(std::size_t)>* fn{ nullptr };
+  std::size_t n{ 0 };
+  /** @brief The next index to claim, it is only valid while less than n */
+  std::atomic<std::size_t> next{ 0 };
+  /** @brief The number of claimed indices which have finished */
+  std::atomic<std::size_t> n_done{ 0 };
+  std::atomic<bool> failed{ false };
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable done_cv;
+
+  /** @brief Run indices until all of them are claimed */
+  void run()
+  {
+    for (std::size_t i = next++; i < n; i = next++)
+    {
+      if (!failed)
+      {
+        try
+        {
+          (*fn)(i);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error)
+            error = std::current_exception();
+          failed = true;
+        }
+      }
+
+      if (++n_done == n)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done_cv.notify_all();
+      }
+    }
+  }
+};
+
+ThreadPoolExecutor::ThreadPoolExecutor(std::size_t num_threads)
+{
+  if (num_threads == 0)
+    num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+  workers_.reserve(num_threads - 1);
+  for (std::size_t i = 1; i < num_threads; ++i)
+    workers_.emplace_back([this]() { workerLoop(); });
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+}
+
+void ThreadPoolExecutor::parallelFor(std::size_t n,
+                                     std::size_t max_concurrency,
+                                     const std::function<void(std::size_t)>& fn)
+{
+  if (max_concurrency == 0)
+    max_concurrency = getConcurrency();
+
+  const std::size_t n_threads = std::min({ max_concurrency, getConcurrency(), n });
+  if (n_threads <= 1)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      fn(i);
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->n = n;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.insert(queue_.end(), n_threads - 1, job);
+  }
+  if (n_threads == 2)
+    cv_.notify_one();
+  else
+    cv_.notify_all();
+
+  job->run();
+
+  // Workers which have not picked up the job yet have nothing left to do
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.erase(std::remove(queue_.begin(), queue_.end(), job), queue_.end());
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done_cv.wait(lock, [&job]() { return job->n_done == job->n; });
+  }
+
+  if (job->error)
+    std::rethrow_exception(job->error);
+}
+
+std::size_t ThreadPoolExecutor::getConcurrency() const { return workers_.size() + 1; }
+
+void ThreadPoolExecutor::workerLoop()
+{
+  while (true)
+  {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (stop_)
+        return;
+
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    job->run();
+  }
+}
+
+namespace
+{
+std::mutex default_executor_mutex;
+TaskExecutor::Ptr default_executor;  // NOLINT
+}  // namespace
+
+TaskExecutor::Ptr getDefaultTaskExecutor()
+{
+  std::lock_guard<std::mutex> lock(default_executor_mutex);
+  if (default_executor == nullptr)
+    default_executor = std::make_shared<ThreadPoolExecutor>();
+
+  return default_executor;
+}
+
+void setDefaultTaskExecutor(TaskExecutor::Ptr executor)
+{
+  std::lock_guard<std::mutex> lock(default_executor_mutex);
+  default_executor = std::move(executor);
+}
+}  // namespace sco
@@ -27,6 +27,17 @@ protected:
   SQP() = default;
 };
 
+/** @brief Runs on every solver of the SQP tests which provides constraint duals */
+class SQPWithDuals : public testing::TestWithParam<ModelType>
+{
+protected:
+  SQPWithDuals() = default;
+};
+#ifdef GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST
+// Builds may only have solvers without constraint duals
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(SQPWithDuals);
+#endif
+
 void setupProblem(OptProb::Ptr& probptr, size_t nvars, ModelType convex_solver)
 {
   probptr = std::make_shared<OptProb>(convex_solver);
@@ -173,6 +184,260 @@ TEST_P(SQP, TP7)  // NOLINT
               GetParam());
 }
 
+double f_Streaming(const VectorXd& x) { return sq(x(0) - 3) + sq(x(1) - 3); }
+VectorXd g_Streaming(const VectorXd& x)
+{
+  VectorXd out(1);
+  out(0) = sq(x(0)) + sq(x(1)) - 4;
+  return out;
+}
+
+/** @brief Create the problem of minimizing f_Streaming subject to n_constraints copies of the g_Streaming inequality */
+OptProb::Ptr makeStreamingProblem(int n_constraints, ModelType convex_solver)
+{
+  OptProb::Ptr prob;
+  setupProblem(prob, 2, convex_solver);
+  prob->addCost(std::make_shared<CostFromFunc>(ScalarOfVector::construct(&f_Streaming), prob->getVars(), "f", true));
+  for (int i = 0; i < n_constraints; ++i)
+  {
+    prob->addConstraint(std::make_shared<ConstraintFromErrFunc>(
+        VectorOfVector::construct(&g_Streaming), prob->getVars(), VectorXd(), INEQ, "g_" + std::to_string(i)));
+  }
+  return prob;
+}
+
+/** @brief Set the parameters shared by the solves of makeStreamingProblem */
+void setStreamingParameters(BasicTrustRegionSQPParameters& params)
+{
+  params.max_iter = 1000;
+  params.min_trust_box_size = 1e-5;
+  params.min_approx_improve = 1e-10;
+  params.initial_merit_error_coeff = 1;
+}
+
+/** @brief Solve a problem created by makeStreamingProblem from its start point, it must converge */
+OptResults solveStreamingProblem(BasicTrustRegionSQP& solver)
+{
+  solver.initialize({ 10, 1 });
+  EXPECT_EQ(solver.optimize(), OPT_CONVERGED);
+  return solver.results();
+}
+
+TEST_P(SQP, StreamingConstraintEval)  // NOLINT
+{
+  // Evaluating the constraints in chunks with early exit must not change the accepted steps
+  auto solve = [](bool streaming, ModelType convex_solver) {
+    BasicTrustRegionSQP solver(makeStreamingProblem(10, convex_solver));
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    setStreamingParameters(params);
+    params.streaming_constraint_eval = streaming;
+    params.streaming_constraint_chunk_size = 2;
+    return solveStreamingProblem(solver);
+  };
+
+  OptResults full = solve(false, GetParam());
+  OptResults streaming = solve(true, GetParam());
+  EXPECT_EQ(full.n_early_exits, 0);
+  EXPECT_GT(streaming.n_early_exits, 0);
+  EXPECT_EQ(full.n_qp_solves, streaming.n_qp_solves);
+  expectAllNear(streaming.x, full.x, 1e-6);
+  expectAllNear(streaming.x, { std::sqrt(2.), std::sqrt(2.) }, .01);
+}
+
+TEST_P(SQP, MultiThreadedMatchesSingleThreaded)  // NOLINT
+{
+  // Costs and constraints share one parallel region in the multi threaded solver, the result must not change
+  auto solve = [](BasicTrustRegionSQP& solver) {
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    setStreamingParameters(params);
+    params.num_threads = 2;
+    return solveStreamingProblem(solver);
+  };
+
+  BasicTrustRegionSQP single_threaded(makeStreamingProblem(10, GetParam()));
+  BasicTrustRegionSQPMultiThreaded multi_threaded(makeStreamingProblem(10, GetParam()));
+  OptResults single_results = solve(single_threaded);
+  OptResults multi_results = solve(multi_threaded);
+  EXPECT_EQ(single_results.n_qp_solves, multi_results.n_qp_solves);
+  expectAllNear(multi_results.x, single_results.x, 1e-6);
+}
+
+TEST_P(SQP, LineSearch)  // NOLINT
+{
+  // A large trust region makes the first steps fail the ratio test, the line search accepts fractions of them
+  auto solve = [](bool line_search, ModelType convex_solver) {
+    BasicTrustRegionSQP solver(makeStreamingProblem(1, convex_solver));
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    setStreamingParameters(params);
+    params.trust_box_size = 10;
+    params.line_search = line_search;
+    return solveStreamingProblem(solver);
+  };
+
+  OptResults shrink = solve(false, GetParam());
+  OptResults line_search = solve(true, GetParam());
+  EXPECT_EQ(shrink.n_line_search_steps, 0);
+  EXPECT_EQ(shrink.n_line_search_evals, 0);
+  EXPECT_GT(line_search.n_line_search_evals, 0);
+  EXPECT_GT(line_search.n_line_search_steps, 0);
+  EXPECT_LE(line_search.n_line_search_steps, line_search.n_line_search_evals);
+  EXPECT_LT(line_search.n_qp_solves, shrink.n_qp_solves);
+  expectAllNear(shrink.x, { std::sqrt(2.), std::sqrt(2.) }, .01);
+  expectAllNear(line_search.x, { std::sqrt(2.), std::sqrt(2.) }, .01);
+}
+
+/** @brief Exposes the merit coefficient update from the multipliers */
+class MultiplierMeritSQP : public BasicTrustRegionSQP
+{
+public:
+  using BasicTrustRegionSQP::BasicTrustRegionSQP;
+  using BasicTrustRegionSQP::updateMeritCoeffsFromDuals;
+};
+
+TEST_P(SQP, MultiplierMeritUpdate)  // NOLINT
+{
+  // Only violated constraints change. A multiplier at its bound inflates the coefficient, a smaller one sets it to the
+  // largest multiplier magnitude plus the margin
+  {
+    MultiplierMeritSQP solver;
+    solver.getParameters().merit_coeff_multiplier_margin = 0.5;
+    solver.results().cnt_viols = { 1, 1, 0, 1 };
+    solver.results().cnt_duals = { { 0.2, -1 }, { 0.8, -0.1 }, { 1 }, { 0.1 } };
+    std::vector<double> merit_error_coeffs(4, 1);
+    EXPECT_TRUE(solver.updateMeritCoeffsFromDuals(merit_error_coeffs));
+    const double increase_ratio = solver.getParameters().merit_coeff_increase_ratio;
+    expectAllNear(merit_error_coeffs, { increase_ratio, 1.2, 1, 1 }, 1e-12);
+
+    solver.results().cnt_viols = { 0, 0, 0, 0 };
+    EXPECT_FALSE(solver.updateMeritCoeffsFromDuals(merit_error_coeffs));
+    expectAllNear(merit_error_coeffs, { increase_ratio, 1.2, 1, 1 }, 1e-12);
+  }
+}
+
+TEST_P(SQPWithDuals, MultiplierMeritUpdateFromDuals)  // NOLINT
+{
+  // With a merit coefficient below the multiplier the constraint stays violated and the duals raise its coefficient
+  {
+    MultiplierMeritSQP solver(makeStreamingProblem(1, GetParam()));
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    setStreamingParameters(params);
+    params.initial_merit_error_coeff = 0.1;
+    params.max_merit_coeff_increases = 1;
+    solver.initialize({ 10, 1 });
+    EXPECT_EQ(solver.optimize(), OPT_PENALTY_ITERATION_LIMIT);
+
+    const OptResults& results = solver.results();
+    ASSERT_EQ(results.cnt_viols.size(), 1);
+    ASSERT_EQ(results.cnt_duals.size(), 1);
+    ASSERT_EQ(results.cnt_duals[0].size(), 1);
+    EXPECT_GT(results.cnt_viols[0], params.cnt_tolerance);
+    EXPECT_GT(std::abs(results.cnt_duals[0][0]), 0);
+
+    std::vector<double> merit_error_coeffs{ 0.1 };
+    EXPECT_TRUE(solver.updateMeritCoeffsFromDuals(merit_error_coeffs));
+    EXPECT_GT(merit_error_coeffs[0], 0.1);
+  }
+
+  // The coefficient is raised from the multipliers until the constraint is satisfied
+  auto solve = [](bool multiplier_merit_update, ModelType convex_solver) {
+    BasicTrustRegionSQP solver(makeStreamingProblem(1, convex_solver));
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    setStreamingParameters(params);
+    params.initial_merit_error_coeff = 0.1;
+    params.multiplier_merit_update = multiplier_merit_update;
+    return solveStreamingProblem(solver);
+  };
+
+  OptResults inflated = solve(false, GetParam());
+  OptResults updated = solve(true, GetParam());
+  expectAllNear(inflated.x, { std::sqrt(2.), std::sqrt(2.) }, .01);
+  expectAllNear(updated.x, { std::sqrt(2.), std::sqrt(2.) }, .01);
+  ASSERT_EQ(updated.cnt_duals.size(), 1);
+  ASSERT_EQ(updated.cnt_duals[0].size(), 1);
+  EXPECT_GT(std::abs(updated.cnt_duals[0][0]), 0);
+}
+
+VectorXd g_Far(const VectorXd& x)
+{
+  VectorXd out(1);
+  out(0) = x(0) + x(1) - 100;
+  return out;
+}
+TEST_P(SQP, ScreenInactiveHinges)  // NOLINT
+{
+  // Only hinges that cannot become positive inside the trust box may be dropped
+  {
+    OptProb::Ptr prob;
+    setupProblem(prob, 2, GetParam());
+    const VarVector& vars = prob->getVars();
+    ConvexObjective obj(prob->getModel().get());
+    obj.addHinge(exprSub(AffExpr(vars[0]), 1.), 1);
+    obj.addHinge(exprSub(AffExpr(vars[0]), 1.2), 1);
+    obj.addHinge(exprSub(AffExpr(vars[0]), 5.), 1);
+    EXPECT_EQ(obj.screenInactiveHinges({ 1, 1 }, 0.1), 2);
+    ASSERT_EQ(obj.ineqs_.size(), 1);
+    ASSERT_EQ(obj.hinge_ineqs_.size(), 1);
+    EXPECT_EQ(obj.vars_.size(), 1);
+    EXPECT_EQ(obj.quad_.affexpr.vars.size(), 1);
+    EXPECT_NEAR(obj.ineqs_[0].constant, -1, 1e-12);
+  }
+
+  // Screening must not change the accepted steps
+  auto solve = [](bool screen, ModelType convex_solver) {
+    OptProb::Ptr prob = makeStreamingProblem(1, convex_solver);
+    for (int i = 0; i < 10; ++i)
+    {
+      prob->addConstraint(std::make_shared<ConstraintFromErrFunc>(
+          VectorOfVector::construct(&g_Far), prob->getVars(), VectorXd(), INEQ, "far_" + std::to_string(i)));
+    }
+    BasicTrustRegionSQP solver(prob);
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    setStreamingParameters(params);
+    params.screen_inactive_hinges = screen;
+    return solveStreamingProblem(solver);
+  };
+
+  OptResults full = solve(false, GetParam());
+  OptResults screened = solve(true, GetParam());
+  EXPECT_EQ(full.n_screened_hinges, 0);
+  EXPECT_GT(screened.n_screened_hinges, 0);
+  EXPECT_EQ(full.n_qp_solves, screened.n_qp_solves);
+  expectAllNear(screened.x, full.x, 1e-6);
+}
+
+/** @brief Jacobian calculator whose combined error deliberately differs from the error function it is used with */
+class OffsetErrJacCalculator : public MatrixOfVector, public VectorAndMatrixOfVector
+{
+public:
+  MatrixXd operator()(const VectorXd& x) const override { return MatrixXd::Identity(x.size(), x.size()); }
+  void operator()(const VectorXd& x, VectorXd& y, MatrixXd& jac) const override
+  {
+    y = x.array() + 1;
+    jac = MatrixXd::Identity(x.size(), x.size());
+  }
+};
+TEST_P(SQP, ErrFuncCombinedCalculatorIsOptIn)  // NOLINT
+{
+  // The combined calculator must only replace the error function when it is passed explicitly
+  OptProb::Ptr prob;
+  setupProblem(prob, 2, GetParam());
+  Model* model = prob->getModel().get();
+  auto f = VectorOfVector::construct([](const VectorXd& x) { return x; });
+  auto dfdx = std::make_shared<OffsetErrJacCalculator>();
+  const DblVec x = { 1, 2 };
+  const VectorXd coeffs = VectorXd::Ones(2);
+
+  CostFromErrFunc cost(f, dfdx, prob->getVars(), coeffs, SQUARED, "cost");
+  EXPECT_NEAR(cost.convex(x, model)->value(x), 5, 1e-12);
+  CostFromErrFunc combined_cost(f, dfdx, dfdx, prob->getVars(), coeffs, SQUARED, "combined_cost");
+  EXPECT_NEAR(combined_cost.convex(x, model)->value(x), 13, 1e-12);
+
+  ConstraintFromErrFunc cnt(f, dfdx, prob->getVars(), coeffs, EQ, "cnt");
+  expectAllNear(cnt.convex(x, model)->violations(x), { 1, 2 }, 1e-12);
+  ConstraintFromErrFunc combined_cnt(f, dfdx, dfdx, prob->getVars(), coeffs, EQ, "combined_cnt");
+  expectAllNear(combined_cnt.convex(x, model)->violations(x), { 2, 3 }, 1e-12);
+}
+
 auto getAvailableSolvers = []() {
   std::vector<ModelType> solvers = availableSolvers();
   auto it = std::find(solvers.begin(), solvers.end(), ModelType::OSQP);
@@ -184,3 +449,16 @@ auto getAvailableSolvers = []() {
 };
 
 INSTANTIATE_TEST_CASE_P(AllSolvers, SQP, testing::ValuesIn(getAvailableSolvers()));
+
+// BPMPD does not provide constraint duals
+auto getDualSQPSolvers = []() {
+  std::vector<ModelType> solvers = getAvailableSolvers();
+  auto it = std::find(solvers.begin(), solvers.end(), ModelType::BPMPD);
+  if (it != solvers.end())
+  {
+    solvers.erase(it);
+  };
+  return solvers;
+};
+
+INSTANTIATE_TEST_CASE_P(AllSolvers, SQPWithDuals, testing::ValuesIn(getDualSQPSolvers()));
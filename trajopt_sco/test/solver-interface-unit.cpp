@@ -18,6 +18,17 @@ protected:
   SolverInterface() = default;
 };
 
+/** @brief Runs on every available solver which provides constraint duals, including OSQP */
+class ConstraintDuals : public testing::TestWithParam<ModelType>
+{
+protected:
+  ConstraintDuals() = default;
+};
+#ifdef GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST
+// Builds may only have solvers without constraint duals
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(ConstraintDuals);
+#endif
+
 TEST(SolverInterface, simplify2)  // NOLINT
 {
   IntVec indices = { 0, 1, 3 };
@@ -236,6 +247,45 @@ TEST_P(SolverInterface, ExprMult_test3)  // NOLINT
   EXPECT_NEAR(aff12.value(soln), answer, 1e-6);
 }
 
+// Tests the constraint duals of min (v1 - 2)^2 + v2^2 s.t. v1 - 1 <= 0, v2 - 5 <= 0 and v2 - 1 == 0
+TEST_P(ConstraintDuals, constraint_duals)  // NOLINT
+{
+  Model::Ptr solver = createModel(GetParam());
+  Var v1 = solver->addVar("v1");
+  Var v2 = solver->addVar("v2");
+  solver->update();
+
+  AffExpr aff1(v1);
+  aff1.constant = -2;
+  QuadExpr objective = exprSquare(aff1);
+  exprInc(objective, exprSquare(AffExpr(v2)));
+  solver->setObjective(objective);
+
+  AffExpr active(v1);
+  active.constant = -1;
+  AffExpr inactive(v2);
+  inactive.constant = -5;
+  AffExpr equality(v2);
+  equality.constant = -1;
+  CntVector cnts;
+  cnts.push_back(solver->addIneqCnt(active, "active"));
+  cnts.push_back(solver->addIneqCnt(inactive, "inactive"));
+  cnts.push_back(solver->addEqCnt(equality, "equality"));
+  solver->update();
+
+  EXPECT_EQ(solver->optimize(), CVX_SOLVED);
+  EXPECT_NEAR(solver->getVarValue(v1), 1, 1e-3);
+  EXPECT_NEAR(solver->getVarValue(v2), 1, 1e-3);
+
+  // The stationarity of the lagrangian gives 2 * (v1 - 2) + y1 = 0 and 2 * v2 + y2 + y3 = 0
+  DblVec duals = solver->getCntDuals(cnts);
+  ASSERT_EQ(duals.size(), 3);
+  EXPECT_NEAR(duals[0], 2, 1e-2);
+  EXPECT_NEAR(duals[1], 0, 1e-2);
+  EXPECT_NEAR(duals[2], -2, 1e-2);
+  EXPECT_NEAR(solver->getCntDual(cnts[0]), duals[0], 1e-8);
+}
+
 auto getAvailableSolvers = []() {
   std::vector<ModelType> solvers = availableSolvers();
   auto it = std::find(solvers.begin(), solvers.end(), ModelType::OSQP);
@@ -247,3 +297,16 @@ auto getAvailableSolvers = []() {
 };
 
 INSTANTIATE_TEST_CASE_P(AllSolvers, SolverInterface, testing::ValuesIn(getAvailableSolvers()));
+
+// BPMPD does not provide constraint duals
+auto getDualSolvers = []() {
+  std::vector<ModelType> solvers = availableSolvers();
+  auto it = std::find(solvers.begin(), solvers.end(), ModelType::BPMPD);
+  if (it != solvers.end())
+  {
+    solvers.erase(it);
+  };
+  return solvers;
+};
+
+INSTANTIATE_TEST_CASE_P(AllSolvers, ConstraintDuals, testing::ValuesIn(getDualSolvers()));
@@ -0,0 +1,143 @@
+#include <trajopt_common/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/optimizers.hpp>
+#include <trajopt_sco/task_executor.hpp>
+
+using namespace sco;
+
+namespace
+{
+/** @brief Runs the tasks on the calling thread and records the requested concurrency */
+class SerialTaskExecutor : public TaskExecutor
+{
+public:
+  void parallelFor(std::size_t n, std::size_t max_concurrency, const std::function<void(std::size_t)>& fn) override
+  {
+    ++n_calls;
+    last_max_concurrency = max_concurrency;
+    for (std::size_t i = 0; i < n; ++i)
+      fn(i);
+  }
+
+  std::size_t getConcurrency() const override { return 1; }
+
+  int n_calls{ 0 };
+  std::size_t last_max_concurrency{ 0 };
+};
+
+/** @brief A cost whose value is its index */
+class IndexCost : public Cost
+{
+public:
+  explicit IndexCost(double index) : index_(index) {}
+  double value(const DblVec& /*x*/) override { return index_; }
+  ConvexObjective::Ptr convex(const DblVec& /*x*/, Model* /*model*/) override { return nullptr; }
+  VarVector getVars() override { return {}; }
+
+private:
+  double index_;
+};
+}  // namespace
+
+TEST(TaskExecutor, parallelFor)  // NOLINT
+{
+  ThreadPoolExecutor executor(4);
+  EXPECT_EQ(executor.getConcurrency(), 4);
+
+  for (std::size_t max_concurrency : { 0, 1, 2, 8 })
+  {
+    std::vector<std::atomic<int>> counts(1000);
+    std::atomic<int> running{ 0 };
+    std::atomic<int> max_running{ 0 };
+    executor.parallelFor(counts.size(), max_concurrency, [&](std::size_t i) {
+      const int n_running = ++running;
+      int prev = max_running;
+      while (n_running > prev && !max_running.compare_exchange_weak(prev, n_running))
+      {
+      }
+      ++counts[i];
+      --running;
+    });
+
+    for (const auto& count : counts)
+      EXPECT_EQ(count, 1);
+
+    if (max_concurrency != 0)
+    {
+      EXPECT_LE(max_running, static_cast<int>(max_concurrency));
+    }
+    EXPECT_LE(max_running, 4);
+  }
+
+  executor.parallelFor(0, 0, [](std::size_t /*i*/) { FAIL(); });
+}
+
+TEST(TaskExecutor, nestedParallelFor)  // NOLINT
+{
+  ThreadPoolExecutor executor(2);
+
+  std::atomic<int> count{ 0 };
+  executor.parallelFor(8, 0, [&](std::size_t /*i*/) {
+    executor.parallelFor(8, 0, [&](std::size_t /*j*/) { ++count; });
+  });
+  EXPECT_EQ(count, 64);
+}
+
+TEST(TaskExecutor, exception)  // NOLINT
+{
+  ThreadPoolExecutor executor(3);
+
+  EXPECT_THROW(executor.parallelFor(100,
+                                    0,
+                                    [](std::size_t i) {
+                                      if (i == 10)
+                                        throw std::runtime_error("failed");
+                                    }),
+               std::runtime_error);
+
+  // The executor is still usable
+  std::atomic<int> count{ 0 };
+  executor.parallelFor(100, 0, [&](std::size_t /*i*/) { ++count; });
+  EXPECT_EQ(count, 100);
+}
+
+TEST(TaskExecutor, optimizerExecutor)  // NOLINT
+{
+  std::vector<Cost::Ptr> costs;
+  for (int i = 0; i < 10; ++i)
+    costs.push_back(std::make_shared<IndexCost>(i));
+
+  BasicTrustRegionSQPMultiThreaded opt;
+  EXPECT_EQ(opt.getTaskExecutor(), getDefaultTaskExecutor());
+
+  auto executor = std::make_shared<SerialTaskExecutor>();
+  opt.setTaskExecutor(executor);
+  opt.getParameters().num_threads = 3;
+  DblVec cost_vals = opt.evaluateCosts(costs, DblVec());
+  EXPECT_EQ(executor->n_calls, 1);
+  EXPECT_EQ(executor->last_max_concurrency, 3);
+  for (std::size_t i = 0; i < cost_vals.size(); ++i)
+    EXPECT_EQ(cost_vals[i], static_cast<double>(i));
+
+  // Zero keeps the serial default, a negative value leaves the concurrency to the executor
+  opt.getParameters().num_threads = 0;
+  opt.evaluateCosts(costs, DblVec());
+  EXPECT_EQ(executor->last_max_concurrency, 1);
+  opt.getParameters().num_threads = -1;
+  opt.evaluateCosts(costs, DblVec());
+  EXPECT_EQ(executor->last_max_concurrency, 0);
+
+  // The process wide default is used by optimizers without an executor
+  opt.setTaskExecutor(nullptr);
+  setDefaultTaskExecutor(executor);
+  opt.evaluateCosts(costs, DblVec());
+  EXPECT_EQ(executor->n_calls, 4);
+  setDefaultTaskExecutor(nullptr);
+  EXPECT_NE(opt.getTaskExecutor(), executor);
+}